@@ -7,7 +7,7 @@
 // Module Name:   AHBDCD 
 // Description:   Address decoder for AHB Lite bus, incomplete
 //          Examines the 8 MSBs of the address signal.
-//			Outputs ten individual slave select signals and a 4-bit signal
+//			Outputs twelve individual slave select signals and a 4-bit signal
 //          to tell the multiplexers which slave is active.
 //
 //////////////////////////////////////////////////////////////////////////////////
@@ -23,7 +23,9 @@ module AHBDCD(
     output reg HSEL_S6,
     output reg HSEL_S7,
     output reg HSEL_S8,
-    output reg HSEL_S9,       // slave select line 9
+    output reg HSEL_S9,
+    output reg HSEL_S10,
+    output reg HSEL_S11,      // slave select line 11
     output reg HSEL_NOMAP,    // indicates invalid address  
     output reg [3:0] MUX_SEL  // multiplexer control signal
     );  // end of port list
@@ -43,6 +45,8 @@ always @ (HADDR)
         HSEL_S7 = 1'b0;
         HSEL_S8 = 1'b0;
         HSEL_S9 = 1'b0;
+        HSEL_S10 = 1'b0;
+        HSEL_S11 = 1'b0;
         HSEL_NOMAP = 1'b0;
         
 // Logic to select one slave, and also output the slave number to the multiplexers
@@ -78,6 +82,48 @@ always @ (HADDR)
                     MUX_SEL = 4'd4;     // send slave number 4 to multiplexers
                 end
 
+            8'h53: 				// Address range 0x5300_0000 to 0x53FF_FFFF  16MB - SPI
+                begin
+                    HSEL_S5 = 1'b1;     // activate slave select 5 output
+                    MUX_SEL = 4'd5;     // send slave number 5 to multiplexers
+                end
+
+            8'h54: 				// Address range 0x5400_0000 to 0x54FF_FFFF  16MB - ACCELEROMETER SAMPLER
+                begin
+                    HSEL_S6 = 1'b1;     // activate slave select 6 output
+                    MUX_SEL = 4'd6;     // send slave number 6 to multiplexers
+                end
+
+            8'h55: 				// Address range 0x5500_0000 to 0x55FF_FFFF  16MB - ARITHMETIC UNIT
+                begin
+                    HSEL_S7 = 1'b1;     // activate slave select 7 output
+                    MUX_SEL = 4'd7;     // send slave number 7 to multiplexers
+                end
+
+            8'h56: 				// Address range 0x5600_0000 to 0x56FF_FFFF  16MB - PERFORMANCE COUNTERS
+                begin
+                    HSEL_S8 = 1'b1;     // activate slave select 8 output
+                    MUX_SEL = 4'd8;     // send slave number 8 to multiplexers
+                end
+
+            8'h57: 				// Address range 0x5700_0000 to 0x57FF_FFFF  16MB - DMA CONTROLLER
+                begin
+                    HSEL_S9 = 1'b1;     // activate slave select 9 output
+                    MUX_SEL = 4'd9;     // send slave number 9 to multiplexers
+                end
+
+            8'h58: 				// Address range 0x5800_0000 to 0x58FF_FFFF  16MB - MAILBOX
+                begin
+                    HSEL_S10 = 1'b1;    // activate slave select 10 output
+                    MUX_SEL = 4'd10;    // send slave number 10 to multiplexers
+                end
+
+            8'h59: 				// Address range 0x5900_0000 to 0x59FF_FFFF  16MB - CORDIC UNIT
+                begin
+                    HSEL_S11 = 1'b1;    // activate slave select 11 output
+                    MUX_SEL = 4'd11;    // send slave number 11 to multiplexers
+                end
+
         
             default: 			// Address not mapped to any slave
                 begin
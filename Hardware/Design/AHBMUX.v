@@ -4,7 +4,7 @@
 //                                                                              //
 //Copyright (c) 2012, ARM All rights reserved.                                  //
 //                                                                              //
-//THIS END USER LICENCE AGREEMENT (LICENCE) IS A LEGAL AGREEMENT BETWEEN      //
+//THIS END USER LICENCE AGREEMENT (ÂLICENCEÂ) IS A LEGAL AGREEMENT BETWEEN      //
 //YOU AND ARM LIMITED ("ARM") FOR THE USE OF THE SOFTWARE EXAMPLE ACCOMPANYING  //
 //THIS LICENCE. ARM IS ONLY WILLING TO LICENSE THE SOFTWARE EXAMPLE TO YOU ON   //
 //CONDITION THAT YOU ACCEPT ALL OF THE TERMS IN THIS LICENCE. BY INSTALLING OR  //
@@ -55,6 +55,8 @@ module AHBMUX(
   input wire [31:0] HRDATA_S7,
   input wire [31:0] HRDATA_S8,
   input wire [31:0] HRDATA_S9,
+  input wire [31:0] HRDATA_S10,
+  input wire [31:0] HRDATA_S11,
   input wire [31:0] HRDATA_NOMAP,
 
   //READYOUT FROM ALL THE SLAVES  
@@ -68,6 +70,8 @@ module AHBMUX(
   input wire HREADYOUT_S7,
   input wire HREADYOUT_S8,
   input wire HREADYOUT_S9,
+  input wire HREADYOUT_S10,
+  input wire HREADYOUT_S11,
   input wire HREADYOUT_NOMAP,
  
   //MULTIPLEXED HREADY & HRDATA TO MASTER
@@ -131,6 +135,14 @@ module AHBMUX(
         HRDATA = HRDATA_S9;
         HREADY = HREADYOUT_S9;
       end
+      4'b1010: begin
+        HRDATA = HRDATA_S10;
+        HREADY = HREADYOUT_S10;
+      end
+      4'b1011: begin
+        HRDATA = HRDATA_S11;
+        HREADY = HREADYOUT_S11;
+      end
       default: begin            
         HRDATA = HRDATA_NOMAP;
         HREADY = HREADYOUT_NOMAP;
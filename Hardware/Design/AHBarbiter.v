@@ -0,0 +1,88 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBarbiter
+// Description:   Lets three AHB-Lite masters share one bus, in front of AHBDCD and AHBMUX.
+//          Master 0 (the processor) has priority: its address phase goes on the bus
+//          whenever it starts a transfer, so it never waits for master 1 and needs no
+//          grant signal.  Master 1 (the DMA controller) gets the address phase only in
+//          cycles where master 0 is idle (HTRANS[1] low), and must hold its address
+//          and control until a cycle with HGRANT_M1 and HREADY both high - that is
+//          when its transfer is accepted.  The processor leaves many idle cycles, and
+//          none at all while sleeping (WFI), so DMA transfers mostly use bus cycles
+//          that would otherwise be wasted.
+//          Master 2 (the debug bridge, AHBdebug) also uses idle cycles, in the same
+//          way, and goes before master 1 when both are waiting.  It makes at most
+//          one transfer per serial word, so master 1 is hardly delayed.
+//          HRDATA and HREADY are shared by both masters, straight from AHBMUX.  Write
+//          data comes from the master that owns the data phase, remembered from the
+//          address phase.  Each master sees HREADY high in cycles where another
+//          master's transfer completes - a master only uses HREADY when it has a
+//          transfer in progress, so this does no harm.
+//          HPROT, HBURST and HMASTLOCK are not used in this system, so not switched.
+//
+// Revision 0.01 - File Created
+// Revision 0.02 - Master 2, for the debug bridge
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBarbiter(
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HREADY,          // from AHBMUX - previous transfer completing
+            // Master 0 - processor, priority
+            input wire [31:0] HADDR_M0,
+            input wire [1:0] HTRANS_M0,
+            input wire HWRITE_M0,
+            input wire [2:0] HSIZE_M0,
+            input wire [31:0] HWDATA_M0,
+            // Master 1 - DMA controller, uses idle cycles
+            input wire [31:0] HADDR_M1,
+            input wire [1:0] HTRANS_M1,
+            input wire HWRITE_M1,
+            input wire [2:0] HSIZE_M1,
+            input wire [31:0] HWDATA_M1,
+            output wire HGRANT_M1,      // master 1 has the address phase in this cycle
+            // Master 2 - debug bridge, uses idle cycles, before master 1
+            input wire [31:0] HADDR_M2,
+            input wire [1:0] HTRANS_M2,
+            input wire HWRITE_M2,
+            input wire [2:0] HSIZE_M2,
+            input wire [31:0] HWDATA_M2,
+            output wire HGRANT_M2,      // master 2 has the address phase in this cycle
+            // Shared bus, to the address decoder and all slaves
+            output wire [31:0] HADDR,
+            output wire [1:0] HTRANS,
+            output wire HWRITE,
+            output wire [2:0] HSIZE,
+            output wire [31:0] HWDATA
+    );
+
+    // Address phase - masters 2 and 1 only when master 0 has nothing to do
+    assign HGRANT_M2 = ~HTRANS_M0[1];
+    assign HGRANT_M1 = ~HTRANS_M0[1] & ~HTRANS_M2[1];
+    assign HADDR  = HGRANT_M1 ? HADDR_M1  : HGRANT_M2 ? HADDR_M2  : HADDR_M0;
+    assign HTRANS = HGRANT_M1 ? HTRANS_M1 : HGRANT_M2 ? HTRANS_M2 : HTRANS_M0;
+    assign HWRITE = HGRANT_M1 ? HWRITE_M1 : HGRANT_M2 ? HWRITE_M2 : HWRITE_M0;
+    assign HSIZE  = HGRANT_M1 ? HSIZE_M1  : HGRANT_M2 ? HSIZE_M2  : HSIZE_M0;
+
+    // Data phase owner, captured when the address phase is accepted
+    reg dataM1, dataM2;
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                dataM1 <= 1'b0;
+                dataM2 <= 1'b0;
+            end
+        else if (HREADY)
+            begin
+                dataM1 <= HGRANT_M1 & HTRANS_M1[1];
+                dataM2 <= HGRANT_M2 & HTRANS_M2[1];
+            end
+
+    assign HWDATA = dataM1 ? HWDATA_M1 : dataM2 ? HWDATA_M2 : HWDATA_M0;
+
+endmodule
@@ -0,0 +1,218 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBarith
+// Description:   Arithmetic unit on AHB: 32-bit divide and remainder, signed and
+//          unsigned, 32 x 32 multiply-accumulate into a 64-bit accumulator, and
+//          signed saturating add.  Operand A is written first, then writing
+//          operand B to one of the operation addresses starts the operation.
+//      Address 00 - operand A, read/write
+//      Address 04 - operand B, read/write (also written by the operation addresses)
+//      Address 08 - status, read only:  bit 0 = operation in progress
+//                                       bit 1 = last divide was by zero
+//                                       bit 2 = last saturating add was limited
+//      Address 0C - result: quotient, or saturated sum
+//      Address 10 - remainder, same sign as A for signed divide
+//      Address 14 - accumulator bits 31:0, read/write
+//      Address 18 - accumulator bits 63:32, read/write
+//      Address 20 - write B: unsigned divide A / B, 34 clock cycles
+//      Address 24 - write B: signed divide A / B, 34 clock cycles
+//      Address 28 - write B: unsigned multiply-accumulate, acc = acc + A * B, 2 clock cycles
+//      Address 2C - write B: signed multiply-accumulate, 2 clock cycles
+//      Address 30 - write B: signed saturating add, result = A + B limited to 32 bits
+//      While an operation is in progress, reads of the result registers and writes
+//      to the operation or accumulator addresses are delayed (HREADYOUT low) until
+//      it finishes, so the processor does not need to poll the status register.
+//      Divide by zero gives quotient all 1s and remainder A.
+//      All transfers 32 bits.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBarith(
+            // Bus signals
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HSEL,            // selects this slave
+            input wire HREADY,          // indicates previous transaction completing
+            input wire [31:0] HADDR,    // address
+            input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
+            input wire HWRITE,          // write transaction
+//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [31:0] HWDATA,   // write data
+            output wire [31:0] HRDATA,  // read data from slave
+            output wire HREADYOUT       // ready output from slave
+    );
+
+    // Registers to hold signals from address phase
+    reg [3:0] rHADDR;           // only need four bits of address
+    reg rWrite, rRead;          // write and read enable signals
+
+    // Capture bus signals in address phase
+    always @(posedge HCLK)
+        if(!HRESETn)
+            begin
+                rHADDR <= 4'b0;
+                rWrite <= 1'b0;
+                rRead  <= 1'b0;
+            end
+        else if(HREADY)
+            begin
+                rHADDR <= HADDR[5:2];                   // capture address bits for use in data phase
+                rWrite <= HSEL & HWRITE & HTRANS[1];    // slave selected for write transfer
+                rRead <= HSEL & ~HWRITE & HTRANS[1];    // slave selected for read transfer
+            end
+
+    localparam [3:0] OPA = 4'h0, OPB = 4'h1, STATUS = 4'h2, RESULT = 4'h3, REMAIN = 4'h4,
+                     ACCLO = 4'h5, ACCHI = 4'h6,
+                     UDIV = 4'h8, SDIV = 4'h9, UMAC = 4'hA, SMAC = 4'hB, SADD = 4'hC;
+    localparam [1:0] IDLE = 2'd0, DIVIDE = 2'd1, MULTIPLY = 2'd2, ACCUM = 2'd3;
+
+    reg [1:0] state;            // operation in progress
+    wire busy = (state != IDLE);
+
+    // Delay the bus while busy, except for status reads and operand writes
+    wire stall = busy & ((rRead & (rHADDR != STATUS)) | (rWrite & (rHADDR != OPA) & (rHADDR != OPB)));
+    wire write = rWrite & ~stall;
+    wire start = write & rHADDR[3];             // write to an operation address
+
+    // Operand registers, accumulator and results
+    reg [31:0] opA, opB;
+    reg [63:0] acc;
+    reg [31:0] result, remainder;
+    reg divZero, saturated;
+
+    // Divider registers - restoring division, one quotient bit per clock
+    reg [31:0] quo;             // dividend, shifted out as quotient bits shift in
+    reg [31:0] rem;             // partial remainder
+    reg [31:0] divisor;         // magnitude of divisor
+    reg [5:0] count;            // quotient bits still to find
+    reg negQ, negR;             // signs to apply to quotient and remainder
+    wire [32:0] remShift = {rem, quo[31]};      // partial remainder with next dividend bit
+    wire [32:0] diff = remShift - {1'b0, divisor};
+    wire fits = ~diff[32];                      // divisor fits - quotient bit is 1
+
+    // Values at the start of an operation - B comes straight from the bus
+    wire signedDiv = (rHADDR == SDIV);
+    wire negA = signedDiv & opA[31];
+    wire negB = signedDiv & HWDATA[31];
+
+    // Multiplier - registered product, then accumulate
+    reg signedMul;
+    reg [63:0] product;
+    wire [63:0] uProduct = opA * opB;
+    wire signed [63:0] sProduct = $signed(opA) * $signed(opB);
+
+    // Saturating add
+    wire [32:0] sum = {opA[31], opA} + {HWDATA[31], HWDATA};
+    wire sumOver = (sum[32] != sum[31]);        // result does not fit in 32 bits
+
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                state <= IDLE;
+                opA <= 32'b0;
+                opB <= 32'b0;
+                acc <= 64'b0;
+                result <= 32'b0;
+                remainder <= 32'b0;
+                divZero <= 1'b0;
+                saturated <= 1'b0;
+                quo <= 32'b0;
+                rem <= 32'b0;
+                divisor <= 32'b0;
+                count <= 6'd0;
+                negQ <= 1'b0;
+                negR <= 1'b0;
+                signedMul <= 1'b0;
+                product <= 64'b0;
+            end
+        else
+            begin
+                // register writes
+                if (write)
+                    case (rHADDR)
+                        OPA:    opA <= HWDATA;
+                        ACCLO:  acc[31:0] <= HWDATA;
+                        ACCHI:  acc[63:32] <= HWDATA;
+                        default: if (start | (rHADDR == OPB)) opB <= HWDATA;
+                    endcase
+
+                // start operations
+                if (start)
+                    case (rHADDR)
+                        UDIV, SDIV:
+                            begin
+                                quo <= negA ? -opA : opA;
+                                divisor <= negB ? -HWDATA : HWDATA;
+                                rem <= 32'b0;
+                                count <= 6'd32;
+                                negQ <= negA ^ negB;
+                                negR <= negA;
+                                divZero <= (HWDATA == 32'b0);
+                                state <= DIVIDE;
+                            end
+                        UMAC, SMAC:
+                            begin
+                                signedMul <= (rHADDR == SMAC);
+                                state <= MULTIPLY;
+                            end
+                        SADD:
+                            begin
+                                result <= sumOver ? (sum[32] ? 32'h80000000 : 32'h7fffffff) : sum[31:0];
+                                saturated <= sumOver;
+                            end
+                        default: ;
+                    endcase
+
+                // operations in progress
+                case (state)
+                    DIVIDE:
+                        if (count != 6'd0)
+                            begin
+                                rem <= fits ? diff[31:0] : remShift[31:0];
+                                quo <= {quo[30:0], fits};
+                                count <= count - 6'd1;
+                            end
+                        else
+                            begin
+                                result <= divZero ? 32'hffffffff : (negQ ? -quo : quo);
+                                remainder <= negR ? -rem : rem;
+                                state <= IDLE;
+                            end
+                    MULTIPLY:
+                        begin
+                            product <= signedMul ? sProduct : uProduct;
+                            state <= ACCUM;
+                        end
+                    ACCUM:
+                        begin
+                            acc <= acc + product;
+                            state <= IDLE;
+                        end
+                    default: ;
+                endcase
+            end
+
+    // Bus output signals
+    reg [31:0] readData;
+    always @(opA, opB, divZero, saturated, busy, result, remainder, acc, rHADDR)
+        case (rHADDR)       // select on word address (stored from address phase)
+            OPA:        readData = opA;
+            OPB:        readData = opB;
+            STATUS:     readData = {29'b0, saturated, divZero, busy};
+            RESULT:     readData = result;
+            REMAIN:     readData = remainder;
+            ACCLO:      readData = acc[31:0];
+            ACCHI:      readData = acc[63:32];
+            default:    readData = 32'b0;
+        endcase
+
+    assign HRDATA = readData;
+    assign HREADYOUT = ~stall;
+
+endmodule
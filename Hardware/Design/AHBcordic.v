@@ -0,0 +1,250 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBcordic
+// Description:   CORDIC unit on AHB: angle and length of a vector, and the tilt
+//          angles of the board from an accelerometer sample set, which would take
+//          the processor thousands of cycles in floating point.  Vectoring mode,
+//          16 iterations, one per clock, with 10 fraction bits below the input LSB.
+//          Angles are in hundredths of a degree, -18000 to 18000, within 0.05
+//          degree (0.12 for vectors shorter than 16).  Lengths are in the units of
+//          the inputs, within 1.
+//          Write the operands, then write (any value) to an operation address.
+//      Address 00 - X, 16-bit signed, read/write (reads sign-extended)
+//      Address 04 - Y, 16-bit signed, read/write
+//      Address 08 - Z, 16-bit signed, read/write
+//      Address 0C - status, read only: bit 0 = operation in progress
+//      Address 10 - write: angle = atan2(Y, X), magnitude = sqrt(X^2 + Y^2),
+//                   17 clock cycles
+//      Address 14 - write: tilt angles, 34 clock cycles:
+//                   roll = atan2(Y, Z), -18000 to 18000
+//                   pitch = atan2(X, sqrt(Y^2 + Z^2)), -9000 to 9000
+//                   magnitude = sqrt(X^2 + Y^2 + Z^2)
+//      Address 18 - angle, signed, read only
+//      Address 1C - magnitude, unsigned, read only, from the last operation
+//      Address 20 - pitch, signed, read only
+//      Address 24 - roll, signed, read only
+//      While an operation is in progress, reads of the results and writes to the
+//      operation addresses are delayed (HREADYOUT low) until it finishes, so the
+//      processor does not need to poll the status register.  The operands are
+//      taken at the start, so the next ones can be written while it runs.
+//      The angle of a zero vector is 0.
+//      All transfers 32 bits.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBcordic(
+            // Bus signals
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HSEL,            // selects this slave
+            input wire HREADY,          // indicates previous transaction completing
+            input wire [31:0] HADDR,    // address
+            input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
+            input wire HWRITE,          // write transaction
+//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [31:0] HWDATA,   // write data
+            output wire [31:0] HRDATA,  // read data from slave
+            output wire HREADYOUT       // ready output from slave
+    );
+
+    // Registers to hold signals from address phase
+    reg [3:0] rHADDR;           // only need four bits of address
+    reg rWrite, rRead;          // write and read enable signals
+
+    // Capture bus signals in address phase
+    always @(posedge HCLK)
+        if(!HRESETn)
+            begin
+                rHADDR <= 4'b0;
+                rWrite <= 1'b0;
+                rRead  <= 1'b0;
+            end
+        else if(HREADY)
+            begin
+                rHADDR <= HADDR[5:2];                   // capture address bits for use in data phase
+                rWrite <= HSEL & HWRITE & HTRANS[1];    // slave selected for write transfer
+                rRead <= HSEL & ~HWRITE & HTRANS[1];    // slave selected for read transfer
+            end
+
+    localparam [3:0] OPX = 4'h0, OPY = 4'h1, OPZ = 4'h2, STATUS = 4'h3, ATAN2 = 4'h4, TILT = 4'h5,
+                     ANGLE = 4'h6, MAG = 4'h7, PITCH = 4'h8, ROLL = 4'h9;
+    localparam [1:0] IDLE = 2'd0, RUN = 2'd1, FINISH = 2'd2;
+
+    localparam FRAC = 10;                       // fraction bits below the input LSB
+    localparam W = 28;                          // room for 16 bits, FRAC, and the CORDIC gain
+    localparam signed [23:0] ANGLE_180 = 24'sd4608000;     // angles in 1/25600 degree
+    localparam [15:0] INV_GAIN = 16'd39797;     // 65536 / 1.64676, the gain after 16 iterations
+
+    reg [1:0] state;            // operation in progress
+    wire busy = (state != IDLE);
+
+    // Delay the bus while busy, for result reads and operation writes
+    wire stall = busy & ((rRead & (rHADDR >= ANGLE)) | (rWrite & ((rHADDR == ATAN2) | (rHADDR == TILT))));
+    wire write = rWrite & ~stall;
+    wire start = write & ((rHADDR == ATAN2) | (rHADDR == TILT));
+
+    // Operands and results
+    reg signed [15:0] opX, opY, opZ;
+    reg signed [15:0] tiltX;    // X, kept for the second pass of a tilt operation
+    reg signed [15:0] angle, pitch, roll;
+    reg [15:0] magnitude;
+
+    // CORDIC registers - the vector is rotated towards the X axis, and the angles of
+    // the rotations are added up in z
+    reg signed [W-1:0] x, y;
+    reg signed [23:0] z;
+    reg [3:0] iter;             // iteration number, shift for this iteration
+    reg tilt, pass2;            // tilt operation, and in its second pass (pitch)
+    reg zero;                   // vector is zero, angle undefined
+
+    // atan(2^-i) in 1/25600 degree
+    reg [20:0] atanI;
+    always @(iter)
+        case (iter)
+            4'd0:   atanI = 21'd1152000;
+            4'd1:   atanI = 21'd680065;
+            4'd2:   atanI = 21'd359328;
+            4'd3:   atanI = 21'd182400;
+            4'd4:   atanI = 21'd91554;
+            4'd5:   atanI = 21'd45822;
+            4'd6:   atanI = 21'd22916;
+            4'd7:   atanI = 21'd11459;
+            4'd8:   atanI = 21'd5730;
+            4'd9:   atanI = 21'd2865;
+            4'd10:  atanI = 21'd1432;
+            4'd11:  atanI = 21'd716;
+            4'd12:  atanI = 21'd358;
+            4'd13:  atanI = 21'd179;
+            4'd14:  atanI = 21'd90;
+            default: atanI = 21'd45;
+        endcase
+
+    // Final x is the length times the gain - scale it back, keeping the fraction bits
+    wire [W+15:0] product = x * INV_GAIN;       // x is not negative after the iterations
+    wire [W-1:0] length = product[W+15:16];
+    wire [15:0] lengthOut = (length + (1 << (FRAC-1))) >> FRAC;     // rounded
+    wire signed [23:0] zRound = z + 24'sd128;
+    wire signed [15:0] angleOut = zero ? 16'sd0 : zRound[23:8];    // hundredths of a degree, rounded
+
+    // Vector to start from: X and Y for atan2, Z and Y for roll, then the length of
+    // (Y, Z) and X for pitch
+    wire tiltStart = (rHADDR == TILT);
+    wire signed [W-1:0] startX = (state == FINISH) ? $signed(length) :
+                                 tiltStart ? ($signed(opZ) <<< FRAC) : ($signed(opX) <<< FRAC);
+    wire signed [W-1:0] startY = (state == FINISH) ? ($signed(tiltX) <<< FRAC) : ($signed(opY) <<< FRAC);
+    wire load = start | ((state == FINISH) & tilt & ~pass2);
+
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                state <= IDLE;
+                opX <= 16'b0;
+                opY <= 16'b0;
+                opZ <= 16'b0;
+                tiltX <= 16'b0;
+                angle <= 16'b0;
+                pitch <= 16'b0;
+                roll <= 16'b0;
+                magnitude <= 16'b0;
+                x <= {W{1'b0}};
+                y <= {W{1'b0}};
+                z <= 24'b0;
+                iter <= 4'd0;
+                tilt <= 1'b0;
+                pass2 <= 1'b0;
+                zero <= 1'b0;
+            end
+        else
+            begin
+                // operand writes
+                if (write)
+                    case (rHADDR)
+                        OPX:    opX <= HWDATA[15:0];
+                        OPY:    opY <= HWDATA[15:0];
+                        OPZ:    opZ <= HWDATA[15:0];
+                        default: ;
+                    endcase
+
+                // start a pass: turn a vector with negative X through 180 degrees, so
+                // it is within 90 degrees of the X axis, where the iterations converge
+                if (load)
+                    begin
+                        x <= startX[W-1] ? -startX : startX;
+                        y <= startX[W-1] ? -startY : startY;
+                        z <= startX[W-1] ? (startY[W-1] ? -ANGLE_180 : ANGLE_180) : 24'sd0;
+                        zero <= (startX == 0) & (startY == 0);
+                        iter <= 4'd0;
+                        state <= RUN;
+                    end
+                if (start)
+                    begin
+                        tilt <= tiltStart;
+                        pass2 <= 1'b0;
+                        tiltX <= opX;
+                    end
+
+                case (state)
+                    RUN:        // rotate towards the X axis by atan(2^-iter)
+                        begin
+                            if (~y[W-1])
+                                begin
+                                    x <= x + (y >>> iter);
+                                    y <= y - (x >>> iter);
+                                    z <= z + $signed({3'b0, atanI});
+                                end
+                            else
+                                begin
+                                    x <= x - (y >>> iter);
+                                    y <= y + (x >>> iter);
+                                    z <= z - $signed({3'b0, atanI});
+                                end
+                            iter <= iter + 4'd1;
+                            if (iter == 4'd15) state <= FINISH;
+                        end
+                    FINISH:
+                        if (~tilt)
+                            begin
+                                angle <= angleOut;
+                                magnitude <= lengthOut;
+                                state <= IDLE;
+                            end
+                        else if (~pass2)
+                            begin
+                                roll <= angleOut;
+                                pass2 <= 1'b1;      // state and vector loaded above
+                            end
+                        else
+                            begin
+                                pitch <= angleOut;
+                                magnitude <= lengthOut;
+                                state <= IDLE;
+                            end
+                    default: ;
+                endcase
+            end
+
+    // Bus output signals
+    reg [31:0] readData;
+    always @(opX, opY, opZ, busy, angle, magnitude, pitch, roll, rHADDR)
+        case (rHADDR)       // select on word address (stored from address phase)
+            OPX:        readData = {{16{opX[15]}}, opX};
+            OPY:        readData = {{16{opY[15]}}, opY};
+            OPZ:        readData = {{16{opZ[15]}}, opZ};
+            STATUS:     readData = {31'b0, busy};
+            ANGLE:      readData = {{16{angle[15]}}, angle};
+            MAG:        readData = {16'b0, magnitude};
+            PITCH:      readData = {{16{pitch[15]}}, pitch};
+            ROLL:       readData = {{16{roll[15]}}, roll};
+            default:    readData = 32'b0;
+        endcase
+
+    assign HRDATA = readData;
+    assign HREADYOUT = ~stall;
+
+endmodule
@@ -0,0 +1,155 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBcore
+// Description:   One processor of the dual-core system, with its own local bus, so
+//          the two processors only compete for the shared bus when they use it.
+//          The local bus has three slaves:
+//      Address 0x00xx_xxxx - program ROM, through a read port of AHBrom (outside)
+//      Address 0x10xx_xxxx - private RAM, 16 kbyte, seen only by this processor
+//      Anything else       - the shared bus, through a bridge with a master port
+//          on AHBrrarb, so the shared RAM at 0x2000_0000 and the peripherals are
+//          reached as in the single processor system.
+//          The bridge registers the address phase, then waits for a grant on the
+//          shared bus, so each shared access takes at least one extra cycle,
+//          more if another master has the bus.  The processor sees wait states.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBcore(
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus and processor reset, active low
+            // Processor signals
+            input wire [15:0] IRQ,      // interrupt requests, active high
+            input wire RXEV,            // event input, for WFE
+            output wire TXEV,           // event output, from SEV
+            output wire SYSRESETREQ,    // reset request
+            output wire LOCKUP,         // processor is in lockup state
+            output wire SLEEPING,       // processor is sleeping
+            // Local bus, brought out for the ROM port and for monitoring
+            output wire [31:0] HADDR,   // address
+            output wire [1:0] HTRANS,   // transaction type
+            output wire [3:0] HPROT,    // protection - bit 0 low for an instruction fetch
+            output wire HREADY,         // local bus ready
+            input wire [31:0] romHRDATA,    // read data from the ROM port, for HADDR
+            // Master port on the shared bus, to AHBrrarb
+            output wire [31:0] mHADDR,  // address
+            output wire [1:0] mHTRANS,  // transaction type, NONSEQ or IDLE
+            output wire mHWRITE,        // write transaction
+            output wire [2:0] mHSIZE,   // transaction width
+            output wire [31:0] mHWDATA, // write data
+            input wire mHGRANT,         // address phase is on the shared bus in this cycle
+            input wire mHREADY,         // shared bus ready
+            input wire [31:0] mHRDATA   // shared bus read data
+    );
+
+    localparam [7:0] ROM_BASE = 8'h00, PRIV_BASE = 8'h10;
+    localparam [1:0] SEL_ROM = 2'd0, SEL_PRIV = 2'd1, SEL_SHARED = 2'd2;
+
+    // Local bus signals
+    wire [31:0] HWDATA, HRDATA;
+    wire HWRITE;
+    wire [2:0] HSIZE;
+    wire [31:0] HRDATA_priv;
+    wire HREADYOUT_priv, HREADYOUT_bridge;
+
+// ======================== Processor ========================================
+    CORTEXM0DS cpu (
+        .HCLK        (HCLK),
+        .HRESETn     (HRESETn),
+        .HWDATA      (HWDATA),
+        .HADDR       (HADDR),
+        .HWRITE      (HWRITE),
+        .HTRANS      (HTRANS),
+        .HPROT       (HPROT),
+        .HSIZE       (HSIZE),
+        .HMASTLOCK   (),        // not used, not connected
+        .HBURST      (),        // not used, not connected
+        .HRDATA      (HRDATA),
+        .HREADY      (HREADY),
+        .HRESP       (1'b0),    // no error responses
+        .NMI         (1'b0),    // non-maskable interrupt is not used
+        .IRQ         (IRQ),
+        .TXEV        (TXEV),
+        .RXEV        (RXEV),
+        .SYSRESETREQ (SYSRESETREQ),
+        .LOCKUP      (LOCKUP),
+        .SLEEPING    (SLEEPING)
+        );
+
+// ======================== Local address decoder and multiplexer ================
+    wire [1:0] sel = (HADDR[31:24] == ROM_BASE) ? SEL_ROM :
+                     (HADDR[31:24] == PRIV_BASE) ? SEL_PRIV : SEL_SHARED;
+
+    reg [1:0] dataSel;          // slave in the data phase
+    always @(posedge HCLK)
+        if (!HRESETn) dataSel <= SEL_ROM;
+        else if (HREADY) dataSel <= sel;
+
+    assign HRDATA = (dataSel == SEL_ROM) ? romHRDATA :
+                    (dataSel == SEL_PRIV) ? HRDATA_priv : mHRDATA;
+    assign HREADY = (dataSel == SEL_ROM) ? 1'b1 :          // ROM is always ready
+                    (dataSel == SEL_PRIV) ? HREADYOUT_priv : HREADYOUT_bridge;
+
+// ======================== Private RAM ==========================================
+    AHBram RAM (
+        .HCLK        (HCLK),
+        .HRESETn     (HRESETn),
+        .HSEL        (sel == SEL_PRIV),
+        .HREADY      (HREADY),
+        .HADDR       (HADDR),
+        .HTRANS      (HTRANS),
+        .HSIZE       (HSIZE),
+        .HWRITE      (HWRITE),
+        .HWDATA      (HWDATA),
+        .HRDATA      (HRDATA_priv),
+        .HREADYOUT   (HREADYOUT_priv)
+        );
+
+// ======================== Bridge to the shared bus =============================
+    localparam [1:0] IDLE = 2'd0, REQ = 2'd1, DATA = 2'd2;
+    reg [1:0] state;
+    reg [31:0] bAddr;
+    reg bWrite;
+    reg [2:0] bSize;
+
+    // A local transfer for the shared bus starts when its address phase completes
+    wire start = (sel == SEL_SHARED) & HTRANS[1] & HREADY;
+
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                state <= IDLE;
+                bAddr <= 32'b0;
+                bWrite <= 1'b0;
+                bSize <= 3'b0;
+            end
+        else
+            begin
+                if (start)
+                    begin
+                        bAddr <= HADDR;
+                        bWrite <= HWRITE;
+                        bSize <= HSIZE;
+                    end
+                case (state)
+                    IDLE:       if (start) state <= REQ;
+                    REQ:        if (mHGRANT & mHREADY) state <= DATA;     // address accepted
+                    DATA:       if (mHREADY) state <= start ? REQ : IDLE;  // data phase done
+                    default:    state <= IDLE;
+                endcase
+            end
+
+    assign mHADDR = bAddr;
+    assign mHTRANS = (state == REQ) ? 2'b10 : 2'b00;
+    assign mHWRITE = bWrite;
+    assign mHSIZE = bSize;
+    assign mHWDATA = HWDATA;        // the processor holds it until the local data phase ends
+    assign HREADYOUT_bridge = (state == IDLE) | ((state == DATA) & mHREADY);
+
+endmodule
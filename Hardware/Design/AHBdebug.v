@@ -0,0 +1,232 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBdebug
+// Description:   Debug bridge - a bus master controlled through its own serial port,
+//          so a PC can read and write memory and peripheral registers while the
+//          program runs, without any firmware.  The bridge gets the bus only in
+//          cycles the processor leaves idle (AHBarbiter), or takes its turn with the
+//          other masters in the dual-core system (AHBrrarb), and a word takes much
+//          longer to send than to read, so reads run at the full serial rate.
+//          Serial format 8 bits, no parity, 1 stop bit, bit rate set by INCR
+//          (default 921600 bit/s) - see uart.v.  Tools/dbg.cpp is the PC client.
+//      Commands - 6 byte header: command, address (4 bytes, LSB first), length
+//          (number of words minus 1, so 1 to 256 words).  Word transfers only -
+//          the two LSBs of the address are ignored.
+//      'R' (52) - read words from incrementing addresses.  Reply: the words, LSB first.
+//      'F' (46) - read words, all from the same address, e.g. a FIFO data register.
+//      'W' (57) - write words to incrementing addresses - the words follow the header,
+//                 LSB first.  Reply: 'K' (4B) when the last write has finished, or
+//                 'E' (45) if a word arrived before the last one had been written,
+//                 or the words stopped - nothing more is written after an error.
+//      'I' (49) - identify.  Reply: 4 bytes "DBG1".  The address and length are ignored.
+//      Any other command - reply 'E'.
+//      A gap of 20 bit times within a command abandons it, so the PC can always get
+//          back in step by waiting.  Bytes that arrive while a reply is being sent
+//          are ignored - send one command at a time.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBdebug #(parameter [19:0] INCR = 20'd154619)     // 921600 bit/s
+        (
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HREADY,          // from AHBMUX - previous transfer completing
+            // Master port, to the arbiter (HRDATA and HREADY shared with the other masters)
+            output wire [31:0] mHADDR,  // address
+            output wire [1:0] mHTRANS,  // transaction type, NONSEQ or IDLE
+            output wire mHWRITE,        // write transaction
+            output wire [2:0] mHSIZE,   // transaction width - always word
+            output wire [31:0] mHWDATA, // write data
+            input wire mHGRANT,         // address phase is on the bus in this cycle
+            input wire [31:0] mHRDATA,  // read data from the bus
+            // Serial port
+            input wire serialRx,        // serial input from PC
+            output wire serialTx        // serial output to PC
+    );
+
+    localparam [7:0] CMD_READ = 8'h52, CMD_FIFO = 8'h46, CMD_WRITE = 8'h57, CMD_ID = 8'h49,
+                     REPLY_OK = 8'h4B, REPLY_ERROR = 8'h45;
+    localparam [31:0] ID_WORD = 32'h31474244;   // "DBG1", LSB first
+    localparam [4:0] TIMEOUT = 5'd20;           // bit times
+
+    // Serial port
+    wire [7:0] rxByte;
+    wire rxNew, txRdy, bitTick;
+    reg [31:0] word;            // word being sent, or received, LSB first
+    wire txGo;
+
+    uart uart (
+        .clk        (HCLK),
+        .rst        (~HRESETn),
+        .incr       (INCR),
+        .txdin      (word[7:0]),        // sends the LSB of the word
+        .txgo       (txGo),
+        .txd        (serialTx),
+        .txrdy      (txRdy),
+        .rxd        (serialRx),
+        .rxdout     (rxByte),
+        .rxnew      (rxNew),
+        .bittick    (bitTick)
+        );
+
+    // Command state machine
+    localparam [2:0] HDR = 3'd0,    // receiving a header
+                     RREQ = 3'd1,   // read address phase, waiting to be accepted
+                     RDATA = 3'd2,  // read data phase
+                     SEND = 3'd3,   // sending the bytes of word
+                     WRX = 3'd4,    // receiving words to write
+                     WEND = 3'd5;   // waiting for the last write to finish
+    localparam [1:0] W_IDLE = 2'd0, W_REQ = 2'd1, W_DATA = 2'd2;
+
+    reg [2:0] state;
+    reg [1:0] wState;           // write transfers, which overlap receiving the next word
+    reg [7:0] cmd;
+    reg [31:0] addr;
+    reg [7:0] count;            // words still to do after the current one
+    reg [2:0] byteCnt;          // header byte, or byte of a received word
+    reg [2:0] sendLeft;         // bytes of word still to send
+    reg [31:0] wData;           // word being written
+    reg error;                  // write data lost or abandoned
+    reg [4:0] rxTimer;          // bit times since the last byte received
+
+    wire reading = (cmd == CMD_READ) | (cmd == CMD_FIFO);
+    wire [31:0] rxWord = {rxByte, word[31:8]};              // word with this byte shifted in
+    wire wFree = (wState == W_IDLE) | ((wState == W_DATA) & HREADY);
+    wire waiting = ((state == HDR) & (byteCnt != 3'd0)) | (state == WRX);
+    wire timeout = waiting & (rxTimer == TIMEOUT);
+    assign txGo = (state == SEND) & txRdy;
+
+    always @(posedge HCLK)
+        if (!HRESETn) rxTimer <= 5'd0;
+        else if (rxNew | ~waiting) rxTimer <= 5'd0;
+        else if (bitTick & ~timeout) rxTimer <= rxTimer + 5'd1;
+
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                state <= HDR;
+                cmd <= 8'b0;
+                addr <= 32'b0;
+                count <= 8'b0;
+                byteCnt <= 3'd0;
+                sendLeft <= 3'd0;
+                word <= 32'b0;
+                error <= 1'b0;
+            end
+        else
+            case (state)
+                HDR:    if (timeout) byteCnt <= 3'd0;
+                        else if (rxNew)
+                            begin
+                                byteCnt <= byteCnt + 3'd1;
+                                case (byteCnt)
+                                    3'd0:       cmd <= rxByte;
+                                    3'd5:       begin           // header complete
+                                                    byteCnt <= 3'd0;
+                                                    count <= rxByte;
+                                                    error <= 1'b0;
+                                                    case (cmd)
+                                                        CMD_READ, CMD_FIFO: state <= RREQ;
+                                                        CMD_WRITE:  state <= WRX;
+                                                        CMD_ID:     begin
+                                                                        word <= ID_WORD;
+                                                                        sendLeft <= 3'd4;
+                                                                        state <= SEND;
+                                                                    end
+                                                        default:    begin
+                                                                        word <= {24'b0, REPLY_ERROR};
+                                                                        sendLeft <= 3'd1;
+                                                                        state <= SEND;
+                                                                    end
+                                                    endcase
+                                                end
+                                    default:    addr <= {rxByte, addr[31:8]};   // address, LSB first
+                                endcase
+                            end
+                RREQ:   if (mHGRANT & HREADY) state <= RDATA;     // read accepted
+                RDATA:  if (HREADY)
+                            begin
+                                word <= mHRDATA;
+                                sendLeft <= 3'd4;
+                                state <= SEND;
+                            end
+                SEND:   if (txGo)
+                            begin
+                                word <= {8'b0, word[31:8]};
+                                sendLeft <= sendLeft - 3'd1;
+                                if (sendLeft == 3'd1)           // last byte going
+                                    if (reading & (count != 8'b0))
+                                        begin
+                                            count <= count - 8'd1;
+                                            if (cmd == CMD_READ) addr <= addr + 32'd4;
+                                            state <= RREQ;
+                                        end
+                                    else state <= HDR;
+                            end
+                WRX:    if (timeout)
+                            begin
+                                error <= 1'b1;
+                                state <= WEND;
+                            end
+                        else if (rxNew)
+                            begin
+                                word <= rxWord;
+                                byteCnt <= byteCnt + 3'd1;
+                                if (byteCnt == 3'd3)            // word complete
+                                    begin
+                                        byteCnt <= 3'd0;
+                                        if (~wFree) error <= 1'b1;
+                                        if (count == 8'b0) state <= WEND;
+                                        else count <= count - 8'd1;
+                                    end
+                            end
+                WEND:   if (wState == W_IDLE)
+                            begin
+                                word <= {24'b0, error ? REPLY_ERROR : REPLY_OK};
+                                sendLeft <= 3'd1;
+                                state <= SEND;
+                            end
+                default:    state <= HDR;
+            endcase
+
+    // Write transfers - a word is written while the next one is being received
+    wire wStart = (state == WRX) & rxNew & (byteCnt == 3'd3) & wFree & ~error;
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                wState <= W_IDLE;
+                wData <= 32'b0;
+            end
+        else if (wStart)
+            begin
+                wData <= rxWord;
+                wState <= W_REQ;
+            end
+        else
+            case (wState)
+                W_REQ:      if (mHGRANT & HREADY) wState <= W_DATA;   // write accepted
+                W_DATA:     if (HREADY) wState <= W_IDLE;
+                default:    wState <= W_IDLE;
+            endcase
+
+    // Write address advances when each write is accepted - reads use it as it is
+    reg [31:0] wAddr;
+    always @(posedge HCLK)
+        if (!HRESETn) wAddr <= 32'b0;
+        else if ((state == HDR) & rxNew & (byteCnt == 3'd5)) wAddr <= addr;
+        else if ((wState == W_REQ) & mHGRANT & HREADY) wAddr <= wAddr + 32'd4;
+
+    // Master port outputs - address and control held until accepted
+    assign mHTRANS = ((state == RREQ) | (wState == W_REQ)) ? 2'b10 : 2'b00;
+    assign mHWRITE = (wState == W_REQ);
+    assign mHADDR = {(mHWRITE ? wAddr[31:2] : addr[31:2]), 2'b00};
+    assign mHSIZE = 3'b010;     // word
+    assign mHWDATA = wData;
+
+endmodule
@@ -17,8 +17,31 @@
 //                      a pattern to display: hex digits and others, see table in code
 //      Address 9 - 8-bit read/write register with enable bits: 0 = off, 1 - enabled 
 //      For registers 8 and 9, bit 0 controls the rightmost digit
+//      Address A - control:    bit 0 = buffered - 1 means writes to addresses 0 to 9
+//                                      go to a shadow bank, and the display does not
+//                                      change until a commit
+//                              bit 1 = commit - write 1 to copy the shadow bank to
+//                                      the display, including any registers written
+//                                      in the same transaction (reads as 0)
+//                              Writing 0 to bit 0 also commits.
+//                  So a word write to 0, a word write to 4 and a word write to 8 with
+//                  bits 17:16 = 11 change the whole display at once.
+//      Reads of addresses 0 to 9 return the shadow bank, which is the same as the
+//      display when not buffered.
+//      Address C - 32-bit read/write register for a signed decimal number.  A write
+//                  converts the value to decimal and sets all the registers above:
+//                  hex mode, leading zeros blanked, a minus sign to the left of the
+//                  first digit if negative.  The range is -9999999 to 99999999,
+//                  values outside this are shown as 8 dashes.  The conversion takes
+//                  about 35 clock cycles, then the other registers show the result.
+//                  Write a 16-bit value as a sign-extended word.
+//      Address 10 - 3-bit read/write register: decimal places for the number, 0 to 7.
+//                  With n > 0 the dot of digit n is lit, and digits 0 to n are
+//                  always shown, so 2 shows 5 as 0.05 - a value in hundredths.
+//                  Takes effect at the next number write.
 //
-//      This version only allows 8-bit write transactions, reads can be 8, 16 or 32 bits.
+//      Writes and reads can be 8, 16 or 32 bits, but address C must be written as a word.
+//      The decimal number updates the shadow bank and the display together.
 //
 //      The display refresh rate is the clock frequency divided by
 //      2^D_WIDTH.  D_WIDTH is a parameter, with default value 20, which sets
@@ -27,6 +50,9 @@
 //      display cycles through all 8 digits every ~21 ms.
 //
 // Version: 1.2, March 2023 - using byte writes only
+// Version: 1.3, April 2023 - decimal number register added - SoC lab Group 14
+// Version: 1.4, April 2023 - halfword and word writes, shadow bank with commit
+// Version: 1.5, April 2023 - decimal places for the number
 //
 //////////////////////////////////////////////////////////////////////////////////
 module  AHBdisp #(D_WIDTH = 20) (
@@ -38,7 +64,7 @@ module  AHBdisp #(D_WIDTH = 20) (
             input wire [31:0] HADDR,    // address
             input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
             input wire HWRITE,          // write transaction
-//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [2:0] HSIZE,     // transaction width (max 32-bit supported)
             input wire [31:0] HWDATA,   // write data
             output wire [31:0] HRDATA,  // read data from slave
             output wire HREADYOUT,      // ready output from slave
@@ -50,53 +76,205 @@ module  AHBdisp #(D_WIDTH = 20) (
 //================================  AHB-Lite Bus Interface =============================
     
 // Registers to hold signals from address phase
-    reg [3:0] rHADDR;           // only need four bits of address
+    reg [4:0] rHADDR;           // only need five bits of address
+    reg [1:0] rHSIZE;           // only need 2 bits of size
     reg rWrite;                 // write enable signal
 
 // Internal signals
     reg [31:0] readData;       // ouptut of read multiplexer
+    reg [3:0] byteWrite;       // write enable for each byte lane
 
 // Capture bus signals in the address phase
     always @ (posedge HCLK)
         if (!HRESETn)
             begin
-                rHADDR <= 4'b0;
+                rHADDR <= 5'b0;
+                rHSIZE <= 2'b0;
                 rWrite <= 1'b0;
             end
         else if (HREADY)    // previous bus transaction is completing
             begin
-                rHADDR <= HADDR[3:0];  // capture address bits for for use in data phase
+                rHADDR <= HADDR[4:0];  // capture address bits for for use in data phase
+                rHSIZE <= HSIZE[1:0];  // for use in data phase
                 rWrite <= HSEL & HWRITE & HTRANS[1]; // this slave selected for write transfer       
             end
 
-// Ten registers visible on the AHB-Lite bus, as described above
+// Generate byte write enable signals based on captured control signals
+    always @ (rWrite, rHSIZE, rHADDR[1:0])
+        if (rWrite)         // write transaction in progress
+            case ({rHSIZE, rHADDR[1:0]})    // select on size and LSBs of address
+                4'b00_00:   byteWrite = 4'b0001;    // writing least significant byte
+                4'b00_01:   byteWrite = 4'b0010;
+                4'b00_10:   byteWrite = 4'b0100;
+                4'b00_11:   byteWrite = 4'b1000;    // writing most significant byte
+                4'b01_00:   byteWrite = 4'b0011;    // writing least significant halfword
+                4'b01_10:   byteWrite = 4'b1100;    // writing most significant halfword
+                4'b10_00:   byteWrite = 4'b1111;    // writing full word
+                default:    byteWrite = 4'b0000;    // anything else - no write
+            endcase
+        else                byteWrite = 4'b0000;    // not writing
+
+// Write enables for the ten registers below, and for the control register
+    wire [9:0] regWrite = {byteWrite[1:0] & {2{rHADDR[4:2] == 3'd2}},
+                           byteWrite & {4{rHADDR[4:2] == 3'd1}},
+                           byteWrite & {4{rHADDR[4:2] == 3'd0}}};
+    wire ctrlWrite = byteWrite[2] & (rHADDR[4:2] == 3'd2);
+    reg buffered;               // writes go to the shadow bank only
+    wire commit = ctrlWrite & (HWDATA[17] | ~HWDATA[16]);  // commit, or leaving buffered mode
+
+    always @ (posedge HCLK)
+        if (!HRESETn) buffered <= 1'b0;
+        else if (ctrlWrite) buffered <= HWDATA[16];
+
+// Decimal conversion results, to be loaded into the registers below
+    wire convLoad;              // conversion finished, results waiting
+    reg [7:0] convDigit [0:7];  // data for each digit
+    reg [7:0] convEnable;       // enable bits
+
+// Ten registers visible on the AHB-Lite bus, as described above (shadow bank),
+// and the ten registers that drive the display
+    reg [7:0] shadowReg [0:9];
     reg [7:0] displayReg [0:9];
     integer i;
     always @ (posedge HCLK)
         if (!HRESETn)                       // reset is active
             for (i = 0; i < 10; i = i + 1)  // for each register
-                displayReg[i] <= 8'b0;      // set it to 0
-        else if (rWrite)                    // writing to a register
-            case (rHADDR)                   // choose which register to change
-                4'd0:     displayReg[0] <= HWDATA[7:0];   // get data from correct byte lane
-                4'd1:     displayReg[1] <= HWDATA[15:8];
-                4'd2:     displayReg[2] <= HWDATA[23:16];
-                4'd3:     displayReg[3] <= HWDATA[31:24];
-                4'd4:     displayReg[4] <= HWDATA[7:0];
-                4'd5:     displayReg[5] <= HWDATA[15:8];
-                4'd6:     displayReg[6] <= HWDATA[23:16];
-                4'd7:     displayReg[7] <= HWDATA[31:24];
-                4'd8:     displayReg[8] <= HWDATA[7:0];
-                default:  displayReg[9] <= HWDATA[15:8];  // address 9 to 15 selects register 9
-            endcase
+                shadowReg[i] <= 8'b0;       // set it to 0
+        else if (convLoad & ~rWrite)        // conversion finished, bus not writing
+            begin
+                for (i = 0; i < 8; i = i + 1)
+                    shadowReg[i] <= convDigit[i];
+                shadowReg[8] <= 8'hff;      // all digits in hex mode
+                shadowReg[9] <= convEnable;
+            end
+        else                                // writing to registers
+            for (i = 0; i < 10; i = i + 1)
+                if (regWrite[i]) shadowReg[i] <= HWDATA[8*(i%4) +: 8];  // get data from correct byte lane
+
+    always @ (posedge HCLK)
+        if (!HRESETn)
+            for (i = 0; i < 10; i = i + 1)
+                displayReg[i] <= 8'b0;
+        else if (convLoad & ~rWrite)        // same as the shadow bank above
+            begin
+                for (i = 0; i < 8; i = i + 1)
+                    displayReg[i] <= convDigit[i];
+                displayReg[8] <= 8'hff;
+                displayReg[9] <= convEnable;
+            end
+        else if (commit)                    // copy the shadow bank, with any new data
+            for (i = 0; i < 10; i = i + 1)
+                displayReg[i] <= regWrite[i] ? HWDATA[8*(i%4) +: 8] : shadowReg[i];
+        else if (!buffered)                 // follow the bus writes
+            for (i = 0; i < 10; i = i + 1)
+                if (regWrite[i]) displayReg[i] <= HWDATA[8*(i%4) +: 8];
+
+//================================  Decimal Conversion ===============================
+// Double dabble: the magnitude is shifted into the BCD register one bit per clock,
+// after adding 3 to any BCD digit that is 5 or more.
+
+    reg [31:0] number;          // value written to address C
+    reg [31:0] binShift;        // magnitude, shifted out MSB first
+    reg [31:0] bcd;             // 8 BCD digits, digit 0 in bits 3:0
+    reg [5:0] shiftCount;       // shifts still to do, 0 when idle
+    reg negative, overflow;     // sign, and value out of range
+    reg convDone;               // results waiting to be loaded
+
+    wire numWrite = rWrite & (rHADDR == 5'hC);
+    wire [31:0] magnitude = HWDATA[31] ? -HWDATA : HWDATA;
+
+// Decimal places, set by writing address 10
+    reg [2:0] decimals;
+    always @ (posedge HCLK)
+        if (!HRESETn) decimals <= 3'd0;
+        else if (byteWrite[0] & (rHADDR[4:2] == 3'd4)) decimals <= HWDATA[2:0];
+
+// Add 3 to each BCD digit of 5 or more, before shifting
+    reg [31:0] bcdAdj;
+    integer j;
+    always @ (bcd)
+        for (j = 0; j < 8; j = j + 1)
+            bcdAdj[4*j +: 4] = (bcd[4*j +: 4] > 4'd4) ? bcd[4*j +: 4] + 4'd3 : bcd[4*j +: 4];
+
+    always @ (posedge HCLK)
+        if (!HRESETn)
+            begin
+                number <= 32'b0;
+                binShift <= 32'b0;
+                bcd <= 32'b0;
+                shiftCount <= 6'd0;
+                negative <= 1'b0;
+                overflow <= 1'b0;
+                convDone <= 1'b0;
+            end
+        else if (numWrite)                  // start a new conversion
+            begin
+                number <= HWDATA;
+                binShift <= magnitude;
+                bcd <= 32'b0;
+                shiftCount <= 6'd32;
+                negative <= HWDATA[31];
+                overflow <= HWDATA[31] ? (magnitude > 32'd9999999) : (magnitude > 32'd99999999);
+                convDone <= 1'b0;
+            end
+        else if (shiftCount != 6'd0)        // conversion in progress
+            begin
+                {bcd, binShift} <= {bcdAdj, binShift} << 1;
+                shiftCount <= shiftCount - 6'd1;
+                if (shiftCount == 6'd1) convDone <= 1'b1;
+            end
+        else if (convLoad & ~rWrite)        // results have been loaded
+            convDone <= 1'b0;
+
+    assign convLoad = convDone;
+
+// Position of the most significant digit to show: the first non-zero digit, or the
+// digit with the dot if that is further left
+    reg [2:0] msd;
+    integer k;
+    always @ (bcd, decimals)
+        begin
+            msd = decimals;
+            for (k = 1; k < 8; k = k + 1)
+                if ((bcd[4*k +: 4] != 4'd0) && (k > msd)) msd = k;
+        end
+
+// Digit data and enable bits: digits, then minus sign if needed, then blank
+    integer m;
+    always @ (bcd, msd, negative, overflow, decimals)
+        for (m = 0; m < 8; m = m + 1)
+            if (overflow)
+                begin
+                    convDigit[m] = 8'h11;       // dash
+                    convEnable[m] = 1'b1;
+                end
+            else if (m <= msd)
+                begin
+                    convDigit[m] = {(decimals != 3'd0) && (m == decimals), 3'b0, bcd[4*m +: 4]};  // dot in bit 7
+                    convEnable[m] = 1'b1;
+                end
+            else if (negative && (m == msd + 1))
+                begin
+                    convDigit[m] = 8'h11;       // minus sign
+                    convEnable[m] = 1'b1;
+                end
+            else
+                begin
+                    convDigit[m] = 8'h1f;       // blank, and digit disabled
+                    convEnable[m] = 1'b0;
+                end
 
 // Bus read multiplexer - output a full word and let the bus master select the byte
-    always @(rHADDR, displayReg[0], displayReg[1], displayReg[2], displayReg[3], displayReg[4], 
-               displayReg[5], displayReg[6], displayReg[7], displayReg[8], displayReg[9])
-        case (rHADDR[3:2])      // select on word address (stored from address phase)
-            2'd0:     readData = {displayReg[3], displayReg[2], displayReg[1], displayReg[0]};
-            2'd1:     readData = {displayReg[7], displayReg[6], displayReg[5], displayReg[4]};
-            default:  readData = {16'b0, displayReg[9], displayReg[8]};
+    always @(rHADDR, shadowReg[0], shadowReg[1], shadowReg[2], shadowReg[3], shadowReg[4], 
+               shadowReg[5], shadowReg[6], shadowReg[7], shadowReg[8], shadowReg[9], buffered, number,
+               decimals)
+        case (rHADDR[4:2])      // select on word address (stored from address phase)
+            3'd0:     readData = {shadowReg[3], shadowReg[2], shadowReg[1], shadowReg[0]};
+            3'd1:     readData = {shadowReg[7], shadowReg[6], shadowReg[5], shadowReg[4]};
+            3'd2:     readData = {15'b0, buffered, shadowReg[9], shadowReg[8]};
+            3'd3:     readData = number;
+            3'd4:     readData = {29'b0, decimals};
+            default:  readData = 32'b0;
         endcase
         
     assign HRDATA = readData;   
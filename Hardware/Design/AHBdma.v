@@ -0,0 +1,239 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBdma
+// Description:   Two channel DMA controller.  A slave port holds the channel registers,
+//          and a master port, through AHBarbiter, moves data between memory and the
+//          peripherals without the processor.  Each transfer is a read from the
+//          source address, then a write of the same data to the destination address.
+//      Channel n registers at 10*n, n = 0 or 1:
+//      Address 00 - source address.  Reads give the address of the next transfer.
+//      Address 04 - destination address.  Reads give the address of the next transfer.
+//      Address 08 - count, 16 bits: transfers still to do, counts down to 0
+//      Address 0C - control:   bit 0 = enable - write 1 to start (also clears done),
+//                                      cleared when count reaches 0
+//                              bits 2:1 = size: 0 byte, 1 halfword, 2 word (3 is taken as word)
+//                              bit 3 = increment source address by size after each transfer
+//                              bit 4 = increment destination address
+//                              bit 5 = interrupt enable, for the done bit
+//                              bit 6 = source reload - at the end of each burst, the source
+//                                      address goes back to the value last written, to read
+//                                      a group of registers again (with bit 3)
+//                              bits 10:8 = request: 0 = none, transfer as fast as the bus
+//                                      allows (memory to memory), n = wait for dreq[n]
+//                              bits 15:12 = burst, minus 1: transfers done for each request
+//      Address 20 - status:    bits 1:0 = done, per channel - set when count reaches 0,
+//                                      write 1 to clear
+//                              bits 9:8 = busy, per channel (enable bits), read only
+//      The interrupt request is high while a channel with interrupt enable is done.
+//      Addresses must be aligned to the size.  Source reads extract the addressed byte
+//      or halfword, and destination writes copy it to all byte lanes, so peripherals
+//      that ignore HSIZE see the data in the low bits.
+//      With both channels waiting, they take turns by burst.  Writing the registers of
+//      an active channel changes the transfers still to come - clear enable first.
+//      The master port gets the bus only when the processor leaves it idle (AHBarbiter),
+//      and takes at least 4 bus cycles per transfer.
+//      All slave transfers 32 bits.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBdma(
+            // Bus signals - slave port
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HSEL,            // selects this slave
+            input wire HREADY,          // indicates previous transaction completing
+            input wire [31:0] HADDR,    // address
+            input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
+            input wire HWRITE,          // write transaction
+//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [31:0] HWDATA,   // write data
+            output wire [31:0] HRDATA,  // read data from slave
+            output wire HREADYOUT,      // ready output from slave
+            // Bus signals - master port, to AHBarbiter (HRDATA and HREADY shared with slaves)
+            output wire [31:0] mHADDR,  // address
+            output wire [1:0] mHTRANS,  // transaction type, NONSEQ or IDLE
+            output wire mHWRITE,        // write transaction
+            output wire [2:0] mHSIZE,   // transaction width
+            output wire [31:0] mHWDATA, // write data
+            input wire mHGRANT,         // address phase is on the bus in this cycle
+            input wire [31:0] mHRDATA,  // read data from the bus
+            // Other signals
+            input wire [7:1] dreq,      // transfer requests from peripherals, active high
+            output wire dma_IRQ         // interrupt request
+    );
+
+    localparam NCH = 2;     // number of channels
+
+    // Registers to hold signals from address phase
+    reg [3:0] rHADDR;           // only need four bits of address
+    reg rWrite;                 // write enable signal
+
+    // Capture bus signals in address phase
+    always @(posedge HCLK)
+        if(!HRESETn)
+            begin
+                rHADDR <= 4'b0;
+                rWrite <= 1'b0;
+            end
+        else if(HREADY)
+            begin
+                rHADDR <= HADDR[5:2];                   // capture address bits for use in data phase
+                rWrite <= HSEL & HWRITE & HTRANS[1];    // slave selected for write transfer
+            end
+
+    localparam [1:0] SRC = 2'd0, DST = 2'd1, COUNT = 2'd2, CONTROL = 2'd3;
+    localparam [3:0] STATUS = 4'h8;
+    wire chWrite = rWrite & ~rHADDR[3];         // write to a channel register
+    wire wrCh = rHADDR[2];                      // channel number for the write
+
+    // Channel registers
+    reg [31:0] src [0:NCH-1];
+    reg [31:0] srcStart [0:NCH-1];              // source address as written, for reload
+    reg [31:0] dst [0:NCH-1];
+    reg [15:0] count [0:NCH-1];
+    reg [15:0] control [0:NCH-1];
+    reg [NCH-1:0] done;
+
+// ========================= Transfer engine =====================================
+    localparam [2:0] IDLE = 3'd0, RADDR = 3'd1, RDATA = 3'd2, WADDR = 3'd3, WDATA = 3'd4;
+    reg [2:0] state;
+    reg ch;                     // channel being served
+    reg [3:0] burstLeft;        // transfers left in this burst, after the current one
+    reg [31:0] data;            // data read from the source, in the low bits
+
+    // A channel is ready if enabled, with transfers to do and its request active
+    wire [7:0] reqLine = {dreq, 1'b1};
+    reg [NCH-1:0] ready;
+    integer i;
+    always @(*)
+        for (i = 0; i < NCH; i = i + 1)
+            ready[i] = control[i][0] & (count[i] != 16'b0) & reqLine[control[i][10:8]];
+    wire next = ready[~ch] ? ~ch : ch;          // the other channel first, if it is ready
+
+    // Fields of the channel being served
+    wire [15:0] chControl = control[ch];
+    wire [1:0] size = chControl[2] ? 2'd2 : {1'b0, chControl[1]};
+    wire [31:0] step = (size == 2'd2) ? 32'd4 : (size == 2'd1) ? 32'd2 : 32'd1;
+    wire [1:0] srcLane = src[ch][1:0];
+    wire finish = (state == WDATA) & HREADY;    // write completing - transfer done
+    wire lastOne = (count[ch] == 16'd1);
+
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                state <= IDLE;
+                ch <= 1'b0;
+                burstLeft <= 4'b0;
+                data <= 32'b0;
+            end
+        else
+            case (state)
+                IDLE:   if (|ready)
+                            begin
+                                ch <= next;
+                                burstLeft <= control[next][15:12];
+                                state <= RADDR;
+                            end
+                RADDR:  if (mHGRANT & HREADY) state <= RDATA;         // read accepted
+                RDATA:  if (HREADY)                                     // read data arrived
+                            begin
+                                case (size)
+                                    2'd0:       data <= {24'b0, mHRDATA[8*srcLane +: 8]};
+                                    2'd1:       data <= {16'b0, mHRDATA[16*srcLane[1] +: 16]};
+                                    default:    data <= mHRDATA;
+                                endcase
+                                state <= WADDR;
+                            end
+                WADDR:  if (mHGRANT & HREADY) state <= WDATA;         // write accepted
+                WDATA:  if (HREADY)
+                            if (lastOne | ~chControl[0] | (burstLeft == 4'b0)) state <= IDLE;
+                            else
+                                begin
+                                    burstLeft <= burstLeft - 4'd1;
+                                    state <= RADDR;
+                                end
+                default:    state <= IDLE;
+            endcase
+
+    // Master port outputs - address and control held until accepted
+    assign mHTRANS = ((state == RADDR) | (state == WADDR)) ? 2'b10 : 2'b00;
+    assign mHWRITE = (state == WADDR);
+    assign mHADDR = (state == WADDR) ? dst[ch] : src[ch];
+    assign mHSIZE = {1'b0, size};
+    assign mHWDATA = (size == 2'd0) ? {4{data[7:0]}} : (size == 2'd1) ? {2{data[15:0]}} : data;
+
+// ========================= Channel registers =====================================
+    // Updated by the engine at the end of each transfer, and by bus writes - a bus
+    // write in the same cycle takes priority
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                for (i = 0; i < NCH; i = i + 1)
+                    begin
+                        src[i] <= 32'b0;
+                        srcStart[i] <= 32'b0;
+                        dst[i] <= 32'b0;
+                        count[i] <= 16'b0;
+                        control[i] <= 16'b0;
+                    end
+                done <= {NCH{1'b0}};
+            end
+        else
+            begin
+                if (finish)
+                    begin
+                        if (chControl[3])
+                            src[ch] <= (chControl[6] & (burstLeft == 4'b0)) ? srcStart[ch] : src[ch] + step;
+                        if (chControl[4]) dst[ch] <= dst[ch] + step;
+                        count[ch] <= count[ch] - 16'd1;
+                        if (lastOne)
+                            begin
+                                control[ch][0] <= 1'b0;
+                                done[ch] <= 1'b1;
+                            end
+                    end
+                if (chWrite)
+                    case (rHADDR[1:0])
+                        SRC:        begin
+                                        src[wrCh] <= HWDATA;
+                                        srcStart[wrCh] <= HWDATA;
+                                    end
+                        DST:        dst[wrCh] <= HWDATA;
+                        COUNT:      count[wrCh] <= HWDATA[15:0];
+                        CONTROL:    begin
+                                        control[wrCh] <= HWDATA[15:0];
+                                        if (HWDATA[0]) done[wrCh] <= 1'b0;  // new start
+                                    end
+                    endcase
+                if (rWrite & (rHADDR == STATUS))
+                    done <= done & ~HWDATA[NCH-1:0];    // write 1 to clear
+            end
+
+    wire [NCH-1:0] busy = {control[1][0], control[0][0]};
+    assign dma_IRQ = |(done & {control[1][5], control[0][5]});
+
+// ========================= Bus output signals =====================================
+    reg [31:0] readData;
+    always @(*)
+        if (rHADDR == STATUS)
+            readData = {22'b0, busy, 6'b0, done};
+        else if (rHADDR[3])
+            readData = 32'b0;                   // unused addresses
+        else
+            case (rHADDR[1:0])
+                SRC:        readData = src[rHADDR[2]];
+                DST:        readData = dst[rHADDR[2]];
+                COUNT:      readData = {16'b0, count[rHADDR[2]]};
+                default:    readData = {16'b0, control[rHADDR[2]]};
+            endcase
+
+    assign HRDATA = readData;
+    assign HREADYOUT = 1'b1;    // never delays the bus
+
+endmodule
@@ -10,11 +10,29 @@
 //						and two 16-bit input ports at address 8 and C.
 //						16-bit data is right-justified in words on 32-bit transfers.
 //						Also supports byte and half-word write transactions.
-//						This version does not support interrupt generation...
+//						Write-only aliases change bits of an output port in one
+//						bus write, so no read-modify-write is needed:
+//						address 10, 14 - set bits of port 0, 1 where data is 1
+//						address 18, 1C - clear bits of port 0, 1 where data is 1
+//						address 20, 24 - toggle bits of port 0, 1 where data is 1
+//						Reading an alias returns the output port.
+//						Edge detection on the inputs, word access only - in these
+//						registers bits 15:0 are input port 0 and bits 31:16 are port 1:
+//						address 28 - rising edge enables, 1 = latch an event on a 0 to 1 change
+//						address 2C - falling edge enables, 1 = latch an event on a 1 to 0 change
+//						address 30 - events, latched until cleared by writing 1 to the bit
+//						address 34 - debounce: inputs are sampled every 256 x (value + 1)
+//									clock cycles, and a new level is accepted when two
+//									samples in a row agree - 976 gives 5 ms with 50 MHz clock
+//						address 38 - debounced inputs (read only)
+//						Interrupt output irq is high while any event is latched.
+//						The edges use the debounced inputs, addresses 8 and C are not debounced.
 //
 // Revision: 
 // Revision 0.01 - File Created
 // Revision 1 - modified for synchronous reset, October 2015
+// Revision 2 - set, clear and toggle aliases, April 2023 - SoC lab Group 14
+// Revision 3 - edge detection with debounce and interrupt, April 2023
 //
 //////////////////////////////////////////////////////////////////////////////////
 module AHBgpio(
@@ -34,11 +52,12 @@ module AHBgpio(
 			output [15:0] gpio_out0,	// read-write address 0
 			output [15:0] gpio_out1,	// read-write address 4
 			input [15:0] gpio_in0,		// read only address 8
-			input [15:0] gpio_in1		// read only address C
+			input [15:0] gpio_in1,		// read only address C
+			output irq					// interrupt request, an input event is latched
     );
 	
 	// Registers to hold signals from address phase
-	reg [3:0] rHADDR;			// only need 4 bits of address
+	reg [5:0] rHADDR;			// only need 6 bits of address
 	reg [1:0] rHSIZE;			// only need 2 bits of size
 	reg rWrite;                // store one bit to indicate write transaction 
 	
@@ -52,19 +71,19 @@ module AHBgpio(
 	// Internal control signals
 	reg [1:0] byteWrite;	// individual byte write enable signals
 	wire  nextWrite = HSEL & HWRITE & HTRANS[1];	// slave selected for write transfer
-	reg [15:0]	readData;		// 16-bit data from read multiplexer
+	reg [31:0]	readData;		// data from read multiplexer
 
  	// Capture bus and internal signals in address phase
 	always @(posedge HCLK)
 		if(!HRESETn)
 			begin
-				rHADDR <= 4'b0;
+				rHADDR <= 6'b0;
 				rHSIZE <= 2'b0;
 				rWrite <= 1'b0;
 			end
 		else if(HREADY)       // only update if HREADY is 1 - previous transaction completing
              begin
-                rHADDR <= HADDR[3:0];         // capture signals from address phase
+                rHADDR <= HADDR[5:0];         // capture signals from address phase
                 rHSIZE <= HSIZE[1:0];         // for use in data phase
                 rWrite <= nextWrite;
              end
@@ -80,6 +99,22 @@ module AHBgpio(
 				default:    byteWrite = 2'b00;		// anything else - no write				
 			endcase
 		else				byteWrite = 2'b00;		// not writing
+
+	// New value for the output port being written, depending on the address used
+	localparam [2:0] PLAIN = 3'b000, SET = 3'b010, CLR = 3'b011, TOGGLE = 3'b100;
+	wire [15:0] portOld = rHADDR[2] ? gpio_out1 : gpio_out0;	// port 1 at odd word addresses
+	reg [15:0] portNew;
+	always @ (rHADDR, portOld, HWDATA)
+		case (rHADDR[5:3])
+			SET:		portNew = portOld | HWDATA[15:0];
+			CLR:		portNew = portOld & ~HWDATA[15:0];
+			TOGGLE:		portNew = portOld ^ HWDATA[15:0];
+			default:	portNew = HWDATA[15:0];		// plain write
+		endcase
+	wire portWrite = (rHADDR[5:3] == PLAIN) || (rHADDR[5:3] == SET) ||
+	                 (rHADDR[5:3] == CLR) || (rHADDR[5:3] == TOGGLE);
+	wire [1:0] write0 = byteWrite & {2{portWrite & ~rHADDR[2]}};	// byte writes to port 0
+	wire [1:0] write1 = byteWrite & {2{portWrite & rHADDR[2]}};		// byte writes to port 1
 	
 	//	Output port registers
 	always @(posedge HCLK)
@@ -92,10 +127,10 @@ module AHBgpio(
 			end
 		else 
 		 begin		
-				if (byteWrite[0] && (rHADDR[3:2] == 2'h0)) out0L <= HWDATA[7:0];
-				if (byteWrite[1] && (rHADDR[3:2] == 2'h0)) out0H <= HWDATA[15:8];
-				if (byteWrite[0] && (rHADDR[3:2] == 2'h1)) out1L <= HWDATA[7:0];
-				if (byteWrite[1] && (rHADDR[3:2] == 2'h1)) out1H <= HWDATA[15:8];
+				if (write0[0]) out0L <= portNew[7:0];
+				if (write0[1]) out0H <= portNew[15:8];
+				if (write1[0]) out1L <= portNew[7:0];
+				if (write1[1]) out1H <= portNew[15:8];
 		 end
 	
 	//	Input port registers
@@ -114,17 +149,77 @@ module AHBgpio(
 				in0B <= in0A;		// B registers copy from A registers - should be safe
 				in1B <= in1A;
 		 end
+
+	// Edge detection control registers - word writes only
+	localparam [3:0] RISE = 4'hA, FALL = 4'hB, EVENTS = 4'hC, DEBOUNCE = 4'hD, STABLE = 4'hE;
+	wire regWrite = rWrite & (rHSIZE == 2'b10);
+	reg [31:0] riseEn, fallEn;		// edge enables
+	reg [15:0] dbPeriod;			// debounce sample period
+	always @(posedge HCLK)
+		if(!HRESETn)
+			begin
+				riseEn <= 32'b0;
+				fallEn <= 32'b0;
+				dbPeriod <= 16'b0;
+			end
+		else if (regWrite)
+			case (rHADDR[5:2])
+				RISE:		riseEn <= HWDATA;
+				FALL:		fallEn <= HWDATA;
+				DEBOUNCE:	dbPeriod <= HWDATA[15:0];
+				default:	;
+			endcase
+
+	// Debounce - sample the synchronised inputs on each tick, accept bits that match the last sample
+	reg [23:0] dbCount;				// counts down to the next sample
+	wire sampleTick = (dbCount == 24'b0);
+	wire [31:0] inNow = {in1B, in0B};
+	reg [31:0] sampled, stable, stableOld;	// last sample, debounced inputs, and one cycle later
+	always @(posedge HCLK)
+		if(!HRESETn)
+			begin
+				dbCount <= 24'b0;
+				sampled <= 32'b0;
+				stable <= 32'b0;
+				stableOld <= 32'b0;
+			end
+		else
+			begin
+				if (sampleTick)
+					begin
+						dbCount <= {dbPeriod, 8'hff};
+						sampled <= inNow;
+						stable <= (inNow & ~(inNow ^ sampled)) | (stable & (inNow ^ sampled));
+					end
+				else dbCount <= dbCount - 1'b1;
+				stableOld <= stable;
+			end
+
+	// Events - set on an enabled edge, cleared by writing 1, set wins
+	wire [31:0] newEvents = (stable & ~stableOld & riseEn) | (~stable & stableOld & fallEn);
+	wire [31:0] clearEvents = (regWrite && (rHADDR[5:2] == EVENTS)) ? HWDATA : 32'b0;
+	reg [31:0] events;
+	always @(posedge HCLK)
+		if(!HRESETn) events <= 32'b0;
+		else events <= (events & ~clearEvents) | newEvents;
+
+	assign irq = |events;
 		
 	// Bus output signals
-	always @(in0B, in1B, gpio_out0, gpio_out1, rHADDR)
-		case (rHADDR[3:2])		// select on word address
-			2'h0:		readData = gpio_out0;		// address ends in 0x0
-			2'h1:		readData = gpio_out1;		// address ends in 0x4
-			2'h2:		readData = in0B;		    // address ends in 0x8
-			2'h3:		readData = in1B;			// address ends in 0xC			
+	always @(in0B, in1B, gpio_out0, gpio_out1, riseEn, fallEn, events, dbPeriod, stable, rHADDR)
+		case (rHADDR[5:2])		// select on word address
+			4'h2:		readData = {16'b0, in0B};	// address ends in 0x8
+			4'h3:		readData = {16'b0, in1B};	// address ends in 0xC			
+			RISE:		readData = riseEn;
+			FALL:		readData = fallEn;
+			EVENTS:		readData = events;
+			DEBOUNCE:	readData = {16'b0, dbPeriod};
+			STABLE:		readData = stable;
+			4'hF:		readData = 32'b0;
+			default:	readData = {16'b0, rHADDR[2] ? gpio_out1 : gpio_out0};	// outputs and aliases
 		endcase
 		
-	assign HRDATA = {16'b0, readData};	// extend with 0 bits for bus read
+	assign HRDATA = readData;
 	assign HREADYOUT = 1'b1;	// always ready - transaction never delayed
        
 endmodule
@@ -14,7 +14,12 @@
 // Revisions: April 2023 - SoC lab Group 14
 //
 //////////////////////////////////////////////////////////////////////////////////
-module AHBliteTop (
+module AHBliteTop #(
+    parameter [19:0] UART_INCR = 20'd3221,     // uart increment, 19200 bit/s - larger value simulates faster
+    parameter [19:0] LOAD_INCR = 20'd154619,   // ROM loader uart increment, 921600 bit/s
+    parameter [19:0] DEBUG_INCR = 20'd154619,  // debug bridge uart increment, 921600 bit/s
+    parameter DUAL_CORE = 0                     // 1 for two processors, each with private RAM
+    ) (
     input clk100,           // input clock from 100 MHz oscillator on Nexys4 board
     input btnCpuResetn,     // reset pushbutton, active low (marked CPU RESET)
     input btnU,             // up button - if pressed after reset, ROM loader activated
@@ -24,11 +29,15 @@ module AHBliteTop (
     input btnR,             // right button
     input [15:0] sw,        // 16 slide switches on Nexys 4 board
     input serialRx,         // serial port receive line
+    input dbgRx,            // debug bridge serial receive line, on connector JB
     input aclMISO,          // accelerometer SPI MISO signal
+    input aclInt1,          // accelerometer interrupt pin 1, active high
+    input aclInt2,          // accelerometer interrupt pin 2, active high
     output [15:0] led,      // 16 individual LEDs above slide switches   
     output [5:0] rgbLED,    // multi-colour LEDs {blu2, grn2, red2, blu1, grn1, red1} 
     output [7:0] JA,        // monitoring connector on FPGA board - use with oscilloscope
     output serialTx,        // serial port transmit line
+    output dbgTx,           // debug bridge serial transmit line
     output aclMOSI,         // accelerometer SPI MOSI signal
     output aclSCK,          // accelerometer SPI clock signal
     output aclSSn,          // accelerometer slave select signal, active low
@@ -58,47 +67,61 @@ module AHBliteTop (
     wire [31:0] HRDATA;     // read data
     wire		HREADY;     // ready signal from active slave
     wire 		HRESP;      // error response (not used here)
+
+// Signals from each master to the arbiter, which puts one of them on the bus
+// In the dual-core system, the _cpu signals are on the local bus of processor 0
+    wire [31:0] HWDATA_cpu, HADDR_cpu, HWDATA_dma, HADDR_dma, HWDATA_dbg, HADDR_dbg;
+    wire        HWRITE_cpu, HWRITE_dma, HWRITE_dbg;
+    wire [1:0]  HTRANS_cpu, HTRANS_dma, HTRANS_dbg;
+    wire [2:0]  HSIZE_cpu, HSIZE_dma, HSIZE_dbg;
+    wire        HREADY_cpu;     // ready signal seen by processor 0
+    wire        HGRANT_dma;     // DMA controller has the address phase
+    wire        HGRANT_dbg;     // debug bridge has the address phase
+    wire [1:0]  HMASTER;        // master with the address phase: processor 0 or 1, 2 for DMA, 3 for debug
     
 // ====================== Signals to and from individual slaves ==================
 // Slave select signals (one per slave)
 // ## As you add more slaves, you will need more of these signals
-    wire        HSEL_rom, HSEL_ram, HSEL_uart, HSEL_gpio, HSEL_Display;
+    wire        HSEL_rom, HSEL_ram, HSEL_uart, HSEL_gpio, HSEL_Display, HSEL_spi, HSEL_smp, HSEL_arith, HSEL_perf, HSEL_dma, HSEL_mbox, HSEL_cordic;
     
 // Slave output signals (one per slave)
 // ## As you add more slaves, you will need more of these signals
-    wire [31:0] HRDATA_rom, HRDATA_ram, HRDATA_uart, HRDATA_gpio, HRDATA_Display;               // read data from each slave
-    wire        HREADYOUT_rom, HREADYOUT_ram, HREADYOUT_uart, HREADYOUT_gpio, HREADYOUT_Display;   // ready output from each slave
+    wire [31:0] HRDATA_rom, HRDATA_ram, HRDATA_uart, HRDATA_gpio, HRDATA_Display, HRDATA_spi, HRDATA_smp, HRDATA_arith, HRDATA_perf, HRDATA_dma, HRDATA_mbox, HRDATA_cordic;                    // read data from each slave
+    wire        HREADYOUT_rom, HREADYOUT_ram, HREADYOUT_uart, HREADYOUT_gpio, HREADYOUT_Display, HREADYOUT_spi, HREADYOUT_smp, HREADYOUT_arith, HREADYOUT_perf, HREADYOUT_dma, HREADYOUT_mbox, HREADYOUT_cordic;   // ready output from each slave
  
 
 // ======================== Other Interconnecting Signals =======================
     wire        PLL_locked;                                 // from clock generator, indicates clock is running
     wire        resetHW;                                    // reset signal for hardware, active high
     wire        CPUreset, CPUlockup, CPUsleep;              // status signals
+    wire        CPUlockup1, CPUsleep1;                      // processor 1 status (dual-core only)
+    wire [31:0] HADDR_rom, HADDR_rom1, HRDATA_rom1;         // ROM read ports - see AHBrom
     wire        ROMload;                                    // rom loader is active
     wire [3:0]  muxSel;                                     // from address decoder to control the multiplexer
     wire [4:0]  buttons = {btnU, btnD, btnL, btnC, btnR};   // concatenate 5 pushbuttons
+    wire        uartRxAvail, uartTxSpace, smpAvail;         // DMA requests from peripherals
 
 // Define wires for Cortex-M0 DesignStart processor signals (not part of AHB-Lite)
     wire 		RXEV, TXEV;     // event signals (not used here)
     wire        NMI;            // non-maskable interrupt (not used here)
     wire [15:0]	IRQ;            // interrupt signals from up to 16 devices - active high
     wire        SYSRESETREQ;    // processor reset request output
+    wire        mboxIRQ1;       // mailbox interrupt for processor 1 - IRQ[6] is for processor 0
 
-// Assign values to the event and interrupt signals - none of these is used yet 
-    assign RXEV = 1'b0;         // no event 
+// Assign values to the event and interrupt signals - RXEV is set with the processors below
     assign NMI = 1'b0;          // non-maskable interrupt is not active
     assign HRESP = 1'b0;        // no slaves use this signal yet
 
     // ## Change this if you add a slave that uses an interrupt
     // Connect the interrupt signal from the slave to the appropriate bit of IRQ
     // Leave any unused interrupt inputs wired to 0 (inactive)
-    assign IRQ[15:2] = 16'b0;     // sets 14 MSB to 0
+    assign IRQ[15:7] = 9'b0;      // sets 9 MSB to 0
     assign IRQ[0] = 1'b0;         // sets LSB to 0
    
 // Wires and multiplexer to drive LEDs from two different sources - needed for ROM loader
-    wire [11:0] led_rom;                                // status output from ROM loader
+    wire [15:0] led_rom;                                // status output from ROM loader
     wire [15:0] led_gpio;                               // led output from GPIO block
-    assign led = ROMload ? {4'b0,led_rom} : led_gpio;   // choose which to display
+    assign led = ROMload ? led_rom : led_gpio;          // choose which to display
     
 // Temporary connections to the accelerometer signals, to avoid warnings in synthesis
 // ## If you use the accelerometer, you will need to delete these assignments
@@ -106,6 +129,12 @@ module AHBliteTop (
 //    assign aclMOSI = 1'b0;  // acceleromoter SPI MOSI is always 0
 //    assign aclSSn = 1'b1;   // accelerometer SPI slave select is high (inactive)
 
+// Accelerometer SPI pins are shared by the SPI block and the sampling engine
+    wire        spiSCK, spiMOSI, spiSSn;                    // from SPI block
+    wire        smpSCK, smpMOSI, smpSSn, smpOwn;            // from sampling engine
+    assign aclSCK = smpOwn ? smpSCK : spiSCK;
+    assign aclMOSI = smpOwn ? smpMOSI : spiMOSI;
+    assign aclSSn = smpOwn ? smpSSn : spiSSn;
 
 // ======================== Clock Generator ======================================
 // Generates 50 MHz bus clock from 100 MHz input clock
@@ -134,22 +163,33 @@ module AHBliteTop (
     status_ind statusInd (                                              // Instantiate status indicator module   
         .clk            (HCLK),                                         // works on system bus clock
         .reset          (resetHW),                                      // hardware reset signal
-        .statusIn       ({CPUreset, CPUlockup, CPUsleep, ROMload}),     // status inputs
+        .statusIn       ({CPUreset, CPUlockup | CPUlockup1, CPUsleep & CPUsleep1, ROMload}),     // status inputs
         .rgbLED         (rgbLED)                                        // output signals for colour LEDs
         );
 
-// ======================== Processor ========================================
-// Instantiate Cortex-M0 DesignStart processor and connect signals 
+// ======================== Processors and Bus Arbiter ========================================
+// Single processor: the processor, the DMA controller and the debug bridge share the bus
+// through AHBarbiter, processor has priority, the others use the cycles where the processor
+// has no transfer.
+// Dual-core: two processors, each in AHBcore with its own ROM read port and private RAM,
+// share the bus with the DMA controller and the debug bridge through the round-robin
+// arbiter AHBrrarb.
+// The peripheral interrupts go to both processors - the firmware enables each one on
+// only one processor.  Each processor wakes the other from WFE with SEV.
+    generate
+        if (DUAL_CORE == 0)
+            begin : single
+    // Instantiate Cortex-M0 DesignStart processor and connect signals 
     CORTEXM0DS cpu (
         .HCLK       (HCLK),
         .HRESETn    (HRESETn), 
         // Outputs to the AHB-Lite bus
-        .HWDATA      (HWDATA), 
-        .HADDR       (HADDR), 
-        .HWRITE      (HWRITE), 
-        .HTRANS      (HTRANS), 
+        .HWDATA      (HWDATA_cpu),  // through the arbiter
+        .HADDR       (HADDR_cpu), 
+        .HWRITE      (HWRITE_cpu), 
+        .HTRANS      (HTRANS_cpu), 
         .HPROT       (HPROT),
-        .HSIZE       (HSIZE),
+        .HSIZE       (HSIZE_cpu),
         .HMASTLOCK   (),        // not used, not connected
         .HBURST      (),        // not used, not connected
         // Inputs from the AHB-Lite bus	
@@ -166,22 +206,159 @@ module AHBliteTop (
         .SLEEPING    (CPUsleep)     // status: CPU sleeping, waiting for interrupt
         );
 
+    AHBarbiter arbiter (
+        .HCLK       (HCLK),         // bus clock and reset
+        .HRESETn    (HRESETn),
+        .HREADY     (HREADY),       // from multiplexer
+        .HADDR_M0   (HADDR_cpu),    // master 0 - processor
+        .HTRANS_M0  (HTRANS_cpu),
+        .HWRITE_M0  (HWRITE_cpu),
+        .HSIZE_M0   (HSIZE_cpu),
+        .HWDATA_M0  (HWDATA_cpu),
+        .HADDR_M1   (HADDR_dma),    // master 1 - DMA controller
+        .HTRANS_M1  (HTRANS_dma),
+        .HWRITE_M1  (HWRITE_dma),
+        .HSIZE_M1   (HSIZE_dma),
+        .HWDATA_M1  (HWDATA_dma),
+        .HGRANT_M1  (HGRANT_dma),
+        .HADDR_M2   (HADDR_dbg),    // master 2 - debug bridge
+        .HTRANS_M2  (HTRANS_dbg),
+        .HWRITE_M2  (HWRITE_dbg),
+        .HSIZE_M2   (HSIZE_dbg),
+        .HWDATA_M2  (HWDATA_dbg),
+        .HGRANT_M2  (HGRANT_dbg),
+        .HADDR      (HADDR),        // shared bus signals to decoder and slaves
+        .HTRANS     (HTRANS),
+        .HWRITE     (HWRITE),
+        .HSIZE      (HSIZE),
+        .HWDATA     (HWDATA)
+        );
+
+    assign HREADY_cpu = HREADY;
+    assign HMASTER = HGRANT_dma ? 2'd2 : (HGRANT_dbg & HTRANS_dbg[1]) ? 2'd3 : 2'd0;
+    assign RXEV = 1'b0;             // no event
+    assign HADDR_rom = HADDR;       // ROM is on the bus
+    assign HADDR_rom1 = 32'b0;      // second read port not used
+    assign CPUlockup1 = 1'b0;       // no processor 1
+    assign CPUsleep1 = 1'b1;
+            end
+        else
+            begin : dual
+    // Master ports of the two processors, to the arbiter
+    wire [31:0] HADDR_m0, HWDATA_m0, HADDR_m1, HWDATA_m1;
+    wire        HWRITE_m0, HWRITE_m1, HGRANT_m0, HGRANT_m1;
+    wire [1:0]  HTRANS_m0, HTRANS_m1;
+    wire [2:0]  HSIZE_m0, HSIZE_m1;
+    wire        TXEV1, SYSRESETREQ0, SYSRESETREQ1;
+
+    AHBcore core0 (
+        .HCLK        (HCLK),
+        .HRESETn     (HRESETn),
+        .IRQ         (IRQ),                 // peripherals, mailbox interrupt 0 on IRQ[6]
+        .RXEV        (TXEV1),               // SEV on processor 1 wakes processor 0
+        .TXEV        (TXEV),
+        .SYSRESETREQ (SYSRESETREQ0),
+        .LOCKUP      (CPUlockup),
+        .SLEEPING    (CPUsleep),
+        .HADDR       (HADDR_cpu),           // local bus, for ROM port 0 and monitoring
+        .HTRANS      (HTRANS_cpu),
+        .HPROT       (HPROT),
+        .HREADY      (HREADY_cpu),
+        .romHRDATA   (HRDATA_rom),
+        .mHADDR      (HADDR_m0),            // master port on the shared bus
+        .mHTRANS     (HTRANS_m0),
+        .mHWRITE     (HWRITE_m0),
+        .mHSIZE      (HSIZE_m0),
+        .mHWDATA     (HWDATA_m0),
+        .mHGRANT     (HGRANT_m0),
+        .mHREADY     (HREADY),
+        .mHRDATA     (HRDATA)
+        );
+
+    AHBcore core1 (
+        .HCLK        (HCLK),
+        .HRESETn     (HRESETn),
+        .IRQ         ({IRQ[15:7], mboxIRQ1, IRQ[5:0]}),     // mailbox interrupt 1 on IRQ[6]
+        .RXEV        (TXEV),
+        .TXEV        (TXEV1),
+        .SYSRESETREQ (SYSRESETREQ1),
+        .LOCKUP      (CPUlockup1),
+        .SLEEPING    (CPUsleep1),
+        .HADDR       (HADDR_rom1),          // local bus, for ROM port 1
+        .HTRANS      (),
+        .HPROT       (),
+        .HREADY      (),
+        .romHRDATA   (HRDATA_rom1),
+        .mHADDR      (HADDR_m1),
+        .mHTRANS     (HTRANS_m1),
+        .mHWRITE     (HWRITE_m1),
+        .mHSIZE      (HSIZE_m1),
+        .mHWDATA     (HWDATA_m1),
+        .mHGRANT     (HGRANT_m1),
+        .mHREADY     (HREADY),
+        .mHRDATA     (HRDATA)
+        );
+
+    AHBrrarb arbiter (
+        .HCLK       (HCLK),         // bus clock and reset
+        .HRESETn    (HRESETn),
+        .HREADY     (HREADY),       // from multiplexer
+        .HADDR_M0   (HADDR_m0),     // master 0 - processor 0
+        .HTRANS_M0  (HTRANS_m0),
+        .HWRITE_M0  (HWRITE_m0),
+        .HSIZE_M0   (HSIZE_m0),
+        .HWDATA_M0  (HWDATA_m0),
+        .HGRANT_M0  (HGRANT_m0),
+        .HADDR_M1   (HADDR_m1),     // master 1 - processor 1
+        .HTRANS_M1  (HTRANS_m1),
+        .HWRITE_M1  (HWRITE_m1),
+        .HSIZE_M1   (HSIZE_m1),
+        .HWDATA_M1  (HWDATA_m1),
+        .HGRANT_M1  (HGRANT_m1),
+        .HADDR_M2   (HADDR_dma),    // master 2 - DMA controller
+        .HTRANS_M2  (HTRANS_dma),
+        .HWRITE_M2  (HWRITE_dma),
+        .HSIZE_M2   (HSIZE_dma),
+        .HWDATA_M2  (HWDATA_dma),
+        .HGRANT_M2  (HGRANT_dma),
+        .HADDR_M3   (HADDR_dbg),    // master 3 - debug bridge
+        .HTRANS_M3  (HTRANS_dbg),
+        .HWRITE_M3  (HWRITE_dbg),
+        .HSIZE_M3   (HSIZE_dbg),
+        .HWDATA_M3  (HWDATA_dbg),
+        .HGRANT_M3  (HGRANT_dbg),
+        .HMASTER    (HMASTER),
+        .HADDR      (HADDR),        // shared bus signals to decoder and slaves
+        .HTRANS     (HTRANS),
+        .HWRITE     (HWRITE),
+        .HSIZE      (HSIZE),
+        .HWDATA     (HWDATA)
+        );
+
+    assign SYSRESETREQ = SYSRESETREQ0 | SYSRESETREQ1;   // either processor resets both
+    assign RXEV = TXEV1;
+    assign HADDR_rom = HADDR_cpu;   // ROM port 0 on the local bus of processor 0
+            end
+    endgenerate
+
 
 // ======================== Address Decoder ======================================
 // Implements address map, generates slave select signals and controls mux
 // ## As you add more slaves, you need to use more of the slave select signals   
     AHBDCD decode (
         .HADDR      (HADDR),        // address in
-        .HSEL_S0    (HSEL_rom),     // ten slave select signals out
+        .HSEL_S0    (HSEL_rom),     // twelve slave select signals out
         .HSEL_S1    (HSEL_ram),
         .HSEL_S2    (HSEL_gpio),
         .HSEL_S3    (HSEL_uart),
         .HSEL_S4    (HSEL_Display),
-        .HSEL_S5    (),
-        .HSEL_S6    (),
-        .HSEL_S7    (),
-        .HSEL_S8    (),
-        .HSEL_S9    (),
+        .HSEL_S5    (HSEL_spi),
+        .HSEL_S6    (HSEL_smp),
+        .HSEL_S7    (HSEL_arith),
+        .HSEL_S8    (HSEL_perf),
+        .HSEL_S9    (HSEL_dma),
+        .HSEL_S10   (HSEL_mbox),
+        .HSEL_S11   (HSEL_cordic),
         .HSEL_NOMAP (),             // indicates invalid address selected
         .MUX_SEL    (muxSel)        // multiplexer control signal out
         );
@@ -195,30 +372,34 @@ module AHBliteTop (
         .HRESETn        (HRESETn),
         .MUX_SEL        (muxSel[3:0]),     // control from address decoder
 
-        .HRDATA_S0      (HRDATA_rom),       // ten read data inputs from slaves
+        .HRDATA_S0      (DUAL_CORE ? BAD_DATA : HRDATA_rom),   // twelve read data inputs - ROM only on local buses if dual-core
         .HRDATA_S1      (HRDATA_ram),
         .HRDATA_S2      (HRDATA_gpio),
         .HRDATA_S3      (HRDATA_uart),
         .HRDATA_S4      (HRDATA_Display),
-        .HRDATA_S5      (BAD_DATA),
-        .HRDATA_S6      (BAD_DATA),         // unused inputs give BAD_DATA
-        .HRDATA_S7      (BAD_DATA),
-        .HRDATA_S8      (BAD_DATA),
-        .HRDATA_S9      (BAD_DATA),
-        .HRDATA_NOMAP   (BAD_DATA),
+        .HRDATA_S5      (HRDATA_spi),
+        .HRDATA_S6      (HRDATA_smp),
+        .HRDATA_S7      (HRDATA_arith),
+        .HRDATA_S8      (HRDATA_perf),
+        .HRDATA_S9      (HRDATA_dma),
+        .HRDATA_S10     (HRDATA_mbox),
+        .HRDATA_S11     (HRDATA_cordic),
+        .HRDATA_NOMAP   (BAD_DATA),         // unmapped addresses give BAD_DATA
         .HRDATA         (HRDATA),           // read data output to master
          
-        .HREADYOUT_S0   (HREADYOUT_rom),    // ten ready signals from slaves
+        .HREADYOUT_S0   (HREADYOUT_rom),    // twelve ready signals from slaves
         .HREADYOUT_S1   (HREADYOUT_ram),
         .HREADYOUT_S2   (HREADYOUT_gpio),
         .HREADYOUT_S3   (HREADYOUT_uart),             
         .HREADYOUT_S4   (HREADYOUT_Display),
-        .HREADYOUT_S5   (1'b1),
-        .HREADYOUT_S6   (1'b1),             // unused inputs tied to 1, meaning ready
-        .HREADYOUT_S7   (1'b1),
-        .HREADYOUT_S8   (1'b1),
-        .HREADYOUT_S9   (1'b1),
-        .HREADYOUT_NOMAP(1'b1),
+        .HREADYOUT_S5   (HREADYOUT_spi),
+        .HREADYOUT_S6   (HREADYOUT_smp),
+        .HREADYOUT_S7   (HREADYOUT_arith),
+        .HREADYOUT_S8   (HREADYOUT_perf),
+        .HREADYOUT_S9   (HREADYOUT_dma),
+        .HREADYOUT_S10  (HREADYOUT_mbox),
+        .HREADYOUT_S11  (HREADYOUT_cordic),
+        .HREADYOUT_NOMAP(1'b1),             // tied to 1, meaning ready
         .HREADY         (HREADY)            // ready output to master and all slaves
         );
 
@@ -226,22 +407,24 @@ module AHBliteTop (
 // ======================== Slaves on AHB Lite Bus ======================================
 
 // ======================== Program store - block RAM with loader interface ==============
-    AHBrom ROM (
+    AHBrom #(.LOAD_INCR(LOAD_INCR), .READ_PORTS(DUAL_CORE ? 2 : 1)) ROM (
         // AHB-Lite bus interface - partial: HSIZE is not used - only word transactions needed
         // HWRITE and HWDATA are not used - read only memory
         .HCLK           (HCLK),             // bus clock
         .HRESETn        (HRESETn),          // bus reset, active low
         .HSEL           (HSEL_rom),         // selects this slave
         .HREADY         (HREADY),           // indicates previous transaction completing
-        .HADDR          (HADDR),            // address
+        .HADDR          (HADDR_rom),        // address - from processor 0 if dual-core
         .HTRANS         (HTRANS),           // transaction type (only bit 1 used)
         .HRDATA         (HRDATA_rom),       // read data output
         .HREADYOUT      (HREADYOUT_rom),    // ready output
+        .HADDR1         (HADDR_rom1),       // second read port, for processor 1
+        .HRDATA1        (HRDATA_rom1),
         // Loader connections - to allow new program to be loaded into ROM
         .resetHW        (resetHW),			// hardware reset
         .loadButton     (btnU),		        // pushbutton to activate loader
         .serialRx	    (serialRx),         // serial input
-        .status         (led_rom),          // 12-bit word count for display on LEDs
+        .status         (led_rom),          // word count and result flags for display on LEDs
         .ROMload        (ROMload)			// loader active
         );
 
@@ -279,9 +462,10 @@ module AHBliteTop (
            .HREADYOUT   (HREADYOUT_gpio),      // ready output
            // GPIO signals
            .gpio_out0   (led_gpio),                      // connects port to GPIO LED wire. all 16 bits.
-           .gpio_out1   ({aclMOSI,aclSCK,aclSSn}),       // 3 LSB (default) are GPIO outputs
+           .gpio_out1   (),                              // not used - accelerometer is driven by AHBspi
            .gpio_in0    (sw),                            // all 16 bits connected to switches on board
-           .gpio_in1    ({aclMISO,10'b0,buttons})        // MSB is acc input. 5 LSB are buttons.
+           .gpio_in1    ({aclMISO,10'b0,buttons}),       // MSB is acc input. 5 LSB are buttons.
+           .irq         (IRQ[4])                         // input event interrupt, bit 4 of 16
    
    );
 
@@ -291,7 +475,7 @@ module AHBliteTop (
    some new wires for slave select, read data and ready output.  Connect the serial tansmit and
    receive signals to serialTx and serialRx, and the interrupt to one bit of the IRQ signal. */
    
-   AHBuart AHBuart (
+   AHBuart #(.BAUD_RESET(UART_INCR)) AHBuart (
            .HCLK        (HCLK),                // bus clock
            .HRESETn     (HRESETn),             // bus reset, active low
            .HSEL        (HSEL_uart),           // selects this slave
@@ -306,7 +490,9 @@ module AHBliteTop (
            // UART signals
            .serialRx    (serialRx),            // block serial rx connected to external serial rx
            .serialTx    (serialTx),            // block serial tx connected to external serial tx
-           .uart_IRQ    (IRQ[1])               // interrupt request output. bit 1 of 16 only
+           .uart_IRQ    (IRQ[1]),              // interrupt request output. bit 1 of 16 only
+           .rxAvail     (uartRxAvail),         // DMA requests
+           .txSpace     (uartTxSpace)
    );
    
   AHBdisp AHBdisp (
@@ -318,7 +504,7 @@ module AHBliteTop (
            .HADDR       (HADDR),    // address
            .HTRANS      (HTRANS),    // transaction type (only bit 1 used)
            .HWRITE      (HWRITE),          // write transaction
-   //          input wire [2:0] HSIZE,     // transaction width ignored
+           .HSIZE       (HSIZE),           // transaction width (max 32-bit supported)
            .HWDATA      (HWDATA),   // write data
            .HRDATA      (HRDATA_Display),  // read data from slave
            .HREADYOUT   (HREADYOUT_Display),      // ready output from slave
@@ -327,5 +513,161 @@ module AHBliteTop (
            .segment     (segment)   // segment lines, active low, PABCDEFG
    );  // end of port list
 
+// ======================= SPI block ======================================
+// SPI master for the accelerometer - replaces the bit-banged GPIO connection
+   AHBspi AHBspi (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HSEL        (HSEL_spi),            // selects this slave
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           .HADDR       (HADDR),               // address
+           .HTRANS      (HTRANS),              // transaction type (only bit 1 used)
+           .HWRITE      (HWRITE),              // write transaction
+           .HWDATA      (HWDATA),              // write data
+           .HRDATA      (HRDATA_spi),          // read data output
+           .HREADYOUT   (HREADYOUT_spi),       // ready output
+           // SPI signals
+           .spiSCK      (spiSCK),              // accelerometer SPI clock, through multiplexer
+           .spiMOSI     (spiMOSI),             // accelerometer SPI MOSI, through multiplexer
+           .spiMISO     (aclMISO),             // accelerometer SPI MISO
+           .spiSSn      (spiSSn),              // accelerometer slave select, through multiplexer
+           .slaveInt    ({aclInt2, aclInt1}),  // accelerometer interrupt pins
+           .spi_IRQ     (IRQ[2])               // interrupt request output, bit 2 of 16
+   );
+
+// ======================= Accelerometer sampling engine ======================================
+// Reads the accelerometer without the processor, takes over the SPI pins when enabled
+   AHBsampler AHBsampler (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HSEL        (HSEL_smp),            // selects this slave
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           .HADDR       (HADDR),               // address
+           .HTRANS      (HTRANS),              // transaction type (only bit 1 used)
+           .HWRITE      (HWRITE),              // write transaction
+           .HWDATA      (HWDATA),              // write data
+           .HRDATA      (HRDATA_smp),          // read data output
+           .HREADYOUT   (HREADYOUT_smp),       // ready output
+           // SPI signals
+           .spiSCK      (smpSCK),              // accelerometer SPI clock, through multiplexer
+           .spiMOSI     (smpMOSI),             // accelerometer SPI MOSI, through multiplexer
+           .spiMISO     (aclMISO),             // accelerometer SPI MISO
+           .spiSSn      (smpSSn),              // accelerometer slave select, through multiplexer
+           .spiOwn      (smpOwn),              // controls the SPI pin multiplexer
+           .dataReady   (aclInt1),             // accelerometer interrupt pin 1, mapped to data ready
+           .smp_IRQ     (IRQ[3]),              // interrupt request output, bit 3 of 16
+           .dataAvail   (smpAvail)             // DMA request
+   );
+
+// ======================= Arithmetic unit ======================================
+// Divide, multiply-accumulate and saturating add - the processor has no divide instruction
+   AHBarith AHBarith (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HSEL        (HSEL_arith),          // selects this slave
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           .HADDR       (HADDR),               // address
+           .HTRANS      (HTRANS),              // transaction type (only bit 1 used)
+           .HWRITE      (HWRITE),              // write transaction
+           .HWDATA      (HWDATA),              // write data
+           .HRDATA      (HRDATA_arith),        // read data output
+           .HREADYOUT   (HREADYOUT_arith)      // ready output, low while an operation is finishing
+   );
+
+// ======================= CORDIC unit ======================================
+// Vector angle and length, and tilt angles from an accelerometer sample set
+   AHBcordic AHBcordic (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HSEL        (HSEL_cordic),         // selects this slave
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           .HADDR       (HADDR),               // address
+           .HTRANS      (HTRANS),              // transaction type (only bit 1 used)
+           .HWRITE      (HWRITE),              // write transaction
+           .HWDATA      (HWDATA),              // write data
+           .HRDATA      (HRDATA_cordic),       // read data output
+           .HREADYOUT   (HREADYOUT_cordic)     // ready output, low while an operation is finishing
+   );
+
+// ======================= Performance counters ======================================
+// Counts cycles and transactions per slave by watching the bus, for utilisation reports
+   AHBperf AHBperf (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HSEL        (HSEL_perf),           // selects this slave
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           .HADDR       (HADDR),               // address
+           .HTRANS      (HTRANS),              // transaction type (only bit 1 used)
+           .HWRITE      (HWRITE),              // write transaction
+           .HWDATA      (HWDATA),              // write data
+           .HRDATA      (HRDATA_perf),         // read data output
+           .HREADYOUT   (HREADYOUT_perf),      // ready output
+           // signals being counted
+           .busSlave    (muxSel),              // slave selected by the address decoder
+           .cpuSleep    (CPUsleep),            // processor status
+           .cpuLockup   (CPUlockup)
+   );
+
+// ======================= DMA controller ======================================
+// Two channels moving data between memory and peripherals, as a second bus master
+   AHBdma AHBdma (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HSEL        (HSEL_dma),            // selects this slave
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           .HADDR       (HADDR),               // address
+           .HTRANS      (HTRANS),              // transaction type (only bit 1 used)
+           .HWRITE      (HWRITE),              // write transaction
+           .HWDATA      (HWDATA),              // write data
+           .HRDATA      (HRDATA_dma),          // read data output
+           .HREADYOUT   (HREADYOUT_dma),       // ready output
+           // master port, through the arbiter
+           .mHADDR      (HADDR_dma),
+           .mHTRANS     (HTRANS_dma),
+           .mHWRITE     (HWRITE_dma),
+           .mHSIZE      (HSIZE_dma),
+           .mHWDATA     (HWDATA_dma),
+           .mHGRANT     (HGRANT_dma),
+           .mHRDATA     (HRDATA),              // read data and ready shared with the processor
+           // requests: 1 = uart rx data, 2 = uart tx space, 3 = sample sets, others unused
+           .dreq        ({4'b0, smpAvail, uartTxSpace, uartRxAvail}),
+           .dma_IRQ     (IRQ[5])               // interrupt request output, bit 5 of 16
+   );
+
+// ======================= Debug bridge ======================================
+// Reads and writes memory and registers for a PC on its own serial port, as another bus master
+   AHBdebug #(.INCR(DEBUG_INCR)) AHBdebug (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           // master port, through the arbiter
+           .mHADDR      (HADDR_dbg),
+           .mHTRANS     (HTRANS_dbg),
+           .mHWRITE     (HWRITE_dbg),
+           .mHSIZE      (HSIZE_dbg),
+           .mHWDATA     (HWDATA_dbg),
+           .mHGRANT     (HGRANT_dbg),
+           .mHRDATA     (HRDATA),              // read data and ready shared with the processor
+           .serialRx    (dbgRx),               // serial input from PC
+           .serialTx    (dbgTx)                // serial output to PC
+   );
+
+// ======================= Mailbox ======================================
+// Messages and semaphores between the processors of the dual-core system
+   AHBmailbox AHBmailbox (
+           .HCLK        (HCLK),                // bus clock
+           .HRESETn     (HRESETn),             // bus reset, active low
+           .HSEL        (HSEL_mbox),           // selects this slave
+           .HREADY      (HREADY),              // indicates previous transaction completing
+           .HADDR       (HADDR),               // address
+           .HTRANS      (HTRANS),              // transaction type (only bit 1 used)
+           .HWRITE      (HWRITE),              // write transaction
+           .HWDATA      (HWDATA),              // write data
+           .HMASTER     (HMASTER),             // master number, to tell the processors apart
+           .HRDATA      (HRDATA_mbox),         // read data output
+           .HREADYOUT   (HREADYOUT_mbox),      // ready output
+           .irq         ({mboxIRQ1, IRQ[6]})   // interrupt requests, bit 6 of 16 on each processor
+   );
+
 
 endmodule
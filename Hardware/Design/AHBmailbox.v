@@ -0,0 +1,142 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBmailbox
+// Description:   Mailboxes and semaphores for the dual-core system.  The bus master
+//          number from AHBrrarb tells the processors apart (0 or 1, 2 is the DMA
+//          controller, 3 the debug bridge).  In the single processor system HMASTER
+//          is 0 for the processor.
+//      Address 00 - CPU ID, read only: number of the processor reading it
+//      Address 04 - status, read only: bit n = mailbox n full, n = 0 or 1
+//      Address 08 - interrupt enable: bit n = interrupt processor n while mailbox n
+//                   is full.  Reads give the enables.
+//      Address 10 - mailbox 0, 32 bits: message for processor 0.  A write stores the
+//                   message and sets full, a read returns it and clears full.
+//                   A write when full replaces the message - check status first.
+//      Address 14 - mailbox 1: message for processor 1
+//      Address 20 + 4n - semaphore n, n = 0 to 7.  A read returns 0 if the semaphore
+//                   was free, and it now belongs to the processor reading, or if it
+//                   already belonged to that processor; otherwise it returns 1.
+//                   A write from the owner frees it.  All are free after reset.
+//      irq[n] goes to IRQ 6 of processor n.
+//      All transfers 32 bits.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBmailbox(
+            // Bus signals
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HSEL,            // selects this slave
+            input wire HREADY,          // indicates previous transaction completing
+            input wire [31:0] HADDR,    // address
+            input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
+            input wire HWRITE,          // write transaction
+//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [31:0] HWDATA,   // write data
+            input wire [1:0] HMASTER,   // master number, with the address phase
+            output wire [31:0] HRDATA,  // read data from slave
+            output wire HREADYOUT,      // ready output from slave
+            // Interrupt requests, one per processor
+            output wire [1:0] irq
+    );
+
+    localparam NSEM = 8;        // number of semaphores
+
+    // Registers to hold signals from address phase
+    reg [3:0] rHADDR;           // only need four bits of word address
+    reg rWrite, rRead;          // write and read enable signals
+    reg [1:0] rMaster;          // master making the transfer
+
+    // Capture bus signals in address phase
+    always @(posedge HCLK)
+        if(!HRESETn)
+            begin
+                rHADDR <= 4'b0;
+                rWrite <= 1'b0;
+                rRead <= 1'b0;
+                rMaster <= 2'b0;
+            end
+        else if(HREADY)
+            begin
+                rHADDR <= HADDR[5:2];                   // capture address bits for use in data phase
+                rWrite <= HSEL & HWRITE & HTRANS[1];    // slave selected for write transfer
+                rRead <= HSEL & ~HWRITE & HTRANS[1];    // slave selected for read transfer
+                rMaster <= HMASTER;
+            end
+
+    localparam [3:0] CPUID = 4'h0, STATUS = 4'h1, IRQEN = 4'h2, MBOX0 = 4'h4, MBOX1 = 4'h5,
+                     SEM = 4'h8;
+
+    // Mailboxes
+    reg [31:0] message [0:1];
+    reg [1:0] full, irqEnable;
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                message[0] <= 32'b0;
+                message[1] <= 32'b0;
+                full <= 2'b0;
+                irqEnable <= 2'b0;
+            end
+        else
+            begin
+                if (rWrite & (rHADDR == IRQEN)) irqEnable <= HWDATA[1:0];
+                if (rWrite & ((rHADDR == MBOX0) | (rHADDR == MBOX1)))
+                    begin
+                        message[rHADDR[0]] <= HWDATA;
+                        full[rHADDR[0]] <= 1'b1;
+                    end
+                else if (rRead & ((rHADDR == MBOX0) | (rHADDR == MBOX1)))
+                    full[rHADDR[0]] <= 1'b0;
+            end
+
+    assign irq = full & irqEnable;
+
+    // Semaphores - taken and owner of each
+    reg [NSEM-1:0] taken;
+    reg [NSEM-1:0] owner;       // processor number, 1 bit
+    wire [2:0] semNum = rHADDR[2:0];
+    wire semAccess = rHADDR[3];
+    wire semMine = ~taken[semNum] | (owner[semNum] == rMaster[0]);
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                taken <= {NSEM{1'b0}};
+                owner <= {NSEM{1'b0}};
+            end
+        else if (semAccess)
+            begin
+                if (rRead & ~taken[semNum])
+                    begin
+                        taken[semNum] <= 1'b1;
+                        owner[semNum] <= rMaster[0];
+                    end
+                else if (rWrite & taken[semNum] & (owner[semNum] == rMaster[0]))
+                    taken[semNum] <= 1'b0;
+            end
+
+    // Bus output signals
+    reg [31:0] readData;
+    always @(*)
+        if (semAccess)
+            readData = {31'b0, ~semMine};
+        else
+            case (rHADDR)
+                CPUID:      readData = {30'b0, rMaster};
+                STATUS:     readData = {30'b0, full};
+                IRQEN:      readData = {30'b0, irqEnable};
+                MBOX0:      readData = message[0];
+                MBOX1:      readData = message[1];
+                default:    readData = 32'b0;
+            endcase
+
+    assign HRDATA = readData;
+    assign HREADYOUT = 1'b1;    // never delays the bus
+
+endmodule
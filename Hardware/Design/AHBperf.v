@@ -0,0 +1,136 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBperf
+// Description:   Performance counters on AHB.  Watches the bus signals and the
+//          processor status signals, and counts clock cycles and transactions,
+//          so the firmware can see where the bus bandwidth and the time go.
+//      Address 00 - control:   bit 0 = freeze - 1 stops all counters, so they can be
+//                                      read as a consistent set
+//                              bit 1 = clear - write 1 to set all counters to 0
+//                                      (reads as 0)
+//      Address 04 - total clock cycles
+//      Address 08 - cycles with the processor sleeping (WFI)
+//      Address 0C - cycles with the processor in lockup
+//      Address 10 - wait cycles - HREADY low, a slave is delaying the bus
+//      Address 14 - idle cycles - HREADY high and no transaction starting
+//      Address 40 + 8n - read transactions to slave n, n = 0 to 11 (MUX_SEL from AHBDCD)
+//      Address 44 + 8n - write transactions to slave n
+//      Address A0, A4 - read and write transactions to unmapped addresses
+//      A transaction is counted in its address phase, so instruction fetches count
+//      as reads of the ROM.  Reads of these registers count as reads of this slave.
+//      All counters are 32 bits - total cycles wraps after 85 seconds at 50 MHz.
+//      All transfers 32 bits.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBperf(
+            // Bus signals
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HSEL,            // selects this slave
+            input wire HREADY,          // indicates previous transaction completing
+            input wire [31:0] HADDR,    // address
+            input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
+            input wire HWRITE,          // write transaction
+//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [31:0] HWDATA,   // write data
+            output wire [31:0] HRDATA,  // read data from slave
+            output wire HREADYOUT,      // ready output from slave
+            // Signals being counted
+            input wire [3:0] busSlave,  // slave number from the address decoder, 15 for unmapped
+            input wire cpuSleep,        // processor sleeping
+            input wire cpuLockup        // processor in lockup state
+    );
+
+    localparam NSLAVE = 13;     // slaves 0 to 11, then unmapped addresses
+
+    // Registers to hold signals from address phase
+    reg [5:0] rHADDR;           // six bits of word address
+    reg rWrite;                 // write enable signal
+
+    // Capture bus signals in address phase
+    always @(posedge HCLK)
+        if(!HRESETn)
+            begin
+                rHADDR <= 6'b0;
+                rWrite <= 1'b0;
+            end
+        else if(HREADY)
+            begin
+                rHADDR <= HADDR[7:2];                   // capture address bits for use in data phase
+                rWrite <= HSEL & HWRITE & HTRANS[1];    // slave selected for write transfer
+            end
+
+    localparam [5:0] CONTROL = 6'h00, TOTAL = 6'h01, SLEEP = 6'h02, LOCKUP = 6'h03,
+                     WAIT = 6'h04, IDLE = 6'h05, SLAVES = 6'h10;
+
+    // Control register
+    reg freeze;
+    wire clear = rWrite & (rHADDR == CONTROL) & HWDATA[1];
+    always @(posedge HCLK)
+        if (!HRESETn) freeze <= 1'b0;
+        else if (rWrite & (rHADDR == CONTROL)) freeze <= HWDATA[0];
+
+    // Transaction starting in this cycle, and which slave it is for
+    wire transfer = HREADY & HTRANS[1];
+    wire [3:0] slave = (busSlave > 4'd11) ? 4'd12 : busSlave;
+
+    // Counters
+    reg [31:0] total, sleep, lockup, waits, idle;
+    reg [31:0] reads [0:NSLAVE-1];
+    reg [31:0] writes [0:NSLAVE-1];
+    integer i;
+
+    always @(posedge HCLK)
+        if (!HRESETn | clear)
+            begin
+                total <= 32'b0;
+                sleep <= 32'b0;
+                lockup <= 32'b0;
+                waits <= 32'b0;
+                idle <= 32'b0;
+                for (i = 0; i < NSLAVE; i = i + 1)
+                    begin
+                        reads[i] <= 32'b0;
+                        writes[i] <= 32'b0;
+                    end
+            end
+        else if (!freeze)
+            begin
+                total <= total + 32'd1;
+                if (cpuSleep) sleep <= sleep + 32'd1;
+                if (cpuLockup) lockup <= lockup + 32'd1;
+                if (!HREADY) waits <= waits + 32'd1;
+                else if (!HTRANS[1]) idle <= idle + 32'd1;
+                if (transfer & HWRITE) writes[slave] <= writes[slave] + 32'd1;
+                if (transfer & !HWRITE) reads[slave] <= reads[slave] + 32'd1;
+            end
+
+    // Bus output signals
+    wire [5:0] slaveReg = rHADDR - SLAVES;     // counter pair number in bits 4:1, write in bit 0
+    reg [31:0] readData;
+    always @(*)
+        case (rHADDR)       // select on word address (stored from address phase)
+            CONTROL:    readData = {31'b0, freeze};
+            TOTAL:      readData = total;
+            SLEEP:      readData = sleep;
+            LOCKUP:     readData = lockup;
+            WAIT:       readData = waits;
+            IDLE:       readData = idle;
+            default:
+                if ((rHADDR >= SLAVES) && (slaveReg[5:1] < NSLAVE))
+                    readData = slaveReg[0] ? writes[slaveReg[4:1]] : reads[slaveReg[4:1]];
+                else
+                    readData = 32'b0;
+        endcase
+
+    assign HRDATA = readData;
+    assign HREADYOUT = 1'b1;    // never delays the bus
+
+endmodule
@@ -9,12 +9,22 @@
 // Description: 	Provides on-chip program memory on AHBlite bus - 32kByte. 
 //			Uses dual-port block ram, with load facilty through serial port.
 //			Loader active if button signal high after reset.
+//			Loader takes ASCII hex or a binary stream - see ram_loader.
+//			With READ_PORTS = 2, a second block ram holds a copy of the program,
+//			loaded at the same time, to give a second read port (HADDR1, HRDATA1)
+//			for the other processor of the dual-core system.  Port 1 is not on
+//			the bus - its data is valid in the cycle after HADDR1, like HRDATA.
 //
 // Revision: 
 // Revision 0.01 - File Created
+// Revision 0.02 - loader bit rate parameter LOAD_INCR added, April 2023
+// Revision 0.03 - status shows binary mode and errors, April 2023
+// Revision 0.04 - optional second read port, April 2023
 //
 //////////////////////////////////////////////////////////////////////////////////
-module AHBrom(
+module AHBrom #(parameter [19:0] LOAD_INCR = 20'd3221,	// loader uart increment, 19200 bit/s
+				parameter READ_PORTS = 1)			// 2 for a second read port
+		(
 			input wire HCLK,				// bus clock
 			// Bus interface - read only
 			input wire HRESETn,			// bus reset, active low
@@ -27,11 +37,14 @@ module AHBrom(
 //			input wire [31:0] HWDATA,	// write data (ignored)
 			output wire [31:0] HRDATA,	// read data from slave
 			output wire HREADYOUT,		// ready output from slave
+			// Second read port, used if READ_PORTS = 2
+			input wire [31:0] HADDR1,	// address
+			output wire [31:0] HRDATA1,	// read data
 			// Loader connections
 			input wire resetHW,			// hardware reset
 			input wire loadButton,		// pushbutton to activate loader
 			input wire serialRx,	    // serial input
-			output [11:0] status,        // 12-bit output to indicate progress
+			output [15:0] status,        // {error, CRC error, binary mode, word count}
 			output ROMload			// loader active
             );
 	
@@ -41,12 +54,13 @@ module AHBrom(
 	wire newByte, wNow;
 	wire [ADDR_WIDTH-3:0] wAddr;
 	wire [31:0] wData;
+	wire [2:0] flags;
 
 	assign HREADYOUT = 1'b1;	// always ready - transaction never delayed
-	assign status = wAddr;     // widths may not match - ok	
+	assign status = {flags, wAddr};     // 3 flags and 13-bit word count
 
 	// Instantiate UART receive block (includes bit-rate generator)
-    uart_RXonly uart1 (
+    uart_RXonly #(.INCR(LOAD_INCR)) uart1 (
         .clk        (HCLK),          // 50 MHz clock
         .rst        (resetHW),       // asynchronous reset
         .rxd        (serialRx),      // serial data in (idle at logic 1)
@@ -64,7 +78,8 @@ module AHBrom(
 		.wAddr		(wAddr),        // write address
 		.wData		(wData),			// data to memory
 		.wNow			(wNow),					// write control signal
-		.ROMload		(ROMload)			// loader active
+		.ROMload		(ROMload),			// loader active
+		.flags		(flags)				// error, CRC error, binary mode
 		);
 	
 	// Instantiate the block ram - created by Xilinx IP generator (in VHDL)
@@ -80,5 +95,27 @@ module AHBrom(
         .doutb      (HRDATA)            // read data goes directly to bus
         );
 
+	// Second copy of the program, written with the first, for the second read port
+	generate
+		if (READ_PORTS == 2)
+			begin : port1
+			blk_mem_8Kword bram2 (
+				.clka       (HCLK),
+				.ena        (ROMload),
+				.wea        (wNow),
+				.addra      (wAddr),
+				.dina       (wData),
+				.clkb       (HCLK),
+				.enb        (~ROMload),
+				.addrb      (HADDR1[ADDR_WIDTH-1:2]),
+				.doutb      (HRDATA1)
+				);
+			end
+		else
+			begin : noPort1
+			assign HRDATA1 = 32'b0;
+			end
+	endgenerate
+
  
 endmodule
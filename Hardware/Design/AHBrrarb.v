@@ -0,0 +1,129 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBrrarb
+// Description:   Round-robin arbiter for four AHB-Lite masters on the shared bus of
+//          the dual-core system, in front of AHBDCD and AHBMUX: the two processor
+//          bridges (AHBcore), the DMA controller and the debug bridge (AHBdebug).  Every master holds its
+//          address and control until a cycle with its grant and HREADY both high -
+//          that is when its transfer is accepted.  When more than one master is
+//          waiting, the one after the master last accepted goes first, so no master
+//          waits for more than three transfers by the others.
+//          HMASTER gives the master number with the address phase, so a slave can
+//          tell the processors apart (AHBmailbox).  Write data comes from the
+//          master that owns the data phase, remembered from the address phase.
+//          HRDATA and HREADY are shared by all the masters, straight from AHBMUX.
+//
+// Revision 0.01 - File Created
+// Revision 0.02 - Master 3, for the debug bridge
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBrrarb(
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HREADY,          // from AHBMUX - previous transfer completing
+            // Master 0 - processor 0
+            input wire [31:0] HADDR_M0,
+            input wire [1:0] HTRANS_M0,
+            input wire HWRITE_M0,
+            input wire [2:0] HSIZE_M0,
+            input wire [31:0] HWDATA_M0,
+            output wire HGRANT_M0,
+            // Master 1 - processor 1
+            input wire [31:0] HADDR_M1,
+            input wire [1:0] HTRANS_M1,
+            input wire HWRITE_M1,
+            input wire [2:0] HSIZE_M1,
+            input wire [31:0] HWDATA_M1,
+            output wire HGRANT_M1,
+            // Master 2 - DMA controller
+            input wire [31:0] HADDR_M2,
+            input wire [1:0] HTRANS_M2,
+            input wire HWRITE_M2,
+            input wire [2:0] HSIZE_M2,
+            input wire [31:0] HWDATA_M2,
+            output wire HGRANT_M2,
+            // Master 3 - debug bridge
+            input wire [31:0] HADDR_M3,
+            input wire [1:0] HTRANS_M3,
+            input wire HWRITE_M3,
+            input wire [2:0] HSIZE_M3,
+            input wire [31:0] HWDATA_M3,
+            output wire HGRANT_M3,
+            // Shared bus, to the address decoder and all slaves
+            output wire [1:0] HMASTER,  // master with the address phase
+            output wire [31:0] HADDR,
+            output wire [1:0] HTRANS,
+            output wire HWRITE,
+            output wire [2:0] HSIZE,
+            output wire [31:0] HWDATA
+    );
+
+    wire [3:0] req = {HTRANS_M3[1], HTRANS_M2[1], HTRANS_M1[1], HTRANS_M0[1]};
+    reg [1:0] last;             // master accepted most recently
+    reg [1:0] grant;            // master with the address phase
+
+    // Look at the masters in turn, starting after the last one accepted
+    always @(*)
+        case (last)
+            2'd0:       grant = req[1] ? 2'd1 : req[2] ? 2'd2 : req[3] ? 2'd3 : 2'd0;
+            2'd1:       grant = req[2] ? 2'd2 : req[3] ? 2'd3 : req[0] ? 2'd0 : 2'd1;
+            2'd2:       grant = req[3] ? 2'd3 : req[0] ? 2'd0 : req[1] ? 2'd1 : 2'd2;
+            default:    grant = req[0] ? 2'd0 : req[1] ? 2'd1 : req[2] ? 2'd2 : 2'd3;
+        endcase
+
+    wire accepted = HREADY & req[grant];
+    reg [1:0] dataOwner;        // master with the data phase
+
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                last <= 2'd3;   // processor 0 first after reset
+                dataOwner <= 2'd0;
+            end
+        else if (HREADY)
+            begin
+                if (accepted) last <= grant;
+                dataOwner <= grant;
+            end
+
+    assign HGRANT_M0 = (grant == 2'd0);
+    assign HGRANT_M1 = (grant == 2'd1);
+    assign HGRANT_M2 = (grant == 2'd2);
+    assign HGRANT_M3 = (grant == 2'd3);
+    assign HMASTER = grant;
+
+    // Address phase from the granted master - its HTRANS is IDLE if none is waiting
+    reg [31:0] addrMux, dataMux;
+    reg [1:0] transMux;
+    reg writeMux;
+    reg [2:0] sizeMux;
+    always @(*)
+        case (grant)
+            2'd0:       {addrMux, transMux, writeMux, sizeMux} = {HADDR_M0, HTRANS_M0, HWRITE_M0, HSIZE_M0};
+            2'd1:       {addrMux, transMux, writeMux, sizeMux} = {HADDR_M1, HTRANS_M1, HWRITE_M1, HSIZE_M1};
+            2'd2:       {addrMux, transMux, writeMux, sizeMux} = {HADDR_M2, HTRANS_M2, HWRITE_M2, HSIZE_M2};
+            default:    {addrMux, transMux, writeMux, sizeMux} = {HADDR_M3, HTRANS_M3, HWRITE_M3, HSIZE_M3};
+        endcase
+
+    assign HADDR  = addrMux;
+    assign HTRANS = transMux;
+    assign HWRITE = writeMux;
+    assign HSIZE  = sizeMux;
+
+    // Data phase
+    always @(*)
+        case (dataOwner)
+            2'd0:       dataMux = HWDATA_M0;
+            2'd1:       dataMux = HWDATA_M1;
+            2'd2:       dataMux = HWDATA_M2;
+            default:    dataMux = HWDATA_M3;
+        endcase
+
+    assign HWDATA = dataMux;
+
+endmodule
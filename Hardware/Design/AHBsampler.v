@@ -0,0 +1,405 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBsampler
+// Description:   Accelerometer sampling engine on AHB.  Reads X, Y, Z (and optionally
+//          temperature) from the ADXL362 over SPI without the processor, either at a
+//          fixed period or when the data ready signal (INT1) goes high, and stores
+//          each sample set with a timestamp in a buffer of 2**BUF_AWIDTH entries.
+//          A filter between the SPI and the buffer can combine each group of ratio
+//          sample sets into one, so the processor reads fewer, less noisy sets.
+//      Address 00 - control:   bit 0 = enable - the engine drives the SPI pins
+//                              bit 1 = trigger on data ready (1) or period timer (0)
+//                              bit 2 = read temperature as well
+//                              bit 3 = interrupt enable for buffer level
+//      Address 04 - status:    bit 0 = SPI sequence in progress
+//                              bit 1 = buffer not empty
+//                              bit 2 = buffer holds at least level sample sets
+//                              bit 3 = overflow - oldest sample set was lost, write 1 to clear
+//                              bit 4 = limited - a filter output was out of the 16-bit
+//                                      range and was limited, write 1 to clear
+//      Address 08 - period, 24 bits, in clock cycles.  Reset value gives 400 Hz.
+//      Address 0C - level, 13 bits, for status bit 2 and interrupt.  0 disables.
+//      Address 10 - count of sample sets in buffer, read only
+//      Address 14 - SPI clock divider, 8 bits, as in AHBspi.  Reset value 3 gives 6.25 MHz.
+//      Address 18 - time, read only: microseconds since reset, 32 bits
+//      Address 1C - filter:    bits 7:0 = ratio - 1: one sample set stored for each ratio read
+//                              bits 11:8 = shift
+//                              bit 12 = mode: 0 average, 1 first-order IIR low-pass
+//                  Average: X, Y and Z of each group of ratio sets are added up, and the
+//                  sum shifted right by shift is stored - the mean if ratio = 2**shift.
+//                  IIR: each set moves the filter 1/2**shift of the way towards it, and
+//                  the filter output is stored after every ratio sets.  Writing this
+//                  register starts a new group and restarts the IIR from the next set.
+//                  Reset value 0 stores every sample set unchanged.  Temperature is not
+//                  filtered, and the timestamp is that of the last set of the group.
+//      Address 20 - oldest sample set: timestamp in microseconds
+//      Address 24 - oldest sample set: Y in bits 31:16, X in bits 15:0
+//      Address 28 - oldest sample set: temperature in bits 31:16, Z in bits 15:0.
+//                  Reading this word removes the sample set from the buffer, so read
+//                  the other two first, and read this as a word.
+//      The SPI pins are shared with AHBspi, through a multiplexer in AHBliteTop
+//      controlled by spiOwn.  Set up the ADXL362 using AHBspi, then enable the engine.
+//      If the buffer is full, the oldest sample set is discarded to make space.
+//      All transfers 32 bits.
+//
+// Revision 0.01 - File Created
+// Revision 0.02 - buffer not empty output, as a DMA request
+// Revision 0.03 - decimation filter
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBsampler #(parameter BUF_AWIDTH = 8,           // 256 sample sets
+                    parameter CLK_MHZ = 50)             // clock frequency, for timestamps
+        (
+            // Bus signals
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HSEL,            // selects this slave
+            input wire HREADY,          // indicates previous transaction completing
+            input wire [31:0] HADDR,    // address
+            input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
+            input wire HWRITE,          // write transaction
+//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [31:0] HWDATA,   // write data
+            output wire [31:0] HRDATA,  // read data from slave
+            output wire HREADYOUT,      // ready output from slave
+            // SPI signals
+            output spiSCK,              // SPI clock, idles low
+            output spiMOSI,             // SPI data out
+            input spiMISO,              // SPI data in
+            output spiSSn,              // slave select, active low
+            output spiOwn,              // this block is driving the SPI pins
+            input dataReady,            // data ready signal from ADXL362 (INT1), active high
+            output smp_IRQ,             // interrupt request
+            output dataAvail            // buffer not empty - DMA request to read 20 to 28
+    );
+
+    localparam [23:0] PERIOD_RESET = 24'd125000;   // 400 Hz with 50 MHz clock
+    localparam [7:0] DIV_RESET = 8'd3;              // 6.25 MHz SCLK with 50 MHz clock
+    localparam [7:0] ADXL_READ_REG = 8'h0B;         // ADXL362 read command
+    localparam [7:0] ADXL_XDATA_L = 8'h0E;          // first data register
+
+    // Registers to hold signals from address phase
+    reg [3:0] rHADDR;           // only need four bits of address
+    reg rWrite, rRead;          // write and read enable signals
+
+    // Capture bus signals in address phase
+    always @(posedge HCLK)
+        if(!HRESETn)
+            begin
+                rHADDR <= 4'b0;
+                rWrite <= 1'b0;
+                rRead  <= 1'b0;
+            end
+        else if(HREADY)
+            begin
+                rHADDR <= HADDR[5:2];                   // capture address bits for use in data phase
+                rWrite <= HSEL & HWRITE & HTRANS[1];    // slave selected for write transfer
+                rRead <= HSEL & ~HWRITE & HTRANS[1];    // slave selected for read transfer
+            end
+
+    // Control and setup registers
+    reg [3:0] control;          // enable, trigger mode, temperature, interrupt enable
+    reg [23:0] period;          // sample period in clock cycles
+    reg [12:0] level;           // buffer level for interrupt
+    reg [7:0] divider;          // SCLK half period, minus 1
+    reg [12:0] filter;          // mode, shift, decimation ratio - 1
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                control <= 4'b0;
+                period <= PERIOD_RESET;
+                level <= 13'b0;
+                divider <= DIV_RESET;
+                filter <= 13'b0;
+            end
+        else if (rWrite)
+            case (rHADDR)
+                4'h0:   control <= HWDATA[3:0];
+                4'h2:   period <= HWDATA[23:0];
+                4'h3:   level <= HWDATA[12:0];
+                4'h5:   divider <= HWDATA[7:0];
+                4'h7:   filter <= HWDATA[12:0];
+                default: ;                              // other registers read only
+            endcase
+
+    wire enable = control[0];
+    wire drdyMode = control[1];
+    wire withTemp = control[2];
+    wire [7:0] ratio = filter[7:0];             // sample sets per group, minus 1
+    wire [3:0] shift = filter[11:8];
+    wire iir = filter[12];
+    wire filterWrite = rWrite & (rHADDR == 4'h7);
+
+// ========================= Timestamp and triggers =====================================
+    // Microsecond timer - prescaler divides clock by CLK_MHZ
+    reg [7:0] prescale;
+    reg [31:0] usTime;
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                prescale <= 8'd0;
+                usTime <= 32'd0;
+            end
+        else if (prescale == CLK_MHZ - 1)
+            begin
+                prescale <= 8'd0;
+                usTime <= usTime + 32'd1;
+            end
+        else prescale <= prescale + 8'd1;
+
+    // Period timer - runs when enabled in timer mode
+    reg [23:0] periodCount;
+    wire timerOn = enable & ~drdyMode;
+    wire periodTick = timerOn & (periodCount == period - 24'd1);
+    always @(posedge HCLK)
+        if (!HRESETn || !timerOn || periodTick) periodCount <= 24'd0;
+        else periodCount <= periodCount + 24'd1;
+
+    // Synchronise data ready signal - double registers
+    reg drdyA, drdyB;
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                drdyA <= 1'b0;
+                drdyB <= 1'b0;
+            end
+        else
+            begin
+                drdyA <= dataReady;
+                drdyB <= drdyA;
+            end
+
+// ========================= Sequencer ================================================
+    localparam [2:0] IDLE = 3'd0,       // waiting for trigger
+                     SETUP = 3'd1,      // slave select active, before first byte
+                     XFER = 3'd2,       // byte transfer in progress
+                     STORE = 3'd3,      // write sample set to buffer
+                     MAKEROOM = 3'd4,   // buffer was full, oldest entry removed
+                     FILTER = 3'd5;     // add sample set to the filters
+
+    reg [2:0] state;
+    reg [3:0] byteIdx;          // byte in sequence: command, address, then data bytes
+    reg [3:0] waitCount;        // slave select setup time, and hold-off after a sequence
+    reg pending;                // period trigger waiting to be served
+    reg spiGo;                  // start SPI byte
+    reg [7:0] spiTx;            // byte to send
+    reg select;                 // slave select
+    reg [63:0] sampleData;      // {temp, Z, Y, X}
+    reg [31:0] stamp;           // time of trigger
+    reg engWr, engRd;           // buffer write, and read to discard oldest
+    reg overflow;               // sticky flag
+    reg limited;                // sticky flag
+    reg [7:0] groupCount;       // sample sets already in the filters for this group
+    reg primed;                 // IIR filters hold a state - cleared to restart them
+    wire [2:0] filterLimited;   // filter outputs limited, per axis
+    wire [7:0] spiRx;
+    wire spiDone, spiReady;
+    wire bufFull;
+
+    wire [3:0] lastIdx = withTemp ? 4'd9 : 4'd7;
+    // Data ready is a level - the hold-off gives time for it to fall after the data is read
+    wire trigger = enable & (drdyMode ? (drdyB & (waitCount == 4'd0)) : pending);
+
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                state <= IDLE;
+                byteIdx <= 4'd0;
+                waitCount <= 4'd0;
+                pending <= 1'b0;
+                spiGo <= 1'b0;
+                spiTx <= 8'b0;
+                select <= 1'b0;
+                sampleData <= 64'b0;
+                stamp <= 32'b0;
+                engWr <= 1'b0;
+                engRd <= 1'b0;
+                overflow <= 1'b0;
+                limited <= 1'b0;
+                groupCount <= 8'd0;
+                primed <= 1'b0;
+            end
+        else
+            begin
+                spiGo <= 1'b0;          // strobes last one clock cycle
+                engWr <= 1'b0;
+                engRd <= 1'b0;
+                if (periodTick) pending <= 1'b1;
+                if (rWrite && (rHADDR == 4'h1) && HWDATA[3]) overflow <= 1'b0;
+                if (rWrite && (rHADDR == 4'h1) && HWDATA[4]) limited <= 1'b0;
+                case (state)
+                    IDLE:
+                        if (waitCount != 4'd0) waitCount <= waitCount - 4'd1;
+                        else if (trigger)
+                            begin
+                                pending <= 1'b0;
+                                stamp <= usTime;
+                                sampleData <= 64'b0;    // temperature is 0 if not read
+                                select <= 1'b1;
+                                waitCount <= 4'd7;      // slave select setup time
+                                state <= SETUP;
+                            end
+                    SETUP:
+                        if (waitCount != 4'd0) waitCount <= waitCount - 4'd1;
+                        else
+                            begin
+                                byteIdx <= 4'd0;
+                                spiTx <= ADXL_READ_REG;
+                                spiGo <= 1'b1;
+                                state <= XFER;
+                            end
+                    XFER:
+                        if (spiDone)
+                            begin
+                                if (byteIdx >= 4'd2) sampleData[8*(byteIdx-4'd2) +: 8] <= spiRx;
+                                if (byteIdx == lastIdx)
+                                    begin
+                                        select <= 1'b0;
+                                        state <= FILTER;
+                                    end
+                                else
+                                    begin
+                                        byteIdx <= byteIdx + 4'd1;
+                                        spiTx <= (byteIdx == 4'd0) ? ADXL_XDATA_L : 8'h00;
+                                        spiGo <= 1'b1;
+                                    end
+                            end
+                    FILTER:                             // filters add the set in this cycle
+                        begin
+                            primed <= 1'b1;
+                            if (groupCount == ratio)
+                                begin
+                                    groupCount <= 8'd0;
+                                    state <= STORE;
+                                end
+                            else
+                                begin
+                                    groupCount <= groupCount + 8'd1;
+                                    waitCount <= 4'd15;     // hold-off before next trigger
+                                    state <= IDLE;
+                                end
+                        end
+                    STORE:
+                        if (bufFull)
+                            begin
+                                engRd <= 1'b1;          // discard oldest sample set
+                                overflow <= 1'b1;
+                                state <= MAKEROOM;
+                            end
+                        else
+                            begin
+                                engWr <= 1'b1;
+                                if (filterLimited != 3'b0) limited <= 1'b1;
+                                waitCount <= 4'd15;     // hold-off before next trigger
+                                state <= IDLE;
+                            end
+                    MAKEROOM:
+                        state <= STORE;
+                    default:
+                        state <= IDLE;
+                endcase
+                // a new filter setting, or stopping the engine, starts again
+                if (filterWrite | ~enable)
+                    begin
+                        groupCount <= 8'd0;
+                        primed <= 1'b0;
+                    end
+            end
+
+    wire busy = (state != IDLE);
+    assign spiOwn = enable | busy;      // finish a sequence even if disabled during it
+    assign spiSSn = ~select;
+
+// ========================= Filters ==================================================
+    // One per axis - the output is valid in STORE, after the last set of the group
+    wire [47:0] filtered;                       // {Z, Y, X}
+    wire filterAdd = (state == FILTER);
+    wire filterRestart = iir ? ~primed : (groupCount == 8'd0);
+
+    genvar axis;
+    generate
+        for (axis = 0; axis < 3; axis = axis + 1)
+            begin : axisFilter
+                smp_filter filt (
+                    .clk        (HCLK),
+                    .rst        (~HRESETn),
+                    .iir        (iir),
+                    .shift      (shift),
+                    .add        (filterAdd),
+                    .restart    (filterRestart),
+                    .din        (sampleData[16*axis +: 16]),
+                    .dout       (filtered[16*axis +: 16]),
+                    .limited    (filterLimited[axis])
+                    );
+            end
+    endgenerate
+
+// ========================= Buffer ===================================================
+    wire [95:0] bufOut;                         // {timestamp, temp, Z, Y, X}
+    wire [BUF_AWIDTH:0] bufCount;
+    wire bufEmpty;
+    wire cpuPop = rRead & (rHADDR == 4'hA);     // read of temperature and Z word
+
+    FIFO_BRAM #(.DWIDTH(96), .AWIDTH(BUF_AWIDTH))
+        buffer (
+        .clk(HCLK),
+        .resetn(HRESETn),
+        .rd(cpuPop | engRd),
+        .wr(engWr),
+        .w_data({stamp, sampleData[63:48], filtered}),
+        .empty(bufEmpty),
+        .full(bufFull),
+        .count(bufCount),
+        .r_data(bufOut)
+        );
+
+    wire [12:0] count13 = bufCount;             // count extended for comparing and reading
+    wire levelReached = (level != 13'b0) && (count13 >= level);
+    wire [4:0] status = {limited, overflow, levelReached, ~bufEmpty, busy};
+
+    // Interrupt signal - level reached, if enabled
+    assign smp_IRQ = control[3] & levelReached;
+    assign dataAvail = ~bufEmpty;
+
+// ========================= Bus output signals =======================================
+    reg [31:0] readData;
+    always @(control, status, period, level, count13, divider, usTime, filter, bufOut, rHADDR)
+        case (rHADDR)       // select on word address (stored from address phase)
+            4'h0:       readData = {28'b0, control};
+            4'h1:       readData = {27'b0, status};
+            4'h2:       readData = {8'b0, period};
+            4'h3:       readData = {19'b0, level};
+            4'h4:       readData = {19'b0, count13};
+            4'h5:       readData = {24'b0, divider};
+            4'h6:       readData = usTime;
+            4'h7:       readData = {19'b0, filter};
+            4'h8:       readData = bufOut[95:64];   // timestamp
+            4'h9:       readData = bufOut[31:0];    // Y and X
+            4'hA:       readData = bufOut[63:32];   // temperature and Z
+            default:    readData = 32'b0;
+        endcase
+
+    assign HRDATA = readData;
+    assign HREADYOUT = 1'b1;    // always ready - transaction never delayed
+
+// ========================= SPI shift engine =========================================
+    spi_master spi (
+        .clk        (HCLK),             // 50 MHz clock
+        .rst        (~HRESETn),         // synchronous reset
+        .divider    (divider),          // SCLK half period
+        .txdin      (spiTx),            // byte to send
+        .go         (spiGo),            // start byte
+        .ready      (spiReady),         // not used - sequencer waits for done
+        .rxdout     (spiRx),            // byte received
+        .done       (spiDone),          // byte finished
+        .sclk       (spiSCK),
+        .mosi       (spiMOSI),
+        .miso       (spiMISO)
+        );
+
+endmodule
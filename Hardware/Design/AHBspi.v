@@ -0,0 +1,152 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   AHBspi
+// Description:   Provides SPI master on AHB, for the ADXL362 accelerometer.
+//      Address 0 - data, 8 bits.  Write starts a transfer of the byte written
+//                  (ignored if a transfer is in progress).  Read gives the byte
+//                  received in the last transfer.  A read while a transfer is
+//                  in progress is delayed (HREADYOUT low) until it finishes.
+//      Address 4 - status, read only:  bit 0 = transfer in progress
+//                                      bit 1 = slave select active
+//                                      bit 2 = interrupt pin 1 from slave is high
+//                                      bit 3 = interrupt pin 2 from slave is high
+//      Address 8 - control:    bit 0 = select - 1 holds slave select active between bytes
+//                              bits 3:2 = interrupt enable bits, 1 enables corresponding
+//                              status bit to cause interrupt, 0 blocks the interrupt (default)
+//      Address C - clock divider, 8 bits: SCLK half period is (value + 1) clock
+//                  cycles.  Reset value 3 gives 6.25 MHz with 50 MHz clock.
+//      Slave select is also active automatically while a byte is transferred, so
+//      clearing the select bit during the last byte ends the transaction when
+//      that byte is finished.
+//      The interrupt is level-based, like AHBuart: it is cleared by removing the
+//      cause in the slave device, or by clearing the enable bit.
+//      All transfers 32 bits, with data bits right-justified, filled with 0 on left on read.
+//
+// Revision 0.01 - File Created
+// Revision 0.02 - Interrupt pins from the ADXL362 added
+//
+//////////////////////////////////////////////////////////////////////////////////
+module AHBspi(
+            // Bus signals
+            input wire HCLK,            // bus clock
+            input wire HRESETn,         // bus reset, active low
+            input wire HSEL,            // selects this slave
+            input wire HREADY,          // indicates previous transaction completing
+            input wire [31:0] HADDR,    // address
+            input wire [1:0] HTRANS,    // transaction type (only bit 1 used)
+            input wire HWRITE,          // write transaction
+//          input wire [2:0] HSIZE,     // transaction width ignored
+            input wire [31:0] HWDATA,   // write data
+            output wire [31:0] HRDATA,  // read data from slave
+            output wire HREADYOUT,      // ready output from slave
+            // SPI signals
+            output spiSCK,              // SPI clock, idles low
+            output spiMOSI,             // SPI data out
+            input spiMISO,              // SPI data in
+            output spiSSn,              // slave select, active low
+            input [1:0] slaveInt,       // interrupt pins from slave device, active high
+            output spi_IRQ              // interrupt request
+    );
+
+    localparam [7:0] DIV_RESET = 8'd3;  // 6.25 MHz SCLK with 50 MHz HCLK
+
+    // Registers to hold signals from address phase
+    reg [1:0] rHADDR;           // only need two bits of address
+    reg rWrite, rRead;          // write and read enable signals
+
+    // Internal signals
+    reg [7:0] readData;         // 8-bit data from read multiplexer
+    wire [7:0] rxData;          // byte received by shift engine
+    wire spiReady;              // shift engine is idle
+    wire spiGo = rWrite & (rHADDR == 2'h0);      // start transfer on write to address 0x0
+    wire dataRead = rRead & (rHADDR == 2'h0);    // read from address 0x0
+
+    // Capture bus signals in address phase
+    always @(posedge HCLK)
+        if(!HRESETn)
+            begin
+                rHADDR <= 2'b0;
+                rWrite <= 1'b0;
+                rRead  <= 1'b0;
+            end
+        else if(HREADY)
+            begin
+                rHADDR <= HADDR[3:2];                   // capture address bits for use in data phase
+                rWrite <= HSEL & HWRITE & HTRANS[1];    // slave selected for write transfer
+                rRead <= HSEL & ~HWRITE & HTRANS[1];    // slave selected for read transfer
+            end
+
+    // Synchronise the interrupt pins from the slave - double registers
+    reg [1:0] intA, intB;
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                intA <= 2'b0;
+                intB <= 2'b0;
+            end
+        else
+            begin
+                intA <= slaveInt;
+                intB <= intA;
+            end
+
+    // Control register and clock divider register
+    reg [3:0] control;          // interrupt enable bits and select bit (bit 1 not used)
+    reg [7:0] divider;          // SCLK half period, minus 1
+    always @(posedge HCLK)
+        if (!HRESETn)
+            begin
+                control <= 4'b0;
+                divider <= DIV_RESET;
+            end
+        else
+            begin
+                if (rWrite && (rHADDR == 2'h2)) control <= {HWDATA[3:2], 1'b0, HWDATA[0]};
+                if (rWrite && (rHADDR == 2'h3)) divider <= HWDATA[7:0];
+            end
+
+    // Slave select is active while selected, or while a byte is being transferred
+    wire select = control[0] | ~spiReady;
+    assign spiSSn = ~select;
+
+    // Status bits - the interrupt pin bits can cause interrupts if enabled
+    wire [3:0] status = {intB, select, ~spiReady};
+
+    // Interrupt signal - AND each interrupt pin bit with enable bit, then OR the results
+    assign spi_IRQ = |(status[3:2] & control[3:2]);
+
+    // Bus output signals
+    always @(rxData, status, control, divider, rHADDR)
+        case (rHADDR)       // select on word address (stored from address phase)
+            2'h0:       readData = rxData;              // last byte received
+            2'h1:       readData = {4'b0, status};      // status register
+            2'h2:       readData = {4'b0, control};     // read back of control register
+            2'h3:       readData = divider;             // read back of clock divider
+        endcase
+
+    assign HRDATA = {24'b0, readData};  // extend with 0 bits for bus read
+
+    // Wait on read of data while a transfer is in progress, so no polling is needed
+    assign HREADYOUT = ~(dataRead & ~spiReady);
+
+// ========================= SPI shift engine =========================================
+    spi_master spi (
+        .clk        (HCLK),             // 50 MHz clock
+        .rst        (~HRESETn),         // synchronous reset
+        .divider    (divider),          // SCLK half period
+        .txdin      (HWDATA[7:0]),      // byte to send comes straight from bus
+        .go         (spiGo),            // start on write to data register
+        .ready      (spiReady),
+        .rxdout     (rxData),           // byte received
+        .done       (),                 // not used
+        .sclk       (spiSCK),
+        .mosi       (spiMOSI),
+        .miso       (spiMISO)
+        );
+
+endmodule
@@ -7,24 +7,46 @@
 // Design Name: 	Cortex-M0 DesignStart system
 // Module Name:   AHBuart 
 // Description: 	Provides asynchronous serial transmitter and receiver on AHB.
-//					Transmit and receive paths have 16-byte FIFO buffers.
+//					Transmit and receive paths have FIFO buffers, 2**FIFO_AWIDTH bytes each
+//					(default 256, up to 4096 in block RAM).
 //		Address 0 - receive data, 8 bits, from FIFO, read only
 //		Address 4 - transmit data, 8-bits, to FIFO (read gives FIFO output)
 //		Address 8 - status, read only: 	bit 0 = tx FIFO full
 //										bit 1 = tx FIFO empty
 //										bit 2 = rx FIFO full
 //										bit 3 = rx FIFO not empty - data available
-//		Address C - control - four interrupt enable bits, 1 enables corresponding status
+//										bit 4 = rx FIFO has at least rx level bytes
+//										bit 5 = tx FIFO has less than tx level bytes
+//										bit 6 = rx idle timeout - rx FIFO not empty, and no
+//											byte received or read for timeout bit times
+//		Address C - control - seven interrupt enable bits, 1 enables corresponding status
 //					bit to cause interrupt, 0 blocks the interrupt (default).
+//		Address 10 - bit rate, 20 bits: accumulator increment for the uart timing block,
+//					increment = bit rate * 2**23 / clock frequency.  Must be written as a word.
+//					Reset value is set by parameter BAUD_RESET: 3221 gives 19200 bit/s
+//					at 50 MHz, testbenches can use a larger value to simulate faster.
+//		Address 14 - rx level, 13 bits, for status bit 4.  0 (default) disables it.
+//		Address 18 - tx level, 13 bits, for status bit 5.  0 (default) disables it.
+//		Address 1C - timeout, 8 bits, in bit times, for status bit 6.  0 (default) disables it.
+//					40 (4 characters) is a good choice.
+//		Address 20 - counts, read only: bits 15:0 = bytes in rx FIFO, bits 31:16 = bytes in tx FIFO
+//		With the level and timeout interrupts, one interrupt can handle a whole line or burst
+//		of data, instead of one interrupt per byte.  The new features are disabled after reset,
+//		so the block behaves as the 16-byte version, apart from the FIFO depth.
 //		This version provides simple level-based interrupt signal from the status bits.
 //		The only way to clear an interrupt request is to remove the problem or clear the enable bit.
 //		All transfers 32 bits, with data bits right-justified, filled with 0 on left on read.
 // Revision: 
 // Revision 0.01 - File Created
 // Revision 1 - modified for synchronous reset, October 2015
+// Revision 2 - bit rate register added, April 2023 (SoC Group 14)
+// Revision 3 - deeper FIFOs in block RAM, level and timeout interrupts, April 2023
+// Revision 4 - FIFO status outputs for DMA requests, April 2023
 //
 //////////////////////////////////////////////////////////////////////////////////
-module AHBuart(
+module AHBuart #(parameter [19:0] BAUD_RESET = 20'd3221,	// 19200 bit/s at 50 MHz
+				  parameter FIFO_AWIDTH = 8)				// FIFO address bits, 8 to 12 for block RAM
+		(
 			// Bus signals
 			input wire HCLK,				// bus clock
 			input wire HRESETn,			// bus reset, active low
@@ -40,60 +62,109 @@ module AHBuart(
 			// UART signals
 			input serialRx,				// serial receive, idles at 1
 			output serialTx,				// serial transmit, idles at 1
-			output uart_IRQ				// interrupt request
+			output uart_IRQ,				// interrupt request
+			output rxAvail,				// rx FIFO not empty - DMA request to read address 0
+			output txSpace				// tx FIFO not full - DMA request to write address 4
     );
 	
 	// Registers to hold signals from address phase
-	reg [1:0] rHADDR;			// only need two bits of address
+	reg [3:0] rHADDR;			// only need four bits of address
 	reg rWrite, rRead;	// write enable signals
 
 	// Internal signals
-	reg [7:0]	readData;		// 8-bit data from read multiplexer
+	reg [31:0]	readData;		// data from read multiplexer
 	wire [7:0] rx_fifo_out, rx_fifo_in, tx_fifo_out;  // fifo data
 	wire rx_fifo_empty, rx_fifo_full, tx_fifo_empty, tx_fifo_full;  // fifo output signals
-	wire tx_fifo_wr = rWrite & (rHADDR == 2'h1);  // tx fifo write on write to address 0x4
-	wire rx_fifo_rd = rRead & (rHADDR == 2'h0);  // rx fifo read on read to address 0x0
+	wire [FIFO_AWIDTH:0] rx_count, tx_count;	// number of bytes in each fifo
+	wire tx_fifo_wr = rWrite & (rHADDR == 4'h1);  // tx fifo write on write to address 0x4
+	wire rx_fifo_rd = rRead & (rHADDR == 4'h0);  // rx fifo read on read to address 0x0
 	wire txrdy;		// transmitter status signal
 	wire txgo = ~tx_fifo_empty;	// transmitter control signal
 	wire rxnew;		// receiver strobe output
+	wire bittick;	// pulse once per bit time from uart
 
  	// Capture bus signals in address phase
 	always @(posedge HCLK)
 		if(!HRESETn)
 			begin
-				rHADDR <= 2'b0;
+				rHADDR <= 4'b0;
 				rWrite <= 1'b0;
 				rRead  <= 1'b0;
 			end
 		else if(HREADY)
 		 begin
-			rHADDR <= HADDR[3:2];         // capture address bits for for use in data phase
+			rHADDR <= HADDR[5:2];         // capture address bits for for use in data phase
 			rWrite <= HSEL & HWRITE & HTRANS[1];	// slave selected for write transfer       
 			rRead <= HSEL & ~HWRITE & HTRANS[1];	// slave selected for read transfer 
 		 end
 
 	// Control register
-	reg [3:0] control;	// holds interrupt enable bits
+	reg [6:0] control;	// holds interrupt enable bits
 	always @(posedge HCLK)
-		if (!HRESETn) control <= 4'b0;
-		else if (rWrite && (rHADDR == 2'h3)) control <= HWDATA[3:0];
+		if (!HRESETn) control <= 7'b0;
+		else if (rWrite && (rHADDR == 4'h3)) control <= HWDATA[6:0];
+
+	// Bit rate register
+	reg [19:0] baudIncr;	// accumulator increment for uart timing block
+	always @(posedge HCLK)
+		if (!HRESETn) baudIncr <= BAUD_RESET;
+		else if (rWrite && (rHADDR == 4'h4)) baudIncr <= HWDATA[19:0];
+
+	// Level and timeout registers
+	reg [12:0] rxLevel, txLevel;	// fifo levels for interrupts
+	reg [7:0] timeout;				// rx idle time in bit times
+	always @(posedge HCLK)
+		if (!HRESETn)
+			begin
+				rxLevel <= 13'b0;
+				txLevel <= 13'b0;
+				timeout <= 8'b0;
+			end
+		else
+			begin
+				if (rWrite && (rHADDR == 4'h5)) rxLevel <= HWDATA[12:0];
+				if (rWrite && (rHADDR == 4'h6)) txLevel <= HWDATA[12:0];
+				if (rWrite && (rHADDR == 4'h7)) timeout <= HWDATA[7:0];
+			end
+
+	// Idle counter - counts bit times since a byte was received or read, stops at timeout
+	reg [7:0] idleCount;
+	always @(posedge HCLK)
+		if (!HRESETn) idleCount <= 8'b0;
+		else if (rxnew | rx_fifo_rd) idleCount <= 8'b0;	// activity - start again
+		else if (bittick && (idleCount != timeout)) idleCount <= idleCount + 8'b1;
+
+	wire [15:0] rxCount16 = rx_count;	// counts extended to 16 bits for reading
+	wire [15:0] txCount16 = tx_count;
+	wire rx_level = (rxLevel != 13'b0) && (rx_count >= rxLevel);
+	wire tx_low = (tx_count < txLevel);		// never true if tx level is 0
+	wire rx_idle = (timeout != 8'b0) && (idleCount == timeout) && ~rx_fifo_empty;
 		
 	// Status bits - can read in status register, can cause interrupts if enabled
-	wire [3:0] status = {~rx_fifo_empty, rx_fifo_full, tx_fifo_empty, tx_fifo_full};
+	wire [6:0] status = {rx_idle, tx_low, rx_level, ~rx_fifo_empty, rx_fifo_full, tx_fifo_empty, tx_fifo_full};
 	
 	// Interrupt signal - AND each status bit with enable bit, then OR all the results
 	assign uart_IRQ = |(status & control);
+	assign rxAvail = ~rx_fifo_empty;
+	assign txSpace = ~tx_fifo_full;
 		
 	// Bus output signals
-	always @(rx_fifo_out, tx_fifo_out, status, control, rHADDR)
+	always @(rx_fifo_out, tx_fifo_out, status, control, baudIncr, rxLevel, txLevel, timeout,
+				rxCount16, txCount16, rHADDR)
 		case (rHADDR)		// select on word address (stored from address phase)
-			2'h0:		readData = rx_fifo_out;	// read from rx fifo - oldest received byte
-			2'h1:		readData = tx_fifo_out;	// read of tx register gives oldest byte in queue
-			2'h2:		readData = {4'b0, status};	// status register	    
-			2'h3:		readData = {4'b0, control};	// read back of control register
+			4'h0:		readData = {24'b0, rx_fifo_out};	// read from rx fifo - oldest received byte
+			4'h1:		readData = {24'b0, tx_fifo_out};	// read of tx register gives oldest byte in queue
+			4'h2:		readData = {25'b0, status};		// status register	    
+			4'h3:		readData = {25'b0, control};	// read back of control register
+			4'h4:		readData = {12'b0, baudIncr};	// read back of bit rate register
+			4'h5:		readData = {19'b0, rxLevel};	// read back of level and timeout registers
+			4'h6:		readData = {19'b0, txLevel};
+			4'h7:		readData = {24'b0, timeout};
+			4'h8:		readData = {txCount16, rxCount16};	// fifo counts
+			default:	readData = 32'b0;			// unused addresses
 		endcase
 		
-	assign HRDATA = {24'b0, readData};	// extend with 0 bits for bus read
+	assign HRDATA = readData;
 
 // Options on ready signal - can wait on write when full, or read when empty 
 	assign HREADYOUT = 1'b1;	// always ready - transaction never delayed
@@ -101,7 +172,7 @@ module AHBuart(
 	
 // ========================= FIFOs ===================================================
 	  //Transmitter FIFO
-	  FIFO  #(.DWIDTH(8), .AWIDTH(4))
+	  FIFO_BRAM  #(.DWIDTH(8), .AWIDTH(FIFO_AWIDTH))
 		uFIFO_TX (
 	    .clk(HCLK),
 	    .resetn(HRESETn),
@@ -110,11 +181,12 @@ module AHBuart(
 	    .w_data(HWDATA[7:0]),
 	    .empty(tx_fifo_empty),
 	    .full(tx_fifo_full),
+	    .count(tx_count),
 	    .r_data(tx_fifo_out)
 	  );
 	  
 	  //Receiver FIFO
-	  FIFO  #(.DWIDTH(8), .AWIDTH(4))
+	  FIFO_BRAM  #(.DWIDTH(8), .AWIDTH(FIFO_AWIDTH))
 		uFIFO_RX (
 	    .clk(HCLK),
 	    .resetn(HRESETn),
@@ -123,21 +195,24 @@ module AHBuart(
 	    .w_data(rx_fifo_in),
 	    .empty(rx_fifo_empty),
 	    .full(rx_fifo_full),
+	    .count(rx_count),
 	    .r_data(rx_fifo_out)
 	  );
 
 // ========================= UART ===================================================
-// Simple self-contained UART, fixed 19200 bit/s, 8 data, no parity, 1 stop bit
+// Simple self-contained UART, bit rate from register, 8 data, no parity, 1 stop bit
    uart uart2 (
         .clk        (HCLK),          // 50 MHz clock
         .rst        (~HRESETn),       // asynchronous reset
+        .incr       (baudIncr),      // sets bit rate
 		.txdin		(tx_fifo_out),
 		.txgo		(txgo),
 		.txrdy		(txrdy),
 		.txd		(serialTx),
         .rxd        (serialRx),      // serial data in (idle at logic 1)
         .rxdout     (rx_fifo_in),        // 8-bit received data
-        .rxnew      (rxnew)       // one-cycle strobe signal
+        .rxnew      (rxnew),      // one-cycle strobe signal
+        .bittick    (bittick)     // one pulse per bit time
 	   );
    
 endmodule
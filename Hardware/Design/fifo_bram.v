@@ -0,0 +1,90 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   FIFO_BRAM
+// Description:   FIFO with the same interface as FIFO in fifo.v, plus a count of
+//          the entries in use, for deeper buffers.  The data array is not reset
+//          and is read synchronously, so it can be implemented in block RAM
+//          (AWIDTH 8 to 12, 256 to 4096 entries) or distributed RAM.
+//          The output is first-word-fall-through, like FIFO: r_data shows the
+//          oldest entry whenever empty is low, and rd moves on to the next one.
+//          The RAM is read at the address the read pointer will have after the
+//          clock edge, and a write to that address on the same edge is passed
+//          straight to the output, so r_data is valid one clock after any change.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module FIFO_BRAM #(parameter DWIDTH=8, AWIDTH=8)
+(
+  input wire clk,
+  input wire resetn,                // active-low reset
+  input wire rd,                    // read means that entry is being taken from fifo output
+  input wire wr,                    // write means that entry should be written to fifo input
+  input wire [DWIDTH-1:0] w_data,   // fifo data in
+
+  output wire empty,                // no entries in queue - output data is rubbish
+  output wire full,                 // no space in queue - write requests will be ignored
+  output wire [AWIDTH:0] count,     // number of entries in queue, 0 to 2**AWIDTH
+  output wire [DWIDTH-1:0] r_data   // fifo data out
+);
+
+  reg [DWIDTH-1:0] mem [2**AWIDTH-1:0];   // data array - not reset, so RAM can be used
+  reg [AWIDTH-1:0] w_ptr;                 // where next data should be stored
+  reg [AWIDTH-1:0] r_ptr;                 // oldest data in queue = next to be read
+  reg [AWIDTH:0]   count_reg;             // entries in use
+
+  wire w_en = wr & ~full;                 // write if not full
+  wire r_en = rd & ~empty;                // read if not empty
+  wire [AWIDTH-1:0] r_ptr_next = r_ptr + r_en;  // read pointer after this clock edge
+
+// Pointers and count
+  always @ (posedge clk)
+    if (!resetn)
+      begin
+        w_ptr <= 0;
+        r_ptr <= 0;
+        count_reg <= 0;
+      end
+    else
+      begin
+        if (w_en) w_ptr <= w_ptr + 1'b1;       // pointers wrap at end of array
+        r_ptr <= r_ptr_next;
+        case ({w_en, r_en})
+          2'b10:   count_reg <= count_reg + 1'b1;
+          2'b01:   count_reg <= count_reg - 1'b1;
+          default: ;                           // no change, or read and write together
+        endcase
+      end
+
+// Data array - synchronous write and read, read-first
+  reg [DWIDTH-1:0] ram_out;               // data read from array
+  always @ (posedge clk)
+    begin
+      if (w_en) mem[w_ptr] <= w_data;
+      ram_out <= mem[r_ptr_next];
+    end
+
+// Bypass - if the entry to be shown is being written now, the array gives old data
+  reg bypass;
+  reg [DWIDTH-1:0] w_data_reg;
+  always @ (posedge clk)
+    if (!resetn) bypass <= 1'b0;
+    else
+      begin
+        bypass <= w_en & (w_ptr == r_ptr_next);
+        w_data_reg <= w_data;
+      end
+
+  assign r_data = bypass ? w_data_reg : ram_out;
+
+// Status outputs
+  assign count = count_reg;
+  assign empty = (count_reg == 0);
+  assign full  = count_reg[AWIDTH];       // count is 2**AWIDTH
+
+endmodule
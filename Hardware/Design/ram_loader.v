@@ -2,21 +2,34 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Company: UCD School of Electrical and Electronic Engineering
 // Engineer: Brian Mulkeen
-// 
-// Create Date:   21:37:44 10/14/2014 
+//
+// Create Date:   21:37:44 10/14/2014
 // Design Name: 	Cortex-M0 DesignStart system
-// Module Name:   ram_loader 
+// Module Name:   ram_loader
 // Description: 	State machine to enter ROMload mode if button pressed after reset.
 //			When active, takes bytes from uart, converts from ASCII hex to binary,
 //			outputs 32-bit words and control signal to write words to block ram.
 //			Returns to normal if Q received, or on normal reset.
+//			If the first byte is BIN_START, takes a binary stream instead (see below),
+//			and returns to normal when the whole image has arrived with a good CRC.
+//
+// Binary stream, all multi-byte values LSB first:
+//			BIN_START (8'hB5), then 2 bytes - image length in words (1 to 2**(ADDR_WIDTH-2))
+//			then records until the image is complete:
+//				control byte 0nnnnnnn - n+1 data words follow (4 bytes each)
+//				control byte 1nnnnnnn - n+1 words of zero, no data follows
+//			then 4 bytes - CRC-32 (as zlib, Ethernet) of the image, taken as bytes
+//			in little-endian order, so the same as the CRC of the .bin file.
+//			A zero run is written at one word per clock cycle, so the stream never
+//			has to wait for the loader.  Tools/rom_pack.cpp makes the stream.
 //
-// Revision: 
+// Revision:
 // Revision 0.01 - File Created
 // Revision 1 - modified for synchronous reset, October 2015
+// Revision 2 - binary load mode with run-length compression and CRC, April 2023
 //
 //////////////////////////////////////////////////////////////////////////////////
-module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNow, ROMload);
+module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNow, ROMload, flags);
 		parameter ADDR_WIDTH	= 15;		// 32kByte = 8k words of 32 bits
 		input  HCLK;				// bus clock
 		input  resetHW;			// hardware reset
@@ -27,52 +40,87 @@ module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNo
 		output [31:0] wData;			// data to memory
 		output wNow;					// write control signal
 		output reg ROMload;			// loader active
-	
+		output [2:0] flags;			// {error, CRC error, binary mode} for display
+
 
 // =============== Loader Hardware =========================================
 // If button is pressed on first clock edge after reset, enter active state.
 // If not, go to idle state and stay there forever.
 // In active state, act on bytes received: if hex char, store nibble in array,
 // after 8 nibbles, if end of line, write word to PROM, if Q, go to idle state.
+// If BIN_START arrives before anything else, follow the binary stream instead.
 // If anything unexpected arrives, go to error state and stay there forever.
 
+    localparam [7:0] BIN_START = 8'hB5;		// first byte of a binary stream
+    localparam MAX_WORDS = 1 << (ADDR_WIDTH-2);	// memory size in words
+
     // State machine to control everything
-	localparam [1:0] INIT = 2'd0, IDLE = 2'd1, ACTIVE = 2'd2, ERROR = 2'd3;
-	reg [1:0] loadState, loadNext;	// state register
+	localparam [3:0] INIT = 4'd0, IDLE = 4'd1, ACTIVE = 4'd2, ERROR = 4'd3,
+	                 BLEN = 4'd4,		// binary - receiving length
+	                 BCTRL = 4'd5,		// binary - waiting for control byte
+	                 BDATA = 4'd6,		// binary - receiving data words
+	                 BZERO = 4'd7,		// binary - writing zero words
+	                 BCRC = 4'd8;		// binary - receiving CRC
+	reg [3:0] loadState, loadNext;	// state register
 	reg storeNibble, storeWord;		// FSM output signals (also ROMload)
+	reg startBin, takeByte, clearCount, loadLength, loadRun, writeBin, crcFail;	// binary mode signals
 
     // Signals for decoder
 	localparam [1:0] ENDL = 2'd0, HEX = 2'd1, QUIT = 2'd2, OTHER = 2'd3;
 	reg [1:0] byteType, nextType;	// decoder output - type of byte received
 	reg [3:0] nibbleIn, nextIn;		// decoded nibble
+	reg [7:0] byteIn;				// received byte, for binary mode
 	reg newDecode;					// new decoded output
 
-    // Storage for the received nibbles, with counter	
+    // Storage for the received nibbles, with counter
 	reg [3:0] nibbleReg [0:7];			// array of 8 nibble registers
 	reg [3:0] nibbleCount;				// nibble count (0 to 8 as received)
 	wire fullWord = (nibbleCount == 4'd8);	// 8 nibbles received
 	wire partWord = (nibbleCount > 4'd0);	// some nibbles received
-	
+	reg [ADDR_WIDTH-3:0] wordCount;	// word count
+
+	// Storage for binary mode
+	reg binMode;					// binary stream selected
+	reg crcError, errorFlag;		// results for display
+	reg [31:0] binWord;				// received bytes, shifted in from the left
+	reg [1:0] byteCount;			// bytes received in this field
+	reg [ADDR_WIDTH-2:0] wordsLeft;	// words still to be written
+	reg [6:0] runCount;				// words left in this record, less 1
+	reg [31:0] crc;					// CRC of words written so far
+	wire [31:0] wordIn = {byteIn, binWord[31:8]};	// word complete with this byte
+	wire [15:0] lengthIn = {byteIn, binWord[31:24]};	// length complete with this byte
+	wire lastWord = (wordsLeft == 1);	// this write completes the image
+
 	// Nibbles combined to word, first on left, for writing to memory
-	wire [31:0] wData = {nibbleReg[0], nibbleReg[1], nibbleReg[2], nibbleReg[3], 
+	wire [31:0] hexWord = {nibbleReg[0], nibbleReg[1], nibbleReg[2], nibbleReg[3],
 	                       nibbleReg[4], nibbleReg[5], nibbleReg[6], nibbleReg[7]};
-	reg [ADDR_WIDTH-3:0] wordCount;	// word count
+	wire [31:0] binData = (loadState == BZERO) ? 32'b0 : wordIn;
+	assign wData = binMode ? binData : hexWord;
 	assign wAddr = wordCount;     // memory address is same as word count
-	assign wNow = storeWord;		// write enable comes from state machine
-	
+	assign wNow = storeWord | writeBin;		// write enable comes from state machine
+	assign flags = {errorFlag, crcError, binMode};
+
 //====================================== State Machine =====================================
 	// State register
 	always @ (posedge HCLK)
 		if (resetHW) loadState <= INIT;
 		else loadState <= loadNext;
-		
+
 	// Next state and output logic - Mealy machine
-	always @ (loadState, loadButton, newDecode, byteType, fullWord, partWord)
+	always @ (*)
 		begin
 			loadNext = loadState;  // default is no state change
 			storeNibble = 1'b0;	// default values of output signals
 			storeWord = 1'b0;
-			
+			startBin = 1'b0;
+			takeByte = 1'b0;
+			clearCount = 1'b0;
+			loadLength = 1'b0;
+			loadRun = 1'b0;
+			writeBin = 1'b0;
+			crcFail = 1'b0;
+			ROMload = 1'b1;		// active in most states
+
 			case (loadState)
 				INIT:		begin	// move to active or idle, depending on button
 								if (loadButton) loadNext = ACTIVE;
@@ -80,10 +128,13 @@ module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNo
 								ROMload = 1'b0;	// not active
 							end
 				IDLE:		ROMload = 1'b0;	// not active, no state change...
-				ACTIVE:	begin
-								ROMload = 1'b1;	// indicate active
-								if (newDecode)	// if a byte has been received
-									case (byteType)
+				ACTIVE:	if (newDecode)	// if a byte has been received
+								if ((byteIn == BIN_START) && !partWord && (wordCount == 0))
+									begin		// binary stream, before any hex
+										startBin = 1'b1;
+										loadNext = BLEN;
+									end
+								else case (byteType)
 										HEX: 	if (fullWord) loadNext = ERROR; // ninth nibble
 												else storeNibble = 1'b1;  // store nibble
 										ENDL: if (fullWord) storeWord = 1'b1;  // store word
@@ -92,13 +143,59 @@ module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNo
 												else loadNext = IDLE; // quit at nibble count 0
 										default:	loadNext = ERROR;	// unexpected byte
 									endcase
+				BLEN:		if (newDecode)	// length, 2 bytes
+								begin
+									takeByte = 1'b1;
+									if (byteCount == 2'd1)
+										begin
+											clearCount = 1'b1;
+											if ((lengthIn == 0) || (lengthIn > MAX_WORDS)) loadNext = ERROR;
+											else
+												begin
+													loadLength = 1'b1;
+													loadNext = BCTRL;
+												end
+										end
+								end
+				BCTRL:	if (newDecode)	// control byte - run length and type
+								if ({1'b0, byteIn[6:0]} >= wordsLeft) loadNext = ERROR;	// run too long
+								else
+									begin
+										loadRun = 1'b1;
+										loadNext = byteIn[7] ? BZERO : BDATA;
+									end
+				BDATA:	if (newDecode)	// data word, 4 bytes
+								begin
+									takeByte = 1'b1;
+									if (byteCount == 2'd3)
+										begin
+											writeBin = 1'b1;
+											if (lastWord) loadNext = BCRC;
+											else if (runCount == 0) loadNext = BCTRL;
+										end
+								end
+				BZERO:	begin			// one zero word per clock cycle
+								writeBin = 1'b1;
+								if (lastWord) loadNext = BCRC;
+								else if (runCount == 0) loadNext = BCTRL;
 							end
-				ERROR:	ROMload = 1'b1;	// indicate active, but no state change
+				BCRC:		if (newDecode)	// CRC, 4 bytes
+								begin
+									takeByte = 1'b1;
+									if (byteCount == 2'd3)
+										if (wordIn == ~crc) loadNext = IDLE;	// good load, run the program
+										else
+											begin
+												crcFail = 1'b1;
+												loadNext = ERROR;
+											end
+								end
+				ERROR:	;	// indicate active, but no state change
 				default:	ROMload = 1'b0;	// not active, no state change...
 			endcase
 		end
 
-//================================ Nibble storage, Nibbles and Word counters =================================		
+//================================ Nibble storage, Nibbles and Word counters =================================
 	// Nibble registers
     integer i;
     always @ (posedge HCLK)
@@ -110,24 +207,84 @@ module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNo
 		if (resetHW) nibbleCount <= 4'd0;
 		else if (storeNibble) nibbleCount <= nibbleCount + 1'd1;
 		else if (storeWord) nibbleCount <= 4'd0;
-		
-	// Word counter - advance on storeWord signal - wraps if too many words!!
+
+	// Word counter - advance on storeWord or writeBin - wraps if too many hex words!!
 	always @ (posedge HCLK)
 		if (resetHW) wordCount <= {ADDR_WIDTH{1'b0}};
-		else if (storeWord) wordCount <= wordCount + 1'd1;
+		else if (wNow) wordCount <= wordCount + 1'd1;
+
+//================================ Binary mode storage and counters =================================
+	// Result flags
+	always @ (posedge HCLK)
+		if (resetHW)
+			begin
+				binMode <= 1'b0;
+				crcError <= 1'b0;
+				errorFlag <= 1'b0;
+			end
+		else
+			begin
+				if (startBin) binMode <= 1'b1;
+				if (crcFail) crcError <= 1'b1;
+				if (loadNext == ERROR) errorFlag <= 1'b1;
+			end
+
+	// Byte shift register and byte counter
+	always @ (posedge HCLK)
+		if (resetHW)
+			begin
+				binWord <= 32'b0;
+				byteCount <= 2'd0;
+			end
+		else if (takeByte)
+			begin
+				binWord <= wordIn;
+				byteCount <= clearCount ? 2'd0 : byteCount + 1'd1;
+			end
+
+	// Words left in the image, and in the current record
+	always @ (posedge HCLK)
+		if (resetHW)
+			begin
+				wordsLeft <= {(ADDR_WIDTH-1){1'b0}};
+				runCount <= 7'd0;
+			end
+		else if (loadLength) wordsLeft <= lengthIn[ADDR_WIDTH-2:0];
+		else if (loadRun) runCount <= byteIn[6:0];
+		else if (writeBin)
+			begin
+				wordsLeft <= wordsLeft - 1'd1;
+				runCount <= runCount - 1'd1;
+			end
+
+	// CRC-32, reflected, polynomial 04C11DB7 - one word per clock, LSB first
+	function [31:0] crcWord(input [31:0] c, input [31:0] d);
+		integer b;
+		begin
+			crcWord = c;
+			for (b = 0; b < 32; b = b + 1)
+				crcWord = (crcWord[0] ^ d[b]) ? (crcWord >> 1) ^ 32'hEDB88320 : crcWord >> 1;
+		end
+	endfunction
+
+	always @ (posedge HCLK)
+		if (resetHW | startBin) crc <= 32'hFFFFFFFF;
+		else if (writeBin) crc <= crcWord(crc, binData);
 
 //========================== Byte decoding =================================================
-// Decoder converts received bytes into data nibbles, detects end of line, etc.	
+// Decoder converts received bytes into data nibbles, detects end of line, etc.
 	// All outputs registered, so delayed one clock cycle - plenty of time for comb. logic
 	always @ (posedge HCLK)
 		if (resetHW) begin
 							nibbleIn <= 4'b0;
 							byteType	<= ENDL;
+							byteIn <= 8'b0;
 							newDecode <= 1'b0;
 						 end
 		else 	begin
 							nibbleIn <= nextIn;
 							byteType <= nextType;
+							byteIn <= rxByte;
 							newDecode <= newByte;
 				end
 
@@ -136,7 +293,7 @@ module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNo
 		begin
 			nextType = OTHER;			// default value
 			nextIn = rxByte[3:0];	// take lower 4 bits of received byte
-		
+
 			case (rxByte[7:4])	// test upper half of byte
 				4'h0:		// control group - check for LF or CR
 						if (nextIn == 4'hA || nextIn == 4'hD) nextType = ENDL;
@@ -152,5 +309,5 @@ module ram_loader( HCLK, resetHW, loadButton, rxByte, newByte, wAddr, wData, wNo
 				default: nextType = OTHER;		// not really needed
 			endcase
 		end
- 
+
 endmodule
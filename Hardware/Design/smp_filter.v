@@ -0,0 +1,52 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   smp_filter
+// Description:   Filter for one axis of the accelerometer sampling engine.
+//          Average mode: adds up the samples of a group (a first-order CIC
+//          decimator), and the output is the sum shifted right by shift, so it is
+//          the mean when the group has 2**shift samples.
+//          IIR mode: first-order low-pass, state = state + (sample - state) / 2**shift,
+//          with 16 fraction bits, and the output is the state rounded.
+//          Either way the output is limited to the 16-bit range.
+//          restart with add loads the sample, starting a new group or IIR run.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module smp_filter(
+    input clk,                  // main clock, drives all logic
+    input rst,                  // synchronous reset, active high
+    input iir,                  // 1 - IIR low-pass, 0 - sum for the average
+    input [3:0] shift,          // output scaling (average) or filter coefficient (IIR)
+    input add,                  // new sample, for one clock cycle
+    input restart,              // the new sample starts a group, or the IIR state
+    input signed [15:0] din,    // sample
+    output [15:0] dout,         // filtered, signed
+    output limited              // dout is limited to the 16-bit range
+    );
+
+    localparam FRAC = 16;       // IIR fraction bits
+
+    // Sum of up to 256 samples (24 bits), or IIR state with 16 fraction bits
+    reg signed [31:0] acc;
+    wire signed [31:0] sample = iir ? ($signed(din) <<< FRAC) : $signed(din);
+    wire signed [32:0] diff = sample - acc;     // IIR: distance from the state to the sample
+
+    always @(posedge clk)
+        if (rst) acc <= 32'sd0;
+        else if (add)
+            if (restart) acc <= sample;
+            else if (iir) acc <= acc + (diff >>> shift);
+            else acc <= acc + sample;
+
+    // Scale, round the IIR state, and limit
+    wire signed [32:0] scaled = iir ? ((acc + 33'sd32768) >>> FRAC) : (acc >>> shift);
+    assign limited = (scaled > 33'sd32767) | (scaled < -33'sd32768);
+    assign dout = (scaled > 33'sd32767) ? 16'h7FFF : (scaled < -33'sd32768) ? 16'h8000 : scaled[15:0];
+
+endmodule
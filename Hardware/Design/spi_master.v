@@ -0,0 +1,90 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+// 
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   spi_master
+// Description:   Simple SPI master shift engine, mode 0 (CPOL = 0, CPHA = 0).
+//          Transfers 8 bits MSB first on each go signal, if ready.
+//          MISO is sampled just before each rising edge of SCLK, MOSI changes
+//          after each falling edge.  The SCLK half period is (divider + 1)
+//          clock cycles, so with a 50 MHz clock, divider = 3 gives 6.25 MHz.
+//          A trailing half period with SCLK low is added after the last bit,
+//          to give the slave select hold time required by the ADXL362.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module spi_master(
+    input clk,                  // main clock, drives all logic
+    input rst,                  // synchronous reset, active high
+    input [7:0] divider,        // SCLK half period in clock cycles, minus 1
+    input [7:0] txdin,          // 8-bit data to be transmitted
+    input go,                   // start a transfer, ignored if not ready
+    output ready,               // ready for new data - no transfer in progress
+    output reg [7:0] rxdout,    // 8-bit data received in last transfer
+    output reg done,            // transfer finished, asserted for 1 clock
+    output sclk,                // SPI clock, idles low
+    output mosi,                // SPI data out, MSB first
+    input miso                  // SPI data in
+    );
+
+    reg busy;                   // transfer in progress
+    reg [7:0] divCount;         // counts clock cycles in each half period
+    reg [4:0] phase;            // half period counter: 0 to 15 are data, 16 is trailing
+    reg [7:0] shiftreg;         // shifts out on MOSI, shifts in from MISO
+    reg misoSample;             // MISO value captured at rising edge of SCLK
+
+    wire halfEnd = busy & (divCount == 8'd0);  // last clock cycle of a half period
+
+// Control logic - count half periods, sample and shift at the SCLK edges
+    always @ (posedge clk)
+        if (rst)
+            begin
+                busy <= 1'b0;
+                divCount <= 8'd0;
+                phase <= 5'd0;
+                shiftreg <= 8'b0;
+                misoSample <= 1'b0;
+            end
+        else if (go & ready)                    // start a new transfer
+            begin
+                busy <= 1'b1;
+                divCount <= divider;
+                phase <= 5'd0;
+                shiftreg <= txdin;              // MSB appears on MOSI immediately
+            end
+        else if (busy)
+            begin
+                if (!halfEnd) divCount <= divCount - 8'd1;   // count down within half period
+                else
+                    begin
+                        divCount <= divider;                 // reload for next half period
+                        phase <= phase + 5'd1;
+                        if (phase == 5'd16) busy <= 1'b0;    // trailing half period finished
+                        else if (!phase[0]) misoSample <= miso;  // SCLK about to rise - sample
+                        else shiftreg <= {shiftreg[6:0], misoSample};  // SCLK about to fall - shift
+                    end
+            end
+
+// Output register and strobe - loaded when the transfer finishes
+    always @ (posedge clk)
+        if (rst)
+            begin
+                rxdout <= 8'b0;
+                done <= 1'b0;
+            end
+        else
+            begin
+                done <= halfEnd & (phase == 5'd16);
+                if (halfEnd & (phase == 5'd16)) rxdout <= shiftreg;
+            end
+
+// Output signals
+    assign ready = ~busy;
+    assign sclk = busy & phase[0] & ~phase[4];  // high in odd half periods 1 to 15
+    assign mosi = shiftreg[7];
+
+endmodule
@@ -8,35 +8,41 @@
 // Target Devices: Spartan3, Kintex7
 // Description: 	 Simple self-contained UART block for clock >> bit rate.
 //			Transmit & receive 8 bit, no parity, 1 stop bit.
-//			Bit rate is set using INCR parameter in timing block.
+//			Bit rate is set by the incr input to the timing block.
 //
 // Revision 0 - File Created
 // Revision 1, 20 October 2014 - modified to sample rxd on bit8x,
 //					added FF for bit8x for timing, tidied state names and comments
 // Revision 2 - modified for synchronous reset, October 2015
+// Revision 3, April 2023 - accumulator increment is an input, so the bit rate
+//					can be changed at run time, bit time output added (SoC Group 14)
 //////////////////////////////////////////////////////////////////////////////////
 module uart(
     input clk,						// main clock, drives all logic
     input rst,						// asynchronous reset
+    input [19:0] incr,				// accumulator increment, sets the bit rate - see below
     input [7:0] txdin,			// 8-bit data to be transmitted
     input txgo,					// indicates new data to send, ignored if not ready
     output reg txd,				// serial data out (idle at logic 1, high)
     output txrdy,					// transmitter ready for new data
     input rxd,						// serial data in (idle at logic 1, high)
     output reg [7:0] rxdout,	// 8-bit received data
-    output rxnew					// indicates new data available, asserted for 1 clock
+    output rxnew,					// indicates new data available, asserted for 1 clock
+    output bittick				// pulse once per bit time, for timeouts
     );
 
 // Timing block:  Receiver needs pulses at 8 X bitrate, transmitter at bitrate.
 // Uses frequency synthesis technique with 20-bit accumulator.
 // bit8x frequency is clock frequency * increment / 2**20
 // so with 50 MHz clock, increment of 6442 gives bit8x at 307178.5 Hz = 8 X 38397.3 Hz
-	//localparam INCR = 20'd6442;	// increment value for 38400 bit/s at 50 MHz
-	localparam INCR = 20'd3221;	// increment value for 19200 bit/s at 50 MHz
-	//localparam INCR = 20'd206144;  // 32 times faster for simulation
+// Some increment values at 50 MHz:
+//		3221 for 19200 bit/s		6442 for 38400 bit/s		19327 for 115200 bit/s
+//		154619 for 921600 bit/s		206144 for 32 times 19200 (fast simulation)
+// In general, increment = bit rate * 2**23 / clock frequency, maximum bit rate is
+// clock frequency / 8.  The increment can change at any time.
 	
 	reg [20:0] accum;		// 20-bit accumulator register with extra bit for carry
-	wire [20:0] accsum = accum[19:0] + INCR;	// ignore previous carry on add
+	wire [20:0] accsum = accum[19:0] + incr;	// ignore previous carry on add
 	
 	always @(posedge clk)	// accumulator behaviour
 		if (rst) accum <= 21'b0;		// clear on reset
@@ -50,6 +56,7 @@ module uart(
 		else if (bit8x) div8 <= div8 + 3'b1;		// increment on clock
 
 	wire bit1x = bit8x & (div8 == 3'b111);	// bit clock pulse for transmit block
+	assign bittick = bit1x;
 
 // =====================================================================================	
 // Transmit block:  Takes 8-bit data input and transmits start bit (0), data bits
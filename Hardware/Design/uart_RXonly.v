@@ -8,7 +8,8 @@
 // Target Devices: Spartan3, Kintex7, Artix7
 // Description: 	 Simple self-contained UART block for clock >> bit rate.
 //			Transmit & receive 8 bit, no parity, 1 stop bit.
-//			Bit rate is set using INCR parameter in timing block.
+//			Bit rate is set using INCR parameter in timing block - default 19200 bit/s,
+//			testbenches can override it to simulate faster.
 //
 // Revision 1   20 October 2014 - modified to sample rxd on bit8x,
 //					added FF for bit8x for timing, tidied state names and comments
@@ -16,7 +17,8 @@
 // Revision 3 	October 2015 - modified for synchronous reset
 //
 //////////////////////////////////////////////////////////////////////////////////
-module uart_RXonly(
+module uart_RXonly #(parameter [19:0] INCR = 20'd3221)	// 19200 bit/s with 50 MHz clock
+	(
     input clk,						// main clock, drives all logic
     input rst,						// asynchronous reset
     input rxd,						// serial data in (idle at logic 1, high)
@@ -28,9 +30,7 @@ module uart_RXonly(
 // Uses frequency synthesis technique with 20-bit accumulator.
 // bit8x frequency is clock frequency * increment / 2**20
 // so with 50 MHz clock, increment of 6442 gives bit8x at 307178.5 Hz = 8 X 38397.3 Hz
-	//localparam INCR = 20'd6442;	// increment value for 38400 bit/s with 50 MHz clock
-	localparam INCR = 20'd3221;	// increment value for 19200 bit/s with 50 MHz clock
-	//localparam INCR = 20'd206144;  // 32 times faster for simulation
+// INCR = 6442 for 38400 bit/s, 206144 is 32 times faster than 19200 for simulation
 	
 	reg [20:0] accum;		// 20-bit accumulator register with extra bit for carry
 	wire [20:0] accsum = accum[19:0] + INCR;	// ignore previous carry on add
@@ -0,0 +1,371 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   ADXL362_model
+// Description:   Behavioural model of the ADXL362 accelerometer, for simulation only.
+//          SPI slave, mode 0, with the commands used by the firmware:
+//              0x0A write register(s), 0x0B read register(s) - address auto-increments
+//              0x0D read FIFO - 2 bytes per entry, low byte first
+//          Register map as in the data sheet: device ID, data registers (8-bit and
+//          16-bit), STATUS, FIFO_ENTRIES, FIFO_CONTROL, FIFO_SAMPLES, INTMAP1/2,
+//          FILTER_CTL, POWER_CTL, SOFT_RESET.  Activity detection is not modelled.
+//          In measurement mode, a new sample set is taken at the output data rate
+//          from FILTER_CTL, divided by TIME_SCALE to make simulation practical.
+//          Sample sets come from the stimulus file STIM_FILE, one per line, as four
+//          signed decimal numbers: X Y Z temperature, in LSB (1 mg per LSB at +/- 2 g).
+//          The file is repeated when the end is reached.  Without a file, the samples
+//          are a simple ramp.
+//          DATA_READY is cleared when any data register is read.  The FIFO holds
+//          512 entries, in oldest-saved or stream mode, with watermark and overrun.
+//          Statistics for measuring the SoC: bytes transferred, sample sets made and
+//          read, and the latency from a new sample set to the first read of its data.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module ADXL362_model #(
+    parameter STIM_FILE = "adxl362_stim.txt",
+    parameter TIME_SCALE = 1,           // sample rate multiplier for fast simulation
+    parameter MISO_DELAY = 10           // ns from SCLK falling edge to MISO change
+    ) (
+    input SCLK,
+    input MOSI,
+    output reg MISO,
+    input CSn,                          // slave select, active low
+    output INT1,
+    output INT2
+    );
+
+    localparam MAX_SETS = 4096;         // size of stimulus store
+    localparam FIFO_SIZE = 512;         // 16-bit FIFO entries
+
+    // Register addresses
+    localparam [7:0] DEVID_AD = 8'h00, DEVID_MST = 8'h01, PARTID = 8'h02, REVID = 8'h03,
+                     XDATA = 8'h08, YDATA = 8'h09, ZDATA = 8'h0A, STATUS = 8'h0B,
+                     FIFO_ENTRIES_L = 8'h0C, FIFO_ENTRIES_H = 8'h0D,
+                     XDATA_L = 8'h0E, TEMP_H = 8'h15, SOFT_RESET = 8'h1F,
+                     FIFO_CONTROL = 8'h28, FIFO_SAMPLES = 8'h29, INTMAP1 = 8'h2A,
+                     INTMAP2 = 8'h2B, FILTER_CTL = 8'h2C, POWER_CTL = 8'h2D, LAST_REG = 8'h2E;
+
+// ========================= Registers and samples ====================================
+    reg [7:0] regs [0:63];              // writable registers
+    reg signed [15:0] x, y, z, t;       // current sample set
+    reg dataReady, overrun;
+    reg [15:0] fifo [0:FIFO_SIZE-1];
+    integer fifoCount, fifoRd, fifoWr;
+    integer i;
+
+    task resetRegs;
+        begin
+            for (i = 0; i < 64; i = i + 1) regs[i] = 8'h00;
+            regs[FIFO_SAMPLES] = 8'h80;     // reset values from data sheet
+            regs[FILTER_CTL] = 8'h13;
+            x = 0; y = 0; z = 0; t = 0;
+            dataReady = 1'b0;
+            overrun = 1'b0;
+            fifoCount = 0;
+            fifoRd = 0;
+            fifoWr = 0;
+        end
+    endtask
+
+    // Stimulus store
+    reg signed [15:0] stimX [0:MAX_SETS-1];
+    reg signed [15:0] stimY [0:MAX_SETS-1];
+    reg signed [15:0] stimZ [0:MAX_SETS-1];
+    reg signed [15:0] stimT [0:MAX_SETS-1];
+    integer stimSets, stimNext, fd, n, sx, sy, sz, st;
+
+    initial
+        begin
+            stimSets = 0;
+            stimNext = 0;
+            fd = $fopen(STIM_FILE, "r");
+            if (fd == 0) $display("ADXL362_model: no stimulus file %s, using ramp", STIM_FILE);
+            else
+                begin
+                    while (!$feof(fd) && stimSets < MAX_SETS)
+                        begin
+                            n = $fscanf(fd, "%d %d %d %d\n", sx, sy, sz, st);
+                            if (n == 4)
+                                begin
+                                    stimX[stimSets] = sx;
+                                    stimY[stimSets] = sy;
+                                    stimZ[stimSets] = sz;
+                                    stimT[stimSets] = st;
+                                    stimSets = stimSets + 1;
+                                end
+                            else n = $fgetc(fd);    // skip a bad character
+                        end
+                    $fclose(fd);
+                    $display("ADXL362_model: %0d sample sets from %s", stimSets, STIM_FILE);
+                end
+        end
+
+// ========================= FIFO =====================================================
+    wire [1:0] fifoMode = regs[FIFO_CONTROL][1:0];      // 0 off, 1 oldest saved, 2 stream, 3 triggered
+    wire [8:0] watermark = {regs[FIFO_CONTROL][3], regs[FIFO_SAMPLES]};
+
+    // 14-bit value with axis tag in the top 2 bits
+    function [15:0] fifoEntry (input [1:0] axis, input [15:0] value);
+        fifoEntry = {axis, value[13:0]};
+    endfunction
+
+    task fifoPush (input [15:0] entry);
+        reg lost;
+        begin
+            lost = 1'b0;
+            if (fifoCount == FIFO_SIZE)
+                begin
+                    overrun = 1'b1;
+                    if (fifoMode == 2'd1) lost = 1'b1;          // oldest saved - new data lost
+                    else                                        // stream - oldest data lost
+                        begin
+                            fifoRd = (fifoRd + 1) % FIFO_SIZE;
+                            fifoCount = fifoCount - 1;
+                        end
+                end
+            if (!lost)
+                begin
+                    fifo[fifoWr] = entry;
+                    fifoWr = (fifoWr + 1) % FIFO_SIZE;
+                    fifoCount = fifoCount + 1;
+                end
+        end
+    endtask
+
+    function [15:0] fifoHead (input dummy);
+        fifoHead = (fifoCount > 0) ? fifo[fifoRd] : 16'h0000;
+    endfunction
+
+    task fifoPop;
+        if (fifoCount > 0)
+            begin
+                fifoRd = (fifoRd + 1) % FIFO_SIZE;
+                fifoCount = fifoCount - 1;
+            end
+    endtask
+
+// ========================= Sampling =================================================
+    integer setsMade = 0, setsRead = 0;         // statistics
+    real lastSampleTime = 0.0, latencyTotal = 0.0, latencyMax = 0.0;
+    reg waitingRead = 1'b0;                     // latest sample set not read yet
+
+    wire measuring = (regs[POWER_CTL][1:0] == 2'b10);
+
+    // Time between sample sets in ns: 12.5 Hz doubled for each ODR step, up to 400 Hz
+    function real odrPeriod (input [2:0] odr);
+        odrPeriod = (80.0e6 / (1 << ((odr > 3'd5) ? 5 : odr))) / TIME_SCALE;
+    endfunction
+
+    initial
+        begin
+            resetRegs;
+            forever
+                begin
+                    #(odrPeriod(regs[FILTER_CTL][2:0]));
+                    if (measuring) newSample;
+                end
+        end
+
+    task newSample;
+        begin
+            if (stimSets > 0)
+                begin
+                    x = stimX[stimNext];
+                    y = stimY[stimNext];
+                    z = stimZ[stimNext];
+                    t = stimT[stimNext];
+                    stimNext = (stimNext + 1) % stimSets;
+                end
+            else
+                begin
+                    x = (setsMade % 2000) - 1000;   // ramp
+                    y = 0;
+                    z = 1000;
+                    t = 350;
+                end
+            dataReady = 1'b1;
+            setsMade = setsMade + 1;
+            lastSampleTime = $realtime;
+            waitingRead = 1'b1;
+            if (fifoMode != 2'd0)
+                begin
+                    fifoPush(fifoEntry(2'b00, x));
+                    fifoPush(fifoEntry(2'b01, y));
+                    fifoPush(fifoEntry(2'b10, z));
+                    if (regs[FIFO_CONTROL][2]) fifoPush(fifoEntry(2'b11, t));
+                end
+        end
+    endtask
+
+// ========================= Register read and write ==================================
+    wire [7:0] status = {4'b0, overrun, (fifoCount >= watermark) && (watermark != 0),
+                         (fifoCount > 0), dataReady};
+
+    function [7:0] readReg (input [7:0] addr);
+        case (addr)
+            DEVID_AD:       readReg = 8'hAD;
+            DEVID_MST:      readReg = 8'h1D;
+            PARTID:         readReg = 8'hF2;
+            REVID:          readReg = 8'h01;
+            XDATA:          readReg = x[11:4];      // 8 MSBs of 12-bit value
+            YDATA:          readReg = y[11:4];
+            ZDATA:          readReg = z[11:4];
+            STATUS:         readReg = status;
+            FIFO_ENTRIES_L: readReg = fifoCount[7:0];
+            FIFO_ENTRIES_H: readReg = {6'b0, fifoCount[9:8]};
+            8'h0E:          readReg = x[7:0];
+            8'h0F:          readReg = x[15:8];
+            8'h10:          readReg = y[7:0];
+            8'h11:          readReg = y[15:8];
+            8'h12:          readReg = z[7:0];
+            8'h13:          readReg = z[15:8];
+            8'h14:          readReg = t[7:0];
+            8'h15:          readReg = t[15:8];
+            default:        readReg = (addr <= LAST_REG) ? regs[addr[5:0]] : 8'h00;
+        endcase
+    endfunction
+
+    // Side effects of reading: data ready cleared, overrun cleared by reading status
+    task readEffects (input [7:0] addr);
+        begin
+            if ((addr >= XDATA && addr <= ZDATA) || (addr >= XDATA_L && addr <= TEMP_H))
+                begin
+                    dataReady = 1'b0;
+                    if (waitingRead)
+                        begin
+                            waitingRead = 1'b0;
+                            setsRead = setsRead + 1;
+                            latencyTotal = latencyTotal + ($realtime - lastSampleTime);
+                            if ($realtime - lastSampleTime > latencyMax) latencyMax = $realtime - lastSampleTime;
+                        end
+                end
+            if (addr == STATUS) overrun = 1'b0;
+        end
+    endtask
+
+    task writeReg (input [7:0] addr, input [7:0] data);
+        if (addr == SOFT_RESET)
+            begin
+                if (data == 8'h52) resetRegs;
+            end
+        else if (addr >= 8'h20 && addr <= LAST_REG)   // read-only registers below 0x20
+            regs[addr[5:0]] = data;
+    endtask
+
+// ========================= SPI slave ================================================
+    localparam [7:0] CMD_WRITE = 8'h0A, CMD_READ = 8'h0B, CMD_FIFO = 8'h0D;
+
+    reg [7:0] rxShift, txShift, command, address;
+    integer bitCount, byteCount;
+    reg fifoHigh;                               // next FIFO byte is the high byte
+    reg [15:0] fifoWord;
+    integer bytesTotal = 0, transactions = 0;
+
+    always @ (negedge CSn)                      // start of transaction
+        begin
+            bitCount = 0;
+            byteCount = 0;
+            txShift = 8'h00;
+            MISO <= #MISO_DELAY 1'b0;
+            transactions = transactions + 1;
+        end
+
+    initial MISO = 1'bz;                        // not driven until selected
+    always @ (posedge CSn) MISO <= #MISO_DELAY 1'bz;
+
+    always @ (posedge SCLK)                     // sample MOSI
+        if (!CSn)
+            begin
+                rxShift = {rxShift[6:0], MOSI};
+                bitCount = bitCount + 1;
+                if (bitCount == 8)
+                    begin
+                        bitCount = 0;
+                        bytesTotal = bytesTotal + 1;
+                        byteDone(rxShift);
+                        byteCount = byteCount + 1;
+                        MISO <= #MISO_DELAY txShift[7];    // first bit of next byte
+                    end
+            end
+
+    always @ (negedge SCLK)                     // shift out MISO, not after a byte boundary
+        if (!CSn && bitCount != 0)
+            begin
+                txShift = {txShift[6:0], 1'b0};
+                MISO <= #MISO_DELAY txShift[7];
+            end
+
+    // Handle a complete byte from the master, and get the next byte to send
+    task byteDone (input [7:0] rx);
+        begin
+            txShift = 8'h00;
+            if (byteCount == 0)
+                begin
+                    command = rx;
+                    fifoHigh = 1'b0;
+                    if (command == CMD_FIFO) nextFifoByte;
+                end
+            else if (command == CMD_FIFO) nextFifoByte;
+            else if (byteCount == 1)
+                begin
+                    address = rx;
+                    if (command == CMD_READ) nextReadByte;
+                end
+            else if (command == CMD_WRITE)
+                begin
+                    writeReg(address, rx);
+                    address = address + 8'd1;
+                end
+            else if (command == CMD_READ) nextReadByte;
+        end
+    endtask
+
+    // Next register byte to send, in txShift
+    task nextReadByte;
+        begin
+            txShift = readReg(address);
+            readEffects(address);
+            address = address + 8'd1;
+        end
+    endtask
+
+    // Next FIFO byte to send, in txShift - entry removed when its high byte is loaded
+    task nextFifoByte;
+        begin
+            if (!fifoHigh)
+                begin
+                    fifoWord = fifoHead(1'b0);
+                    txShift = fifoWord[7:0];
+                end
+            else
+                begin
+                    txShift = fifoWord[15:8];
+                    fifoPop;
+                end
+            fifoHigh = ~fifoHigh;
+        end
+    endtask
+
+// ========================= Interrupt pins ===========================================
+    // INTMAP bits 3:0 select status bits, bit 7 makes the pin active low
+    assign INT1 = (|(status[3:0] & regs[INTMAP1][3:0])) ^ regs[INTMAP1][7];
+    assign INT2 = (|(status[3:0] & regs[INTMAP2][3:0])) ^ regs[INTMAP2][7];
+
+// ========================= Statistics ===============================================
+    task report;
+        begin
+            $display("ADXL362_model: %0d transactions, %0d bytes, %0d sample sets made, %0d read",
+                     transactions, bytesTotal, setsMade, setsRead);
+            if (setsRead > 0)
+                $display("ADXL362_model: latency from sample to read: mean %0.0f ns, max %0.0f ns",
+                         latencyTotal / setsRead, latencyMax);
+        end
+    endtask
+
+endmodule
@@ -23,7 +23,7 @@ module TB_AHBdisp (    );
 // Define constants for bus signals and control register addresses
     localparam [2:0] BYTE = 3'b000, HALF = 3'b001, WORD = 3'b010;   // HSIZE values
     localparam [1:0] IDLE = 2'b00, NONSEQ = 2'b10;    // HTRANS values
-    localparam [3:0] MODREG = 4'd8, ENBREG = 4'd9;  // address offset
+    localparam [3:0] MODREG = 4'd8, ENBREG = 4'd9, CTLREG = 4'hA, NUMREG = 4'hC;  // address offset
     localparam [31:0] BASEADDR = 32'h5300_0000;     // base address
 
 // Instantiate the display interface block to be tested    
@@ -36,6 +36,7 @@ module TB_AHBdisp (    );
         .HADDR      (HADDR),
         .HTRANS     (HTRANS),
         .HWRITE     (HWRITE),  
+        .HSIZE      (HSIZE),
         .HWDATA     (HWDATA),  
         .HRDATA     (HRDATA),  
         .HREADYOUT  (HREADYOUT),
@@ -74,9 +75,104 @@ module TB_AHBdisp (    );
             AHBread (WORD, BASEADDR+4, 32'h3649af13);  // read back data as word
             AHBidle;    // put bus in idle state
             #2000;      // delay to see effect of all that
+
+            // Decimal number register - digit data, then modes and enables
+            checkNumber(32'd1234, 32'h01020304, 32'h1f1f1f1f, 8'h0f);
+            checkSegment(3'd0, 8'hcc);                  // 4
+            checkSegment(3'd3, 8'hcf);                  // 1
+            checkSegment(3'd4, 8'hff);                  // blank
+            checkNumber(-32'sd56, 32'h1f110506, 32'h1f1f1f1f, 8'h07);
+            checkSegment(3'd2, 8'hfe);                  // minus sign
+            checkNumber(32'd0, 32'h1f1f1f00, 32'h1f1f1f1f, 8'h01);
+            checkSegment(3'd0, 8'h81);                  // 0
+            checkSegment(3'd1, 8'hff);                  // blank
+            checkNumber(32'd70, 32'h1f1f0700, 32'h1f1f1f1f, 8'h03);       // zero inside number shown
+            checkNumber(-32'sd9999999, 32'h09090909, 32'h11090909, 8'hff);
+            checkNumber(32'd99999999, 32'h09090909, 32'h09090909, 8'hff);
+            checkNumber(32'd12345678, 32'h05060708, 32'h01020304, 8'hff);
+            checkNumber(32'd100000000, 32'h11111111, 32'h11111111, 8'hff);    // too big - dashes
+            checkNumber(-32'sd10000000, 32'h11111111, 32'h11111111, 8'hff);
+            checkNumber(32'h80000000, 32'h11111111, 32'h11111111, 8'hff);
+            checkNumber(-32'sd1, 32'h1f1f1101, 32'h1f1f1f1f, 8'h03);
+            checkSegment(3'd7, 8'hff);                  // blank
+
+            // Byte writes still work after a conversion
+            AHBwrite(BYTE, BASEADDR+3, 8'h0e);
+            AHBread (WORD, BASEADDR, 32'h0e1f1101);
+            AHBidle;
+
+            // Word and halfword writes update all the byte lanes
+            AHBwrite(WORD, BASEADDR, 32'h04030201);
+            AHBwrite(HALF, BASEADDR+6, 16'h0807);
+            AHBwrite(HALF, BASEADDR+4, 16'h0605);
+            AHBwrite(WORD, BASEADDR+MODREG, 32'h0000ffff);    // all hex, all enabled
+            AHBread (WORD, BASEADDR, 32'h04030201);
+            AHBread (WORD, BASEADDR+4, 32'h08070605);
+            AHBread (HALF, BASEADDR+MODREG, 16'hffff);
+            AHBidle;
+            checkSegment(3'd0, 8'hcf);                  // 1
+            checkSegment(3'd7, 8'h80);                  // 8
+
+            // Buffered mode - display does not change until commit
+            AHBwrite(BYTE, BASEADDR+CTLREG, 8'h01);
+            AHBwrite(WORD, BASEADDR, 32'h0c0c0c0c);
+            AHBwrite(WORD, BASEADDR+4, 32'h0c0c0c0c);
+            AHBread (WORD, BASEADDR+4, 32'h0c0c0c0c);     // shadow bank reads back
+            AHBread (BYTE, BASEADDR+CTLREG, 8'h01);
+            AHBidle;
+            checkSegment(3'd0, 8'hcf);                  // still 1
+            checkSegment(3'd7, 8'h80);                  // still 8
+            AHBwrite(WORD, BASEADDR+MODREG, 32'h0003ffff);    // modes and enables, with commit
+            AHBread (WORD, BASEADDR+MODREG, 32'h0001ffff);    // commit bit reads 0
+            AHBidle;
+            checkSegment(3'd0, 8'hb1);                  // C
+            checkSegment(3'd7, 8'hb1);
+            AHBwrite(BYTE, BASEADDR+ENBREG, 8'h01);     // only digit 0 enabled, not shown yet
+            AHBidle;
+            checkSegment(3'd1, 8'hb1);
+            AHBwrite(BYTE, BASEADDR+CTLREG, 8'h00);     // leaving buffered mode commits
+            AHBidle;
+            checkSegment(3'd1, 8'hff);                  // blank
+            checkSegment(3'd0, 8'hb1);
+
+            $display("TB_AHBdisp finished, %d errors", errCount);
             $stop;            
         end
 
+// Write a number to the decimal register, wait for the conversion, then check
+// the digit registers, the mode and enable registers, and read back the number
+    task checkNumber (
+            input [31:0] value,         // number to write
+            input [31:0] digits3to0,    // expected digit registers
+            input [31:0] digits7to4,
+            input [7:0] enables );      // expected enable register
+        begin
+            AHBwrite(WORD, BASEADDR+NUMREG, value);
+            AHBidle;
+            #800;                       // 40 clock cycles for conversion
+            AHBread (WORD, BASEADDR, digits3to0);
+            AHBread (WORD, BASEADDR+4, digits7to4);
+            AHBread (WORD, BASEADDR+MODREG, {16'b0, enables, 8'hff});
+            AHBread (WORD, BASEADDR+NUMREG, value);
+            AHBidle;
+        end
+    endtask
+
+// Wait until a digit is being displayed, then check its segment pattern
+    task checkSegment (
+            input [2:0] n,              // digit number, 0 is rightmost
+            input [7:0] pattern );      // expected segment signals, active low
+        begin
+            wait (digit == ~(8'b1 << n));
+            @ (negedge HCLK);
+            if (segment != pattern)
+                begin
+                    $display("%t digit %d: segments %h, expected %h", $time, n, segment, pattern);
+                    errCount = errCount + 1;
+                end
+        end
+    endtask
+
 
 // =========== AHB bus tasks - crude models of bus activity =========================
 // To use these tasks, include everything below this line, until the next ===== line
@@ -20,6 +20,7 @@ module TB_AHBgpio(    );
 // GPIO input and output signals
 	reg [15:0] gpio_in0 = 16'h2345, gpio_in1 = 16'habcd;	// input ports with initial values
 	wire [15:0] gpio_out0, gpio_out1;	// output ports
+	wire irq;							// input event interrupt
 
    
 // Define names for some of the bus signal values
@@ -30,6 +31,12 @@ module TB_AHBgpio(    );
 // Then the byte addresses - only two bytes exist in each register
 	localparam [31:0] OUT0L = 32'h5000_0000, OUT0H = 32'h5000_0001, OUT1L = 32'h5000_0004, OUT1H = 32'h5000_0005;
 	localparam [31:0] IN0L = 32'h5000_0008,  IN0H = 32'h5000_0009,  IN1L = 32'h5000_000c,  IN1H = 32'h5000_000d;
+// Then the set, clear and toggle aliases of the output registers
+	localparam [31:0] SET0 = 32'h5000_0010, SET1 = 32'h5000_0014, CLR0 = 32'h5000_0018, CLR1 = 32'h5000_001c;
+	localparam [31:0] TGL0 = 32'h5000_0020, TGL1 = 32'h5000_0024;
+// Then the edge detection registers
+	localparam [31:0] RISE = 32'h5000_0028, FALL = 32'h5000_002c, EVTS = 32'h5000_0030;
+	localparam [31:0] DBNC = 32'h5000_0034, STBL = 32'h5000_0038;
 
 // Instantiate the design under test and connect it to the testbench signals
 	AHBgpio dut(
@@ -47,7 +54,8 @@ module TB_AHBgpio(    );
 		.gpio_out0    (gpio_out0),
 		.gpio_out1    (gpio_out1),
 		.gpio_in0     (gpio_in0),
-		.gpio_in1     (gpio_in1)
+		.gpio_in1     (gpio_in1),
+		.irq          (irq)
 		);
 
 // Generate the clock signal at 50 MHz - period 20 ns
@@ -93,10 +101,75 @@ module TB_AHBgpio(    );
 			AHBread (HALF, IN1,  16'hdcba);      // check in1 - half word
 			AHBread (BYTE, IN1H,  8'hdc);        // check in1 - byte
 			AHBidle;
+			repeat(5)
+				@ (posedge HCLK);		// wait 5 clock cycles
+			AHBwrite(WORD, SET0, 32'h00000f00);  // set, clear and toggle bits of out0
+			AHBwrite(WORD, CLR0, 32'h0000004d);  // 9f4d -> 9f00
+			AHBwrite(HALF, TGL0, 16'hffff);      // 9f00 -> 60ff
+			AHBread (WORD, OUT0, 32'h000060ff);
+			// back-to-back updates of different bits, as from main code and an interrupt
+			// handler - each must see the result of the one before, so none is lost
+			AHBwrite(WORD, TGL1, 32'h000000ff);  // 56ee -> 5611
+			AHBwrite(BYTE, SET1+1, 8'h80);       // high byte only -> d611
+			AHBwrite(WORD, CLR1, 32'h00000001);  // d611 -> d610
+			AHBwrite(WORD, TGL1, 32'h00008000);  // d610 -> 5610
+			AHBread (HALF, OUT1, 16'h5610);
+			AHBread (WORD, TGL1, 32'h00005610);  // an alias reads as the output port
+			AHBread (WORD, OUT0, 32'h000060ff);  // out0 not changed by the out1 aliases
+			AHBidle;
+			// edge detection - inputs are sampled every 256 clock cycles with debounce 0
+			AHBwrite(WORD, DBNC, 32'h0);
+			AHBwrite(WORD, RISE, 32'h00040004);  // rising edges of in0 bit 2 and in1 bit 2
+			AHBwrite(WORD, FALL, 32'h00000001);  // falling edge of in0 bit 0
+			AHBwrite(WORD, EVTS, 32'hffffffff);  // clear any events
+			AHBidle;
+			repeat(600)
+				@ (posedge HCLK);		// wait for two samples
+			AHBread (WORD, STBL, 32'hdcba4321);  // debounced inputs
+			AHBread (WORD, EVTS, 32'h0);
+			AHBidle;
+			gpio_in0 = 16'h4324;		// bit 0 falls, bit 2 rises
+			repeat(600)
+				@ (posedge HCLK);
+			checkIrq(1'b1);
+			AHBread (WORD, EVTS, 32'h00000005);
+			AHBwrite(WORD, EVTS, 32'h00000001);  // clear one event
+			AHBread (WORD, EVTS, 32'h00000004);
+			AHBwrite(WORD, EVTS, 32'h00000004);
+			AHBread (WORD, EVTS, 32'h0);
+			AHBidle;
+			checkIrq(1'b0);
+			gpio_in1 = 16'hdcbe;		// a glitch shorter than the sample period is ignored
+			repeat(100)
+				@ (posedge HCLK);
+			gpio_in1 = 16'hdcba;
+			repeat(600)
+				@ (posedge HCLK);
+			AHBread (WORD, EVTS, 32'h0);
+			AHBidle;
+			gpio_in1 = 16'hdcbe;		// a steady change is an event
+			repeat(600)
+				@ (posedge HCLK);
+			checkIrq(1'b1);
+			AHBread (WORD, EVTS, 32'h00040000);
+			AHBread (WORD, STBL, 32'hdcbe4324);
+			AHBidle;
 			#50;			// wait a while to allow the last transaction to complete
 			$stop;			// stop the simulation
 		end
 
+// Check the interrupt output
+	task checkIrq (input expected);
+		begin
+			@ (negedge HCLK);
+			if (irq !== expected)
+				begin
+					$display("%t irq %b, expected %b", $time, irq, expected);
+					errCount = errCount + 1;
+				end
+		end
+	endtask
+
 // =========== AHB bus tasks - crude models of bus activity =========================
 // To use these tasks, include everything below this line, until the next ===== line
 // Read and Write tasks do not restore the bus to idle, as another transaction might follow.
@@ -24,15 +24,22 @@ module TB_AHBuart(    );
 // Integer is used in for loops
 	integer i = 0;
 
+// Variables for checking the bit time
+	real tStart, tBit, tExpect;
+
 // Define names for some of the bus signal values and for device register addresses
 	localparam [2:0] BYTE = 3'b000, HALF = 3'b001, WORD = 3'b010;	// HSIZE values
 	localparam [1:0] IDLE = 2'b00, NONSEQ = 2'b10;					// HTRANS values
 	localparam [31:0] RXDATA = 32'h5100_0000, TXDATA = 32'h5100_0004, 
-	                   STATUS = 32'h5100_0008, CONTRL = 32'h5100_000c;	// registers
+	                   STATUS = 32'h5100_0008, CONTRL = 32'h5100_000c,
+	                   BAUD = 32'h5100_0010, RXLVL = 32'h5100_0014,
+	                   TXLVL = 32'h5100_0018, TIMEOUT = 32'h5100_001c,
+	                   COUNT = 32'h5100_0020;										// registers
+	localparam [19:0] SIM_INCR = 20'd206144;	// 32 times faster than 19200 bit/s, for simulation
 
 // Instantiate the design under test and connect it to the testbench signals
 // Some bus signals are not used - this design ignores HSIZE, for example
-	AHBuart dut(
+	AHBuart #(.BAUD_RESET(SIM_INCR), .FIFO_AWIDTH(4)) dut(		// 16-byte FIFOs, to test full
 		.HCLK(HCLK),
 		.HRESETn(HRESETn),
 		.HSEL(HSELx),
@@ -106,9 +113,103 @@ module TB_AHBuart(    );
 			AHBread (BYTE, RXDATA, 8'd23);	// read received data - expect sixth byte
 			AHBidle;	
 			#5000;							// delay to allow actions to complete
+
+			// Reset to empty the FIFOs, then check transmit timing and loopback at several bit rates
+			#20 HRESETn = 1'b0;
+			#20 HRESETn = 1'b1;
+			AHBread (WORD, BAUD, SIM_INCR);	// reset value of bit rate register, set by parameter
+			AHBwrite(BYTE, CONTRL, 8'h8);	// enable rx data available interrupt only
+			checkRate(20'd1611, 8'h35);		// 9600 bit/s
+			checkRate(20'd3221, 8'ha5);		// 19200 bit/s
+			checkRate(20'd19327, 8'h0f);	// 115200 bit/s
+			checkRate(20'd154619, 8'hc3);	// 921600 bit/s
+			checkRate(SIM_INCR, 8'h99);		// back to simulation rate
+
+			// Rx level interrupt - one interrupt for three bytes
+			AHBwrite(WORD, RXLVL, 3);
+			AHBwrite(BYTE, CONTRL, 8'h10);	// enable rx level interrupt only
+			AHBwrite(BYTE, TXDATA, 8'h41);
+			AHBwrite(BYTE, TXDATA, 8'h42);
+			AHBwrite(BYTE, TXDATA, 8'h43);
+			AHBidle;
+			#(tExpect * 25);				// two bytes received - no interrupt yet
+			if (uart_IRQ) begin $display("Rx level interrupt too early"); errCount = errCount + 1; end
+			wait (uart_IRQ == 1'b1);		// third byte received
+			AHBread (BYTE, STATUS, 8'h1a);	// rx level, rx not empty, tx empty
+			AHBread (WORD, COUNT, 32'h3);	// tx FIFO empty, 3 bytes in rx FIFO
+			AHBread (BYTE, RXDATA, 8'h41);
+			AHBread (BYTE, RXDATA, 8'h42);
+			AHBread (BYTE, RXDATA, 8'h43);
+			AHBread (BYTE, STATUS, 8'h02);	// all read - level interrupt cleared
+			AHBidle;
+			if (uart_IRQ) begin $display("Rx level interrupt not cleared"); errCount = errCount + 1; end
+
+			// Rx idle timeout - interrupt when one byte has waited for 20 bit times
+			AHBwrite(WORD, RXLVL, 0);
+			AHBwrite(WORD, TIMEOUT, 20);
+			AHBwrite(BYTE, CONTRL, 8'h40);	// enable rx idle interrupt only
+			AHBwrite(BYTE, TXDATA, 8'h55);
+			AHBidle;
+			tStart = $realtime;
+			wait (uart_IRQ == 1'b1);
+			tBit = $realtime - tStart;		// expect about 9.6 + 20 bit times
+			if ((tBit < tExpect * 29) || (tBit > tExpect * 31))
+				begin
+					$display("Rx timeout after %f ns, expected %f ns", tBit, tExpect * 29.6);
+					errCount = errCount + 1;
+				end
+			AHBread (BYTE, STATUS, 8'h4a);	// rx idle, rx not empty, tx empty
+			AHBread (BYTE, RXDATA, 8'h55);
+			AHBread (BYTE, STATUS, 8'h02);	// rx empty - timeout cleared
+			AHBidle;
+
+			// Tx level interrupt - refill when fewer than 4 bytes are waiting
+			AHBwrite(WORD, TIMEOUT, 0);
+			AHBwrite(WORD, TXLVL, 4);
+			AHBwrite(BYTE, CONTRL, 8'h20);	// enable tx level interrupt only
+			AHBread (BYTE, STATUS, 8'h22);	// tx FIFO empty, so below level
+			for (i=0; i<8; i=i+1)
+				AHBwrite(BYTE, TXDATA, 8'h61 + i);
+			AHBidle;
+			#100;
+			if (uart_IRQ) begin $display("Tx level interrupt not cleared"); errCount = errCount + 1; end
+			wait (uart_IRQ == 1'b1);		// 4 bytes sent
+			AHBread (HALF, COUNT + 2, 3);	// 3 bytes left in tx FIFO
+			AHBidle;
+			#1000;
+			$display("TB_AHBuart finished, %d errors", errCount);
 			$stop;							// stop the simulation
 		end
 
+// Task to set the bit rate, send one byte in loopback and check it.
+// The width of the start bit is measured, so the LSB of the data must be 1.
+// With a 50 MHz clock, the bit time is 8 * 2**20 * 20 ns / incr, and the
+// accumulator gives a jitter of one clock cycle.
+	task checkRate (
+			input [19:0] incr,	// accumulator increment
+			input [7:0] data );	// byte to send, LSB must be 1
+		begin
+			AHBwrite(WORD, BAUD, incr);		// set bit rate
+			AHBread (WORD, BAUD, incr);		// read back
+			AHBwrite(BYTE, TXDATA, data);	// send byte
+			AHBidle;
+			tExpect = 8.0 * 1048576.0 * 20.0 / incr;
+			@ (negedge serialTx) tStart = $realtime;	// start of start bit
+			@ (posedge serialTx) tBit = $realtime - tStart;	// start of LSB
+			if ((tBit < tExpect - 40.0) || (tBit > tExpect + 40.0))
+				begin
+					$display("Bit time error at incr %d: %f ns, expected %f ns", incr, tBit, tExpect);
+					errCount = errCount + 1;
+				end
+			wait (uart_IRQ == 1'b1);		// byte received with valid stop bit
+			AHBread (BYTE, RXDATA, data);	// received byte should match
+			AHBread (BYTE, STATUS, 8'h2);	// rx FIFO now empty, tx FIFO empty
+			AHBidle;
+			wait (serialTx == 1'b1);
+			#(tExpect * 2);					// let the stop bit finish before changing rate
+		end
+	endtask
+
 
 // =========== AHB bus tasks - crude models of bus activity =========================
 // To use these tasks, include everything below this line, until the next ===== line
@@ -2,25 +2,53 @@
 /////////////////////////////////////////////////////////////////
 // Module Name: TB_toplevel
 // Simple testbench for SoC - no program load, just clock and reset
+// ADXL362 model on the accelerometer pins, with samples from
+// adxl362_stim.txt (copy to the simulation directory, otherwise
+// the model makes a ramp).  At the end, reports SPI transactions,
+// bytes, bit rate while slave select is active, and the latency
+// from a new sample to the processor reading it.
 /////////////////////////////////////////////////////////////////
 module TB_toplevel(    );
      
+    parameter RUN_TIME = 5000000;   // simulation time in ns
+    parameter TIME_SCALE = 100;     // accelerometer sample rate multiplier
+
     reg btnCpuResetn, clk100, btnU; 
     reg [15:0] sw;		// switch inputs
     wire [15:0] LED;
     wire serialRx = 1'b1;		// serial receive at idle
     wire serialTx;        		// serial transmit
+    wire aclMISO, aclMOSI, aclSCK, aclSSn, aclInt1, aclInt2;   // accelerometer
      
     AHBliteTop dut(
         .clk100(clk100), 
         .btnCpuResetn(btnCpuResetn),
         .btnU(btnU),
+        .btnD(1'b0),
+        .btnL(1'b0),
+        .btnC(1'b0),
+        .btnR(1'b0),
         .serialRx(serialRx),
+        .dbgRx(1'b1),
         .sw(sw),
+        .aclMISO(aclMISO),
+        .aclInt1(aclInt1),
+        .aclInt2(aclInt2),
         .led(LED), 
-        .serialTx(serialTx)
+        .serialTx(serialTx),
+        .aclMOSI(aclMOSI),
+        .aclSCK(aclSCK),
+        .aclSSn(aclSSn)
          );
          
+    ADXL362_model #(.STIM_FILE("adxl362_stim.txt"), .TIME_SCALE(TIME_SCALE)) acl(
+        .SCLK(aclSCK),
+        .MOSI(aclMOSI),
+        .MISO(aclMISO),
+        .CSn(aclSSn),
+        .INT1(aclInt1),
+        .INT2(aclInt2)
+        );
  
     initial
         begin
@@ -29,6 +57,11 @@ module TB_toplevel(    );
                 #5 clk100 = ~clk100;  // invert clock every 5 ns
         end
 
+    // Time with slave select active, for SPI throughput
+    real ssStart, ssTotal = 0.0;
+    always @ (negedge aclSSn) ssStart = $realtime;
+    always @ (posedge aclSSn) if (ssStart > 0.0) ssTotal = ssTotal + ($realtime - ssStart);
+
     initial
         begin
             sw = 16'h5a4b;			// set a value on the switches
@@ -36,7 +69,11 @@ module TB_toplevel(    );
             btnU = 1'b0;				// loader button not pressed
             #30 btnCpuResetn = 1'b0;    // active low reset
             #70 btnCpuResetn = 1'b1;    // release reset
-            #20000;      // delay 20 us or 1000 clock cycles
+            #(RUN_TIME);
+            acl.report;
+            if (ssTotal > 0.0)
+                $display("TB_toplevel: slave select active %0.0f ns, %0.2f Mbit/s while active",
+                         ssTotal, acl.bytesTotal * 8.0e3 / ssTotal);
             $stop;
         end
 
@@ -0,0 +1,420 @@
+/*  sim_main.cpp
+	Verilator harness for the whole SoC (sim_top.v around AHBliteTop), for running
+	firmware and measuring its performance on a PC, much faster than xsim.
+	- The program is loaded into the ROM block RAM by backdoor, from ROMcode.txt
+	  (one hex word per line, as written by fromelf) or from the Intel hex file
+	  DES_M0_SoC.hex, so no ROM loader transfer is needed.
+	- The serial port is connected to the host: bytes sent by the SoC go to standard
+	  output, bytes on standard input (and --send strings) go to the SoC.  The bit
+	  rate is 32 times faster than on the board - see UART_INCR in sim_top.v.
+	- The accelerometer is not modelled yet: MISO is 0, and INT1 (data ready) goes
+	  high at the ADXL362 data rate and low when a SPI transaction ends.
+	- Instruction fetch addresses are monitored, and with the Keil map file the
+	  harness reports clock cycles per call of chosen functions (including the
+	  functions they call) and per iteration of the main loop.  The report goes to
+	  standard error when the simulation ends.
+
+	Build (from Hardware/Verilator, needs Verilator 4.2 or later):
+		verilator -f soc.vc
+	or, for the dual-core system (AHBliteTop DUAL_CORE = 1), in obj_dual:
+		verilator -f soc_dual.vc
+	The dual-core build profiles processor 0, and also reports the time processor 1
+	spends sleeping, so the work moved to processor 1 can be compared with the
+	single processor figures for the same firmware.
+	Use:
+		obj_dir/Vsim_top [options] ../../Software/ROMcode.txt
+	Options:
+		--map file       Keil map file, default ../../Software/temp_files/DES_M0_SoC.map
+		--func name      function to time, may be repeated, default AccRead and printf
+		--loop name      function called once per main loop iteration, default displayValue
+		--cycles n       stop after n clock cycles, default 50000000 (1 s at 50 MHz)
+		--loops n        stop after n main loop iterations
+		--sw hex         slide switch value, default 0
+		--send text      send text to the SoC serial input, \r and \n allowed
+		--drdy n         clock cycles between accelerometer data ready, default 125000
+		                 (400 Hz), 0 for none
+		--no-stdin       do not read standard input
+	Example - binary telemetry mode, 20 loop iterations, output to a file:
+		obj_dir/Vsim_top --sw 8000 --loops 20 ../../Software/ROMcode.txt > tlm.bin
+
+	April 2023 - SoC Group 14
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <poll.h>
+#include <unistd.h>
+
+#include "verilated.h"
+#include "Vsim_top.h"
+
+static const double CLOCK_HZ = 50e6;
+static const uint32_t ROM_WORDS = 8192;
+static const uint32_t UART_INCR = 206144;					// must match sim_top.v
+static const double BIT_CYCLES = 8388608.0 / UART_INCR;		// clock cycles per bit, 2**23 / incr
+
+// ================================ Program loading ================================
+
+// Read ROMcode.txt format: one 32-bit hex word per line
+static bool loadWords(const char *name, std::vector<uint32_t> &rom) {
+	std::ifstream in(name);
+	if (!in) return false;
+	std::string line;
+	uint32_t addr = 0;
+	while (std::getline(in, line) && addr < ROM_WORDS) {
+		if (line.empty() || line[0] == '\r') continue;
+		rom[addr++] = (uint32_t)std::strtoul(line.c_str(), NULL, 16);
+	}
+	return addr > 0;
+}
+
+// Read an Intel hex file, as written by the Keil linker
+static bool loadIntelHex(const char *name, std::vector<uint32_t> &rom) {
+	std::ifstream in(name);
+	if (!in) return false;
+	std::string line;
+	uint32_t base = 0;
+	bool any = false;
+	while (std::getline(in, line)) {
+		if (line.size() < 11 || line[0] != ':') continue;
+		unsigned count = std::strtoul(line.substr(1, 2).c_str(), NULL, 16);
+		unsigned offset = std::strtoul(line.substr(3, 4).c_str(), NULL, 16);
+		unsigned type = std::strtoul(line.substr(7, 2).c_str(), NULL, 16);
+		if (type == 4) base = std::strtoul(line.substr(9, 4).c_str(), NULL, 16) << 16;
+		else if (type == 0)
+			for (unsigned i = 0; i < count; i++) {
+				uint32_t byteAddr = base + offset + i;
+				uint32_t byte = std::strtoul(line.substr(9 + 2*i, 2).c_str(), NULL, 16);
+				if (byteAddr / 4 >= ROM_WORDS) continue;
+				uint32_t &w = rom[byteAddr / 4];
+				w = (w & ~(0xFFu << (8 * (byteAddr & 3)))) | (byte << (8 * (byteAddr & 3)));
+				any = true;
+			}
+	}
+	return any;
+}
+
+// Write the program in $readmemh format, for the ROM model to read
+static std::string writeRomFile(const std::vector<uint32_t> &rom) {
+	char name[] = "/tmp/socromXXXXXX";
+	int fd = mkstemp(name);
+	if (fd < 0) return "";
+	FILE *f = fdopen(fd, "w");
+	for (uint32_t w : rom) std::fprintf(f, "%08X\n", w);
+	std::fclose(f);
+	return name;
+}
+
+// ================================ Symbols and profiling ================================
+
+struct Symbol {
+	uint32_t addr, size;
+};
+
+// Read the Image Symbol Table from a Keil map file - Thumb code symbols only
+static std::map<std::string, Symbol> readMap(const std::string &name) {
+	std::map<std::string, Symbol> syms;
+	std::ifstream in(name.c_str());
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.find("Thumb Code") == std::string::npos) continue;
+		std::istringstream ss(line);
+		std::string sym, value, thumb, code;
+		uint32_t size = 0;
+		if (!(ss >> sym >> value >> thumb >> code >> size)) continue;
+		Symbol s;
+		s.addr = (uint32_t)std::strtoul(value.c_str(), NULL, 16) & ~1u;
+		s.size = size;
+		if (!syms.count(sym) || syms[sym].size == 0) syms[sym] = s;
+	}
+	return syms;
+}
+
+// Find a symbol - printf in the Arm library is __2printf
+static bool findSymbol(const std::map<std::string, Symbol> &syms, const std::string &name, Symbol &s) {
+	const char *prefix[] = {"", "__2", "__0", "__1"};
+	for (const char *p : prefix) {
+		std::map<std::string, Symbol>::const_iterator it = syms.find(p + name);
+		if (it != syms.end() && it->second.size > 0) {
+			s = it->second;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Cycles per call of one function, including the functions it calls.
+// A call is a non-sequential fetch of the first word from outside the function.
+// It returns at the next non-sequential fetch near the address fetched before the
+// call, outside the function - the caller cannot run anywhere else until then.
+struct FuncTimer {
+	std::string name;
+	Symbol sym;
+	struct Call { uint64_t start; uint32_t site; };
+	std::vector<Call> active;		// calls in progress, innermost last
+	uint64_t calls = 0, total = 0, min = ~0ull, max = 0;
+
+	bool inside(uint32_t a) const { return a >= (sym.addr & ~3u) && a < sym.addr + sym.size; }
+
+	void fetch(uint32_t addr, uint32_t prev, uint64_t cycle) {
+		bool jump = (addr != prev + 4);
+		if (!active.empty() && jump && !inside(addr)) {
+			const Call &c = active.back();
+			if (addr + 4 >= c.site && addr <= c.site + 8) {
+				uint64_t t = cycle - c.start;
+				calls++;
+				total += t;
+				if (t < min) min = t;
+				if (t > max) max = t;
+				active.pop_back();
+			}
+		}
+		if (jump && addr == (sym.addr & ~3u) && !inside(prev)) {
+			Call c = {cycle, prev};
+			active.push_back(c);
+		}
+	}
+};
+
+// ================================ Serial port ================================
+
+// Receives bytes from the SoC serialTx line
+struct UartRx {
+	bool busy = false;
+	double next = 0;				// cycle to sample the next bit
+	int bit = 0;
+	uint8_t data = 0;
+	uint64_t count = 0;
+
+	void clock(uint64_t cycle, int line) {
+		if (!busy) {
+			if (line == 0) {		// start bit - sample the middle of each bit from here
+				busy = true;
+				next = cycle + 1.5 * BIT_CYCLES;
+				bit = 0;
+				data = 0;
+			}
+		}
+		else if (cycle >= next) {
+			if (bit < 8) data |= (line & 1) << bit;
+			else {					// stop bit time - byte finished
+				std::fputc(data, stdout);
+				if (data == '\n') std::fflush(stdout);
+				count++;
+				busy = false;
+			}
+			bit++;
+			next += BIT_CYCLES;
+		}
+	}
+};
+
+// Sends bytes to the SoC serialRx line
+struct UartTx {
+	std::deque<uint8_t> queue;
+	bool busy = false;
+	double start = 0;				// cycle the current character started
+	uint16_t frame = 0;				// start bit, 8 data bits, stop bit
+	uint64_t count = 0;
+
+	int clock(uint64_t cycle) {
+		if (!busy) {
+			if (queue.empty()) return 1;
+			frame = (uint16_t)((1u << 9) | (queue.front() << 1));
+			queue.pop_front();
+			busy = true;
+			start = cycle;
+			count++;
+		}
+		int bit = (int)((cycle - start) / BIT_CYCLES);
+		if (bit >= 10) {
+			busy = false;
+			return 1;
+		}
+		return (frame >> bit) & 1;
+	}
+};
+
+// ================================ Main ================================
+
+static void usage() {
+	std::cerr << "usage: Vsim_top [--map file] [--func name]... [--loop name] [--cycles n] [--loops n]\n"
+				 "                [--sw hex] [--send text] [--drdy n] [--no-stdin] program\n"
+				 "program is ROMcode.txt (hex words) or DES_M0_SoC.hex (Intel hex)\n";
+}
+
+// Replace \r and \n in a command line argument
+static std::string unescape(const char *s) {
+	std::string out;
+	for (; *s; s++) {
+		if (s[0] == '\\' && s[1] == 'r') { out += '\r'; s++; }
+		else if (s[0] == '\\' && s[1] == 'n') { out += '\n'; s++; }
+		else out += *s;
+	}
+	return out;
+}
+
+int main(int argc, char **argv) {
+	std::string mapName = "../../Software/temp_files/DES_M0_SoC.map";
+	std::vector<std::string> funcNames;
+	std::string loopName = "displayValue";
+	uint64_t maxCycles = 50000000, maxLoops = 0;
+	uint32_t switches = 0, drdyPeriod = 125000;
+	bool useStdin = true;
+	const char *program = NULL;
+	UartTx toSoc;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		bool more = (i + 1 < argc);
+		if (a == "--map" && more) mapName = argv[++i];
+		else if (a == "--func" && more) funcNames.push_back(argv[++i]);
+		else if (a == "--loop" && more) loopName = argv[++i];
+		else if (a == "--cycles" && more) maxCycles = std::strtoull(argv[++i], NULL, 0);
+		else if (a == "--loops" && more) maxLoops = std::strtoull(argv[++i], NULL, 0);
+		else if (a == "--sw" && more) switches = (uint32_t)std::strtoul(argv[++i], NULL, 16);
+		else if (a == "--drdy" && more) drdyPeriod = (uint32_t)std::strtoul(argv[++i], NULL, 0);
+		else if (a == "--send" && more) {
+			std::string s = unescape(argv[++i]);
+			toSoc.queue.insert(toSoc.queue.end(), s.begin(), s.end());
+		}
+		else if (a == "--no-stdin") useStdin = false;
+		else if (a[0] == '+') ;						// plusargs are for Verilator
+		else if (a[0] != '-' && !program) program = argv[i];
+		else { usage(); return 1; }
+	}
+	if (!program) { usage(); return 1; }
+	if (funcNames.empty()) {
+		funcNames.push_back("AccRead");
+		funcNames.push_back("printf");
+	}
+
+	// Load the program and pass it to the ROM model
+	std::vector<uint32_t> rom(ROM_WORDS, 0);
+	std::string progName = program;
+	bool isHex = progName.size() > 4 && progName.compare(progName.size() - 4, 4, ".hex") == 0;
+	if (!(isHex ? loadIntelHex(program, rom) : loadWords(program, rom))) {
+		std::cerr << "sim: cannot read program " << program << "\n";
+		return 1;
+	}
+	std::string romFile = writeRomFile(rom);
+	std::string plusarg = "+rom=" + romFile;
+	std::vector<const char *> vargs(argv, argv + argc);
+	vargs.push_back(plusarg.c_str());
+	Verilated::commandArgs((int)vargs.size(), vargs.data());
+
+	// Functions to time, and the main loop marker
+	std::map<std::string, Symbol> syms = readMap(mapName);
+	if (syms.empty()) std::cerr << "sim: no symbols from " << mapName << " - no profile\n";
+	std::vector<FuncTimer> timers;
+	for (const std::string &n : funcNames) {
+		FuncTimer t;
+		t.name = n;
+		if (findSymbol(syms, n, t.sym)) timers.push_back(t);
+		else if (!syms.empty()) std::cerr << "sim: function " << n << " not in map file\n";
+	}
+	Symbol loopSym = {0, 0};
+	bool haveLoop = findSymbol(syms, loopName, loopSym);
+	uint64_t loops = 0, loopStart = 0, loopMin = ~0ull, loopMax = 0, loopTotal = 0;
+
+	Vsim_top *top = new Vsim_top;
+	top->resetn = 1;
+	top->sw = switches;
+	top->buttons = 0;
+	top->serialRx = 1;
+	top->aclMISO = 0;
+	top->aclInt1 = 0;
+	top->aclInt2 = 0;
+	top->clk = 0;
+	top->eval();
+
+	UartRx fromSoc;
+	uint64_t cycle = 0, sleepCycles = 0, sleep1Cycles = 0;
+	uint32_t prevFetch = 0;
+	int lastSSn = 1;
+	bool stdinOpen = useStdin;
+	const char *stopReason = "cycle limit";
+
+	while (cycle < maxCycles && !Verilated::gotFinish()) {
+		top->clk = 1;
+		top->eval();
+		top->clk = 0;
+		top->eval();
+		cycle++;
+
+		// Serial port
+		fromSoc.clock(cycle, top->serialTx);
+		top->serialRx = toSoc.clock(cycle);
+		if (stdinOpen && (cycle & 0xFFF) == 0) {		// check the host input now and then
+			struct pollfd p = {0, POLLIN, 0};
+			if (poll(&p, 1, 0) > 0) {
+				uint8_t buf[64];
+				ssize_t n = read(0, buf, sizeof buf);
+				if (n <= 0) stdinOpen = false;
+				else toSoc.queue.insert(toSoc.queue.end(), buf, buf + n);
+			}
+		}
+
+		// Accelerometer data ready - cleared by reading the data registers
+		if (drdyPeriod && cycle % drdyPeriod == 0) top->aclInt1 = 1;
+		if (top->aclSSn && !lastSSn) top->aclInt1 = 0;
+		lastSSn = top->aclSSn;
+
+		// Profiling
+		if (top->sleeping) sleepCycles++;
+		if (top->sleeping1) sleep1Cycles++;
+		if (top->fetch) {
+			uint32_t addr = top->fetchAddr;
+			for (FuncTimer &t : timers) t.fetch(addr, prevFetch, cycle);
+			if (haveLoop && addr == (loopSym.addr & ~3u) && addr != prevFetch + 4) {
+				if (loops > 0) {
+					uint64_t t = cycle - loopStart;
+					loopTotal += t;
+					if (t < loopMin) loopMin = t;
+					if (t > loopMax) loopMax = t;
+				}
+				loopStart = cycle;
+				loops++;
+			}
+			prevFetch = addr;
+		}
+		if (top->lockup) { stopReason = "processor locked up"; break; }
+		if (maxLoops && loops > maxLoops) { stopReason = "loop limit"; break; }
+	}
+	std::fflush(stdout);
+	top->final();
+	delete top;
+	unlink(romFile.c_str());
+
+	// Report
+	std::fprintf(stderr, "\nsim: stopped after %llu cycles (%.3f ms at 50 MHz) - %s\n",
+		(unsigned long long)cycle, cycle * 1e3 / CLOCK_HZ, stopReason);
+	std::fprintf(stderr, "sim: processor sleeping %.1f%% of the time\n",
+		cycle ? 100.0 * sleepCycles / cycle : 0.0);
+	if (sleep1Cycles < cycle)		// always sleeping if there is no processor 1
+		std::fprintf(stderr, "sim: processor 1 sleeping %.1f%% of the time\n", 100.0 * sleep1Cycles / cycle);
+	std::fprintf(stderr, "sim: serial port %llu bytes from SoC, %llu bytes to SoC\n",
+		(unsigned long long)fromSoc.count, (unsigned long long)toSoc.count);
+	if (haveLoop && loops > 1)
+		std::fprintf(stderr, "sim: main loop (%s) %llu iterations, cycles per iteration: mean %llu, min %llu, max %llu\n",
+			loopName.c_str(), (unsigned long long)(loops - 1), (unsigned long long)(loopTotal / (loops - 1)),
+			(unsigned long long)loopMin, (unsigned long long)loopMax);
+	for (const FuncTimer &t : timers) {
+		if (t.calls == 0)
+			std::fprintf(stderr, "sim: %-16s not called\n", t.name.c_str());
+		else
+			std::fprintf(stderr, "sim: %-16s %8llu calls, cycles per call: mean %llu, min %llu, max %llu, %.1f%% of time\n",
+				t.name.c_str(), (unsigned long long)t.calls, (unsigned long long)(t.total / t.calls),
+				(unsigned long long)t.min, (unsigned long long)t.max, 100.0 * t.total / cycle);
+	}
+	return 0;
+}
@@ -0,0 +1,93 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   clock_gen, blk_mem_8Kword, blk_mem_4Kword
+// Description:   Behavioural models of the Xilinx IP blocks, for the Verilator
+//          build only - they replace clock_gen.v and the block RAM IP cores.
+//          clock_gen passes its input straight through, so the harness drives
+//          clk100 at the bus clock rate, and one harness cycle is one bus cycle.
+//          blk_mem_8Kword (program ROM) is loaded from a file named by the
+//          plusarg +rom=file, one hex word per line, as written by the harness.
+//          The ROM loader can still write it, as in the real block RAM.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+module clock_gen (
+    input         clk_in1,      // bus clock from harness
+    output        clk_out1,     // same clock
+    output        locked        // high after a few clock cycles
+    );
+
+    reg [3:0] lockCount = 4'd0;
+    always @ (posedge clk_in1)
+        if (lockCount != 4'hf) lockCount <= lockCount + 4'd1;
+
+    assign clk_out1 = clk_in1;
+    assign locked = (lockCount == 4'hf);
+
+endmodule
+
+
+// Program store - port A writes (ROM loader), port B reads (bus), synchronous
+module blk_mem_8Kword (
+    input clka,
+    input ena,
+    input [0:0] wea,
+    input [12:0] addra,
+    input [31:0] dina,
+    input clkb,
+    input enb,
+    input [12:0] addrb,
+    output reg [31:0] doutb
+    );
+
+    reg [31:0] mem [0:8191];
+    reg [8*256-1:0] romFile;
+    integer i;
+
+    initial
+        begin
+            for (i = 0; i < 8192; i = i + 1) mem[i] = 32'b0;
+            if ($value$plusargs("rom=%s", romFile)) $readmemh(romFile, mem);
+        end
+
+    always @ (posedge clka)
+        if (ena & wea[0]) mem[addra] <= dina;
+
+    always @ (posedge clkb)
+        if (enb) doutb <= mem[addrb];
+
+endmodule
+
+
+// Data memory - port A writes with byte enables, port B reads, synchronous
+module blk_mem_4Kword (
+    input clka,
+    input [3:0] wea,
+    input [11:0] addra,
+    input [31:0] dina,
+    input clkb,
+    input [11:0] addrb,
+    output reg [31:0] doutb
+    );
+
+    reg [31:0] mem [0:4095];
+
+    always @ (posedge clka)
+        begin
+            if (wea[0]) mem[addra][7:0] <= dina[7:0];
+            if (wea[1]) mem[addra][15:8] <= dina[15:8];
+            if (wea[2]) mem[addra][23:16] <= dina[23:16];
+            if (wea[3]) mem[addra][31:24] <= dina[31:24];
+        end
+
+    always @ (posedge clkb)
+        doutb <= mem[addrb];
+
+endmodule
@@ -0,0 +1,83 @@
+`timescale 1ns / 1ns
+//////////////////////////////////////////////////////////////////////////////////
+// Company: UCD School of Electrical and Electronic Engineering
+// Engineer: SoC lab Group 14
+//
+// Create Date:   April 2023
+// Design Name:   Cortex-M0 DesignStart system
+// Module Name:   sim_top
+// Description:   Top level for the Verilator build.  Instantiates AHBliteTop and
+//          brings out the bus signals the harness needs for profiling: the
+//          address of each instruction fetch, and the processor status.
+//          The UART bit rate is a parameter, so the serial port can run much
+//          faster than on the board - the harness uses the same value.
+//          DUAL_CORE selects the dual-core system (soc_dual.vc) - fetches are
+//          then those of processor 0, on its local bus.
+//
+// Revision 0.01 - File Created
+//
+//////////////////////////////////////////////////////////////////////////////////
+module sim_top #(
+    parameter [19:0] UART_INCR = 20'd206144,   // 32 times 19200 bit/s
+    parameter DUAL_CORE = 0                     // 1 for the dual-core system
+    ) (
+    input clk,              // bus clock - clock_gen model passes it through
+    input resetn,           // reset pushbutton, active low
+    input [15:0] sw,        // slide switches
+    input [4:0] buttons,    // {btnU, btnD, btnL, btnC, btnR}
+    input serialRx,         // serial input to SoC
+    output serialTx,        // serial output from SoC
+    input aclMISO,          // accelerometer signals
+    input aclInt1,
+    input aclInt2,
+    output aclSCK,
+    output aclMOSI,
+    output aclSSn,
+    output [15:0] led,
+    output [7:0] digit,
+    output [7:0] segment,
+    // Profiling signals
+    output fetch,           // instruction fetch address phase completing this cycle
+    output [31:0] fetchAddr,
+    output sleeping,        // processor is sleeping
+    output sleeping1,       // processor 1 is sleeping - always 1 in the single processor system
+    output lockup           // processor is locked up - program has crashed
+    );
+
+    wire [5:0] rgbLED;
+    wire [7:0] JA;
+
+    AHBliteTop #(.UART_INCR(UART_INCR), .DUAL_CORE(DUAL_CORE)) dut (
+        .clk100         (clk),
+        .btnCpuResetn   (resetn),
+        .btnU           (buttons[4]),
+        .btnD           (buttons[3]),
+        .btnL           (buttons[2]),
+        .btnC           (buttons[1]),
+        .btnR           (buttons[0]),
+        .sw             (sw),
+        .serialRx       (serialRx),
+        .dbgRx          (1'b1),             // debug bridge not used - serial line idle
+        .aclMISO        (aclMISO),
+        .aclInt1        (aclInt1),
+        .aclInt2        (aclInt2),
+        .led            (led),
+        .rgbLED         (rgbLED),
+        .JA             (JA),
+        .serialTx       (serialTx),
+        .dbgTx          (),
+        .aclMOSI        (aclMOSI),
+        .aclSCK         (aclSCK),
+        .aclSSn         (aclSSn),
+        .digit          (digit),
+        .segment        (segment)
+        );
+
+    // HPROT[0] is 0 for an instruction fetch, 1 for a data access
+    assign fetch = dut.HREADY_cpu & dut.HTRANS_cpu[1] & ~dut.HPROT[0];
+    assign fetchAddr = dut.HADDR_cpu;
+    assign sleeping = dut.CPUsleep;
+    assign sleeping1 = dut.CPUsleep1;
+    assign lockup = dut.CPUlockup;
+
+endmodule
@@ -62,8 +62,8 @@ typedef enum IRQn
 /* ----------------------  ARMCM0 Specific Interrupt Numbers  --------------------- */
   WDT_IRQn                      =   0,      /*!< Watchdog Timer Interrupt           */
   UART_IRQn                     =   1,      /*!< UART Interrupt  for DES_M0_SoC     */
-  TIM0_IRQn                     =   2,      /*!< Timer0 / Timer1 Interrupt          */
-  TIM2_IRQn                     =   3,      /*!< Timer2 / Timer3 Interrupt          */
+  ACL_IRQn                      =   2,      /*!< ACL Interrupt   for DES_M0_SoC     */
+  SMP_IRQn                      =   3,      /*!< Sampler Interrupt for DES_M0_SoC  */
   MCIA_IRQn                     =   4,      /*!< MCIa Interrupt                     */
   MCIB_IRQn                     =   5,      /*!< MCIb Interrupt                     */
   UART0_IRQn                    =   6,      /*!< UART0 Interrupt                    */
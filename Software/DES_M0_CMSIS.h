@@ -41,6 +41,12 @@ typedef struct
 		volatile uint8   Control;
 		volatile uint32  reserved3;
 	};
+	volatile uint32  BaudIncr;		// bit rate: increment = bit rate * 2**23 / clock, word access only
+	volatile uint32  RxLevel;			// rx level interrupt when this many bytes are waiting, 0 disables
+	volatile uint32  TxLevel;			// tx level interrupt when fewer bytes are waiting, 0 disables
+	volatile uint32  Timeout;			// rx idle interrupt after this many bit times, 0 disables
+	volatile uint16  RxCount;			// bytes in rx FIFO, read only
+	volatile uint16  TxCount;			// bytes in tx FIFO, read only
 } UART_block;
 
 // Define bit positions for the UART control and status registers
@@ -48,12 +54,20 @@ typedef struct
 #define UART_TX_FIFO_EMPTY_BIT_POS	1			// Rx FIFO empty
 #define UART_RX_FIFO_FULL_BIT_POS		2			// Rx FIFO full
 #define UART_RX_FIFO_NOTEMPTY_BIT_POS	3		// Rx FIFO not empty (data available)
+#define UART_RX_LEVEL_BIT_POS			4			// Rx FIFO has at least RxLevel bytes
+#define UART_TX_LEVEL_BIT_POS			5			// Tx FIFO has fewer than TxLevel bytes
+#define UART_RX_IDLE_BIT_POS			6			// Rx FIFO not empty and line idle for Timeout bit times
 
 // Simple names for the UART registers
 #define UART_RXD (pt2UART->RxData)
 #define UART_TXD (pt2UART->TxData)
 #define UART_STS (pt2UART->Status)
 #define UART_CTL (pt2UART->Control)
+#define UART_BAUD (pt2UART->BaudIncr)
+#define UART_RXLVL (pt2UART->RxLevel)
+#define UART_TXLVL (pt2UART->TxLevel)
+#define UART_TIMEOUT (pt2UART->Timeout)
+#define UART_CLOCK_HZ	50000000		// bus clock frequency, used to calculate the bit rate
 
 
 // =================================================================
@@ -90,6 +104,17 @@ typedef struct 		// matches the registers in GPIO hardware
 		struct TwoByte IN1;
 		volatile uint32  reserved3;
 	};
+	volatile uint32  Set0;				// write-only aliases: write 1s to set,
+	volatile uint32  Set1;				// clear or toggle those bits of an output port
+	volatile uint32  Clr0;				// in one bus write - safe against interrupts
+	volatile uint32  Clr1;
+	volatile uint32  Toggle0;
+	volatile uint32  Toggle1;
+	volatile uint32  Rise;				// edge detection - word access only, in these
+	volatile uint32  Fall;				// registers bits 15:0 are In0, bits 31:16 are In1
+	volatile uint32  Events;			// latched edges, write 1 to clear
+	volatile uint32  Debounce;		// sample period, 256 x (value + 1) clock cycles
+	volatile uint32  Stable;			// debounced inputs
 } GPIO_block;
 
 // Simple names for the GPIO registers, as used in the SoC assignment
@@ -100,6 +125,16 @@ typedef struct 		// matches the registers in GPIO hardware
 #define GPIO_SW_Lo	(pt2GPIO->IN0.Lo)			// allow access to the 8 rightmost switches
 #define GPIO_SW_Hi	(pt2GPIO->IN0.Hi)			// allow access to the 8 leftmost switches
 #define GPIO_BUTTON	(pt2GPIO->In1)				// input port 1 is connected to 5 buttons
+#define GPIO_LED_SET		(pt2GPIO->Set0)			// write 1s to turn LEDs on
+#define GPIO_LED_CLR		(pt2GPIO->Clr0)			// write 1s to turn LEDs off
+#define GPIO_LED_TOGGLE	(pt2GPIO->Toggle0)		// write 1s to invert LEDs
+#define GPIO_RISE				(pt2GPIO->Rise)			// 1 - event on a rising edge of that input
+#define GPIO_FALL				(pt2GPIO->Fall)			// 1 - event on a falling edge
+#define GPIO_EVENTS			(pt2GPIO->Events)		// events seen, GPIO interrupt while any is set
+#define GPIO_DEBOUNCE		(pt2GPIO->Debounce)
+#define GPIO_STABLE			(pt2GPIO->Stable)		// debounced switches (15:0) and buttons (31:16)
+#define GPIO_IN1_SHIFT	16									// shift a button mask for these registers
+#define GPIO_DEBOUNCE_5MS	976								// 5 ms sample period with 50 MHz clock
 
 // Button masks - as in the example hardware in the SoC assignment
 #define BTNU_MASK		(0x10)		// use to select the input from BTNU only
@@ -109,6 +144,135 @@ typedef struct 		// matches the registers in GPIO hardware
 #define BTNR_MASK		(0x01)
 
 
+// =================================================================
+// Struct for registers in SPI hardware
+typedef struct 
+{
+	union  // this union occupies 4 bytes in the address map
+	{
+		volatile uint8   Data;			// write starts transfer, read gives received byte
+		volatile uint32  reserved0;
+	};
+	union 
+	{
+		volatile uint8   Status;
+		volatile uint32  reserved1;
+	};
+	union 
+	{
+		volatile uint8   Control;
+		volatile uint32  reserved2;
+	};
+	union 
+	{
+		volatile uint8   ClkDiv;		// SCLK half period in bus clock cycles, minus 1
+		volatile uint32  reserved3;
+	};
+} SPI_block;
+
+// Define bit positions for the SPI status and control registers
+#define SPI_BUSY_BIT_POS				0			// Status - transfer in progress
+#define SPI_SELECTED_BIT_POS		1			// Status - slave select is active
+#define SPI_SELECT_BIT_POS			0			// Control - 1 holds slave select active
+#define SPI_INT1_BIT_POS				2			// Status - accelerometer INT1 pin high, Control - enable its interrupt
+#define SPI_INT2_BIT_POS				3			// Status - accelerometer INT2 pin high, Control - enable its interrupt
+
+// Simple names for the SPI registers
+#define SPI_DATA (pt2SPI->Data)
+#define SPI_STS  (pt2SPI->Status)
+#define SPI_CTL  (pt2SPI->Control)
+#define SPI_DIV  (pt2SPI->ClkDiv)
+
+
+// =================================================================
+// Struct for registers in accelerometer sampling engine - word access only
+typedef struct 
+{
+	volatile uint32  Control;
+	volatile uint32  Status;			// write 1 to overflow or limited bit to clear it
+	volatile uint32  Period;			// sample period in bus clock cycles, timer mode
+	volatile uint32  Level;				// sample sets in buffer for level bit and interrupt, 0 disables
+	volatile uint32  Count;				// sample sets in buffer, read only
+	volatile uint32  ClkDiv;			// SCLK half period in bus clock cycles, minus 1
+	volatile uint32  Time;				// microseconds since reset, read only
+	volatile uint32  Filter;			// combines groups of sample sets before the buffer
+	volatile uint32  SampleTime;	// oldest sample set: timestamp in microseconds
+	volatile uint32  SampleXY;		// oldest sample set: Y in upper half, X in lower half
+	volatile uint32  SampleZT;		// oldest sample set: temperature in upper half, Z in lower - read removes it
+} SMP_block;
+// bit position defs for the sampling engine status and control registers
+#define SMP_ENABLE_BIT_POS			0			// Control - engine runs and drives the SPI pins
+#define SMP_DRDY_BIT_POS				1			// Control - 1 triggers on data ready (INT1), 0 on period timer
+#define SMP_TEMP_BIT_POS				2			// Control - read temperature as well
+#define SMP_LEVEL_INT_BIT_POS		3			// Control - enable interrupt when level reached
+#define SMP_BUSY_BIT_POS				0			// Status - SPI sequence in progress
+#define SMP_NOT_EMPTY_BIT_POS		1			// Status - buffer holds at least one sample set
+#define SMP_LEVEL_BIT_POS				2			// Status - buffer holds at least Level sample sets
+#define SMP_OVERFLOW_BIT_POS		3			// Status - a sample set was lost, write 1 to clear
+#define SMP_LIMITED_BIT_POS			4			// Status - a filter output was limited to 16 bits, write 1 to clear
+#define SMP_RATIO_BIT_POS				0			// Filter - 8 bits: sample sets per stored set, minus 1
+#define SMP_SHIFT_BIT_POS				8			// Filter - 4 bits: average sum shift, or IIR coefficient 2^-shift
+#define SMP_IIR_BIT_POS					12		// Filter - 1 first-order IIR low-pass, 0 average
+#define SMP_BUFFER_SIZE					256		// sample sets in buffer
+
+// Simple names for the sampling engine registers
+#define SMP_CTL    (pt2SMP->Control)
+#define SMP_STS    (pt2SMP->Status)
+#define SMP_PERIOD (pt2SMP->Period)
+#define SMP_LEVEL  (pt2SMP->Level)
+#define SMP_COUNT  (pt2SMP->Count)
+#define SMP_DIV    (pt2SMP->ClkDiv)
+#define SMP_TIME   (pt2SMP->Time)
+#define SMP_FILTER (pt2SMP->Filter)
+
+
+// =================================================================
+// Struct for registers in arithmetic unit - word access only
+// Write A, then write B to one of the operation registers to start the operation.
+// Reads of the results wait until the operation has finished.
+typedef struct 
+{
+	volatile uint32  A;						// operand A
+	volatile uint32  B;						// operand B
+	volatile uint32  Status;			// read only
+	volatile uint32  Result;			// quotient, or saturated sum
+	volatile uint32  Remainder;
+	volatile uint32  AccLo;				// 64-bit accumulator
+	volatile uint32  AccHi;
+	volatile uint32  reserved7;
+	volatile uint32  UDiv;				// write B: unsigned divide A / B
+	volatile uint32  SDiv;				// write B: signed divide A / B
+	volatile uint32  UMac;				// write B: acc = acc + A * B, unsigned
+	volatile uint32  SMac;				// write B: acc = acc + A * B, signed
+	volatile uint32  SAdd;				// write B: result = A + B, signed, saturated
+} ARITH_block;
+// bit position defs for the arithmetic unit status register
+#define ARITH_BUSY_BIT_POS			0			// operation in progress
+#define ARITH_DIV_ZERO_BIT_POS	1			// last divide was by zero
+#define ARITH_SATURATED_BIT_POS	2			// last saturating add was limited
+
+
+// =================================================================
+// Struct for registers in CORDIC unit - word access only
+// Write the operands, then write any value to ATan2 or Tilt to start.
+// Angles are in hundredths of a degree.  Reads of the results wait until it has finished.
+typedef struct 
+{
+	volatile int32   X;						// operands, 16-bit signed
+	volatile int32   Y;
+	volatile int32   Z;
+	volatile uint32  Status;			// read only
+	volatile uint32  ATan2;				// write: angle = atan2(Y, X), magnitude of (X, Y)
+	volatile uint32  Tilt;				// write: pitch, roll and magnitude of (X, Y, Z)
+	volatile int32   Angle;
+	volatile uint32  Mag;
+	volatile int32   Pitch;
+	volatile int32   Roll;
+} CORDIC_block;
+// bit position defs for the CORDIC unit status register
+#define CORDIC_BUSY_BIT_POS			0			// operation in progress
+
+
 // =================================================================
 // Struct for an array of registers for the display hardware
 typedef struct 
@@ -116,6 +280,9 @@ typedef struct
 		volatile uint8 digit[8];  // set of 8 digit registers
 		volatile uint8 mode;			// mode register
 		volatile uint8 enable;		// enable register
+		volatile uint8 reserved[2];
+		volatile int32 number;		// signed number, shown in decimal - word write only
+		volatile uint8 decimals;	// digits after the decimal point of number, 0 to 7
 } DISP_block;
 
 
@@ -123,6 +290,10 @@ typedef struct
 // Pointers to the structs above, to define the memory map
 #define pt2GPIO ((GPIO_block *)0x50000000)
 #define pt2UART ((UART_block *)0x51000000)
-#define pt2Disp ((DISP_block *)0x53000000)
+#define pt2Disp ((DISP_block *)0x52000000)
+#define pt2SPI  ((SPI_block *)0x53000000)
+#define pt2SMP  ((SMP_block *)0x54000000)
+#define pt2ARITH ((ARITH_block *)0x55000000)
+#define pt2CORDIC ((CORDIC_block *)0x59000000)
 
 #endif
@@ -1,6 +1,7 @@
 /* DES_M0_SoC.h
 	Definitions and structs for System on Chip design assignment.
-	This version works without CMSIS.  */
+	This version works without CMSIS.
+	With HOST_BUILD defined, the registers are in host memory instead - see host/host_hal.h  */
 
 	
 #ifndef DES_M0_HDR_ALREADY_INCLUDED
@@ -14,7 +15,9 @@ typedef   signed short int   int16;
 typedef unsigned       int  uint32;
 typedef   signed       int   int32;
 
+#ifndef HOST_BUILD
 #pragma anon_unions
+#endif
 
 
 // =================================================================
@@ -41,18 +44,32 @@ typedef struct
 		volatile uint8   Control;
 		volatile uint32  reserved3;
 	};
+	volatile uint32  BaudIncr;		// bit rate: increment = bit rate * 2**23 / clock, word access only
+	volatile uint32  RxLevel;			// rx level interrupt when this many bytes are waiting, 0 disables
+	volatile uint32  TxLevel;			// tx level interrupt when fewer bytes are waiting, 0 disables
+	volatile uint32  Timeout;			// rx idle interrupt after this many bit times, 0 disables
+	volatile uint16  RxCount;			// bytes in rx FIFO, read only
+	volatile uint16  TxCount;			// bytes in tx FIFO, read only
 } UART_block;
 // bit position defs for the UART status register
 #define UART_TX_FIFO_FULL_BIT_POS		0			// Tx FIFO full
 #define UART_TX_FIFO_EMPTY_BIT_POS	1			// Rx FIFO empty
 #define UART_RX_FIFO_FULL_BIT_POS		2			// Rx FIFO full
 #define UART_RX_FIFO_NOTEMPTY_BIT_POS	3		// Rx FIFO not empty (data available)
+#define UART_RX_LEVEL_BIT_POS			4			// Rx FIFO has at least RxLevel bytes
+#define UART_TX_LEVEL_BIT_POS			5			// Tx FIFO has fewer than TxLevel bytes
+#define UART_RX_IDLE_BIT_POS			6			// Rx FIFO not empty and line idle for Timeout bit times
 
 // Simple names for the UART registers
 #define UART_RXD (pt2UART->RxData)
 #define UART_TXD (pt2UART->TxData)
 #define UART_STS (pt2UART->Status)
 #define UART_CTL (pt2UART->Control)
+#define UART_BAUD (pt2UART->BaudIncr)
+#define UART_RXLVL (pt2UART->RxLevel)
+#define UART_TXLVL (pt2UART->TxLevel)
+#define UART_TIMEOUT (pt2UART->Timeout)
+#define UART_CLOCK_HZ	50000000		// bus clock frequency, used to calculate the bit rate
 
 
 // =================================================================
@@ -89,6 +106,17 @@ typedef struct 		// matches the registers in GPIO hardware
 		struct TwoByte IN1;
 		volatile uint32  reserved3;
 	};
+	volatile uint32  Set0;				// write-only aliases: write 1s to set,
+	volatile uint32  Set1;				// clear or toggle those bits of an output port
+	volatile uint32  Clr0;				// in one bus write - safe against interrupts
+	volatile uint32  Clr1;
+	volatile uint32  Toggle0;
+	volatile uint32  Toggle1;
+	volatile uint32  Rise;				// edge detection - word access only, in these
+	volatile uint32  Fall;				// registers bits 15:0 are In0, bits 31:16 are In1
+	volatile uint32  Events;			// latched edges, write 1 to clear
+	volatile uint32  Debounce;		// sample period, 256 x (value + 1) clock cycles
+	volatile uint32  Stable;			// debounced inputs
 } GPIO_block;
 
 // Simple names for the GPIO registers, as used in the SoC assignment
@@ -100,6 +128,19 @@ typedef struct 		// matches the registers in GPIO hardware
 #define GPIO_SW_Lo	(pt2GPIO->IN0.Lo)			// allow access to the 8 rightmost switches
 #define GPIO_SW_Hi	(pt2GPIO->IN0.Hi)			// allow access to the 8 leftmost switches
 #define GPIO_IN1		(pt2GPIO->In1)				// input port 1 is connected to 'aclMISO' (MSB) and 5 buttons (LSB)
+#define GPIO_LED_SET		(pt2GPIO->Set0)			// write 1s to turn LEDs on
+#define GPIO_LED_CLR		(pt2GPIO->Clr0)			// write 1s to turn LEDs off
+#define GPIO_LED_TOGGLE	(pt2GPIO->Toggle0)		// write 1s to invert LEDs
+#define GPIO_ACL_SET		(pt2GPIO->Set1)
+#define GPIO_ACL_CLR		(pt2GPIO->Clr1)
+#define GPIO_ACL_TOGGLE	(pt2GPIO->Toggle1)
+#define GPIO_RISE				(pt2GPIO->Rise)			// 1 - event on a rising edge of that input
+#define GPIO_FALL				(pt2GPIO->Fall)			// 1 - event on a falling edge
+#define GPIO_EVENTS			(pt2GPIO->Events)		// events seen, GPIO interrupt while any is set
+#define GPIO_DEBOUNCE		(pt2GPIO->Debounce)
+#define GPIO_STABLE			(pt2GPIO->Stable)		// debounced switches (15:0) and port 1 (31:16)
+#define GPIO_IN1_SHIFT	16									// shift an In1 mask, e.g. BTNC_MASK, for these registers
+#define GPIO_DEBOUNCE_5MS	976								// 5 ms sample period with 50 MHz clock
 
 // Button masks - as in the example hardware in the SoC assignment
 #define BTNU_MASK		(0x10)		// use to select the input from BTNU only
@@ -109,6 +150,215 @@ typedef struct 		// matches the registers in GPIO hardware
 #define BTNR_MASK		(0x01)
 
 
+// =================================================================
+// Struct for registers in SPI hardware
+typedef struct 
+{
+	union  // this union occupies 4 bytes in the address map
+	{
+		volatile uint8   Data;			// write starts transfer, read gives received byte
+		volatile uint32  reserved0;
+	};
+	union 
+	{
+		volatile uint8   Status;
+		volatile uint32  reserved1;
+	};
+	union 
+	{
+		volatile uint8   Control;
+		volatile uint32  reserved2;
+	};
+	union 
+	{
+		volatile uint8   ClkDiv;		// SCLK half period in bus clock cycles, minus 1
+		volatile uint32  reserved3;
+	};
+} SPI_block;
+// bit position defs for the SPI status and control registers
+#define SPI_BUSY_BIT_POS				0			// Status - transfer in progress
+#define SPI_SELECTED_BIT_POS		1			// Status - slave select is active
+#define SPI_SELECT_BIT_POS			0			// Control - 1 holds slave select active
+#define SPI_INT1_BIT_POS				2			// Status - accelerometer INT1 pin high, Control - enable its interrupt
+#define SPI_INT2_BIT_POS				3			// Status - accelerometer INT2 pin high, Control - enable its interrupt
+
+// Simple names for the SPI registers
+#define SPI_DATA (pt2SPI->Data)
+#define SPI_STS  (pt2SPI->Status)
+#define SPI_CTL  (pt2SPI->Control)
+#define SPI_DIV  (pt2SPI->ClkDiv)
+
+
+// =================================================================
+// Struct for registers in accelerometer sampling engine - word access only
+typedef struct 
+{
+	volatile uint32  Control;
+	volatile uint32  Status;			// write 1 to overflow or limited bit to clear it
+	volatile uint32  Period;			// sample period in bus clock cycles, timer mode
+	volatile uint32  Level;				// sample sets in buffer for level bit and interrupt, 0 disables
+	volatile uint32  Count;				// sample sets in buffer, read only
+	volatile uint32  ClkDiv;			// SCLK half period in bus clock cycles, minus 1
+	volatile uint32  Time;				// microseconds since reset, read only
+	volatile uint32  Filter;			// combines groups of sample sets before the buffer
+	volatile uint32  SampleTime;	// oldest sample set: timestamp in microseconds
+	volatile uint32  SampleXY;		// oldest sample set: Y in upper half, X in lower half
+	volatile uint32  SampleZT;		// oldest sample set: temperature in upper half, Z in lower - read removes it
+} SMP_block;
+// bit position defs for the sampling engine status and control registers
+#define SMP_ENABLE_BIT_POS			0			// Control - engine runs and drives the SPI pins
+#define SMP_DRDY_BIT_POS				1			// Control - 1 triggers on data ready (INT1), 0 on period timer
+#define SMP_TEMP_BIT_POS				2			// Control - read temperature as well
+#define SMP_LEVEL_INT_BIT_POS		3			// Control - enable interrupt when level reached
+#define SMP_BUSY_BIT_POS				0			// Status - SPI sequence in progress
+#define SMP_NOT_EMPTY_BIT_POS		1			// Status - buffer holds at least one sample set
+#define SMP_LEVEL_BIT_POS				2			// Status - buffer holds at least Level sample sets
+#define SMP_OVERFLOW_BIT_POS		3			// Status - a sample set was lost, write 1 to clear
+#define SMP_LIMITED_BIT_POS			4			// Status - a filter output was limited to 16 bits, write 1 to clear
+#define SMP_RATIO_BIT_POS				0			// Filter - 8 bits: sample sets per stored set, minus 1
+#define SMP_SHIFT_BIT_POS				8			// Filter - 4 bits: average sum shift, or IIR coefficient 2^-shift
+#define SMP_IIR_BIT_POS					12		// Filter - 1 first-order IIR low-pass, 0 average
+#define SMP_BUFFER_SIZE					256		// sample sets in buffer
+
+// Simple names for the sampling engine registers
+#define SMP_CTL    (pt2SMP->Control)
+#define SMP_STS    (pt2SMP->Status)
+#define SMP_PERIOD (pt2SMP->Period)
+#define SMP_LEVEL  (pt2SMP->Level)
+#define SMP_COUNT  (pt2SMP->Count)
+#define SMP_DIV    (pt2SMP->ClkDiv)
+#define SMP_TIME   (pt2SMP->Time)
+#define SMP_FILTER (pt2SMP->Filter)
+
+
+// =================================================================
+// Struct for registers in arithmetic unit - word access only
+// Write A, then write B to one of the operation registers to start the operation.
+// Reads of the results wait until the operation has finished.
+typedef struct 
+{
+	volatile uint32  A;						// operand A
+	volatile uint32  B;						// operand B
+	volatile uint32  Status;			// read only
+	volatile uint32  Result;			// quotient, or saturated sum
+	volatile uint32  Remainder;
+	volatile uint32  AccLo;				// 64-bit accumulator
+	volatile uint32  AccHi;
+	volatile uint32  reserved7;
+	volatile uint32  UDiv;				// write B: unsigned divide A / B
+	volatile uint32  SDiv;				// write B: signed divide A / B
+	volatile uint32  UMac;				// write B: acc = acc + A * B, unsigned
+	volatile uint32  SMac;				// write B: acc = acc + A * B, signed
+	volatile uint32  SAdd;				// write B: result = A + B, signed, saturated
+} ARITH_block;
+// bit position defs for the arithmetic unit status register
+#define ARITH_BUSY_BIT_POS			0			// operation in progress
+#define ARITH_DIV_ZERO_BIT_POS	1			// last divide was by zero
+#define ARITH_SATURATED_BIT_POS	2			// last saturating add was limited
+
+
+// =================================================================
+// Struct for registers in CORDIC unit - word access only
+// Write the operands, then write any value to ATan2 or Tilt to start.
+// Angles are in hundredths of a degree.  Reads of the results wait until it has finished.
+typedef struct 
+{
+	volatile int32   X;						// operands, 16-bit signed
+	volatile int32   Y;
+	volatile int32   Z;
+	volatile uint32  Status;			// read only
+	volatile uint32  ATan2;				// write: angle = atan2(Y, X), magnitude of (X, Y)
+	volatile uint32  Tilt;				// write: pitch, roll and magnitude of (X, Y, Z)
+	volatile int32   Angle;
+	volatile uint32  Mag;
+	volatile int32   Pitch;
+	volatile int32   Roll;
+} CORDIC_block;
+// bit position defs for the CORDIC unit status register
+#define CORDIC_BUSY_BIT_POS			0			// operation in progress
+
+
+// =================================================================
+// Struct for registers in performance counters - word access only
+// Counters are cleared by reset, and count until frozen.
+#define PERF_SLAVES							13		// slaves 0 to 11, then unmapped addresses
+#define PERF_UNMAPPED						12		// index of the unmapped address counters
+typedef struct 
+{
+	volatile uint32  Control;
+	volatile uint32  Total;				// clock cycles
+	volatile uint32  Sleep;				// cycles with the processor sleeping
+	volatile uint32  Lockup;			// cycles with the processor in lockup
+	volatile uint32  Wait;				// cycles with a slave delaying the bus (HREADY low)
+	volatile uint32  Idle;				// cycles with no bus transaction starting
+	volatile uint32  reserved[10];
+	struct {
+		volatile uint32  Reads;
+		volatile uint32  Writes;
+	} Slave[PERF_SLAVES];					// transactions per slave, in AHBDCD order, then unmapped
+} PERF_block;
+// bit position defs for the performance counter control register
+#define PERF_FREEZE_BIT_POS			0			// 1 stops all counters
+#define PERF_CLEAR_BIT_POS			1			// write 1 to clear all counters
+
+
+// =================================================================
+// Struct for registers in DMA controller - word access only
+// Set up a channel, then write its control register with the enable bit set to start it.
+// The controller uses the bus only when the processor does not, so it is fastest
+// while the processor sleeps in __wfi().
+#define DMA_CHANNELS						2
+typedef struct 
+{
+	struct {
+		volatile uint32  Src;				// source address, next transfer
+		volatile uint32  Dst;				// destination address, next transfer
+		volatile uint32  Count;			// transfers still to do
+		volatile uint32  Control;
+	} Ch[DMA_CHANNELS];
+	volatile uint32  Status;			// done and busy bits for all channels
+} DMA_block;
+// bit position defs for the DMA channel control register
+#define DMA_ENABLE_BIT_POS			0			// write 1 to start, cleared when count reaches 0
+#define DMA_SIZE_BIT_POS				1			// 2 bits: transfer size, one of DMA_SIZE_...
+#define DMA_SRC_INC_BIT_POS			3			// increment source address after each transfer
+#define DMA_DST_INC_BIT_POS			4			// increment destination address
+#define DMA_INT_BIT_POS					5			// interrupt when done
+#define DMA_SRC_RELOAD_BIT_POS	6			// source address back to start after each burst
+#define DMA_REQ_BIT_POS					8			// 3 bits: request to wait for, one of DMA_REQ_...
+#define DMA_BURST_BIT_POS				12		// 4 bits: transfers per request, minus 1
+#define DMA_SIZE_BYTE						0
+#define DMA_SIZE_HALF						1
+#define DMA_SIZE_WORD						2
+#define DMA_REQ_NONE						0			// memory to memory, as fast as the bus allows
+#define DMA_REQ_UART_RX					1			// UART receive FIFO not empty
+#define DMA_REQ_UART_TX					2			// UART transmit FIFO not full
+#define DMA_REQ_SMP							3			// sampling engine buffer not empty
+// bit position defs for the DMA status register
+#define DMA_DONE_BIT_POS				0			// 1 bit per channel - count reached 0, write 1 to clear
+#define DMA_BUSY_BIT_POS				8			// 1 bit per channel - enabled
+
+// Simple name for the DMA status register
+#define DMA_STS    (pt2DMA->Status)
+
+
+// =================================================================
+// Struct for registers in the mailbox - word access only
+// Messages and semaphores between the two processors of the dual-core system.
+// In the single processor system it is still there, and CpuId reads 0.
+#define MBOX_SEMAPHORES					8
+typedef struct 
+{
+	volatile uint32  CpuId;				// read only: number of the processor reading, 0 or 1
+	volatile uint32  Status;			// read only: bit n = mailbox n full
+	volatile uint32  IntEnable;		// bit n = interrupt processor n while mailbox n is full
+	volatile uint32  reserved1;
+	volatile uint32  Mbox[2];			// message for processor n: write sets full, read clears it
+	volatile uint32  reserved2[2];
+	volatile uint32  Sem[MBOX_SEMAPHORES];	// read 0 = taken by this processor, 1 = busy; write frees
+} MBOX_block;
+
+
 //=================================================
 // Struct for some of the SysTick timer registers - word access only
 typedef struct
@@ -144,15 +394,44 @@ typedef struct {
 
 
 #define NVIC_UART_BIT_POS		1      // bit position of UART in ARM's interrupt control register
+#define NVIC_ACL_BIT_POS		2      // bit position of accelerometer interrupt (from SPI block)
+#define NVIC_SMP_BIT_POS		3      // bit position of accelerometer sampling engine interrupt
+#define NVIC_GPIO_BIT_POS		4      // bit position of GPIO input event interrupt
+#define NVIC_DMA_BIT_POS		5      // bit position of DMA controller interrupt
+#define NVIC_MBOX_BIT_POS		6      // bit position of mailbox interrupt (each processor has its own)
+
+
+// =================================================================
+// Display registers as words - DISPLAY_BASE is in the memory map below
+// A word write to DISPLAY_CONTROL sets the modes (bits 7:0), enables (bits 15:8) and control
+#define DISPLAY_DIGITS_LO (*(volatile uint32 *)(DISPLAY_BASE + 0x0))	// digits 3 to 0, digit 0 in bits 7:0
+#define DISPLAY_DIGITS_HI (*(volatile uint32 *)(DISPLAY_BASE + 0x4))	// digits 7 to 4
+#define DISPLAY_CONTROL   (*(volatile uint32 *)(DISPLAY_BASE + 0x8))	// modes, enables and control
+// bit position defs for the display control byte, in the DISPLAY_CONTROL word
+#define DISPLAY_BUFFERED_BIT_POS	16		// 1 - writes go to the shadow bank until commit
+#define DISPLAY_COMMIT_BIT_POS		17		// write 1 to show the shadow bank
 
 
 // =================================================================
 // Use the typedefs above to define the memory map
+#ifdef HOST_BUILD
+#include "host_hal.h"
+#else
 #define pt2NVIC ((NVIC_block *)0xE000E100)
 #define pt2SysTick  ((SysTick_block *) 0xE000E010)
 #define pt2UART ((UART_block *)0x51000000)
 #define pt2GPIO ((GPIO_block *)0x50000000)
 #define DISPLAY_BASE (0x52000000)
+#define DISPLAY_NUMBER (*(volatile int32 *)(DISPLAY_BASE + 0xC))	// signed number, shown in decimal
+#define DISPLAY_DECIMALS (*(volatile uint32 *)(DISPLAY_BASE + 0x10))	// digits after the point, 0 to 7
+#define pt2SPI ((SPI_block *)0x53000000)
+#define pt2SMP ((SMP_block *)0x54000000)
+#define pt2ARITH ((ARITH_block *)0x55000000)
+#define pt2PERF ((PERF_block *)0x56000000)
+#define pt2DMA ((DMA_block *)0x57000000)
+#define pt2MBOX ((MBOX_block *)0x58000000)
+#define pt2CORDIC ((CORDIC_block *)0x59000000)
+#endif
 
 
 
@@ -0,0 +1,98 @@
+/*  Functions to access the ADXL362 accelerometer through the SPI driver.
+	Register data is read in bursts, using the auto-increment feature of the
+	ADXL362, and the on-chip FIFO can be drained with one command, so one
+	SPI transaction gets many samples.  */
+
+#include "adxl362.h"
+#include "spi.h"				// SPI driver
+
+static uint8 fifoSetWords = 3;		// FIFO entries per sample set: 3, or 4 with temperature
+
+// function to read from accelerometer
+int16 AccRead(uint8 address) {        // takes in a value and calls it 'address'
+	uint8 byteRXL;
+	uint8 byteRXH;
+	SPIselect(ACL);											// sets CS low to start SPI transaction
+	SPIbyte(ADXL_READ_REG);							// sends read instruction
+	SPIbyte(address);										// sends address
+	byteRXL = SPIbyte(0xFF);						// gets reg data (sends junk) 
+	byteRXH = SPIbyte(0xFF);						// gets reg data, high byte. will read next address automatically.
+	SPIselect(NONE);										// sets CS high to end SPI transaction
+	return (int16)(byteRXL | (byteRXH << 8)); // shift high bytes to left and add low bytes
+}
+
+// function to write to accelerometer
+void AccWrite(uint8 address, uint8 byteTX) {
+	SPIselect(ACL);							// sets CS low to start SPI transaction
+	SPIbyte(ADXL_WRITE_REG);		// sends write instruction
+	SPIbyte(address);						// sends address
+	SPIbyte(byteTX);						// sends byte
+	SPIselect(NONE);
+}
+
+// Read 16-bit value, low byte first, in the middle of a transaction
+static int16 AccNext16(void) {
+	uint8 lo = SPIbyte(0xFF);
+	uint8 hi = SPIbyte(0xFF);
+	return (int16)(lo | (hi << 8));
+}
+
+// Read all 8 data registers in a single transaction
+void AccReadAll(AccSample *sample) {
+	SPIselect(ACL);
+	SPIbyte(ADXL_READ_REG);
+	SPIbyte(ADXL_XDATA_L);			// address increments through Y, Z and temperature
+	sample->x = AccNext16();
+	sample->y = AccNext16();
+	sample->z = AccNext16();
+	sample->temp = AccNext16();
+	SPIselect(NONE);
+}
+
+// Configure the FIFO in stream mode
+void AccFifoStart(uint16 watermark, uint8 withTemp) {
+	uint8 control = ADXL_FIFO_STREAM;
+	if (watermark & 0x100) control |= ADXL_FIFO_AH;		// ninth bit of watermark
+	if (withTemp) control |= ADXL_FIFO_TEMP;
+	fifoSetWords = withTemp ? 4 : 3;
+	AccWrite(ADXL_FIFO_SAMPLES, watermark & 0xFF);
+	AccWrite(ADXL_FIFO_CONTROL, control);
+}
+
+uint16 AccFifoEntries(void) {
+	return AccRead(ADXL_FIFO_ENTRIES_L) & 0x3FF;			// 10-bit count
+}
+
+// Drain complete sample sets from the FIFO.  Each entry has the axis in
+// bits 15:14 and a 14-bit sign-extended value in bits 13:0.
+uint16 AccFifoRead(AccSample *buf, uint16 maxSets) {
+	uint16 sets, words, i;
+	uint16 n = 0;					// sets stored so far
+	int16 entry, value;
+
+	sets = AccFifoEntries() / fifoSetWords;	// leave any partial set in the FIFO
+	if (sets > maxSets) sets = maxSets;
+	words = sets * fifoSetWords;
+	if (words == 0) return 0;
+
+	SPIselect(ACL);
+	SPIbyte(ADXL_READ_FIFO);
+	for (i = 0; i < words && n < sets; i++) {
+		entry = AccNext16();
+		value = (int16)(entry << 2) >> 2;		// remove axis tag, keep sign
+		switch ((uint16)entry >> ADXL_FIFO_TAG_POS) {
+			case 0:	buf[n].x = value; break;
+			case 1:	buf[n].y = value; break;
+			case 2:
+				buf[n].z = value;
+				if (fifoSetWords == 3) n++;		// set complete if no temperature
+				break;
+			default:
+				buf[n].temp = value;
+				n++;											// temperature is last in the set
+				break;
+		}
+	}
+	SPIselect(NONE);
+	return n;
+}
@@ -0,0 +1,72 @@
+/* adxl362.h
+	Functions to access the ADXL362 accelerometer through the SPI driver.
+	Register addresses and bit values are from the ADXL362 data sheet.  */
+
+#ifndef ADXL362_HDR_ALREADY_INCLUDED
+#define ADXL362_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+
+// ADXL362 SPI commands
+#define ADXL_WRITE_REG			0x0A		// write register(s), address auto-increments
+#define ADXL_READ_REG				0x0B		// read register(s), address auto-increments
+#define ADXL_READ_FIFO			0x0D		// read FIFO, 2 bytes per entry
+
+// ADXL362 register addresses
+#define ADXL_FIFO_ENTRIES_L	0x0C		// number of valid entries in FIFO, 10 bits
+#define ADXL_XDATA_L				0x0E		// first of 8 data registers: X, Y, Z, temperature
+#define ADXL_YDATA_L				0x10
+#define ADXL_ZDATA_L				0x12
+#define ADXL_TEMP_L					0x14
+#define ADXL_FIFO_CONTROL		0x28
+#define ADXL_FIFO_SAMPLES		0x29		// FIFO watermark, 8 LSBs
+#define ADXL_INTMAP1				0x2A		// selects events that drive the INT1 pin
+#define ADXL_INTMAP2				0x2B		// selects events that drive the INT2 pin
+#define ADXL_FILTER_CTL			0x2C
+#define ADXL_POWER_CTL			0x2D
+
+// Bit values for the control registers
+#define ADXL_FIFO_STREAM		0x02		// FIFO_CONTROL: stream mode, oldest entries overwritten
+#define ADXL_FIFO_TEMP			0x04		// FIFO_CONTROL: store temperature with each sample set
+#define ADXL_FIFO_AH				0x08		// FIFO_CONTROL: bit 8 of the watermark
+#define ADXL_INT_DATA_READY	0x01		// INTMAP: new sample set in data registers
+#define ADXL_INT_FIFO_WATERMARK	0x04	// INTMAP: FIFO holds at least the watermark number of entries
+#define ADXL_INT_FIFO_OVERRUN	0x08	// INTMAP: FIFO has overflowed
+#define ADXL_ODR_25HZ				0x01		// FILTER_CTL: output data rate
+#define ADXL_ODR_100HZ			0x03
+#define ADXL_ODR_400HZ			0x05
+#define ADXL_HALF_BW				0x10		// FILTER_CTL: anti-aliasing filter at ODR/4
+#define ADXL_MEASURE				0x02		// POWER_CTL: measurement mode
+
+#define ADXL_FIFO_WORDS			512			// FIFO size in 16-bit entries
+#define ADXL_FIFO_TAG_POS		14			// FIFO entries have the axis in the 2 MSBs
+
+// One sample set - acceleration in mg (range +/- 2 g) and temperature
+typedef struct {
+	int16 x;
+	int16 y;
+	int16 z;
+	int16 temp;
+} AccSample;
+
+// Read a 16-bit value from a pair of registers, low byte first
+int16 AccRead(uint8 address);
+
+// Write one register
+void AccWrite(uint8 address, uint8 byteTX);
+
+// Read X, Y, Z and temperature in one transaction (8 registers, auto-increment)
+void AccReadAll(AccSample *sample);
+
+/* Put the FIFO in stream mode, holding sample sets of X, Y, Z and optionally temperature.
+   The watermark is the number of FIFO entries (not sets), used for the interrupt pins. */
+void AccFifoStart(uint16 watermark, uint8 withTemp);
+
+// Number of 16-bit entries waiting in the FIFO
+uint16 AccFifoEntries(void);
+
+/* Read all complete sample sets from the FIFO into the array, up to maxSets.
+   Returns the number of sets stored. */
+uint16 AccFifoRead(AccSample *buf, uint16 maxSets);
+
+#endif
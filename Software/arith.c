@@ -0,0 +1,47 @@
+/*  Functions for the arithmetic unit - see arith.h
+	Each operation is a write of A, a write of B to the operation register, and a
+	read of the result, which waits until the hardware has finished.  */
+
+#include <stddef.h>					// NULL
+#include "arith.h"
+
+uint32 ArithUDiv(uint32 a, uint32 b, uint32 *rem) {
+	pt2ARITH->A = a;
+	pt2ARITH->UDiv = b;							// starts the divide
+	if (rem != NULL) *rem = pt2ARITH->Remainder;
+	return pt2ARITH->Result;
+}
+
+int32 ArithSDiv(int32 a, int32 b, int32 *rem) {
+	pt2ARITH->A = (uint32)a;
+	pt2ARITH->SDiv = (uint32)b;			// starts the divide
+	if (rem != NULL) *rem = (int32)pt2ARITH->Remainder;
+	return (int32)pt2ARITH->Result;
+}
+
+int32 ArithSatAdd(int32 a, int32 b) {
+	pt2ARITH->A = (uint32)a;
+	pt2ARITH->SAdd = (uint32)b;
+	return (int32)pt2ARITH->Result;
+}
+
+void ArithMacClear(void) {
+	pt2ARITH->AccLo = 0;
+	pt2ARITH->AccHi = 0;
+}
+
+void ArithSMac(int32 a, int32 b) {
+	pt2ARITH->A = (uint32)a;
+	pt2ARITH->SMac = (uint32)b;			// next access to the unit waits if still adding
+}
+
+void ArithUMac(uint32 a, uint32 b) {
+	pt2ARITH->A = a;
+	pt2ARITH->UMac = b;
+}
+
+signed long long ArithAcc(void) {
+	uint32 lo = pt2ARITH->AccLo;				// waits for any multiply-accumulate to finish
+	uint32 hi = pt2ARITH->AccHi;
+	return (signed long long)(((unsigned long long)hi << 32) | lo);
+}
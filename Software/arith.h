@@ -0,0 +1,33 @@
+/* arith.h
+	Functions for the arithmetic unit (AHBarith), which does 32-bit divide, 64-bit
+	multiply-accumulate and saturating add in hardware.  The Cortex-M0 has no divide
+	instruction, so a / b in C calls a library routine (__aeabi_idiv or __aeabi_uidiv)
+	taking around 100 clock cycles or more; the hardware divide takes about 40.
+	The arithmetic unit is shared: if it is used in an interrupt service routine as
+	well as in main(), main() must disable that interrupt around each call.  */
+
+#ifndef ARITH_HDR_ALREADY_INCLUDED
+#define ARITH_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+
+// Unsigned divide: returns a / b, and stores a % b if rem is not NULL
+uint32 ArithUDiv(uint32 a, uint32 b, uint32 *rem);
+
+// Signed divide, rounding towards zero like C: returns a / b, stores a % b if rem is not NULL
+int32 ArithSDiv(int32 a, int32 b, int32 *rem);
+
+// Signed add, limited to the int32 range instead of wrapping round
+int32 ArithSatAdd(int32 a, int32 b);
+
+// Set the 64-bit accumulator to 0
+void ArithMacClear(void);
+
+// Add a * b to the accumulator, signed or unsigned
+void ArithSMac(int32 a, int32 b);
+void ArithUMac(uint32 a, uint32 b);
+
+// Read the accumulator
+signed long long ArithAcc(void);
+
+#endif
@@ -0,0 +1,270 @@
+/*  Cycle-count benchmarks - see bench.h
+	SysTick is used as a free-running 24-bit down-counter with no interrupt, so this
+	should not be used by a program that needs the SysTick interrupt.  Interrupts are
+	disabled while each loop is timed, so the counts do not include interrupt service.
+	The SysTick control register is restored at the end, so the counter keeps running
+	for the profiler in prof.h, if it was.  */
+
+#include <stdio.h>
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "arith.h"					// arithmetic unit
+#include "dma.h"						// DMA controller
+#include "cordic.h"					// CORDIC unit
+#include "bench.h"
+
+#define BENCH_N							64				// operations in each timed loop
+#define SYSTICK_MASK				0xFFFFFF	// SysTick counter is 24 bits
+#define BENCH_WORDS					256				// words in each timed copy
+#define CORDIC_TOLERANCE		5					// hundredths of a degree allowed between the two
+
+static int32 benchA[BENCH_N], benchB[BENCH_N];		// test operands
+static int32 swQ[BENCH_N], swR[BENCH_N];					// results from the C library
+static int32 hwQ[BENCH_N], hwR[BENCH_N];					// results from the arithmetic unit
+static uint32 copySrc[BENCH_WORDS], copyDst[BENCH_WORDS];	// copy benchmark buffers
+static AccSample benchSet[BENCH_N];										// CORDIC benchmark operands
+static Tilt swTilt[BENCH_N], hwTilt[BENCH_N];
+
+// Start the SysTick counter running from the maximum value, return the start count
+static uint32 benchStart(void) {
+	SysTick_Reload = SYSTICK_MASK;
+	SysTick_Counter = 0;								// any write clears the counter, then it reloads
+	SysTick_Control = (1 << SYSTICK_ENABLE_BIT_POS) | (1 << SYSTICK_CLOCK_SOURCE_BIT_POS);
+	return SysTick_Counter;
+}
+
+// Clock cycles since benchStart - the counter counts down
+static uint32 benchCycles(uint32 start) {
+	return (start - SysTick_Counter) & SYSTICK_MASK;
+}
+
+// Fill the operand arrays with pseudo-random values, both signs, no zero divisors
+static void benchFill(void) {
+	uint32 seed = 12345;
+	int i;
+	for (i = 0; i < BENCH_N; i++) {
+		seed = seed * 1103515245 + 12345;
+		benchA[i] = (int32)seed;
+		seed = seed * 1103515245 + 12345;
+		benchB[i] = (int32)(seed >> (seed & 15));		// divisors of various sizes
+		if (benchB[i] == 0) benchB[i] = 7;
+	}
+	benchA[0] = -2147483647 - 1;							// edge cases
+	benchB[0] = 3;
+	benchA[1] = 1000;
+	benchB[1] = -7;
+}
+
+// Count differences between the two sets of results
+static int benchCompare(int n) {
+	int i, errors = 0;
+	for (i = 0; i < n; i++)
+		if (swQ[i] != hwQ[i] || swR[i] != hwR[i]) errors++;
+	return errors;
+}
+
+static void benchReport(const char *name, uint32 swCycles, uint32 hwCycles, int errors) {
+	printf("%-10s library %4u  hardware %4u cycles/op  %d mismatches\n",
+		name, swCycles / BENCH_N, hwCycles / BENCH_N, errors);
+}
+
+void BenchArith(void) {
+	int i;
+	uint32 start, swCycles, hwCycles;
+	signed long long swAcc;
+	int32 sum;
+	uint32 control = SysTick_Control & ((1 << SYSTICK_ENABLE_BIT_POS) |
+		(1 << SYSTICK_INTERRUPT_BIT_POS) | (1 << SYSTICK_CLOCK_SOURCE_BIT_POS));
+
+	benchFill();
+	printf("\nArithmetic benchmark, %d operations each\n", BENCH_N);
+
+	// Signed divide and remainder
+	__disable_irq();
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++) {
+		swQ[i] = benchA[i] / benchB[i];					// __aeabi_idivmod
+		swR[i] = benchA[i] % benchB[i];
+	}
+	swCycles = benchCycles(start);
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++)
+		hwQ[i] = ArithSDiv(benchA[i], benchB[i], &hwR[i]);
+	hwCycles = benchCycles(start);
+	__enable_irq();
+	benchReport("sdiv+mod", swCycles, hwCycles, benchCompare(BENCH_N));
+
+	// Unsigned divide and remainder
+	__disable_irq();
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++) {
+		swQ[i] = (uint32)benchA[i] / (uint32)benchB[i];		// __aeabi_uidivmod
+		swR[i] = (uint32)benchA[i] % (uint32)benchB[i];
+	}
+	swCycles = benchCycles(start);
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++)
+		hwQ[i] = ArithUDiv(benchA[i], benchB[i], (uint32 *)&hwR[i]);
+	hwCycles = benchCycles(start);
+	__enable_irq();
+	benchReport("udiv+mod", swCycles, hwCycles, benchCompare(BENCH_N));
+
+	// Signed multiply-accumulate, 64 bits
+	__disable_irq();
+	start = benchStart();
+	swAcc = 0;
+	for (i = 0; i < BENCH_N; i++)
+		swAcc += (signed long long)benchA[i] * benchB[i];		// __aeabi_lmul
+	swCycles = benchCycles(start);
+	start = benchStart();
+	ArithMacClear();
+	for (i = 0; i < BENCH_N; i++)
+		ArithSMac(benchA[i], benchB[i]);
+	hwQ[0] = (int32)(ArithAcc() >> 32);
+	hwCycles = benchCycles(start);
+	__enable_irq();
+	swQ[0] = (int32)(swAcc >> 32);
+	swR[0] = hwR[0] = 0;
+	benchReport("smac", swCycles, hwCycles, (benchCompare(1) || ArithAcc() != swAcc) ? 1 : 0);
+
+	// Saturating add
+	__disable_irq();
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++) {
+		sum = (int32)((uint32)benchA[i] + (uint32)benchB[i]);
+		if (benchA[i] >= 0 && benchB[i] >= 0 && sum < 0) sum = 0x7FFFFFFF;
+		else if (benchA[i] < 0 && benchB[i] < 0 && sum >= 0) sum = -2147483647 - 1;
+		swQ[i] = sum;
+	}
+	swCycles = benchCycles(start);
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++)
+		hwQ[i] = ArithSatAdd(benchA[i], benchB[i]);
+	hwCycles = benchCycles(start);
+	__enable_irq();
+	for (i = 0; i < BENCH_N; i++) swR[i] = hwR[i] = 0;
+	benchReport("sat add", swCycles, hwCycles, benchCompare(BENCH_N));
+
+	SysTick_Control = control;						// stop the counter, unless it was running before
+}
+
+// Fill the destination with a value that is not in the source, to catch missed words
+static void copyClear(void) {
+	int i;
+	for (i = 0; i < BENCH_WORDS; i++) copyDst[i] = 0xDEADBEEF;
+}
+
+static int copyCompare(void) {
+	int i, errors = 0;
+	for (i = 0; i < BENCH_WORDS; i++)
+		if (copyDst[i] != copySrc[i]) errors++;
+	return errors;
+}
+
+static void copyReport(const char *name, uint32 cycles, int errors) {
+	printf("%-10s %6u cycles  %u.%02u cycles/word  %d mismatches\n",
+		name, cycles, cycles / BENCH_WORDS, (cycles % BENCH_WORDS) * 100 / BENCH_WORDS, errors);
+}
+
+/* The DMA copies run with interrupts disabled, like the loops above.  The done interrupt
+   still wakes the processor, and DMA_ISR runs once interrupts are enabled again.  */
+void BenchDma(void) {
+	int i;
+	uint32 start, cycles;
+	uint32 control = SysTick_Control & ((1 << SYSTICK_ENABLE_BIT_POS) |
+		(1 << SYSTICK_INTERRUPT_BIT_POS) | (1 << SYSTICK_CLOCK_SOURCE_BIT_POS));
+
+	for (i = 0; i < BENCH_WORDS; i++) copySrc[i] = (uint32)i * 0x01010101u + 0x12345678u;
+	printf("\nCopy benchmark, %d words\n", BENCH_WORDS);
+
+	// Processor copy loop
+	copyClear();
+	__disable_irq();
+	start = benchStart();
+	for (i = 0; i < BENCH_WORDS; i++)
+		copyDst[i] = copySrc[i];
+	cycles = benchCycles(start);
+	__enable_irq();
+	copyReport("cpu loop", cycles, copyCompare());
+
+	// DMA, processor asleep until the done interrupt
+	copyClear();
+	__disable_irq();
+	start = benchStart();
+	DmaCopy(copyDst, copySrc, BENCH_WORDS);
+	cycles = benchCycles(start);
+	__enable_irq();
+	copyReport("dma sleep", cycles, copyCompare());
+
+	// DMA, processor polling - the polling loop competes for the bus
+	copyClear();
+	__disable_irq();
+	start = benchStart();
+	DmaStart(0, copySrc, copyDst, BENCH_WORDS, (DMA_SIZE_WORD << DMA_SIZE_BIT_POS) |
+		(1 << DMA_SRC_INC_BIT_POS) | (1 << DMA_DST_INC_BIT_POS));
+	DmaWait(0);
+	cycles = benchCycles(start);
+	__enable_irq();
+	copyReport("dma poll", cycles, copyCompare());
+
+	SysTick_Control = control;						// stop the counter, unless it was running before
+}
+
+// Angles within CORDIC_TOLERANCE, magnitudes within 1 - the results are rounded differently
+static int cordicMismatch(int32 swAngle, int32 hwAngle, int32 swMag, int32 hwMag) {
+	int32 d = swAngle - hwAngle;
+	if (d > 18000) d -= 36000;						// -18000 and 18000 are the same angle
+	else if (d < -18000) d += 36000;
+	return d > CORDIC_TOLERANCE || d < -CORDIC_TOLERANCE || swMag - hwMag > 1 || hwMag - swMag > 1;
+}
+
+void BenchCordic(void) {
+	int i, errors;
+	uint32 start, swCycles, hwCycles;
+	uint32 control = SysTick_Control & ((1 << SYSTICK_ENABLE_BIT_POS) |
+		(1 << SYSTICK_INTERRUPT_BIT_POS) | (1 << SYSTICK_CLOCK_SOURCE_BIT_POS));
+
+	// Sample sets of all sizes and directions, and a board lying flat
+	benchFill();
+	for (i = 0; i < BENCH_N; i++) {
+		benchSet[i].x = (int16)benchA[i];
+		benchSet[i].y = (int16)(benchA[i] >> 16);
+		benchSet[i].z = (int16)benchB[i];
+	}
+	benchSet[0].x = 0;
+	benchSet[0].y = 0;
+	benchSet[0].z = 1000;
+	printf("\nCORDIC benchmark, %d operations each\n", BENCH_N);
+
+	// Angle and magnitude of (x, y)
+	__disable_irq();
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++)
+		swQ[i] = SoftAtan2(benchSet[i].y, benchSet[i].x, &swTilt[i].mag);		// atan2f, sqrtf
+	swCycles = benchCycles(start);
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++)
+		hwQ[i] = CordicAtan2(benchSet[i].y, benchSet[i].x, &hwTilt[i].mag);
+	hwCycles = benchCycles(start);
+	__enable_irq();
+	for (i = errors = 0; i < BENCH_N; i++)
+		errors += cordicMismatch(swQ[i], hwQ[i], swTilt[i].mag, hwTilt[i].mag);
+	benchReport("atan2+mag", swCycles, hwCycles, errors);
+
+	// Tilt angles and magnitude of (x, y, z)
+	__disable_irq();
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++)
+		SoftTilt(&benchSet[i], &swTilt[i]);
+	swCycles = benchCycles(start);
+	start = benchStart();
+	for (i = 0; i < BENCH_N; i++)
+		CordicTilt(&benchSet[i], &hwTilt[i]);
+	hwCycles = benchCycles(start);
+	__enable_irq();
+	for (i = errors = 0; i < BENCH_N; i++)
+		errors += cordicMismatch(swTilt[i].pitch, hwTilt[i].pitch, swTilt[i].mag, hwTilt[i].mag) |
+			cordicMismatch(swTilt[i].roll, hwTilt[i].roll, 0, 0);
+	benchReport("tilt", swCycles, hwCycles, errors);
+
+	SysTick_Control = control;						// stop the counter, unless it was running before
+}
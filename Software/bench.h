@@ -0,0 +1,20 @@
+/* bench.h
+	Cycle-count benchmarks, timed with the SysTick timer counting processor clock
+	cycles.  Results are printed through the UART.  */
+
+#ifndef BENCH_HDR_ALREADY_INCLUDED
+#define BENCH_HDR_ALREADY_INCLUDED
+
+// Compare the arithmetic unit with the C library routines for divide, 64-bit
+// multiply-accumulate and saturating add, and check that the results agree
+void BenchArith(void);
+
+// Compare a word copy by the processor with the DMA controller, with the processor
+// asleep and with it polling the busy bit, and check the copies
+void BenchDma(void);
+
+// Compare the CORDIC unit with atan2f and sqrtf from the C library, for the angle and
+// magnitude of a vector and for the tilt of a sample set, and check that they agree
+void BenchCordic(void);
+
+#endif
@@ -3,6 +3,8 @@
 
 Stack_Size      EQU     0x00000400		; 1KB of STACK
 Stack_Top		EQU		0x20003FFC		; top of stack at top of 16 KByte RAM
+Core1_Stack_Top	EQU		0x10003FFC		; processor 1 of the dual-core system - top of its private RAM
+MBOX_CPUID		EQU		0x58000000		; mailbox CPU ID register - 0 in the single processor system
 Heap_Size       EQU     0x00000400 		; 1KB of HEAP
 	
                 AREA    STACK, NOINIT, READWRITE, ALIGN=4
@@ -43,11 +45,11 @@ __Vectors    	DCD		Stack_Top			; Initial Stack Pointer
 				; External Interrupts
 				DCD		0					; IRQn value 0  
 				DCD		UART_Handler		; IRQn value 1
-				DCD		0					; IRQn value 2
-				DCD		0
-				DCD		0
-				DCD		0
-				DCD		0
+				DCD		Acc_Handler			; IRQn value 2
+				DCD		Sampler_Handler		; IRQn value 3
+				DCD		GPIO_Handler		; IRQn value 4
+				DCD		DMA_Handler			; IRQn value 5
+				DCD		Mailbox_Handler		; IRQn value 6
 				DCD		0
 				DCD		0
 				DCD		0
@@ -61,12 +63,30 @@ __Vectors    	DCD		Stack_Top			; Initial Stack Pointer
               
                 AREA |.text|, CODE, READONLY
 ;Reset Handler
+;Both processors of the dual-core system start here.  Processor 1 does not run the C library
+;start-up: it takes its stack in its private RAM and goes to Core1_main, or sleeps for ever
+;if the program has no Core1_main.
 Reset_Handler   PROC
                 GLOBAL Reset_Handler
                 ENTRY
 				IMPORT  __main
+				IMPORT	Core1_main [WEAK]		; only in a dual-core program, 0 if not there
+				LDR		R0, =MBOX_CPUID
+				LDR		R0, [R0]				; which processor is this?
+				CMP		R0, #1
+				BEQ		Core1_Start
                 LDR     R0, =__main               
                 BX      R0                        ;Branch to __main
+Core1_Start
+				LDR		R0, =Core1_Stack_Top
+				MOV		SP, R0
+				LDR		R0, =Core1_main
+				CMP		R0, #0
+				BEQ		Core1_Idle
+				BX		R0						;Branch to Core1_main
+Core1_Idle
+				WFI								;no interrupts are enabled, so sleeps for ever
+				B		Core1_Idle
                 ENDP
 
 SysTick_Handler PROC
@@ -86,6 +106,46 @@ UART_Handler    PROC
                 POP     {R0,R1,R2,PC}
                 ENDP
 
+Acc_Handler     PROC
+                EXPORT 	Acc_Handler
+				IMPORT 	Acc_ISR
+                PUSH    {R0,R1,R2,LR}
+				BL 		Acc_ISR
+                POP     {R0,R1,R2,PC}
+                ENDP
+
+Sampler_Handler PROC
+                EXPORT 	Sampler_Handler
+				IMPORT 	Sampler_ISR
+                PUSH    {R0,R1,R2,LR}
+				BL 		Sampler_ISR
+                POP     {R0,R1,R2,PC}
+                ENDP
+
+GPIO_Handler    PROC
+                EXPORT 	GPIO_Handler
+				IMPORT 	GPIO_ISR
+                PUSH    {R0,R1,R2,LR}
+				BL 		GPIO_ISR
+                POP     {R0,R1,R2,PC}
+                ENDP
+
+DMA_Handler     PROC
+                EXPORT 	DMA_Handler
+				IMPORT 	DMA_ISR
+                PUSH    {R0,R1,R2,LR}
+				BL 		DMA_ISR
+                POP     {R0,R1,R2,PC}
+                ENDP
+
+Mailbox_Handler PROC
+                EXPORT 	Mailbox_Handler
+				IMPORT 	Mailbox_ISR
+                PUSH    {R0,R1,R2,LR}
+				BL 		Mailbox_ISR
+                POP     {R0,R1,R2,PC}
+                ENDP
+
 				ALIGN 	4					 ; Align to a word boundary
 
 ; User Initial Stack & Heap
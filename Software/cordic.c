@@ -0,0 +1,46 @@
+/*  Functions for the CORDIC unit - see cordic.h
+	Each operation is writes of the operands, a write to the operation register, and
+	reads of the results, which wait until the hardware has finished.  */
+
+#include <stddef.h>					// NULL
+#include <math.h>						// atan2f, sqrtf
+#include "cordic.h"
+
+#define CENTIDEG_PER_RADIAN		(18000.0f / 3.14159265f)
+
+int16 CordicAtan2(int16 y, int16 x, uint16 *mag) {
+	pt2CORDIC->X = x;
+	pt2CORDIC->Y = y;
+	pt2CORDIC->ATan2 = 0;						// starts the operation
+	if (mag != NULL) *mag = (uint16)pt2CORDIC->Mag;
+	return (int16)pt2CORDIC->Angle;
+}
+
+void CordicTilt(const AccSample *s, Tilt *t) {
+	pt2CORDIC->X = s->x;
+	pt2CORDIC->Y = s->y;
+	pt2CORDIC->Z = s->z;
+	pt2CORDIC->Tilt = 0;
+	t->pitch = (int16)pt2CORDIC->Pitch;
+	t->roll = (int16)pt2CORDIC->Roll;
+	t->mag = (uint16)pt2CORDIC->Mag;
+}
+
+// nearest integer, halves away from zero, as the hardware rounds
+static int32 softRound(float v) {
+	return (int32)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+int16 SoftAtan2(int16 y, int16 x, uint16 *mag) {
+	float fx = x, fy = y;
+	if (mag != NULL) *mag = (uint16)softRound(sqrtf(fx * fx + fy * fy));
+	return (int16)softRound(atan2f(fy, fx) * CENTIDEG_PER_RADIAN);
+}
+
+void SoftTilt(const AccSample *s, Tilt *t) {
+	float fx = s->x, fy = s->y, fz = s->z;
+	float yz = sqrtf(fy * fy + fz * fz);
+	t->pitch = (int16)softRound(atan2f(fx, yz) * CENTIDEG_PER_RADIAN);
+	t->roll = (int16)softRound(atan2f(fy, fz) * CENTIDEG_PER_RADIAN);
+	t->mag = (uint16)softRound(sqrtf(fx * fx + yz * yz));
+}
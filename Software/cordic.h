@@ -0,0 +1,36 @@
+/* cordic.h
+	Functions for the CORDIC unit (AHBcordic), which finds the angle and length of a
+	vector, and the tilt of the board from an accelerometer sample set, in hardware.
+	The Cortex-M0 has no floating point and no divide, so atan2f() and sqrtf() from
+	the C library take thousands of clock cycles; the hardware takes 17 (atan2) or
+	34 (tilt), plus the register accesses.  Angles are in hundredths of a degree,
+	within 0.05 degree of the exact value for vectors longer than 16.
+	The software versions, using the C library, are here too, for comparison.
+	The CORDIC unit is shared: if it is used in an interrupt service routine as well
+	as in main(), main() must disable that interrupt around each call.  */
+
+#ifndef CORDIC_HDR_ALREADY_INCLUDED
+#define CORDIC_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "adxl362.h"				// AccSample
+
+// Tilt of the board, from the direction of gravity in a sample set
+typedef struct {
+	int16  pitch;							// nose up or down, about the Y axis, -9000 to 9000
+	int16  roll;							// about the X axis, -18000 to 18000, 0 when level
+	uint16 mag;								// length of the acceleration vector, in mg
+} Tilt;
+
+// Angle of the vector (x, y) from the X axis, -18000 to 18000 - stores its length
+// if mag is not NULL.  The angle of (0, 0) is 0.
+int16 CordicAtan2(int16 y, int16 x, uint16 *mag);
+
+// Tilt angles and magnitude of a sample set
+void CordicTilt(const AccSample *s, Tilt *t);
+
+// The same, in software with the C library floating point functions
+int16 SoftAtan2(int16 y, int16 x, uint16 *mag);
+void SoftTilt(const AccSample *s, Tilt *t);
+
+#endif
@@ -0,0 +1,42 @@
+/*  Functions for the DMA controller - see dma.h
+	Addresses are given to the hardware as 32-bit values.  */
+
+#include <stdint.h>					// uintptr_t
+#include "dma.h"
+
+void DmaStart(uint32 ch, const volatile void *src, volatile void *dst, uint32 count, uint32 control) {
+	pt2DMA->Ch[ch].Src = (uint32)(uintptr_t)src;
+	pt2DMA->Ch[ch].Dst = (uint32)(uintptr_t)dst;
+	pt2DMA->Ch[ch].Count = count;
+	pt2DMA->Ch[ch].Control = control | (1 << DMA_ENABLE_BIT_POS);	// starts, and clears done
+}
+
+uint32 DmaBusy(uint32 ch) {
+	return pt2DMA->Ch[ch].Control & (1 << DMA_ENABLE_BIT_POS);
+}
+
+void DmaStop(uint32 ch) {
+	pt2DMA->Ch[ch].Control &= ~(1 << DMA_ENABLE_BIT_POS);
+}
+
+/* Interrupts are disabled around the test and the sleep, so the done interrupt cannot
+   be taken in between and leave the processor asleep.  A pending interrupt still wakes
+   the processor from __wfi() with interrupts disabled, and DMA_ISR runs afterwards.  */
+void DmaWait(uint32 ch) {
+	int masked;
+	if (!(pt2DMA->Ch[ch].Control & (1 << DMA_INT_BIT_POS))) {
+		while (DmaBusy(ch)) ;
+		return;
+	}
+	masked = __disable_irq();
+	while (DmaBusy(ch))
+		__wfi();
+	if (!masked) __enable_irq();		// restore previous interrupt state
+}
+
+void DmaCopy(uint32 *dst, const uint32 *src, uint32 words) {
+	if (words == 0) return;
+	DmaStart(0, src, dst, words, (DMA_SIZE_WORD << DMA_SIZE_BIT_POS) | (1 << DMA_SRC_INC_BIT_POS) |
+		(1 << DMA_DST_INC_BIT_POS) | (1 << DMA_INT_BIT_POS) | (DMA_REQ_NONE << DMA_REQ_BIT_POS));
+	DmaWait(0);
+}
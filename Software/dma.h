@@ -0,0 +1,34 @@
+/* dma.h
+	Functions for the DMA controller (AHBdma), which moves data between memory and the
+	peripherals while the processor does something else, or sleeps.  The controller
+	gets the bus only in cycles where the processor has no transfer, so a channel runs
+	fastest while the processor is in __wfi(), and slowly if it polls in a tight loop.
+	Channel 0 is used by DmaCopy(); the other channel is free for peripheral streams,
+	e.g. UART receive data into a RAM buffer with DMA_REQ_UART_RX.  */
+
+#ifndef DMA_HDR_ALREADY_INCLUDED
+#define DMA_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+
+/* Start channel ch moving count items from src to dst.  control gives the size,
+   address increments, request, burst and interrupt enable, using the DMA_..._BIT_POS
+   definitions - the enable bit is added here.  The channel must not be busy.  */
+void DmaStart(uint32 ch, const volatile void *src, volatile void *dst, uint32 count, uint32 control);
+
+// Non-zero while channel ch has transfers to do
+uint32 DmaBusy(uint32 ch);
+
+// Stop channel ch - a transfer already started still completes
+void DmaStop(uint32 ch);
+
+/* Wait for channel ch to finish.  If the channel has its interrupt enabled, the processor
+   sleeps until the done interrupt, leaving the bus to the controller - this needs the DMA
+   interrupt enabled in the NVIC, and a DMA_ISR that clears the done bits.  Otherwise it
+   polls, which slows the channel down.  */
+void DmaWait(uint32 ch);
+
+// Copy words, memory to memory, on channel 0, sleeping until it is done
+void DmaCopy(uint32 *dst, const uint32 *src, uint32 words);
+
+#endif
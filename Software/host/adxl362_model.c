@@ -0,0 +1,213 @@
+/*  Model of the ADXL362 accelerometer at the SPI byte level - see adxl362_model.h
+	The byte sent back depends only on the bytes before it, as on the real SPI bus,
+	so each byte is handled in two steps: the byte out is found when the byte starts,
+	and the byte in is used when it is complete.  */
+
+#include "adxl362_model.h"
+
+#define ADXL_REG_COUNT			0x2F		// registers 0x00 to 0x2E
+#define ADXL_STATUS					0x0B
+#define ADXL_FIFO_ENTRIES_H	0x0D
+#define ADXL_XDATA					0x08		// 8-bit data registers, X, Y, Z
+#define ADXL_YDATA					0x09
+#define ADXL_ZDATA					0x0A
+#define ADXL_TEMP_H					0x15
+#define ADXL_SOFT_RESET			0x1F
+#define ADXL_RESET_CODE			0x52		// written to SOFT_RESET
+#define ADXL_FIRST_RW				0x20		// registers below this are read only
+#define ADXL_INT_LOW				0x80		// INTMAP: pin active low
+
+// STATUS register bits
+#define ADXL_STS_DATA_READY	0x01
+#define ADXL_STS_FIFO_READY	0x02
+#define ADXL_STS_WATERMARK	0x04
+#define ADXL_STS_OVERRUN		0x08
+
+static uint8 regs[ADXL_REG_COUNT];		// read-write registers
+static AccSample data;							// current sample set
+static uint8 dataReady, overrun;
+static uint16 fifo[ADXL_FIFO_WORDS];
+static uint16 fifoCount, fifoRd, fifoWr;
+
+// SPI transaction state
+static uint8 selected;
+static uint32 position;							// bytes so far in this transaction
+static uint8 command, address;
+static uint16 fifoWord;							// FIFO entry being sent
+static uint32 bytes, transactions;	// statistics
+
+void AdxlModelReset(void) {
+	int i;
+	for (i = 0; i < ADXL_REG_COUNT; i++) regs[i] = 0;
+	regs[ADXL_FIFO_SAMPLES] = 0x80;				// reset values from the data sheet
+	regs[ADXL_FILTER_CTL] = 0x13;
+	data.x = data.y = data.z = data.temp = 0;
+	dataReady = 0;
+	overrun = 0;
+	fifoCount = fifoRd = fifoWr = 0;
+	selected = 0;
+	bytes = transactions = 0;
+}
+
+static uint16 watermark(void) {
+	return regs[ADXL_FIFO_SAMPLES] | ((regs[ADXL_FIFO_CONTROL] & ADXL_FIFO_AH) ? 0x100 : 0);
+}
+
+static uint8 status(void) {
+	uint8 s = 0;
+	if (dataReady) s |= ADXL_STS_DATA_READY;
+	if (fifoCount > 0) s |= ADXL_STS_FIFO_READY;
+	if (watermark() != 0 && fifoCount >= watermark()) s |= ADXL_STS_WATERMARK;
+	if (overrun) s |= ADXL_STS_OVERRUN;
+	return s;
+}
+
+// Add an entry with the axis tag in bits 15:14.  When full, stream mode loses
+// the oldest entry and oldest-saved mode loses the new one.
+static void fifoPush(uint8 axis, int16 value) {
+	if (fifoCount == ADXL_FIFO_WORDS) {
+		overrun = 1;
+		if ((regs[ADXL_FIFO_CONTROL] & 0x03) == 0x01) return;
+		fifoRd = (fifoRd + 1) % ADXL_FIFO_WORDS;
+		fifoCount--;
+	}
+	fifo[fifoWr] = (uint16)((axis << ADXL_FIFO_TAG_POS) | ((uint16)value & 0x3FFF));
+	fifoWr = (fifoWr + 1) % ADXL_FIFO_WORDS;
+	fifoCount++;
+}
+
+uint8 AdxlModelSample(const AccSample *sample) {
+	if ((regs[ADXL_POWER_CTL] & 0x03) != ADXL_MEASURE) return 0;
+	data = *sample;
+	dataReady = 1;
+	if (regs[ADXL_FIFO_CONTROL] & 0x03) {
+		fifoPush(0, data.x);
+		fifoPush(1, data.y);
+		fifoPush(2, data.z);
+		if (regs[ADXL_FIFO_CONTROL] & ADXL_FIFO_TEMP) fifoPush(3, data.temp);
+	}
+	return 1;
+}
+
+// Read a register, with the side effects of the real device
+static uint8 readReg(uint8 addr) {
+	uint16 v;
+	if ((addr >= ADXL_XDATA && addr <= ADXL_ZDATA) || (addr >= ADXL_XDATA_L && addr <= ADXL_TEMP_H))
+		dataReady = 0;
+	switch (addr) {
+		case 0x00: return 0xAD;						// device ID
+		case 0x01: return 0x1D;
+		case 0x02: return 0xF2;						// part ID
+		case 0x03: return 0x01;						// revision
+		case ADXL_XDATA:			return (uint8)(data.x >> 4);		// 8 MSBs of 12-bit value
+		case ADXL_YDATA:			return (uint8)(data.y >> 4);
+		case ADXL_ZDATA:			return (uint8)(data.z >> 4);
+		case ADXL_STATUS:
+			v = status();
+			overrun = 0;
+			return (uint8)v;
+		case ADXL_FIFO_ENTRIES_L:	return fifoCount & 0xFF;
+		case ADXL_FIFO_ENTRIES_H:	return fifoCount >> 8;
+		default: break;
+	}
+	if (addr >= ADXL_XDATA_L && addr <= ADXL_TEMP_H) {
+		switch ((addr - ADXL_XDATA_L) / 2) {		// X, Y, Z, temperature in order
+			case 0:  v = (uint16)data.x; break;
+			case 1:  v = (uint16)data.y; break;
+			case 2:  v = (uint16)data.z; break;
+			default: v = (uint16)data.temp; break;
+		}
+		return (addr & 1) ? (uint8)(v >> 8) : (uint8)v;
+	}
+	return (addr < ADXL_REG_COUNT) ? regs[addr] : 0;
+}
+
+static void writeReg(uint8 addr, uint8 value) {
+	if (addr == ADXL_SOFT_RESET) {
+		if (value == ADXL_RESET_CODE) {
+			uint32 b = bytes, t = transactions;
+			AdxlModelReset();
+			selected = 1;										// still in the transaction
+			bytes = b;
+			transactions = t;
+		}
+	}
+	else if (addr >= ADXL_FIRST_RW && addr < ADXL_REG_COUNT)
+		regs[addr] = value;
+}
+
+void AdxlModelSelect(uint8 active) {
+	if (active && !selected) {
+		position = 0;
+		transactions++;
+	}
+	selected = active;
+}
+
+uint8 AdxlModelOut(void) {
+	uint8 miso = 0;
+	if (!selected) return 0xFF;						// MISO not driven
+	if (position == 0) return 0;					// command byte
+	if (command == ADXL_READ_FIFO) {				// low byte first, entry removed after high byte
+		if (position & 1) {
+			fifoWord = fifoCount ? fifo[fifoRd] : 0;
+			miso = (uint8)fifoWord;
+		}
+		else {
+			miso = (uint8)(fifoWord >> 8);
+			if (fifoCount) {
+				fifoRd = (fifoRd + 1) % ADXL_FIFO_WORDS;
+				fifoCount--;
+			}
+		}
+	}
+	else if (position >= 2 && command == ADXL_READ_REG)
+		miso = readReg(address++);
+	return miso;
+}
+
+void AdxlModelIn(uint8 mosi) {
+	if (!selected) return;
+	bytes++;
+	if (position == 0)
+		command = mosi;
+	else if (command == ADXL_READ_FIFO)
+		;															// data ignored
+	else if (position == 1)
+		address = mosi;
+	else if (command == ADXL_WRITE_REG)
+		writeReg(address++, mosi);
+	position++;
+}
+
+uint8 AdxlModelByte(uint8 mosi) {
+	uint8 miso = AdxlModelOut();
+	AdxlModelIn(mosi);
+	return miso;
+}
+
+uint8 AdxlModelInt1(void) {
+	return ((status() & regs[ADXL_INTMAP1] & 0x0F) != 0) ^ ((regs[ADXL_INTMAP1] & ADXL_INT_LOW) != 0);
+}
+
+uint8 AdxlModelInt2(void) {
+	return ((status() & regs[ADXL_INTMAP2] & 0x0F) != 0) ^ ((regs[ADXL_INTMAP2] & ADXL_INT_LOW) != 0);
+}
+
+uint32 AdxlModelPeriodUs(void) {
+	uint8 odr = regs[ADXL_FILTER_CTL] & 0x07;		// 12.5 Hz, doubling up to 400 Hz
+	if ((regs[ADXL_POWER_CTL] & 0x03) != ADXL_MEASURE) return 0;
+	return 80000 >> (odr > 5 ? 5 : odr);
+}
+
+uint16 AdxlModelFifoEntries(void) {
+	return fifoCount;
+}
+
+uint32 AdxlModelBytes(void) {
+	return bytes;
+}
+
+uint32 AdxlModelTransactions(void) {
+	return transactions;
+}
@@ -0,0 +1,48 @@
+/* adxl362_model.h
+	Model of the ADXL362 accelerometer at the SPI byte level, for the host build.
+	The same behaviour as Hardware/Testbench/ADXL362_model.v: register map, the
+	0x0A / 0x0B / 0x0D commands with address auto-increment, a 512-entry FIFO in
+	oldest-saved or stream mode, DATA_READY cleared by reading the data registers,
+	and INT1 / INT2 mapped from INTMAP1 / INTMAP2.  Sample sets are given by the
+	caller, so a benchmark decides the data and the timing.  */
+
+#ifndef ADXL362_MODEL_HDR_ALREADY_INCLUDED
+#define ADXL362_MODEL_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// integer types
+#include "adxl362.h"				// register addresses, AccSample
+
+// Return all registers, data and FIFO to the power-on state, and clear the statistics
+void AdxlModelReset(void);
+
+// Slave select: 1 starts a transaction, 0 ends it
+void AdxlModelSelect(uint8 active);
+
+// Transfer one byte: the argument is MOSI, the return value is MISO
+uint8 AdxlModelByte(uint8 mosi);
+
+/* The two halves of AdxlModelByte, for a bit-level SPI master: AdxlModelOut gives
+   the MISO byte at the start of a byte, AdxlModelIn takes the MOSI byte at the end.  */
+uint8 AdxlModelOut(void);
+void AdxlModelIn(uint8 mosi);
+
+/* A new sample set, in mg and temperature LSB.  Ignored unless POWER_CTL selects
+   measurement mode, as in the real device.  Returns 1 if the set was taken.  */
+uint8 AdxlModelSample(const AccSample *sample);
+
+// Level of the interrupt pins, after the INTMAP active-low bit
+uint8 AdxlModelInt1(void);
+uint8 AdxlModelInt2(void);
+
+// Time between sample sets at the output data rate in FILTER_CTL, in microseconds,
+// or 0 when not in measurement mode
+uint32 AdxlModelPeriodUs(void);
+
+// Entries waiting in the FIFO
+uint16 AdxlModelFifoEntries(void);
+
+// Bytes transferred and transactions since reset, for measuring the SPI cost of driver code
+uint32 AdxlModelBytes(void);
+uint32 AdxlModelTransactions(void);
+
+#endif
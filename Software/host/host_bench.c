@@ -0,0 +1,219 @@
+/*  Benchmark runner for the host build of the firmware.
+	Each benchmark runs a piece of the firmware many times against the peripheral
+	models, checks the results, and reports the time per operation and the number
+	of SPI bytes per operation (the cost on the board is mostly SPI time).
+	Usage:  host_bench [-n operations] [benchmark names...]
+	With no names, all benchmarks run.  The exit status is 1 if any check failed.
+	Times are for the host processor, so use them to compare versions of the
+	same code, not to predict the time on the Cortex-M0.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "host_sim.h"
+#include "telemetry.h"
+
+#define SAMPLE_SETS			64				// sample sets given to the accelerometer model
+#define FIFO_BATCH			8					// sample sets per FIFO read
+#define ACC_BUF_SETS		128				// size of AccBuf, as in main.c
+
+// Firmware in main.c, which is compiled with main renamed to firmware_main
+extern volatile uint8 RxBuf[];
+extern volatile uint8 counter;
+extern volatile uint8 BufReady;
+extern AccSample AccBuf[];
+extern volatile uint8 AccHead;
+extern uint8 binaryMode;
+uint16 OH_LED(int16 reg_read);
+void displayValue(int16 value);
+
+static AccSample samples[SAMPLE_SETS];
+static volatile uint16 sink;				// results nothing else uses, so loops are not removed
+
+// Board tilting slowly, as in Hardware/Testbench/adxl362_stim.txt
+static void makeSamples(void) {
+	int i;
+	for (i = 0; i < SAMPLE_SETS; i++) {
+		samples[i].x = (int16)lround(1000 * sin(2 * M_PI * i / SAMPLE_SETS));
+		samples[i].y = (int16)lround(100 * sin(2 * M_PI * i / 16));
+		samples[i].z = (int16)lround(1000 * cos(2 * M_PI * i / SAMPLE_SETS));
+		samples[i].temp = (int16)(350 + i / 16);
+	}
+}
+
+static int sameSample(const AccSample *a, const AccSample *b, int withTemp) {
+	return a->x == b->x && a->y == b->y && a->z == b->z && (!withTemp || a->temp == b->temp);
+}
+
+// ========================  Benchmarks ==========================================
+// Each runs n operations and returns the number of errors found
+
+static int benchOhLed(uint32 n) {
+	static const int16 in[]   = {1000,   -1000,  0,      2047,   -2048,  127};
+	static const uint16 out[] = {0xFE00, 0x007F, 0x0000, 0xFFFE, 0xFFFF, 0x0000};
+	uint32 i;
+	int errors = 0;
+	binaryMode = 1;							// no printf
+	for (i = 0; i < sizeof(in) / sizeof(in[0]); i++)
+		if (OH_LED(in[i]) != out[i]) errors++;
+	for (i = 0; i < n; i++)
+		sink = OH_LED((int16)((i * 37) % 4096 - 2048));
+	return errors;
+}
+
+static int benchDisplay(uint32 n) {
+	uint32 i;
+	int16 v;
+	int errors = 0;
+	for (i = 0; i < n; i++) {
+		v = (int16)(i * 7919);
+		displayValue(v);
+		if (DISPLAY_NUMBER != v) errors++;
+	}
+	return errors;
+}
+
+static int benchAccReadAll(uint32 n) {
+	uint32 i;
+	AccSample got;
+	int errors = 0;
+	AccWrite(ADXL_POWER_CTL, ADXL_MEASURE);
+	for (i = 0; i < n; i++) {
+		AdxlModelSample(&samples[i % SAMPLE_SETS]);
+		AccReadAll(&got);
+		if (!sameSample(&got, &samples[i % SAMPLE_SETS], 1)) errors++;
+	}
+	return errors;
+}
+
+// n is the number of sample sets, read in batches
+static int benchAccFifo(uint32 n) {
+	uint32 i, j, sets, next = 0;
+	AccSample got[FIFO_BATCH];
+	int errors = 0;
+	AccFifoStart(0, 1);
+	AccWrite(ADXL_POWER_CTL, ADXL_MEASURE);
+	for (i = 0; i < n; i += FIFO_BATCH) {
+		for (j = 0; j < FIFO_BATCH; j++) AdxlModelSample(&samples[(i + j) % SAMPLE_SETS]);
+		sets = AccFifoRead(got, FIFO_BATCH);
+		if (sets != FIFO_BATCH) errors++;
+		for (j = 0; j < sets; j++)
+			if (!sameSample(&got[j], &samples[next++ % SAMPLE_SETS], 1)) errors++;
+	}
+	return errors;
+}
+
+// Interrupt path: data ready on INT1, Acc_ISR reads the set into the circular buffer
+static int benchAccIsr(uint32 n) {
+	uint32 i;
+	int errors = 0;
+	AccWrite(ADXL_INTMAP1, ADXL_INT_DATA_READY);
+	AccWrite(ADXL_POWER_CTL, ADXL_MEASURE);
+	SPI_CTL |= (1 << SPI_INT1_BIT_POS);
+	for (i = 0; i < n; i++) {
+		__wfi();
+		if (!sameSample(&AccBuf[(AccHead - 1) & (ACC_BUF_SETS - 1)], &samples[i % SAMPLE_SETS], 1)) errors++;
+		if (AdxlModelInt1()) errors++;			// reading the data clears data ready
+	}
+	SPI_CTL = 0;
+	return errors;
+}
+
+// n is the number of lines received through UART_ISR
+static int benchUartIsr(uint32 n) {
+	static const char line[] = "hello world";
+	uint32 i;
+	int errors = 0;
+	UART_RXLVL = 16;
+	UART_CTL = (1 << UART_RX_LEVEL_BIT_POS) | (1 << UART_RX_IDLE_BIT_POS);
+	for (i = 0; i < n; i++) {
+		HostUartClear();
+		HostUartInput(line);
+		HostUartInput("\r");
+		__wfi();
+		if (!BufReady || strcmp((char *)RxBuf, line) != 0) errors++;
+		if (HostUartOutputCount != sizeof(line)) errors++;		// echo, including the CR
+		counter = 0;
+		BufReady = 0;
+	}
+	UART_CTL = 0;
+	return errors;
+}
+
+static int benchTelemetry(uint32 n) {
+	uint32 i, j;
+	uint8 sum;
+	int errors = 0;
+	for (i = 0; i < n; i++) {
+		HostUartClear();
+		TlmSendFrame((uint16)i, &samples[i % SAMPLE_SETS]);
+		if (HostUartOutputCount != TLM_FRAME_BYTES) { errors++; continue; }
+		if (HostUartOutput[0] != TLM_SYNC0 || HostUartOutput[1] != TLM_SYNC1) errors++;
+		for (sum = 0, j = 2; j < TLM_FRAME_BYTES; j++) sum += HostUartOutput[j];
+		if (sum != 0) errors++;
+	}
+	return errors;
+}
+
+// ========================  Runner ==========================================
+
+typedef struct {
+	const char *name;
+	const char *about;
+	int (*run)(uint32 n);
+} Bench;
+
+static const Bench benches[] = {
+	{"oh_led",		"OH_LED, LED bar from acceleration",		benchOhLed},
+	{"display",		"displayValue, signed number register",	benchDisplay},
+	{"acc_read",	"AccReadAll, one set per transaction",	benchAccReadAll},
+	{"acc_fifo",	"AccFifoRead, 8 sets per transaction",	benchAccFifo},
+	{"acc_isr",		"Acc_ISR on data ready, per set",				benchAccIsr},
+	{"uart_isr",	"UART_ISR, per line of 12 characters",	benchUartIsr},
+	{"telemetry",	"TlmSendFrame, per frame",							benchTelemetry},
+};
+
+static double seconds(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int selected(const char *name, int argc, char **argv, int first) {
+	int i;
+	if (first >= argc) return 1;
+	for (i = first; i < argc; i++)
+		if (strcmp(argv[i], name) == 0) return 1;
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	uint32 n = 100000;
+	int first = 1, failed = 0, errors;
+	unsigned i;
+	double start, elapsed;
+	uint32 spiBytes;
+
+	if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+		n = (uint32)strtoul(argv[2], NULL, 0);
+		first = 3;
+	}
+	makeSamples();
+	printf("%-10s %-40s %10s %10s  %s\n", "benchmark", "", "ns/op", "SPI B/op", "errors");
+	for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+		if (!selected(benches[i].name, argc, argv, first)) continue;
+		HostReset(samples, SAMPLE_SETS);
+		counter = 0;
+		BufReady = 0;
+		start = seconds();
+		errors = benches[i].run(n);
+		elapsed = seconds() - start;
+		spiBytes = AdxlModelBytes();
+		printf("%-10s %-40s %10.1f %10.2f  %d\n", benches[i].name, benches[i].about,
+			elapsed * 1e9 / n, (double)spiBytes / n, errors);
+		if (errors) failed = 1;
+	}
+	return failed;
+}
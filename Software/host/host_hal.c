@@ -0,0 +1,136 @@
+/*  Register blocks and peripheral models for the host build - see host_hal.h and host_sim.h
+	Replaces spi.c (SPI master) and retarget.c (UART output) from the firmware.  */
+
+#include <string.h>
+#include "host_sim.h"
+#include "spi.h"
+#include "retarget.h"
+
+#define HOST_RX_SIZE			256				// characters in the UART receive queue
+
+NVIC_block    HostNVIC;
+SysTick_block HostSysTick;
+UART_block    HostUART;
+GPIO_block    HostGPIO;
+volatile uint32 HostDisplay[5];
+SPI_block     HostSPI;
+SMP_block     HostSMP;
+ARITH_block   HostARITH;
+PERF_block    HostPERF;
+DMA_block     HostDMA;
+MBOX_block    HostMBOX;
+CORDIC_block  HostCORDIC;
+
+uint8 HostUartOutput[HOST_UART_BUF_SIZE];
+uint32 HostUartOutputCount;
+uint32 HostWfiCount;
+volatile unsigned int uart_tx_dropped = 0;
+
+static uint8 rxQueue[HOST_RX_SIZE];
+static uint32 rxHead, rxTail;					// characters waiting are rxHead - rxTail
+static const AccSample *samples;				// sample sets given to the model by HostWfi()
+static uint32 sampleCount, sampleNext;
+static int irqMasked;
+
+void HostReset(const AccSample *s, uint32 count) {
+	memset(&HostNVIC, 0, sizeof(HostNVIC));
+	memset(&HostSysTick, 0, sizeof(HostSysTick));
+	memset(&HostUART, 0, sizeof(HostUART));
+	memset(&HostGPIO, 0, sizeof(HostGPIO));
+	memset((void *)HostDisplay, 0, sizeof(HostDisplay));
+	memset(&HostSPI, 0, sizeof(HostSPI));
+	memset(&HostSMP, 0, sizeof(HostSMP));
+	memset(&HostARITH, 0, sizeof(HostARITH));
+	memset(&HostPERF, 0, sizeof(HostPERF));
+	memset(&HostDMA, 0, sizeof(HostDMA));
+	memset(&HostMBOX, 0, sizeof(HostMBOX));
+	memset(&HostCORDIC, 0, sizeof(HostCORDIC));
+	AdxlModelReset();
+	samples = s;
+	sampleCount = count;
+	sampleNext = 0;
+	rxHead = rxTail = 0;
+	HostUartClear();
+	HostWfiCount = 0;
+	irqMasked = 0;
+}
+
+// ========================  UART ==========================================
+
+void HostUartInput(const char *s) {
+	while (*s && (rxHead - rxTail) < HOST_RX_SIZE)
+		rxQueue[rxHead++ % HOST_RX_SIZE] = (uint8)*s++;
+}
+
+// Transmit FIFO is always empty, so output never waits
+uint8 HostUartStatus(void) {
+	uint8 sts = (1 << UART_TX_FIFO_EMPTY_BIT_POS);
+	uint32 waiting = rxHead - rxTail;
+	if (waiting) sts |= (1 << UART_RX_FIFO_NOTEMPTY_BIT_POS) | (1 << UART_RX_IDLE_BIT_POS);
+	if (HostUART.RxLevel && waiting >= HostUART.RxLevel) sts |= (1 << UART_RX_LEVEL_BIT_POS);
+	return sts;
+}
+
+uint8 HostUartRead(void) {
+	if (rxHead == rxTail) return 0;
+	return rxQueue[rxTail++ % HOST_RX_SIZE];
+}
+
+void HostUartClear(void) {
+	HostUartOutputCount = 0;
+}
+
+int uart_out(int ch) {
+	if (HostUartOutputCount < HOST_UART_BUF_SIZE)
+		HostUartOutput[HostUartOutputCount++] = (uint8)ch;
+	else
+		uart_tx_dropped++;
+	return ch;
+}
+
+void uart_tx_isr(void) {
+	// Nothing to do - uart_out() never queues
+}
+
+void uart_set_baud(unsigned int baud) {
+	HostUART.BaudIncr = (uint32)((((unsigned long long)baud << 23) + UART_CLOCK_HZ/2) / UART_CLOCK_HZ);
+}
+
+// ========================  SPI ==========================================
+
+void SPIselect(uint8 sel) {
+	AdxlModelSelect(sel != NONE);
+}
+
+uint8 SPIbyte(uint8 TXdata) {
+	return AdxlModelByte(TXdata);
+}
+
+// ========================  Processor ==========================================
+
+int HostDisableIrq(void) {
+	int was = irqMasked;
+	irqMasked = 1;
+	return was;
+}
+
+void HostEnableIrq(void) {
+	irqMasked = 0;
+}
+
+/* Time passes until the next event: the accelerometer takes the next sample set,
+   then each interrupt that is pending and enabled in its peripheral is serviced.
+   The NVIC enable registers are plain memory here, so they are not checked.  */
+void HostWfi(void) {
+	uint8 uartIrq;
+	HostWfiCount++;
+	if (sampleCount) {
+		AdxlModelSample(&samples[sampleNext]);
+		sampleNext = (sampleNext + 1) % sampleCount;
+	}
+	if (irqMasked) return;
+	uartIrq = HostUartStatus() & HostUART.Control &
+		((1 << UART_RX_LEVEL_BIT_POS) | (1 << UART_RX_IDLE_BIT_POS) | (1 << UART_RX_FIFO_NOTEMPTY_BIT_POS));
+	if (uartIrq) UART_ISR();
+	if (AdxlModelInt1() && (HostSPI.Control & (1 << SPI_INT1_BIT_POS))) Acc_ISR();
+}
@@ -0,0 +1,68 @@
+/* host_hal.h
+	Register map for the host build of the firmware (gcc or clang on Linux), included
+	by DES_M0_SoC.h when HOST_BUILD is defined.  The register blocks are ordinary
+	variables, so code that only writes registers (LEDs, display, control registers)
+	runs unchanged and the result can be checked by reading the variable.
+	Registers where a read has a side effect are mapped to functions of a model:
+	  UART_STS and UART_RXD - receive queue filled by HostUartInput()
+	  SPIselect() and SPIbyte() - ADXL362 model in adxl362_model.c, replacing spi.c
+	  uart_out() - output captured in a buffer, replacing retarget.c
+	The processor intrinsics are replaced too: __wfi() runs HostWfi(), which gives the
+	accelerometer model a new sample set and calls the interrupt service routines
+	that the peripheral control registers enable, as the NVIC would.
+	The sampling engine, arithmetic unit, performance counters, DMA controller,
+	mailbox and CORDIC unit are not modelled - their registers are plain memory, so the
+	mailbox CPU ID reads 0, as in the single processor system.  Functions to control the models are
+	in host_sim.h.  */
+
+#ifndef HOST_HAL_HDR_ALREADY_INCLUDED
+#define HOST_HAL_HDR_ALREADY_INCLUDED
+
+#include <stdint.h>
+
+// Register blocks in host memory
+extern NVIC_block    HostNVIC;
+extern SysTick_block HostSysTick;
+extern UART_block    HostUART;
+extern GPIO_block    HostGPIO;
+extern volatile uint32 HostDisplay[5];
+extern SPI_block     HostSPI;
+extern SMP_block     HostSMP;
+extern ARITH_block   HostARITH;
+extern PERF_block    HostPERF;
+extern DMA_block     HostDMA;
+extern MBOX_block    HostMBOX;
+extern CORDIC_block  HostCORDIC;
+
+#define pt2NVIC (&HostNVIC)
+#define pt2SysTick (&HostSysTick)
+#define pt2UART (&HostUART)
+#define pt2GPIO (&HostGPIO)
+#define DISPLAY_BASE ((uintptr_t)HostDisplay)
+#define DISPLAY_NUMBER (*(volatile int32 *)(DISPLAY_BASE + 0xC))	// signed number, shown in decimal
+#define DISPLAY_DECIMALS (*(volatile uint32 *)(DISPLAY_BASE + 0x10))	// digits after the point, 0 to 7
+#define pt2SPI (&HostSPI)
+#define pt2SMP (&HostSMP)
+#define pt2ARITH (&HostARITH)
+#define pt2PERF (&HostPERF)
+#define pt2DMA (&HostDMA)
+#define pt2MBOX (&HostMBOX)
+#define pt2CORDIC (&HostCORDIC)
+
+// UART registers that change when read
+#undef UART_STS
+#undef UART_RXD
+#define UART_STS (HostUartStatus())
+#define UART_RXD (HostUartRead())
+uint8 HostUartStatus(void);
+uint8 HostUartRead(void);
+
+// Processor intrinsics
+#define __wfi() HostWfi()
+#define __disable_irq() HostDisableIrq()
+#define __enable_irq() HostEnableIrq()
+void HostWfi(void);
+int HostDisableIrq(void);
+void HostEnableIrq(void);
+
+#endif
@@ -0,0 +1,35 @@
+/* host_sim.h
+	Control of the peripheral models in the host build, for the benchmark runner.
+	See host_hal.h for the register map.  */
+
+#ifndef HOST_SIM_HDR_ALREADY_INCLUDED
+#define HOST_SIM_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"
+#include "adxl362.h"				// AccSample
+#include "adxl362_model.h"
+
+#define HOST_UART_BUF_SIZE	4096		// characters kept from uart_out()
+
+// Interrupt service routines in the firmware, called by HostWfi()
+void UART_ISR(void);
+void Acc_ISR(void);
+
+/* Clear the register blocks, reset the accelerometer model and empty the UART queues.
+   Each HostWfi() gives the model the next sample set from the array, repeating it
+   when the end is reached.  The array must stay valid.  */
+void HostReset(const AccSample *samples, uint32 count);
+
+/* Put characters in the UART receive queue.  They are taken by UART_ISR at the
+   next HostWfi(), if the UART control register enables a receive interrupt.  */
+void HostUartInput(const char *s);
+
+// Characters sent through uart_out() since the last HostUartClear()
+extern uint8 HostUartOutput[HOST_UART_BUF_SIZE];
+extern uint32 HostUartOutputCount;
+void HostUartClear(void);
+
+// Number of HostWfi() calls since HostReset()
+extern uint32 HostWfiCount;
+
+#endif
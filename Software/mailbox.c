@@ -0,0 +1,56 @@
+/*  Functions for the mailbox - see mailbox.h
+	Every change the other processor could be waiting for is followed by SEV, which
+	wakes it from WFE.  WFE returns at once if an event came since the last one, so
+	a processor cannot miss the event between its test and its sleep.  */
+
+#include "mailbox.h"
+
+uint32 MboxCpuId(void) {
+	return pt2MBOX->CpuId;
+}
+
+uint8 MboxTrySend(uint32 cpu, uint32 msg) {
+	if (pt2MBOX->Status & (1 << cpu)) return 0;
+	pt2MBOX->Mbox[cpu] = msg;
+	__sev();
+	return 1;
+}
+
+void MboxSend(uint32 cpu, uint32 msg) {
+	while (!MboxTrySend(cpu, msg))
+		__wfe();
+}
+
+uint8 MboxTryReceive(uint32 *msg) {
+	uint32 cpu = pt2MBOX->CpuId;
+	if (!(pt2MBOX->Status & (1 << cpu))) return 0;
+	*msg = pt2MBOX->Mbox[cpu];			// clears full
+	__sev();								// the sender may be waiting for space
+	return 1;
+}
+
+uint32 MboxReceive(void) {
+	uint32 msg;
+	while (!MboxTryReceive(&msg))
+		__wfe();
+	return msg;
+}
+
+// Both processors change the same register, so the read-modify-write is locked
+void MboxIntEnable(uint8 on) {
+	uint32 bit = 1 << pt2MBOX->CpuId;
+	MboxLock(MBOX_SEM_INTERNAL);
+	if (on) pt2MBOX->IntEnable |= bit;
+	else pt2MBOX->IntEnable &= ~bit;
+	MboxUnlock(MBOX_SEM_INTERNAL);
+}
+
+void MboxLock(uint32 sem) {
+	while (pt2MBOX->Sem[sem])				// reading takes it if it is free
+		__wfe();
+}
+
+void MboxUnlock(uint32 sem) {
+	pt2MBOX->Sem[sem] = 0;
+	__sev();
+}
@@ -0,0 +1,42 @@
+/* mailbox.h
+	Functions for the mailbox (AHBmailbox), which passes messages between the two
+	processors of the dual-core system and gives them semaphores for shared data.
+	Each processor has one mailbox, holding one 32-bit message.  The mailbox of a
+	processor can interrupt it while full (IRQ 6 - NVIC_MBOX_BIT_POS), and the
+	functions here also use SEV and WFE, so a processor waiting for a message, for
+	space or for a semaphore sleeps until the other one has done something.
+	In the single processor system MboxCpuId() is 0, and nothing ever arrives.  */
+
+#ifndef MAILBOX_HDR_ALREADY_INCLUDED
+#define MAILBOX_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+
+#define MBOX_SEM_INTERNAL		(MBOX_SEMAPHORES - 1)	// used by MboxIntEnable(), not free for others
+
+// Number of the processor calling, 0 or 1
+uint32 MboxCpuId(void);
+
+// Send msg to processor cpu, if its mailbox is empty.  Returns 0 if it was full.
+uint8 MboxTrySend(uint32 cpu, uint32 msg);
+
+// Send msg to processor cpu, sleeping until its mailbox is empty
+void MboxSend(uint32 cpu, uint32 msg);
+
+/* Take the message from the mailbox of the processor calling.  Returns 0 if there
+   is none.  Taking it clears the mailbox interrupt.  */
+uint8 MboxTryReceive(uint32 *msg);
+
+// Wait for a message for the processor calling, sleeping until one arrives
+uint32 MboxReceive(void);
+
+// Enable or disable the mailbox interrupt of the processor calling (the NVIC is separate)
+void MboxIntEnable(uint8 on);
+
+// Take semaphore sem, 0 to MBOX_SEM_INTERNAL-1, sleeping while the other processor has it
+void MboxLock(uint32 sem);
+
+// Give semaphore sem back
+void MboxUnlock(uint32 sem);
+
+#endif
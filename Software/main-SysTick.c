@@ -17,13 +17,14 @@
 
 #include <stdio.h>					// needed for printf
 #include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "retarget.h"				// buffered UART output
 
 #define BUF_SIZE						100				// size of the array to hold received characters
 #define ASCII_CR						'\r'			// character to mark the end of input
 #define CASE_BIT						('A' ^ 'a')		// bit pattern used to change the case of a letter
 #define FLASH_DELAY					1000000		// delay for flashing LEDs, ~220 ms
 
-#define INVERT_LEDS					(GPIO_LED ^= 0xff)		// inverts the 8 rightmost LEDs
+#define INVERT_LEDS					(GPIO_LED_TOGGLE = 0xff)		// inverts the 8 rightmost LEDs
 #define MSB8								0x80			// most significant bit of 8-bit value
 
 #define ARRAY_SIZE(__x__)   (sizeof(__x__)/sizeof(__x__[0]))  // macro to find array size
@@ -40,10 +41,13 @@ volatile uint8  BufReady = 0; 		// flag indicates data in RxBuf is ready for pro
 void UART_ISR()		
 {
 	char c;
-	c = UART_RXD;	 				// read character from UART (there must be one waiting)
+	uart_tx_isr();				// refill transmit FIFO from the printf ring buffer
+	if (!(UART_STS & (1 << UART_RX_FIFO_NOTEMPTY_BIT_POS)))
+		return;							// no character received
+	c = UART_RXD;	 				// read character from UART
 	RxBuf[counter]  = c;  // store in buffer
 	counter++;            // increment counter, number of characters in buffer
-	UART_TXD = c;  				// write character to UART (assuming transmit queue not full)
+	uart_out(c);  				// echo character, queued behind any printf output
 
 	/* Counter is now the position in the buffer that the next character should go into.
 		If this is the end of the buffer, i.e. if counter == BUF_SIZE-1, then null terminate
@@ -63,7 +67,35 @@ void UART_ISR()
 //////////////////////////////////////////////////////////////////
 void SysTick_ISR()	
 {
-		GPIO_LED_Hi ^= MSB8;		// flip the leftmost LED
+		GPIO_LED_TOGGLE = MSB8 << 8;		// flip the leftmost LED
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine for accelerometer interrupt
+//////////////////////////////////////////////////////////////////
+void Acc_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void Sampler_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void GPIO_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void DMA_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void Mailbox_ISR()	
+{
+	// Do nothing - this interrupt is not used here
 }
 
 
@@ -0,0 +1,259 @@
+/*--------------------------------------------------------------------------------------------------
+	Demonstration program for Cortex-M0 SoC design - dual-core version
+
+	For the dual-core system (AHBliteTop with DUAL_CORE = 1).  Both processors run this
+	program from the same ROM: cm0dsasm.s sends processor 0 to main(), and processor 1,
+	with its stack in its private RAM, to Core1_main().  Processor 1 does not run the
+	C library start-up, so it waits for a message from processor 0 before it uses any
+	global variable.  Only processor 1 uses printf.
+	Processor 0 - acquisition: the sampling engine reads the accelerometer, Sampler_ISR
+	  moves batches of sample sets into a circular buffer, and main() shows the chosen
+	  axis of the latest set on the LEDs and the 7-segment display, then passes the set
+	  to processor 1.
+	Processor 1 - output: owns the UART.  For each sample set from processor 0, it prints
+	  the chosen axis, or sends a binary telemetry frame (switch 15 on, or command "bin").
+	  Commands "bin", "txt" and "perf" are as in main.c.
+	The sample set is passed in SharedSample and SharedTime, guarded by semaphore
+	  SEM_SAMPLE, then a mailbox message to processor 1 wakes it with the mailbox
+	  interrupt.  If processor 1 has not taken the last message yet, it prints only the
+	  newer set, and SamplesMissed counts the one it missed.
+	The peripheral interrupts go to both processors - each processor enables, in its own
+	  NVIC, only the interrupts of the peripherals it owns.
+
+	April 2023 - SoC Group 14
+  ------------------------------------------------------------------------------------------------*/
+
+#include <stdio.h>					// needed for printf
+#include <stdlib.h>
+#include <string.h>					// for strcmp
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "adxl362.h"				// accelerometer functions
+#include "retarget.h"				// buffered UART output
+#include "telemetry.h"				// binary telemetry frames
+#include "sampler.h"				// accelerometer sampling engine
+#include "perf.h"						// performance counters
+#include "mailbox.h"				// messages and semaphores between the processors
+
+#define BUF_SIZE						100				// size of the array to hold received characters
+#define ASCII_CR						'\r'			// character to mark the end of input
+#define ACC_BUF_SETS				128					// sample sets in circular buffer, must be a power of 2
+#define DISPLAY_SAMPLES			160					// sample sets between display updates, 400 ms at 400 Hz
+#define TLM_SAMPLES					4						// sample sets between binary frames, 100 frames/s at 400 Hz
+#define TLM_SWITCH_MASK			0x8000			// switch 15 selects binary telemetry
+#define SMP_BATCH						TLM_SAMPLES	// sample sets in engine buffer per interrupt
+#define SWITCH_EVENTS				0xFFFF			// all 16 switches, in the GPIO edge registers
+#define SEM_SAMPLE					0						// semaphore guarding SharedSample
+#define MSG_START						0x80000000	// first message to processor 1 - not a timestamp
+
+// Global variables - in the shared RAM, set up by the C library start-up on processor 0
+// Processor 0: main, Sampler_ISR and GPIO_ISR
+AccSample AccBuf[ACC_BUF_SETS];		// circular buffer of sample sets, written by Sampler_ISR
+volatile uint8  AccHead  = 0;			// position in AccBuf[] for the next sample set
+volatile uint16 AccCount = 0;			// sample sets received since the last update
+volatile uint16 AccTime  = 0;			// sample sets received since start, used as timestamp
+volatile uint16 SwitchState;			// debounced switches, kept up to date by GPIO_ISR
+volatile uint8  SwitchChanged = 0;	// set by GPIO_ISR, main() stops waiting for samples
+// Processor 1: Core1_main, UART_ISR and Mailbox_ISR
+volatile uint8  RxBuf[BUF_SIZE];	// array to hold received characters
+volatile uint8  counter  = 0; 		// current number of characters in RxBuf[]
+volatile uint8  BufReady = 0; 		// flag indicates data in RxBuf is ready for processing
+volatile uint8  NewSample = 0;		// set by Mailbox_ISR when a sample set has been passed
+// Both processors
+AccSample SharedSample;						// latest sample set, from processor 0 to processor 1
+uint16 SharedTime;								// its timestamp
+volatile uint32 SamplesMissed = 0;	// sets replaced before processor 1 took them
+volatile uint8  binaryCmd  = 0;		// binary telemetry selected by command
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs on processor 1 when UART interrupt occurs - see cm0dsasm.s
+// Either a character has been received, or the transmit FIFO needs refilling.
+//////////////////////////////////////////////////////////////////
+void UART_ISR() {
+	char c;
+	uart_tx_isr();				// refill transmit FIFO from the printf ring buffer
+	while (UART_STS & (1 << UART_RX_FIFO_NOTEMPTY_BIT_POS)) {
+		c = UART_RXD;	 				// read character from UART
+		RxBuf[counter]  = c;  // store in buffer
+		counter++;            // increment counter, number of characters in buffer
+		uart_out(c);  				// echo character, queued behind any printf output
+		if (counter == BUF_SIZE-1 || c == ASCII_CR) {
+			counter--;							// decrement counter (CR will be over-written)
+			RxBuf[counter] = '\0';  // null terminate to make the array a valid string
+			BufReady       = 1;	    // indicate that data is ready for processing
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs on processor 1 when its mailbox is full - see cm0dsasm.s
+// Taking the message clears the interrupt.  The NVIC may also run this once after the
+// mailbox has been emptied, so it checks first.
+//////////////////////////////////////////////////////////////////
+void Mailbox_ISR() {
+	uint32 msg;
+	if (MboxTryReceive(&msg)) NewSample = 1;		// the message is the timestamp, not needed
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs on processor 0 when the sampling engine buffer holds
+// SMP_BATCH sample sets - see cm0dsasm.s.  Takes everything waiting, which clears the interrupt.
+//////////////////////////////////////////////////////////////////
+void Sampler_ISR() {
+	while (SmpGet(&AccBuf[AccHead], NULL)) {
+		AccHead = (AccHead + 1) & (ACC_BUF_SETS - 1);
+		AccCount++;
+		AccTime++;
+	}
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs on processor 0 when the GPIO block has seen a
+// debounced switch change - see cm0dsasm.s.  Clears the events it handles.
+//////////////////////////////////////////////////////////////////
+void GPIO_ISR() {
+	uint32 events = GPIO_EVENTS;
+	GPIO_EVENTS = events;
+	if (events & SWITCH_EVENTS) {
+		SwitchState = (uint16)GPIO_STABLE;
+		SwitchChanged = 1;
+	}
+}
+
+void Acc_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void DMA_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void SysTick_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+// the axis chosen by the last two switches: 00 - X, 01 - Y, 1x - Z
+static int16 chosenAxis(const AccSample *s) {
+	switch (SwitchState & 0x3) {
+		case 0:		return s->x;
+		case 1:		return s->y;
+		default:	return s->z;
+	}
+}
+
+// bar of LEDs for an acceleration value, from the right for positive, from the left for negative
+static uint16 barLEDs(int16 value) {
+	uint16 x = (uint16)(abs(value) / 128);		// scale down
+	if (value > 0) return 0xFFFF << (16 - x);
+	return 0xFFFF >> (16 - x);
+}
+
+//////////////////////////////////////////////////////////////////
+// Processor 1 - entered from cm0dsasm.s, with the stack in its private RAM
+//////////////////////////////////////////////////////////////////
+void Core1_main(void) {
+	AccSample sample;						// copy of the sample set from processor 0
+	uint16 timestamp;
+	int16 value;
+
+	MboxReceive();							// wait for processor 0 to set up the global variables
+
+	// Configure the UART - interrupt when 16 characters are waiting, or when input
+	// stops for 4 character times
+	UART_RXLVL = 16;
+	UART_TIMEOUT = 40;
+	UART_CTL = (1 << UART_RX_LEVEL_BIT_POS) | (1 << UART_RX_IDLE_BIT_POS);
+
+	MboxIntEnable(1);
+	NVIC_Enable = (1 << NVIC_UART_BIT_POS) | (1 << NVIC_MBOX_BIT_POS);
+	printf("\n\nWelcome to Cortex-M0 SoC - dual-core\n");
+
+	while(1) {
+		while (!NewSample && !BufReady)
+			__wfi();  // Wait For Interrupt: enter Sleep Mode until interrupt occurs
+
+		if (NewSample) {
+			NewSample = 0;						// cleared first - a newer set makes it 1 again
+			MboxLock(SEM_SAMPLE);
+			sample = SharedSample;
+			timestamp = SharedTime;
+			MboxUnlock(SEM_SAMPLE);
+			if (binaryCmd || (SwitchState & TLM_SWITCH_MASK))
+				TlmSendFrame(timestamp, &sample);
+			else {
+				value = chosenAxis(&sample);
+				printf("%c-Axis: %d\n", "XYZZ"[SwitchState & 0x3], value);
+			}
+		}
+
+		// check for a command - "bin" or "txt" selects the telemetry mode, "perf" reports
+		// the performance counters
+		if (BufReady) {
+			if (strcmp((char *)RxBuf, "bin") == 0) binaryCmd = 1;
+			else if (strcmp((char *)RxBuf, "txt") == 0) binaryCmd = 0;
+			else if (strcmp((char *)RxBuf, "perf") == 0) {
+				PerfReport();
+				PerfClear();
+				printf("Sample sets missed by processor 1: %u\n", SamplesMissed);
+			}
+			NVIC_Disable = (1 << NVIC_UART_BIT_POS);	// reset the buffer with UART interrupt disabled
+			counter  = 0;
+			BufReady = 0;
+			NVIC_Enable = (1 << NVIC_UART_BIT_POS);
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////
+// Processor 0 - Main Function
+//////////////////////////////////////////////////////////////////
+int main(void) {
+	AccSample latest;						// copy of the latest sample set from the circular buffer
+	uint16 timestamp;						// AccTime when it was copied
+	uint8 binaryMode;
+	int16 value;
+
+	// Debounced events from any switch
+	GPIO_DEBOUNCE = GPIO_DEBOUNCE_5MS;
+	GPIO_RISE = SWITCH_EVENTS;
+	GPIO_FALL = SWITCH_EVENTS;
+	SwitchState = GPIO_SW;
+	GPIO_EVENTS = 0xFFFFFFFF;												// clear anything seen before
+	NVIC_Enable = (1 << NVIC_GPIO_BIT_POS);
+
+	MboxSend(1, MSG_START);													// processor 1 can start now
+
+	AccWrite(ADXL_FILTER_CTL, ADXL_HALF_BW | ADXL_ODR_400HZ);	// 400 Hz output data rate, +/- 2 g
+	AccWrite(ADXL_INTMAP1, ADXL_INT_DATA_READY);      // INT1 pin high when a sample set is ready
+	AccWrite(ADXL_POWER_CTL, ADXL_MEASURE);		        // start measuring
+	SmpStart(0, SMP_BATCH, 1);												// engine reads each set on data ready
+	NVIC_Enable = (1 << NVIC_SMP_BIT_POS);
+
+	while(1) {
+		binaryMode = binaryCmd || (SwitchState & TLM_SWITCH_MASK);
+		// sleep until enough sample sets have arrived, or a switch has changed
+		while (AccCount < (binaryMode ? TLM_SAMPLES : DISPLAY_SAMPLES) && !SwitchChanged)
+			__wfi();
+		SwitchChanged = 0;
+
+		// copy the latest sample with the sampler interrupt disabled, so it is consistent
+		NVIC_Disable = (1 << NVIC_SMP_BIT_POS);
+		latest = AccBuf[(AccHead - 1) & (ACC_BUF_SETS - 1)];
+		timestamp = AccTime;
+		AccCount = 0;
+		NVIC_Enable = (1 << NVIC_SMP_BIT_POS);
+
+		// pass it to processor 1 - if the last one is still waiting, this one replaces it
+		MboxLock(SEM_SAMPLE);
+		SharedSample = latest;
+		SharedTime = timestamp;
+		MboxUnlock(SEM_SAMPLE);
+		if (!MboxTrySend(1, timestamp)) SamplesMissed++;
+
+		value = chosenAxis(&latest);
+		GPIO_LED = barLEDs(value);
+		DISPLAY_NUMBER = value;									// display shows it in decimal
+	} // end of infinite loop
+}  // end of main
@@ -10,9 +10,10 @@
 
 #include <stdio.h>					// needed for printf
 #include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "retarget.h"				// buffered UART output
 
 #define FLASH_DELAY					1000000		// delay for flashing LEDs, ~220 ms
-#define INVERT_LEDS					(GPIO_LED ^= 0xff)		// inverts the 8 rightmost LEDs
+#define INVERT_LEDS					(GPIO_LED_TOGGLE = 0xff)		// inverts the 8 rightmost LEDs
 
 
 //////////////////////////////////////////////////////////////////
@@ -20,7 +21,8 @@
 //////////////////////////////////////////////////////////////////
 void UART_ISR()		
 {	
-	// this version does nothing - UART interrupts are not used
+	// only the transmit interrupt is used, to empty the printf ring buffer
+	uart_tx_isr();
 }
 
 
@@ -32,6 +34,34 @@ void SysTick_ISR()
 	// Do nothing - this interrupt is not used here
 }
 
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine for accelerometer interrupt
+//////////////////////////////////////////////////////////////////
+void Acc_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void Sampler_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void GPIO_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void DMA_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
+void Mailbox_ISR()	
+{
+	// Do nothing - this interrupt is not used here
+}
+
 
 //////////////////////////////////////////////////////////////////
 // Software delay function - delay time proportional to argument n
@@ -56,6 +86,9 @@ int main(void)
 	
 // ========================  Initialisation ==========================================
 
+	// printf output is sent by the UART transmit interrupt - enable it in the NVIC
+	NVIC_Enable = (1 << NVIC_UART_BIT_POS);
+
 	delay(FLASH_DELAY);												// wait a short time
 	
 	printf("\n\nWelcome to DES SoC (scanf version)\n");			// output welcome message
@@ -10,26 +10,66 @@
 	  When a whole message has been received, the stored characters are copied to another array
 		  with their case inverted, then printed. 
 
+	Accelerometer: the ADXL362 INT1 pin signals data ready.  With USE_SAMPLER, the
+	  sampling engine reads each sample set in hardware and averages each group of
+	  SMP_AVERAGE sets into one, and Sampler_ISR moves batches of SMP_BATCH averaged sets
+	  into a circular buffer.  Otherwise Acc_ISR reads each set through the
+	  SPI block.  main() sleeps until DISPLAY_SAMPLES sets have arrived, then shows the
+	  chosen axis of the latest one, so the display rate is set by the accelerometer
+	  data rate, not by a delay loop.
+	Telemetry: in binary mode (switch 15 on, or command "bin" typed), a compact frame is
+	  sent every TLM_SAMPLES sets instead of the text output - see telemetry.h.
+	  Command "txt" returns to text mode.
+	Switch 2 on shows the tilt of the board on the display instead, found by the CORDIC
+	  unit - pitch, roll or magnitude, chosen by the same two switches - see cordic.h.
+	Command "bench" times the arithmetic and CORDIC units against the C library routines,
+	  and the DMA controller against a copy loop - see bench.h.
+	Command "perf" prints the performance counters since the last "perf" - see perf.h.
+	Button BTNC prints the cycle counts of the profiled regions, then clears them - see prof.h.
+	Switches and BTNC are not polled: the GPIO block debounces them and interrupts on a
+	  change, and GPIO_ISR updates SwitchState.  A switch change wakes main() at once.
+
 	Version 6 - March 2023
 	Edited April 2023 - SoC Group 14
   ------------------------------------------------------------------------------------------------*/
 
 #include <stdio.h>					// needed for printf
 #include <stdlib.h>
+#include <string.h>					// for strcmp
 #include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "adxl362.h"				// accelerometer functions
+#include "retarget.h"				// buffered UART output
+#include "telemetry.h"				// binary telemetry frames
+#include "sampler.h"				// accelerometer sampling engine
+#include "bench.h"					// cycle-count benchmarks
+#include "perf.h"						// performance counters
+#include "prof.h"						// cycle profiler for regions of code
+#include "cordic.h"					// CORDIC unit, for the tilt angles
 
-// Define names for SPI slaves
-#define NONE 0
-#define DISP 1
-#define ACL  2
 #define BUF_SIZE						100				// size of the array to hold received characters
 #define ASCII_CR						'\r'			// character to mark the end of input
 #define CASE_BIT						('A' ^ 'a')		// bit pattern used to change the case of a letter
 #define FLASH_DELAY					1000000		// delay for flashing LEDs, ~220 ms
-#define INVERT_LEDS					(GPIO_LED ^= 0xff)		// inverts the 8 rightmost LEDs
+#define INVERT_LEDS					(GPIO_LED_TOGGLE = 0xff)		// inverts the 8 rightmost LEDs
 #define ARRAY_SIZE(__x__)   (sizeof(__x__)/sizeof(__x__[0]))  // macro to find array size
+#define ACC_BUF_SETS				128					// sample sets in circular buffer, must be a power of 2
+#define DISPLAY_SAMPLES			160					// sample sets between display updates, 400 ms at 400 Hz
+#define TLM_SAMPLES					4						// sample sets between binary frames, 100 frames/s at 400 Hz
+#define TLM_SWITCH_MASK			0x8000			// switch 15 selects binary telemetry
+#define TILT_SWITCH_MASK		0x0004			// switch 2 selects the tilt display
+#define USE_SAMPLER					1						// 1 - sampling engine reads the accelerometer, 0 - Acc_ISR does
+#define SMP_AVERAGE					4						// sample sets averaged by the engine into each one stored
+#define SMP_BATCH						(TLM_SAMPLES / SMP_AVERAGE)	// averaged sets in engine buffer per interrupt
+#define SWITCH_EVENTS				0xFFFF			// all 16 switches, in the GPIO edge registers
+#define BTNC_EVENT					(BTNC_MASK << GPIO_IN1_SHIFT)	// BTNC in the GPIO edge registers
+
+#if USE_SAMPLER
+#define NVIC_ACC_BIT_POS		NVIC_SMP_BIT_POS
+#else
+#define NVIC_ACC_BIT_POS		NVIC_ACL_BIT_POS
+#endif
 
-// Global variables - shared between main and UART_ISR
+// Global variables - shared between main and UART_ISR, Acc_ISR or Sampler_ISR
 volatile uint8  RxBuf[BUF_SIZE];	// array to hold received characters
 volatile uint8  counter  = 0; 		// current number of characters in RxBuf[]
 volatile uint8  BufReady = 0; 		// flag indicates data in RxBuf is ready for processing
@@ -37,26 +77,102 @@ volatile int16  reg_read;
 volatile uint8  switch_read;
 volatile uint8  junk;
 volatile uint16  leds;
-uint8* displayReg = (uint8*) DISPLAY_BASE;   // Access to each of the numbers displayed.
+AccSample AccBuf[ACC_BUF_SETS];		// circular buffer of sample sets, written by Acc_ISR or Sampler_ISR
+volatile uint8  AccHead  = 0;			// position in AccBuf[] for the next sample set
+volatile uint16 AccCount = 0;			// sample sets received since the last display update
+volatile uint16 AccTime  = 0;			// sample sets received since start, used as timestamp
+volatile uint16 SwitchState;			// debounced switches, kept up to date by GPIO_ISR
+volatile uint8  SwitchChanged = 0;	// set by GPIO_ISR, main() stops waiting for samples
+volatile uint8  ProfRequest = 0;	// BTNC pressed, main() prints the profile
+uint8 binaryCmd  = 0;							// binary telemetry selected by command
+uint8 binaryMode = 0;							// binary telemetry in use - no text output
 
 //////////////////////////////////////////////////////////////////
 // Interrupt service routine, runs when UART interrupt occurs - see cm0dsasm.s
+// Either a character has been received, or the transmit FIFO needs refilling.
 //////////////////////////////////////////////////////////////////
 void UART_ISR() {
 	char c;
-	c = UART_RXD;	 				// read character from UART (there must be one waiting)
-	RxBuf[counter]  = c;  // store in buffer
-	counter++;            // increment counter, number of characters in buffer
-	UART_TXD = c;  				// write character to UART (assuming transmit queue not full)
-	/* Counter is now the position in the buffer that the next character should go into.
-		If this is the end of the buffer, i.e. if counter == BUF_SIZE-1, then null terminate
-		and indicate that a complete sentence has been received.
-		If the character just put in was a carriage return, do the same.  */
-	if (counter == BUF_SIZE-1 || c == ASCII_CR) {
-		counter--;							// decrement counter (CR will be over-written)
-		RxBuf[counter] = NULL;  // null terminate to make the array a valid string
-		BufReady       = 1;	    // indicate that data is ready for processing
+	PROF_START(PROF_UART_ISR);
+	uart_tx_isr();				// refill transmit FIFO from the printf ring buffer
+	// The rx level and idle interrupts are used, so take all the characters waiting
+	while (UART_STS & (1 << UART_RX_FIFO_NOTEMPTY_BIT_POS)) {
+		c = UART_RXD;	 				// read character from UART
+		RxBuf[counter]  = c;  // store in buffer
+		counter++;            // increment counter, number of characters in buffer
+		uart_out(c);  				// echo character, queued behind any printf output
+		/* Counter is now the position in the buffer that the next character should go into.
+			If this is the end of the buffer, i.e. if counter == BUF_SIZE-1, then null terminate
+			and indicate that a complete sentence has been received.
+			If the character just put in was a carriage return, do the same.  */
+		if (counter == BUF_SIZE-1 || c == ASCII_CR) {
+			counter--;							// decrement counter (CR will be over-written)
+			RxBuf[counter] = '\0';  // null terminate to make the array a valid string
+			BufReady       = 1;	    // indicate that data is ready for processing
+		}
+	}
+	PROF_STOP(PROF_UART_ISR);
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs when accelerometer INT1 goes high - see cm0dsasm.s
+// INT1 is mapped to data ready, which is cleared by reading the data registers.
+// main() does not use the SPI once this interrupt is enabled, so no locking is needed.
+//////////////////////////////////////////////////////////////////
+void Acc_ISR() {
+	PROF_START(PROF_ACC_READ);
+	AccReadAll(&AccBuf[AccHead]);					// read X, Y, Z and temperature, clears INT1
+	PROF_STOP(PROF_ACC_READ);
+	AccHead = (AccHead + 1) & (ACC_BUF_SETS - 1);	// advance, wrapping round
+	AccCount++;
+	AccTime++;
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs when the sampling engine buffer holds SMP_BATCH
+// averaged sample sets - see cm0dsasm.s.  Takes everything waiting, which clears the
+// interrupt.  Each one stands for SMP_AVERAGE sets from the accelerometer, so the
+// counts go up by that much, and the display and telemetry rates stay the same.
+//////////////////////////////////////////////////////////////////
+void Sampler_ISR() {
+	PROF_START(PROF_ACC_READ);
+	while (SmpGet(&AccBuf[AccHead], NULL)) {
+		AccHead = (AccHead + 1) & (ACC_BUF_SETS - 1);
+		AccCount += SMP_AVERAGE;
+		AccTime += SMP_AVERAGE;
+	}
+	PROF_STOP(PROF_ACC_READ);
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs when the GPIO block has seen a debounced
+// switch change or a BTNC press - see cm0dsasm.s.  Clears the events it handles.
+//////////////////////////////////////////////////////////////////
+void GPIO_ISR() {
+	uint32 events = GPIO_EVENTS;
+	GPIO_EVENTS = events;
+	if (events & SWITCH_EVENTS) {
+		SwitchState = (uint16)GPIO_STABLE;
+		SwitchChanged = 1;
 	}
+	if (events & BTNC_EVENT) ProfRequest = 1;
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine, runs when a DMA channel with its interrupt
+// enabled has finished - see cm0dsasm.s.  DmaWait() watches the busy bits,
+// so this only clears the done bits, which clears the interrupt.
+//////////////////////////////////////////////////////////////////
+void DMA_ISR() {
+	DMA_STS = DMA_STS;
+}
+
+//////////////////////////////////////////////////////////////////
+// Interrupt service routine for the mailbox - only used in the dual-core
+// system, see main-dual.c
+//////////////////////////////////////////////////////////////////
+void Mailbox_ISR() {
+	// Do nothing - this interrupt is not used here
 }
 
 //////////////////////////////////////////////////////////////////
@@ -76,90 +192,53 @@ void delay (uint32 n) {
 		for(i=0; i<n; i++);		// do nothing n times
 }
 
-// set CS low when argument is ACL, set CS high when argument is NONE
-void SPIselect(uint8 sel) {
-	if (sel) 							// if input not zero
-		GPIO_ACL &= 0xFFFE; // bitwise AND sets the LSB (aclSSn) to 0
-	else
-		GPIO_ACL |= 0x0001; // bitwise OR sets the LSB (aclSSn) to 1
-}
-
-// function must generate 8 clock pulses
-uint8 SPIbyte(uint8 TXdata) {
-	uint8 RXbyte;															// read byte that will be returned
-	int8 i;
-	// bit 2 of GPIO_ACL is MOSI (input bit)
-	for (i = 7 ; i >= 0 ; i--) {
-		GPIO_ACL = ((TXdata >> i) & 1) << 2;		// bit i sent to MOSI (GPIO_ACL[2])
-		delay(10);															// delay half clock cycle
-		GPIO_ACL |= 0x2;												// send SCLK high
-		RXbyte = (RXbyte<<1)|(GPIO_IN1>>15);		// sample MISO (MSB of GPIO_IN1)
-		delay(10);															// delay half clock cycle
-		GPIO_ACL &= ~0x2;	 											// send SCLK low
-	}
-	return RXbyte;
-}
-
-// function to read from accelerometer
-int16 AccRead(uint8 address) {        // takes in a value and calls it 'address'
-	int8 byteRXL;
-	int16 byteRXH;
-	int16 ret_val;
-	SPIselect(ACL);											// sets CS low to start SPI transaction
-	SPIbyte(0x0B);											// sends read instruction
-	SPIbyte(address);										// sends address
-	byteRXL = SPIbyte(0xFF);						// gets reg data (sends junk) 
-	byteRXH = SPIbyte(0xFF);						// gets reg data, high byte. will read next address automatically.
-	SPIselect(NONE);										// sets CS high to end SPI transaction
-	ret_val = byteRXL | (byteRXH << 8); // shift high bytes to left and add low bytes
-	return ret_val;
-}
-
-// function to write to accelerometer
-void AccWrite(uint8 address, uint8 byteTX) {
-	SPIselect(ACL);							// sets CS low to start SPI transaction
-	SPIbyte(0x0A);							// sends write instruction
-	SPIbyte(address);						// sends address
-	SPIbyte(byteTX);						// sends byte
-	SPIselect(NONE);
-}
-
 // function to display acceleration value on LEDs
 uint16 OH_LED(int16 reg_read) {
 	uint16 value = 0xFFFF;
 	uint16 x;
+	PROF_START(PROF_OH_LED);
 	if (reg_read > 0) {
 	 reg_read = abs(reg_read);			// remove sign
-	 printf("reg_read pos: %d\n", reg_read);
+	 if (!binaryMode) printf("reg_read pos: %d\n", reg_read);
 	 x = reg_read/128;							// scale down
-	 printf("lights on: %d\n", x);
+	 if (!binaryMode) printf("lights on: %d\n", x);
 	 value = value << (16-x);				// turns 1-x LEDs off on right side
 	}
 	else {
-	 printf("reg_read neg: %d\n", reg_read);
+	 if (!binaryMode) printf("reg_read neg: %d\n", reg_read);
 	 reg_read = abs(reg_read);			// remove sign
 	 x = reg_read/128;							// scale down
-	 printf("lights on: %d\n", x);
+	 if (!binaryMode) printf("lights on: %d\n", x);
 	 value = value >> (16-x);				// turns 1-x LEDs off on right side
 	}
+	PROF_STOP(PROF_OH_LED);
 	return value;
 }
 
+// function to show a signed value in decimal on the 7-segment display - the display
+// hardware does the conversion, blanks leading zeros and adds the minus sign
 void displayValue(int16 value) {
-	uint8 i = 0;
-	if(value<0) {
-		value = -value;
-	  displayReg[4] = 17;            // display of negative sign
-	} else
-		displayReg[4] = 31;            // If it is a positive number or 0, this digital position does not show anything.
-	displayReg[8] = 0xFF;            // Set hex mode for each digit.
-	displayReg[9] = 0xFF;            // Enable each digit.
-	displayReg[5] = 31;              // This digital position does not show anything.
-	displayReg[6] = 31;              // This digital position does not show anything.
-	displayReg[7] = 31;              // This digital position does not show anything.
-	for (i = 0; i < 4; i++) {        // Display numbers one by one. In total there are 4 figures to be displayed.
-	 displayReg[i] = value%10;
-	 value = value/10;
+	PROF_START(PROF_DISPLAY);
+	DISPLAY_DECIMALS = 0;
+	DISPLAY_NUMBER = value;          // sign-extended to a word
+	PROF_STOP(PROF_DISPLAY);
+}
+
+// function to show the tilt angles in degrees, with two decimal places, or the magnitude
+// in mg - chosen by the two rightmost switches, as for the axes
+void displayTilt(const Tilt *t, uint8 choice) {
+	PROF_START(PROF_DISPLAY);
+	DISPLAY_DECIMALS = (choice < 2) ? 2 : 0;
+	DISPLAY_NUMBER = (choice == 0) ? t->pitch : (choice == 1) ? t->roll : t->mag;
+	PROF_STOP(PROF_DISPLAY);
+}
+
+// print the profile if BTNC has been pressed - called each time main() wakes up
+static void profButton(void) {
+	if (ProfRequest) {
+		ProfRequest = 0;
+		ProfReport();
+		ProfClear();
 	}
 }
 
@@ -167,57 +246,140 @@ void displayValue(int16 value) {
 // Main Function
 //////////////////////////////////////////////////////////////////
 int main(void) {
+	AccSample latest;						// copy of the latest sample set from the circular buffer
+	uint16 timestamp;						// AccTime when it was copied
+	Tilt tilt;									// tilt angles of the latest sample set
 
 // ========================  Initialisation ==========================================
 
 	// Configure the UART - the control register decides which events cause interrupts
-	UART_CTL = (1 << UART_RX_FIFO_NOTEMPTY_BIT_POS);	// enable rx data available interrupt only
+	// Interrupt when 16 characters are waiting, or when input stops for 4 character times,
+	// so a typed line or a burst of input is handled in one interrupt
+	UART_RXLVL = 16;
+	UART_TIMEOUT = 40;
+	UART_CTL = (1 << UART_RX_LEVEL_BIT_POS) | (1 << UART_RX_IDLE_BIT_POS);
+
+	// Debounced events from any switch, and from BTNC when pressed
+	GPIO_DEBOUNCE = GPIO_DEBOUNCE_5MS;
+	GPIO_RISE = SWITCH_EVENTS | BTNC_EVENT;
+	GPIO_FALL = SWITCH_EVENTS;
+	SwitchState = GPIO_SW;
+	GPIO_EVENTS = 0xFFFFFFFF;												// clear anything seen before
 
 	// Configure the interrupt system in the processor (NVIC)
-	NVIC_Enable = (1 << NVIC_UART_BIT_POS);		        // Enable the UART interrupt
+	NVIC_Enable = (1 << NVIC_UART_BIT_POS) | (1 << NVIC_GPIO_BIT_POS) | (1 << NVIC_DMA_BIT_POS);	// Enable the UART, GPIO and DMA interrupts
 
 	delay(FLASH_DELAY);												        // wait a short time
 	printf("\n\nWelcome to Cortex-M0 SoC\n");		      // print a welcome message
-	AccWrite(0x2D, 0x2);		                          // set POWER_CTL register
-	AccWrite(0x2C, 0x1);		                          // set FILTER_CTL register
+	ProfInit();																				// start the cycle counter for profiling
+	AccWrite(ADXL_FILTER_CTL, ADXL_HALF_BW | ADXL_ODR_400HZ);	// 400 Hz output data rate, +/- 2 g
+	AccWrite(ADXL_INTMAP1, ADXL_INT_DATA_READY);      // INT1 pin high when a sample set is ready
+	AccWrite(ADXL_POWER_CTL, ADXL_MEASURE);		        // start measuring
+
+#if USE_SAMPLER
+	// The engine reads each sample set on data ready, averages them to cut the noise, and
+	// interrupts when a batch is waiting
+	SmpAverage(SMP_AVERAGE);
+	SmpStart(0, SMP_BATCH, 1);
+#else
+	// Enable the interrupt from INT1 in the SPI block
+	SPI_CTL |= (1 << SPI_INT1_BIT_POS);
+#endif
+	NVIC_Enable = (1 << NVIC_ACC_BIT_POS);
 
 // ========================  Working Loop ==========================================
 
 	while(1) {		                          // loop forever	
-			delay(2000000);                     // delay of about 400ms. large fraction of a second. sets refresh rate
-			switch_read = GPIO_SW; 					    // check value from switches
+			binaryMode = binaryCmd || (SwitchState & TLM_SWITCH_MASK);
+			// sleep until enough sample sets have arrived, or a switch has changed
+			while (AccCount < (binaryMode ? TLM_SAMPLES : DISPLAY_SAMPLES) && !SwitchChanged) {
+				__wfi();  // Wait For Interrupt: enter Sleep Mode until interrupt occurs
+				profButton();
+			}
+			SwitchChanged = 0;
+			binaryMode = binaryCmd || (SwitchState & TLM_SWITCH_MASK);	// the switch may have changed
+
+			// copy the latest sample with the accelerometer interrupt disabled, so it is consistent
+			NVIC_Disable = (1 << NVIC_ACC_BIT_POS);
+			latest = AccBuf[(AccHead - 1) & (ACC_BUF_SETS - 1)];
+			timestamp = AccTime;
+			AccCount = 0;
+			NVIC_Enable = (1 << NVIC_ACC_BIT_POS);
+
+			if (binaryMode) {
+				PROF_START(PROF_TELEMETRY);
+				TlmSendFrame(timestamp, &latest);		// all three axes, 12 bytes
+				PROF_STOP(PROF_TELEMETRY);
+			}
+
+			// check for a command - "bin" or "txt" selects the telemetry mode, "bench" runs benchmarks,
+			// "perf" reports the performance counters
+			if (BufReady) {
+				if (strcmp((char *)RxBuf, "bin") == 0) binaryCmd = 1;
+				else if (strcmp((char *)RxBuf, "txt") == 0) binaryCmd = 0;
+				else if (strcmp((char *)RxBuf, "bench") == 0) {
+					BenchArith();
+					BenchCordic();
+					BenchDma();
+				}
+				else if (strcmp((char *)RxBuf, "perf") == 0) {
+					PerfReport();
+					PerfClear();								// the next report covers the time from here
+				}
+				NVIC_Disable = (1 << NVIC_UART_BIT_POS);	// reset the buffer with UART interrupt disabled
+				counter  = 0;
+				BufReady = 0;
+				NVIC_Enable = (1 << NVIC_UART_BIT_POS);
+			}
+
+			switch_read = SwitchState; 			    // switches, as seen by GPIO_ISR
 			switch_read &= 0x3;							    // zero all bits except 2 LSB
 			
-			// set register to read based on input from last two switches
+			// choose axis to show from the latest sample, based on input from last two switches
 			// 00 - X-Axis
 			// 01 - Y-Axis
 			// 1x - Z-Axis
 			switch (switch_read) {
 				case 0:
-					reg_read = AccRead(0x0E); 			// read xdata reg
+					reg_read = latest.x;
 					leds = OH_LED(reg_read);
 					GPIO_LED = leds;								// output to LEDs
-					printf("X-Axis: %u\n", leds);
+					if (!binaryMode) {
+						PROF_START(PROF_PRINTF);
+						printf("X-Axis: %u\n", leds);
+						PROF_STOP(PROF_PRINTF);
+					}
 					break;
 				case 1:
-					reg_read = AccRead(0x10); 			// read ydata reg
+					reg_read = latest.y;
 					leds = OH_LED(reg_read);
 					GPIO_LED = leds;								// output to LEDs
-					printf("Y-Axis: %u\n", leds);
+					if (!binaryMode) {
+						PROF_START(PROF_PRINTF);
+						printf("Y-Axis: %u\n", leds);
+						PROF_STOP(PROF_PRINTF);
+					}
 					break;
-				case 2:
-					reg_read = AccRead(0x12); 			// read zdata reg
-					leds = OH_LED(reg_read);
-					GPIO_LED = leds;								// output to LEDs
-					printf("Z-Axis: %u\n", leds);
-				case 3:
-					reg_read = AccRead(0x12); 			// read zdata reg
+				default:
+					reg_read = latest.z;
 					leds = OH_LED(reg_read);
 					GPIO_LED = leds;								// output to LEDs
-					printf("Z-Axis: %u\n", leds);
-				default:
+					if (!binaryMode) {
+						PROF_START(PROF_PRINTF);
+						printf("Z-Axis: %u\n", leds);
+						PROF_STOP(PROF_PRINTF);
+					}
 					break;
 			}
-		displayValue(reg_read);               // display gravitational acceleration
+		if (SwitchState & TILT_SWITCH_MASK) {
+			CordicTilt(&latest, &tilt);					// 34 clock cycles in hardware
+			displayTilt(&tilt, switch_read);
+			if (!binaryMode) {
+				PROF_START(PROF_PRINTF);
+				printf("Pitch: %d Roll: %d Mag: %u\n", tilt.pitch, tilt.roll, tilt.mag);
+				PROF_STOP(PROF_PRINTF);
+			}
+		}
+		else displayValue(reg_read);          // display gravitational acceleration
 	} // end of infinite loop
 }  // end of main
@@ -0,0 +1,57 @@
+/*  Functions for the performance counters - see perf.h
+	The report freezes the counters first, so all the numbers cover the same cycles,
+	and the printing itself is not counted.  */
+
+#include <stdio.h>
+#include "perf.h"
+
+#define PERF_CLOCK_KHZ			50000		// bus clock, for the time in the report
+
+// Slave names, in the order of the AHBDCD slave numbers
+static const char * const perfNames[PERF_SLAVES] = {
+	"ROM", "RAM", "GPIO", "UART", "display", "SPI", "sampler", "arith", "perf", "DMA", "mailbox", "CORDIC", "unmapped"
+};
+
+void PerfClear(void) {
+	pt2PERF->Control = (1 << PERF_CLEAR_BIT_POS);		// clears, and freeze bit is 0
+}
+
+void PerfFreeze(void) {
+	pt2PERF->Control = (1 << PERF_FREEZE_BIT_POS);
+}
+
+void PerfRun(void) {
+	pt2PERF->Control = 0;
+}
+
+// count as a fraction of total, in tenths of a percent
+static uint32 perfTenths(uint32 count, uint32 total) {
+	if (total == 0) return 0;
+	return (uint32)(((unsigned long long)count * 1000) / total);
+}
+
+static void perfLine(const char *name, uint32 count, uint32 total) {
+	uint32 t = perfTenths(count, total);
+	printf("  %-9s %10u  %3u.%u%%\n", name, count, t / 10, t % 10);
+}
+
+void PerfReport(void) {
+	uint32 total, reads, writes, t;
+	int i;
+	PerfFreeze();
+	total = pt2PERF->Total;
+	printf("\nPerformance counters: %u cycles, %u ms\n", total, total / PERF_CLOCK_KHZ);
+	perfLine("asleep", pt2PERF->Sleep, total);
+	perfLine("lockup", pt2PERF->Lockup, total);
+	perfLine("bus wait", pt2PERF->Wait, total);
+	perfLine("bus idle", pt2PERF->Idle, total);
+	printf("  %-9s %10s %10s  %s\n", "slave", "reads", "writes", "bus use");
+	for (i = 0; i < PERF_SLAVES; i++) {
+		reads = pt2PERF->Slave[i].Reads;
+		writes = pt2PERF->Slave[i].Writes;
+		if (reads == 0 && writes == 0) continue;
+		t = perfTenths(reads + writes, total);		// each transaction takes at least one cycle
+		printf("  %-9s %10u %10u  %3u.%u%%\n", perfNames[i], reads, writes, t / 10, t % 10);
+	}
+	PerfRun();
+}
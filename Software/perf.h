@@ -0,0 +1,24 @@
+/* perf.h
+	Functions for the performance counters (AHBperf), which count clock cycles,
+	cycles asleep, bus wait states and the bus transactions to each slave, so a
+	report shows where the time and the bus bandwidth go.  Instruction fetches are
+	reads of the ROM, and reading the counters adds reads of the counter block.  */
+
+#ifndef PERF_HDR_ALREADY_INCLUDED
+#define PERF_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+
+// Set all counters to 0 and start counting
+void PerfClear(void);
+
+// Stop and restart the counters, e.g. to leave out the time spent printing a report
+void PerfFreeze(void);
+void PerfRun(void);
+
+/* Print the counters through the UART: cycles, then the share of them asleep, in
+   lockup, waiting and idle, then reads and writes for each slave.  The counters are
+   frozen while printing, and count on afterwards.  */
+void PerfReport(void);
+
+#endif
@@ -0,0 +1,64 @@
+/*  Cycle profiler for regions of firmware - see prof.h
+	The counter counts down, so the cycles in a region are start - end, and masking
+	to 24 bits gives the right answer when the counter has wrapped once.  */
+
+#include <stdio.h>
+#include "prof.h"
+
+// Region names, in the order of the numbers in prof.h
+static const char * const profNames[PROF_REGIONS] = {
+	"acc read", "OH_LED", "displayValue", "printf", "telemetry", "UART_ISR"
+};
+
+typedef struct {
+	uint32 count;
+	uint32 min, max;
+	unsigned long long total;
+} ProfEntry;
+
+uint32 ProfStarts[PROF_REGIONS];
+static ProfEntry profTable[PROF_REGIONS];
+static uint32 profOverhead;						// cycles between the counter reads of an empty region
+
+void ProfClear(void) {
+	int i;
+	for (i = 0; i < PROF_REGIONS; i++) {
+		profTable[i].count = 0;
+		profTable[i].min = 0xFFFFFFFF;
+		profTable[i].max = 0;
+		profTable[i].total = 0;
+	}
+}
+
+void ProfInit(void) {
+	uint32 start;
+	SysTick_Reload = PROF_SYSTICK_MASK;
+	SysTick_Counter = 0;								// any write clears the counter, then it reloads
+	SysTick_Control = (1 << SYSTICK_ENABLE_BIT_POS) | (1 << SYSTICK_CLOCK_SOURCE_BIT_POS);
+	start = SysTick_Counter;						// the same two reads as PROF_START and PROF_STOP
+	profOverhead = (start - SysTick_Counter) & PROF_SYSTICK_MASK;
+	ProfClear();
+}
+
+void ProfStop(uint8 region, uint32 count) {
+	ProfEntry *e = &profTable[region];
+	uint32 cycles = (ProfStarts[region] - count) & PROF_SYSTICK_MASK;
+	cycles = (cycles > profOverhead) ? cycles - profOverhead : 0;
+	e->count++;
+	e->total += cycles;
+	if (cycles < e->min) e->min = cycles;
+	if (cycles > e->max) e->max = cycles;
+}
+
+void ProfReport(void) {
+	int i;
+	const ProfEntry *e;
+	printf("\nProfile, clock cycles (%u removed for the counter reads)\n", profOverhead);
+	printf("%-13s %8s %8s %8s %8s %12s\n", "region", "count", "min", "max", "mean", "total");
+	for (i = 0; i < PROF_REGIONS; i++) {
+		e = &profTable[i];
+		if (e->count == 0) continue;
+		printf("%-13s %8u %8u %8u %8u %12llu\n", profNames[i], e->count, e->min, e->max,
+			(uint32)(e->total / e->count), e->total);
+	}
+}
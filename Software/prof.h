@@ -0,0 +1,58 @@
+/* prof.h
+	Cycle profiler for regions of firmware, using the SysTick timer as a free-running
+	24-bit down-counter of processor clock cycles.  Put PROF_START(region) and
+	PROF_STOP(region) around the code to measure.  Each region keeps the number of
+	times it ran and the minimum, maximum and total cycles, and ProfReport() prints
+	the table through the UART.
+	The start macro is a single read of the SysTick counter and a store, and the stop
+	macro reads the counter before calling ProfStop, so the bookkeeping is outside
+	the measured time.  The cost of the two counter reads is measured by ProfInit()
+	and subtracted.  The counter wraps every 2^24 cycles (335 ms at 50 MHz), so a
+	region must be shorter than that.  Interrupts that occur inside a region are
+	included in its time.  Different regions can be nested, but a region must not be
+	started again before it is stopped.
+	SysTick is used without its interrupt, so this cannot be used with a program that
+	needs the SysTick interrupt.  Set PROF_ENABLE to 0 to remove all the profiling.  */
+
+#ifndef PROF_HDR_ALREADY_INCLUDED
+#define PROF_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE					1
+#endif
+
+// Regions - add new ones here, and their names in prof.c
+#define PROF_ACC_READ				0			// reading sample sets in the accelerometer ISR
+#define PROF_OH_LED					1			// OH_LED, including its printf calls
+#define PROF_DISPLAY				2			// displayValue
+#define PROF_PRINTF					3			// printf of the axis value
+#define PROF_TELEMETRY			4			// TlmSendFrame
+#define PROF_UART_ISR				5			// UART_ISR
+#define PROF_REGIONS				6			// number of regions
+
+#define PROF_SYSTICK_MASK		0xFFFFFF	// SysTick counter is 24 bits
+
+#if PROF_ENABLE
+extern uint32 ProfStarts[PROF_REGIONS];			// SysTick count at the start of each region
+#define PROF_START(region)	(ProfStarts[region] = SysTick_Counter)
+#define PROF_STOP(region)		ProfStop((region), SysTick_Counter)
+#else
+#define PROF_START(region)	((void)0)
+#define PROF_STOP(region)		((void)0)
+#endif
+
+// Start the SysTick counter and clear the table
+void ProfInit(void);
+
+// End of a region, with the SysTick count at the end - use PROF_STOP
+void ProfStop(uint8 region, uint32 count);
+
+// Clear the table, keeping the counter running
+void ProfClear(void);
+
+// Print the table through the UART: count, minimum, maximum, mean and total cycles
+void ProfReport(void);
+
+#endif
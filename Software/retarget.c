@@ -1,13 +1,24 @@
 /*  Low-level stream input-output functions, using UART.
 	Based on a template provided by ARM, modified for the SoC Design Assignment.
 	Version 3 - March 2022 - includes UART input to support fgetc(), with input 
-	characters echoed back to output stream for use with RealTerm or similar. 	*/
+	characters echoed back to output stream for use with RealTerm or similar. 	
+	Edited April 2023 - SoC Group 14 - output goes through a RAM ring buffer, which is
+	emptied into the UART transmit FIFO by the tx FIFO empty interrupt (see uart_tx_isr),
+	so printf does not wait for the serial line.  */
 
 #include <stdio.h>
 #include "DES_M0_SoC.h"		// defines hardware registers
+#include "retarget.h"
 
 #define ASCII_CR 13		// carriage return
 #define ASCII_LF 10		// line feed
+#define TX_RING_SIZE 256	// size of transmit ring buffer - 256 so the uint8 indexes wrap round
+
+/* Policy when the ring buffer is full:
+	0 - the character is dropped and counted in uart_tx_dropped, so the caller never waits
+	1 - the caller waits with interrupts disabled, moving characters from the ring to
+	    the UART itself, so it is also safe to use in an interrupt service routine */
+#define UART_TX_BLOCK 0
 
 #pragma import(__use_no_semihosting)
 
@@ -18,17 +29,70 @@ struct __FILE {
 FILE __stdout = 	{(unsigned char *)&pt2UART->TxData};
 FILE __stdin = 		{(unsigned char *)&pt2UART->RxData};
 
-// Function to output one character through the UART
+// Transmit ring buffer - main code writes at head, uart_tx_isr reads at tail
+static uint8 txRing[TX_RING_SIZE];
+static volatile uint8 txHead = 0;		// position for the next character in
+static volatile uint8 txTail = 0;		// position of the oldest character
+volatile unsigned int uart_tx_dropped = 0;	// characters lost because the ring was full
+
+// Move characters from the ring buffer to the UART transmit FIFO, until one is full or
+// the other empty.  Returns 1 if the ring is now empty.
+static int tx_refill(void)
+{
+	while ((txTail != txHead) && !(pt2UART->Status & (1<<UART_TX_FIFO_FULL_BIT_POS)))
+	{
+		pt2UART->TxData = txRing[txTail];
+		txTail++;									// wraps round at 256
+	}
+	return (txTail == txHead);
+}
+
+/* Called from UART_ISR.  The tx FIFO empty interrupt is enabled while the ring holds
+   characters - refill the FIFO, and disable the interrupt when the ring is empty.  */
+void uart_tx_isr(void)
+{
+	if (tx_refill())
+		pt2UART->Control &= ~(1<<UART_TX_FIFO_EMPTY_BIT_POS);
+}
+
+/* Function to output one character through the UART, without waiting for the serial line.
+   Both main code and UART_ISR (echo) can send, so interrupts are disabled while the
+   ring is changed.  __disable_irq returns the previous state, so this is also safe
+   to call from an interrupt service routine.  */
 int uart_out(int ch)
 {
-	while((pt2UART->Status & (1<<UART_TX_FIFO_FULL_BIT_POS)))	
+	int masked = __disable_irq();
+	if ((txTail == txHead) && !(pt2UART->Status & (1<<UART_TX_FIFO_FULL_BIT_POS)))
+		pt2UART->TxData = (char)ch;		// nothing queued and the FIFO has space
+	else
 	{
-		// Wait until uart has space in the transmit FIFO
+#if UART_TX_BLOCK
+		while ((uint8)(txHead + 1) == txTail)	// ring is full - wait for space,
+			tx_refill();							// emptying the ring ourselves
+#else
+		if ((uint8)(txHead + 1) == txTail)	// ring is full - drop this character
+		{
+			uart_tx_dropped++;
+			if (!masked) __enable_irq();
+			return(ch);
+		}
+#endif
+		txRing[txHead] = (uint8)ch;
+		txHead++;									// wraps round at 256
+		pt2UART->Control |= (1<<UART_TX_FIFO_EMPTY_BIT_POS);	// interrupt when FIFO needs more
 	}
-	pt2UART->TxData = (char)ch;
+	if (!masked) __enable_irq();		// restore previous interrupt state
 	return(ch);
 }
 
+// Set the bit rate - the UART uses an accumulator, so the increment is
+// bit rate * 2**23 / clock frequency, rounded to the nearest integer
+void uart_set_baud(unsigned int baud)
+{
+	unsigned long long incr = ((unsigned long long)baud << 23) + UART_CLOCK_HZ/2;
+	UART_BAUD = (uint32)(incr / UART_CLOCK_HZ);
+}
+
 // Function to get one character received through the UART
 int uart_in( void )
 {
@@ -0,0 +1,22 @@
+/*  retarget.h
+	Functions in retarget.c for the buffered UART output used by printf.
+	Uses only basic C types, so it can be used with DES_M0_SoC.h or DES_M0_CMSIS.h.  */
+
+#ifndef RETARGET_HDR_ALREADY_INCLUDED
+#define RETARGET_HDR_ALREADY_INCLUDED
+
+// Number of characters dropped because the transmit ring buffer was full
+extern volatile unsigned int uart_tx_dropped;
+
+// Output one character through the ring buffer - safe to use in an interrupt service routine
+int uart_out(int ch);
+
+// Refill the UART transmit FIFO from the ring buffer - call from UART_ISR
+void uart_tx_isr(void);
+
+/* Set the UART bit rate, 9600 up to 921600 or more (maximum is clock / 8).
+   Characters still being sent will be corrupted, so call this when output has finished.
+   The host terminal must be changed to the same rate.  */
+void uart_set_baud(unsigned int baud);
+
+#endif
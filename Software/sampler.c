@@ -0,0 +1,44 @@
+/*  Functions for the accelerometer sampling engine - see sampler.h  */
+
+#include "sampler.h"
+
+void SmpStart(uint32 period_hz, uint16 level, uint8 withTemp) {
+	uint32 control = (1 << SMP_ENABLE_BIT_POS);
+	if (period_hz == 0) control |= (1 << SMP_DRDY_BIT_POS);
+	else SMP_PERIOD = SMP_CLOCK_HZ / period_hz;
+	if (withTemp) control |= (1 << SMP_TEMP_BIT_POS);
+	if (level) control |= (1 << SMP_LEVEL_INT_BIT_POS);
+	SMP_DIV = SPI_DIV;								// same SPI clock as the SPI block
+	SMP_LEVEL = level;
+	SMP_STS = (1 << SMP_OVERFLOW_BIT_POS);		// clear any old overflow
+	SMP_CTL = control;
+}
+
+void SmpStop(void) {
+	SMP_CTL = 0;
+	while (SMP_STS & (1 << SMP_BUSY_BIT_POS));	// wait until the SPI pins are released
+}
+
+void SmpAverage(uint16 ratio) {
+	uint32 shift = 0;
+	while ((2u << shift) <= ratio) shift++;		// log2(ratio)
+	SMP_FILTER = ((uint32)(ratio - 1) << SMP_RATIO_BIT_POS) | (shift << SMP_SHIFT_BIT_POS);
+}
+
+void SmpLowPass(uint16 ratio, uint8 shift) {
+	SMP_FILTER = ((uint32)(ratio - 1) << SMP_RATIO_BIT_POS) | ((uint32)shift << SMP_SHIFT_BIT_POS) |
+		(1 << SMP_IIR_BIT_POS);
+}
+
+uint8 SmpGet(AccSample *sample, uint32 *time) {
+	uint32 xy, zt;
+	if (!(SMP_STS & (1 << SMP_NOT_EMPTY_BIT_POS))) return 0;
+	if (time) *time = pt2SMP->SampleTime;
+	xy = pt2SMP->SampleXY;
+	zt = pt2SMP->SampleZT;							// word read, removes the set from the buffer
+	sample->x = (int16)(xy & 0xFFFF);
+	sample->y = (int16)(xy >> 16);
+	sample->z = (int16)(zt & 0xFFFF);
+	sample->temp = (int16)(zt >> 16);
+	return 1;
+}
@@ -0,0 +1,37 @@
+/* sampler.h
+	Functions for the accelerometer sampling engine (AHBsampler), which reads the
+	ADXL362 without the processor and buffers timestamped sample sets in hardware.
+	The engine shares the SPI pins with the SPI block: set up the ADXL362 with the
+	functions in adxl362.h first, then start the engine.  */
+
+#ifndef SAMPLER_HDR_ALREADY_INCLUDED
+#define SAMPLER_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "adxl362.h"				// AccSample
+
+#define SMP_CLOCK_HZ				50000000	// bus clock, for the sample period
+
+/* Start the engine.  If period_hz is 0, each sample set is read when the ADXL362 INT1
+   pin signals data ready (map it with ADXL_INTMAP1), otherwise at period_hz.
+   level is the number of sample sets in the buffer that causes an interrupt, 0 for none.
+   Temperature is read as well if withTemp is not 0.  */
+void SmpStart(uint32 period_hz, uint16 level, uint8 withTemp);
+
+// Stop the engine after any sequence in progress, giving the SPI pins back to the SPI block
+void SmpStop(void);
+
+/* Filter in the engine, which stores one sample set for each ratio it reads (1 to 256),
+   so the processor handles fewer sets with less noise.  Temperature is not filtered.
+   SmpAverage: the mean of each group of ratio sets - ratio must be a power of 2.
+   SmpLowPass: first-order IIR low-pass, each set moves the output 1/2^shift of the way
+   towards it (shift 0 to 15), and the output is stored after every ratio sets.
+   SmpAverage(1) turns the filter off.  Either restarts the filter from the next set.  */
+void SmpAverage(uint16 ratio);
+void SmpLowPass(uint16 ratio, uint8 shift);
+
+/* Take the oldest sample set from the buffer, with its timestamp in microseconds.
+   Returns 0 if the buffer is empty.  time may be NULL.  */
+uint8 SmpGet(AccSample *sample, uint32 *time);
+
+#endif
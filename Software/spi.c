@@ -0,0 +1,21 @@
+/*  Driver for the SPI master hardware (AHBspi), used for the ADXL362 accelerometer.
+	The hardware generates SCLK and shifts the data, so each byte takes 17 half
+	periods of SCLK instead of many GPIO read-modify-write cycles.  */
+
+#include "spi.h"
+
+// Set slave select active when argument is not NONE, inactive when argument is NONE.
+// If a byte is still being transferred, the hardware keeps slave select active until it is finished.
+// The interrupt enable bits in the control register are not changed.
+void SPIselect(uint8 sel) {
+	if (sel)												// if input not zero
+		SPI_CTL |= (1 << SPI_SELECT_BIT_POS);	// hold slave select active
+	else
+		SPI_CTL &= ~(1 << SPI_SELECT_BIT_POS);	// release slave select
+}
+
+// Send one byte and return the byte received at the same time
+uint8 SPIbyte(uint8 TXdata) {
+	SPI_DATA = TXdata;							// start the transfer
+	return SPI_DATA;								// read waits in hardware until the transfer is finished
+}
@@ -0,0 +1,27 @@
+/* spi.h
+	Driver for the SPI master hardware (AHBspi), used for the ADXL362 accelerometer.
+	Same interface as the functions in ADXL362sim.h, so code written for the
+	simulated accelerometer can be used unchanged on the hardware.  */
+
+#ifndef SPI_HDR_ALREADY_INCLUDED
+#define SPI_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+
+// Define names for SPI slaves
+#define NONE 0
+#define DISP 1
+#define ACL  2
+
+/* Function to activate the slave select signal (active low) for
+   a specific slave device. Use argument ACL to select the
+   ADXL362. Use argument NONE to de-select all slaves. */
+void SPIselect ( uint8 slaveNumber );
+
+/* Function to transfer 8 bits on MOSI and MISO, MSB first.
+   The argument is the byte to send on MOSI.  The function will not
+   return until the transfer is complete, about 1.4 us with the default
+   clock divider.  The return value is the byte received on MISO. */
+uint8 SPIbyte ( uint8 byteTX );
+
+#endif
@@ -0,0 +1,27 @@
+/*  Compact binary telemetry frames, sent through the UART ring buffer in retarget.c.
+	The frame format is described in telemetry.h.  */
+
+#include "telemetry.h"
+#include "retarget.h"				// buffered UART output
+
+static uint8 tlmSeq = 0;			// sequence number for the next frame
+
+// Send a 16-bit value LSB first, adding its bytes to the checksum
+static uint8 send16(uint16 value, uint8 sum) {
+	uart_out(value & 0xFF);
+	uart_out(value >> 8);
+	return sum + (value & 0xFF) + (value >> 8);
+}
+
+void TlmSendFrame(uint16 timestamp, const AccSample *sample) {
+	uint8 sum = tlmSeq;
+	uart_out(TLM_SYNC0);
+	uart_out(TLM_SYNC1);
+	uart_out(tlmSeq);
+	sum = send16(timestamp, sum);
+	sum = send16((uint16)sample->x, sum);
+	sum = send16((uint16)sample->y, sum);
+	sum = send16((uint16)sample->z, sum);
+	uart_out((uint8)(0 - sum));				// makes the total 0
+	tlmSeq++;
+}
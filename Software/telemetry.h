@@ -0,0 +1,24 @@
+/* telemetry.h
+	Compact binary frames for sending accelerometer samples over the UART.
+	Each frame is 12 bytes, compared with about 60 bytes of text per sample:
+	  byte 0, 1   sync word 0xA5 0x5A
+	  byte 2      sequence number, increments by 1 for each frame, wraps round
+	  byte 3, 4   timestamp - sample count from the accelerometer, LSB first
+	  byte 5..10  X, Y, Z acceleration in mg, int16, LSB first
+	  byte 11     checksum - bytes 2 to 11 add up to 0 (modulo 256)
+	Tools/tlm_decode.cpp converts a captured stream of frames to CSV.  */
+
+#ifndef TELEMETRY_HDR_ALREADY_INCLUDED
+#define TELEMETRY_HDR_ALREADY_INCLUDED
+
+#include "DES_M0_SoC.h"			// defines registers in the hardware blocks used
+#include "adxl362.h"				// AccSample
+
+#define TLM_SYNC0						0xA5		// first byte of every frame
+#define TLM_SYNC1						0x5A		// second byte of every frame
+#define TLM_FRAME_BYTES			12			// total frame length
+
+// Send one frame through the buffered UART output, does not wait for the serial line
+void TlmSendFrame(uint16 timestamp, const AccSample *sample);
+
+#endif
@@ -0,0 +1,141 @@
+/*  dbg.cpp
+	Command-line client for the debug bridge (Hardware/Design/AHBdebug.v),
+	which reads and writes memory and registers while the program runs,
+	through its own serial port (connector JB, see Nexys4_SoC.xdc).
+	Addresses and values are decimal or 0x hex.  Words only.
+
+	Build:	g++ -O2 -std=c++11 -o dbg dbg.cpp dbglink.cpp
+	Use:	dbg [-p port] [-b bit rate] command ...
+			port defaults to $DBG_PORT, or /dev/ttyUSB1, bit rate to 921600
+	Commands:
+			id							check the bridge answers
+			read  addr [words]			hex dump, 1 word by default
+			fifo  addr words			read one address repeatedly
+			write addr value...			write words to incrementing addresses
+			fill  addr words value		write the same value to a block
+			dump  addr words file		read a block into a binary file, LSB first
+			watch addr [words] [ms]		read a block again every ms (default 200)
+	e.g.	dbg read 0x20000000 64		first 64 words of RAM
+			dbg write 0x50000004 0x00ff	GPIO output port 1
+
+	April 2023 - SoC Group 14
+*/
+
+#include "dbglink.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static void usage() {
+	std::cerr << "use: dbg [-p port] [-b bit rate] command ...\n"
+				 "  id | read addr [words] | fifo addr words | write addr value...\n"
+				 "  fill addr words value | dump addr words file | watch addr [words] [ms]\n";
+	std::exit(2);
+}
+
+static uint32_t number(const char *s) {
+	char *end;
+	unsigned long v = std::strtoul(s, &end, 0);
+	if (*s == '\0' || *end != '\0') {
+		std::cerr << "dbg: bad number " << s << "\n";
+		std::exit(2);
+	}
+	return (uint32_t)v;
+}
+
+// Four words per line, address first
+static void hexDump(uint32_t addr, const std::vector<uint32_t> &words, bool fixed) {
+	for (size_t i = 0; i < words.size(); i++) {
+		if (i % 4 == 0)
+			std::printf("%s%08x:", i ? "\n" : "", fixed ? addr : addr + 4 * (uint32_t)i);
+		std::printf(" %08x", words[i]);
+	}
+	std::printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+	const char *env = std::getenv("DBG_PORT");
+	std::string port = env ? env : "/dev/ttyUSB1";
+	int baud = DebugLink::DEFAULT_BAUD;
+	int opt;
+	while ((opt = getopt(argc, argv, "p:b:")) != -1) {
+		if (opt == 'p') port = optarg;
+		else if (opt == 'b') baud = (int)number(optarg);
+		else usage();
+	}
+	char **arg = argv + optind;
+	int nArgs = argc - optind;
+	if (nArgs < 1)
+		usage();
+	std::string cmd = arg[0];
+
+	DebugLink link;
+	if (!link.open(port, baud)) {
+		std::cerr << "dbg: " << link.error() << "\n";
+		return 1;
+	}
+
+	bool ok = true;
+	if (cmd == "id") {
+		std::printf("debug bridge on %s\n", port.c_str());		// open has checked it
+	}
+	else if ((cmd == "read" && nArgs >= 2 && nArgs <= 3) || (cmd == "fifo" && nArgs == 3)) {
+		uint32_t addr = number(arg[1]);
+		std::vector<uint32_t> words(nArgs == 3 ? number(arg[2]) : 1);
+		ok = link.read(addr, words.data(), words.size(), cmd == "fifo");
+		if (ok)
+			hexDump(addr, words, cmd == "fifo");
+	}
+	else if (cmd == "write" && nArgs >= 3) {
+		std::vector<uint32_t> words;
+		for (int i = 2; i < nArgs; i++)
+			words.push_back(number(arg[i]));
+		ok = link.write(number(arg[1]), words.data(), words.size());
+	}
+	else if (cmd == "fill" && nArgs == 4) {
+		std::vector<uint32_t> words(number(arg[2]), number(arg[3]));
+		ok = link.write(number(arg[1]), words.data(), words.size());
+	}
+	else if (cmd == "dump" && nArgs == 4) {
+		std::vector<uint32_t> words(number(arg[2]));
+		ok = link.read(number(arg[1]), words.data(), words.size());
+		if (ok) {
+			std::ofstream out(arg[3], std::ios::binary);
+			for (uint32_t w : words) {
+				char b[4] = {(char)w, (char)(w >> 8), (char)(w >> 16), (char)(w >> 24)};
+				out.write(b, 4);
+			}
+			if (!out) {
+				std::cerr << "dbg: cannot write " << arg[3] << "\n";
+				return 1;
+			}
+			std::cerr << "dbg: " << words.size() << " words to " << arg[3] << "\n";
+		}
+	}
+	else if (cmd == "watch" && nArgs >= 2 && nArgs <= 4) {
+		uint32_t addr = number(arg[1]);
+		std::vector<uint32_t> words(nArgs >= 3 ? number(arg[2]) : 1);
+		unsigned ms = nArgs == 4 ? number(arg[3]) : 200;
+		while ((ok = link.read(addr, words.data(), words.size()))) {		// until interrupted
+			hexDump(addr, words, false);
+			std::printf("\n");
+			std::fflush(stdout);
+			usleep(ms * 1000);
+		}
+	}
+	else
+		usage();
+
+	if (!ok) {
+		std::cerr << "dbg: " << link.error() << "\n";
+		return 1;
+	}
+	return 0;
+}
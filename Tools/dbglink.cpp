@@ -0,0 +1,202 @@
+/*  dbglink.cpp
+	Host-side client for the debug bridge - see dbglink.h.
+
+	April 2023 - SoC Group 14
+*/
+
+#include "dbglink.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Command format - must match Hardware/Design/AHBdebug.v
+static const uint8_t CMD_READ = 'R';
+static const uint8_t CMD_FIFO = 'F';
+static const uint8_t CMD_WRITE = 'W';
+static const uint8_t CMD_ID = 'I';
+static const uint8_t REPLY_OK = 'K';
+static const uint8_t REPLY_ERROR = 'E';
+static const char ID_REPLY[4] = {'D', 'B', 'G', '1'};
+
+static speed_t baudCode(int baud) {
+	switch (baud) {
+		case 9600:		return B9600;
+		case 19200:		return B19200;
+		case 38400:		return B38400;
+		case 57600:		return B57600;
+		case 115200:	return B115200;
+		case 230400:	return B230400;
+#ifdef B460800
+		case 460800:	return B460800;
+#endif
+#ifdef B921600
+		case 921600:	return B921600;
+#endif
+		default:		return 0;
+	}
+}
+
+DebugLink::DebugLink() : fd(-1), timeoutMs(500) {}
+
+DebugLink::~DebugLink() {
+	close();
+}
+
+bool DebugLink::open(const std::string &device, int baud) {
+	close();
+	speed_t speed = baudCode(baud);
+	if (speed == 0)
+		return fail("bit rate not supported");
+	fd = ::open(device.c_str(), O_RDWR | O_NOCTTY);
+	if (fd < 0)
+		return fail("cannot open " + device + ": " + std::strerror(errno));
+
+	struct termios tio;
+	if (tcgetattr(fd, &tio) < 0) {
+		std::string why = std::strerror(errno);
+		close();
+		return fail(device + " is not a serial port: " + why);
+	}
+	cfmakeraw(&tio);					// 8 bits, no parity, no translation
+	tio.c_cflag &= ~(CSTOPB | CRTSCTS);	// 1 stop bit, no flow control
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+		std::string why = std::strerror(errno);
+		close();
+		return fail("cannot set up " + device + ": " + why);
+	}
+	resync();
+	if (!identify()) {
+		std::string why = err;
+		close();
+		return fail("no debug bridge on " + device + " - " + why);
+	}
+	return true;
+}
+
+void DebugLink::close() {
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+}
+
+bool DebugLink::identify() {
+	uint8_t reply[4];
+	if (!command(CMD_ID, 0, 1) || !receiveBytes(reply, 4))
+		return false;
+	if (std::memcmp(reply, ID_REPLY, 4) != 0) {
+		resync();
+		return fail("wrong identify reply");
+	}
+	return true;
+}
+
+bool DebugLink::read(uint32_t addr, uint32_t *words, size_t n, bool fixed) {
+	uint8_t buf[4 * MAX_WORDS];
+	while (n > 0) {
+		size_t chunk = n < MAX_WORDS ? n : MAX_WORDS;
+		if (!command(fixed ? CMD_FIFO : CMD_READ, addr, chunk) || !receiveBytes(buf, 4 * chunk))
+			return false;
+		for (size_t i = 0; i < chunk; i++) {
+			const uint8_t *p = buf + 4 * i;		// LSB first
+			words[i] = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		}
+		words += chunk;
+		n -= chunk;
+		if (!fixed)
+			addr += 4 * chunk;
+	}
+	return true;
+}
+
+bool DebugLink::write(uint32_t addr, const uint32_t *words, size_t n) {
+	uint8_t buf[4 * MAX_WORDS];
+	while (n > 0) {
+		size_t chunk = n < MAX_WORDS ? n : MAX_WORDS;
+		for (size_t i = 0; i < chunk; i++) {
+			uint8_t *p = buf + 4 * i;
+			p[0] = (uint8_t)words[i];
+			p[1] = (uint8_t)(words[i] >> 8);
+			p[2] = (uint8_t)(words[i] >> 16);
+			p[3] = (uint8_t)(words[i] >> 24);
+		}
+		uint8_t reply;
+		if (!command(CMD_WRITE, addr, chunk) || !sendBytes(buf, 4 * chunk) || !receiveBytes(&reply, 1))
+			return false;
+		if (reply != REPLY_OK) {
+			resync();
+			return fail(reply == REPLY_ERROR ? "write data lost - serial port too slow?" : "bad write reply");
+		}
+		words += chunk;
+		n -= chunk;
+		addr += 4 * chunk;
+	}
+	return true;
+}
+
+// Send a header: command, address LSB first, number of words minus 1
+bool DebugLink::command(uint8_t cmd, uint32_t addr, size_t n) {
+	if (fd < 0)
+		return fail("not open");
+	uint8_t hdr[6] = {cmd, (uint8_t)addr, (uint8_t)(addr >> 8), (uint8_t)(addr >> 16),
+					  (uint8_t)(addr >> 24), (uint8_t)(n - 1)};
+	return sendBytes(hdr, sizeof hdr);
+}
+
+bool DebugLink::sendBytes(const uint8_t *p, size_t n) {
+	while (n > 0) {
+		ssize_t done = ::write(fd, p, n);
+		if (done < 0) {
+			if (errno == EINTR)
+				continue;
+			return fail(std::string("serial write failed: ") + std::strerror(errno));
+		}
+		p += done;
+		n -= done;
+	}
+	return true;
+}
+
+bool DebugLink::receiveBytes(uint8_t *p, size_t n) {
+	while (n > 0) {
+		struct pollfd pfd = {fd, POLLIN, 0};
+		int ready = poll(&pfd, 1, timeoutMs);
+		if (ready < 0 && errno == EINTR)
+			continue;
+		if (ready <= 0) {
+			resync();
+			return fail("no reply from the debug bridge");
+		}
+		ssize_t got = ::read(fd, p, n);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			return fail(std::string("serial read failed: ") + std::strerror(errno));
+		p += got;
+		n -= got;
+	}
+	return true;
+}
+
+bool DebugLink::fail(const std::string &why) {
+	err = why;
+	return false;
+}
+
+// After an error, wait for the bridge to abandon any partial command (20 bit
+// times with nothing received) and finish any reply, then discard what came back
+void DebugLink::resync() {
+	if (fd < 0)
+		return;
+	tcdrain(fd);
+	usleep(timeoutMs * 1000 / 10);
+	tcflush(fd, TCIOFLUSH);
+}
@@ -0,0 +1,56 @@
+/*  dbglink.h
+	Host-side client for the debug bridge (see Hardware/Design/AHBdebug.v for
+	the command format).  Opens the serial port of the bridge and reads or
+	writes words anywhere in the SoC address space while the program runs.
+	Transfers longer than one command (256 words) are split up here.
+	Linux and other POSIX systems only - uses termios.
+
+	April 2023 - SoC Group 14
+*/
+
+#ifndef DBGLINK_H
+#define DBGLINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class DebugLink {
+public:
+	static const size_t MAX_WORDS = 256;		// words in one command
+	static const int DEFAULT_BAUD = 921600;		// DEBUG_INCR in AHBliteTop
+
+	DebugLink();
+	~DebugLink();
+
+	// Open the serial port and check that the bridge answers
+	bool open(const std::string &device, int baud = DEFAULT_BAUD);
+	void close();
+
+	// Send the identify command - true if the bridge replies "DBG1"
+	bool identify();
+
+	// Read n words from incrementing addresses, or all from addr if fixed
+	bool read(uint32_t addr, uint32_t *words, size_t n, bool fixed = false);
+	bool read(uint32_t addr, uint32_t &word) { return read(addr, &word, 1); }
+
+	// Write n words to incrementing addresses
+	bool write(uint32_t addr, const uint32_t *words, size_t n);
+	bool write(uint32_t addr, uint32_t word) { return write(addr, &word, 1); }
+
+	// Reason for the last failure
+	const std::string &error() const { return err; }
+
+private:
+	int fd;
+	int timeoutMs;					// for each reply
+	std::string err;
+
+	bool command(uint8_t cmd, uint32_t addr, size_t n);
+	bool sendBytes(const uint8_t *p, size_t n);
+	bool receiveBytes(uint8_t *p, size_t n);
+	bool fail(const std::string &why);
+	void resync();
+};
+
+#endif
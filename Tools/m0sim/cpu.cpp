@@ -0,0 +1,667 @@
+/*  cpu.cpp
+	ARMv6-M processor core for m0sim - see m0sim.h.
+	Cycle counts are from the Cortex-M0 Technical Reference Manual, with zero wait
+	state memory: 1 for data processing, 2 for loads and stores, 1+N for LDM, STM,
+	PUSH and POP (4+N when POP loads the PC), 3 for a taken branch, 4 for BL.
+	Exception entry takes 16 cycles and return 12.  Peripherals can add wait states.
+	All exceptions have the same priority (the firmware does not change them),
+	so an exception handler is never pre-empted.  */
+
+#include "m0sim.h"
+
+static const uint32_t EXC_RETURN_MASK = 0xFFFFFFF0;	// exception return values in PC
+static const int HARDFAULT = 3, SVCALL = 11, PENDSV = 14, SYSTICK = 15, IRQ0 = 16;
+static const unsigned ENTRY_CYCLES = 16, RETURN_CYCLES = 12;
+static const uint64_t MAX_SLEEP = 50000;			// 1 ms, so the host can give input while asleep
+
+void Cpu::reset() {
+	for (uint32_t &x : r) x = 0;
+	n = z = c = v = false;
+	ipsr = 0;
+	primask = sleeping = sleepOnExit = false;
+	psp = control = 0;
+	nvicEnable = nvicPending = 0;
+	pendSysTick = pendPendSV = false;
+	stCtrl = stLoad = stVal = 0;
+	stLast = cycles;
+	lockedUp = breakpoint = faulted = false;
+	uint32_t wait;
+	r[13] = soc.read(0, 4, cycles, wait) & ~3u;		// initial stack pointer from the vector table
+	r[15] = soc.read(4, 4, cycles, wait) & ~1u;		// reset handler
+	r[14] = 0xFFFFFFFF;
+}
+
+// ================================ Flags and conditions ================================
+
+uint32_t Cpu::addWithCarry(uint32_t a, uint32_t b, uint32_t carry) {
+	uint64_t u = (uint64_t)a + b + carry;
+	int64_t s = (int64_t)(int32_t)a + (int32_t)b + carry;
+	uint32_t result = (uint32_t)u;
+	setNZ(result);
+	c = (u >> 32) != 0;
+	v = (int64_t)(int32_t)result != s;
+	return result;
+}
+
+bool Cpu::condition(unsigned cond) const {
+	switch (cond) {
+		case 0x0: return z;
+		case 0x1: return !z;
+		case 0x2: return c;
+		case 0x3: return !c;
+		case 0x4: return n;
+		case 0x5: return !n;
+		case 0x6: return v;
+		case 0x7: return !v;
+		case 0x8: return c && !z;
+		case 0x9: return !c || z;
+		case 0xA: return n == v;
+		case 0xB: return n != v;
+		case 0xC: return !z && n == v;
+		case 0xD: return z || n != v;
+		default:  return true;
+	}
+}
+
+uint32_t Cpu::xpsr() const {
+	return ((uint32_t)n << 31) | ((uint32_t)z << 30) | ((uint32_t)c << 29) | ((uint32_t)v << 28)
+		| (1u << 24) | ipsr;
+}
+
+// ================================ Memory ================================
+
+uint32_t Cpu::load(uint32_t addr, int size) {
+	if (addr & (size - 1)) {
+		raiseFault("unaligned load");
+		return 0;
+	}
+	if (addr >= 0xE0000000) {
+		uint32_t w = ppbRead(addr & ~3u) >> (8 * (addr & 3));
+		return size == 4 ? w : w & ((1u << (8 * size)) - 1);
+	}
+	uint32_t wait = 0;
+	uint32_t data = soc.read(addr, size, cycles, wait);
+	cycles += wait;
+	return data;
+}
+
+void Cpu::store(uint32_t addr, uint32_t data, int size) {
+	if (addr & (size - 1)) {
+		raiseFault("unaligned store");
+		return;
+	}
+	if (addr >= 0xE0000000) {
+		if (size == 4) ppbWrite(addr, data);			// system registers are word access only
+		return;
+	}
+	uint32_t wait = 0;
+	soc.write(addr, data, size, cycles, wait);
+	cycles += wait;
+}
+
+// ================================ System registers ================================
+
+void Cpu::sysTickUpdate() {
+	uint64_t d = cycles - stLast;
+	stLast = cycles;
+	if (!(stCtrl & 1) || d == 0) return;
+	if (d < stVal) {
+		stVal -= (uint32_t)d;
+		return;
+	}
+	// Reached 0, then reloads on the next cycle and counts down from LOAD
+	uint64_t after = d - stVal;
+	if (stVal != 0 || after > 0) {
+		stCtrl |= (1u << 16);								// COUNTFLAG
+		if (stCtrl & 2) pendSysTick = true;
+	}
+	if (stLoad == 0 || after == 0) stVal = 0;
+	else stVal = stLoad - (uint32_t)((after - 1) % ((uint64_t)stLoad + 1));
+}
+
+uint32_t Cpu::ppbRead(uint32_t addr) {
+	uint32_t x;
+	switch (addr) {
+		case 0xE000E010:									// SysTick control and status
+			sysTickUpdate();
+			x = stCtrl;
+			stCtrl &= ~(1u << 16);							// COUNTFLAG cleared by read
+			return x;
+		case 0xE000E014: return stLoad;
+		case 0xE000E018: sysTickUpdate(); return stVal;
+		case 0xE000E01C: return 0x80000000;		// SysTick calibration: no reference clock
+		case 0xE000E100: return nvicEnable;
+		case 0xE000E180: return nvicEnable;
+		case 0xE000E200: return nvicPending;
+		case 0xE000E280: return nvicPending;
+		case 0xE000ED00: return 0x410CC200;		// CPUID: Cortex-M0 r0p0
+		case 0xE000ED04:									// ICSR
+			return ((uint32_t)pendPendSV << 28) | ((uint32_t)pendSysTick << 26)
+				| (nvicPending ? (1u << 22) : 0) | ipsr;
+		case 0xE000ED10: return (uint32_t)sleepOnExit << 1;
+		default:
+			if (addr >= 0xE000E400 && addr < 0xE000E420) {
+				uint32_t i = addr - 0xE000E400;
+				return nvicPriority[i] | (nvicPriority[i+1] << 8) | (nvicPriority[i+2] << 16)
+					| ((uint32_t)nvicPriority[i+3] << 24);
+			}
+			return 0;
+	}
+}
+
+void Cpu::ppbWrite(uint32_t addr, uint32_t data) {
+	switch (addr) {
+		case 0xE000E010:
+			sysTickUpdate();
+			stCtrl = (stCtrl & (1u << 16)) | (data & 7);
+			break;
+		case 0xE000E014: stLoad = data & 0xFFFFFF; break;
+		case 0xE000E018:									// any write clears the counter and COUNTFLAG
+			sysTickUpdate();
+			stVal = 0;
+			stCtrl &= ~(1u << 16);
+			break;
+		case 0xE000E100: nvicEnable |= data; break;
+		case 0xE000E180: nvicEnable &= ~data; break;
+		case 0xE000E200: nvicPending |= data; break;
+		case 0xE000E280: nvicPending &= ~data; break;
+		case 0xE000ED04:
+			if (data & (1u << 28)) pendPendSV = true;
+			if (data & (1u << 27)) pendPendSV = false;
+			if (data & (1u << 26)) pendSysTick = true;
+			if (data & (1u << 25)) pendSysTick = false;
+			break;
+		case 0xE000ED0C:									// AIRCR: SYSRESETREQ
+			if ((data >> 16) == 0x05FA && (data & 4)) {
+				soc.reset();
+				reset();
+			}
+			break;
+		case 0xE000ED10: sleepOnExit = (data & 2) != 0; break;
+		default:
+			if (addr >= 0xE000E400 && addr < 0xE000E420)
+				for (int i = 0; i < 4; i++) nvicPriority[addr - 0xE000E400 + i] = (uint8_t)(data >> (8 * i));
+			break;
+	}
+}
+
+// ================================ Exceptions ================================
+
+void Cpu::raiseFault(const std::string &why) {
+	if (fault.empty()) {
+		char where[32];
+		std::snprintf(where, sizeof where, " at 0x%08X", r[15]);
+		fault = why + where;
+	}
+	faulted = true;
+}
+
+int Cpu::pendingException() {
+	if (pendPendSV) return PENDSV;
+	if (pendSysTick) return SYSTICK;
+	uint32_t p = nvicPending & nvicEnable;
+	if (p) return IRQ0 + __builtin_ctz(p);
+	return 0;
+}
+
+void Cpu::enterException(int number, uint32_t returnAddr) {
+	uint32_t frameAlign = (r[13] & 4) ? 1 : 0;
+	uint32_t sp = (r[13] - 0x20) & ~7u;
+	uint32_t frame[8] = {r[0], r[1], r[2], r[3], r[12], r[14], returnAddr, xpsr() | (frameAlign << 9)};
+	r[13] = sp;
+	for (int i = 0; i < 8; i++) store(sp + 4 * i, frame[i], 4);
+	r[14] = ipsr ? 0xFFFFFFF1 : 0xFFFFFFF9;
+	ipsr = (uint32_t)number;
+	if (number == PENDSV) pendPendSV = false;
+	else if (number == SYSTICK) pendSysTick = false;
+	else if (number >= IRQ0) nvicPending &= ~(1u << (number - IRQ0));
+	r[15] = load((uint32_t)number * 4, 4) & ~1u;
+	cycles += ENTRY_CYCLES;
+	exceptions++;
+	ev.exception = true;
+	ev.target = r[15];
+	ev.ret = returnAddr;
+}
+
+void Cpu::exceptionReturn(uint32_t excReturn) {
+	uint32_t sp = r[13];
+	uint32_t frame[8];
+	for (int i = 0; i < 8; i++) frame[i] = load(sp + 4 * i, 4);
+	r[0] = frame[0]; r[1] = frame[1]; r[2] = frame[2]; r[3] = frame[3];
+	r[12] = frame[4]; r[14] = frame[5];
+	r[15] = frame[6] & ~1u;
+	n = (frame[7] >> 31) & 1; z = (frame[7] >> 30) & 1;
+	c = (frame[7] >> 29) & 1; v = (frame[7] >> 28) & 1;
+	ipsr = frame[7] & 0x3F;
+	r[13] = sp + 0x20 + ((frame[7] >> 9) & 1) * 4;
+	if ((excReturn & 0xF) == 0xD) raiseFault("return to process stack not supported");
+	cycles += RETURN_CYCLES;
+	if (sleepOnExit && ipsr == 0) sleeping = true;
+}
+
+void Cpu::branchWritePC(uint32_t addr) {
+	if (ipsr != 0 && (addr & EXC_RETURN_MASK) == EXC_RETURN_MASK) exceptionReturn(addr);
+	else if (!(addr & 1)) raiseFault("branch to ARM state");
+	else r[15] = addr & ~1u;
+}
+
+// ================================ Step ================================
+
+void Cpu::step() {
+	ev = CpuEvents();
+	if (lockedUp || breakpoint) return;
+
+	// Interrupt requests: level sensitive, not re-pended while being serviced
+	uint32_t lines = soc.irqLines(cycles);
+	if (ipsr >= IRQ0) lines &= ~(1u << (ipsr - IRQ0));
+	nvicPending |= lines;
+	if ((stCtrl & 3) == 3 && cycles - stLast >= stVal) sysTickUpdate();
+
+	int exc = pendingException();
+	if (sleeping) {
+		if (exc) sleeping = false;							// wake up, even if PRIMASK is set
+		else {
+			// Nothing to do until a peripheral or SysTick changes something
+			uint64_t skip = soc.nextEvent(cycles);
+			if ((stCtrl & 3) == 3) {
+				uint64_t st = stVal ? stVal : (uint64_t)stLoad + 1;
+				if (st < skip) skip = st;
+			}
+			if (skip > MAX_SLEEP) skip = MAX_SLEEP;
+			if (skip == 0) skip = 1;
+			cycles += skip;
+			sleepCycles += skip;
+			soc.countSleep(skip);
+			ev.sleep = true;
+			return;
+		}
+	}
+	if (exc && !primask && ipsr == 0) {
+		enterException(exc, r[15]);
+		return;
+	}
+
+	// Execute one instruction
+	uint32_t pc = r[15];
+	uint16_t op = soc.fetch(pc);
+	if (!(pc & 2) || pc != lastPc + 2) soc.countFetch(pc);	// the processor fetches a word at a time
+	lastPc = pc;
+	faulted = false;
+	ev.executed = true;
+	instructions++;
+	if ((op >> 11) >= 0x1D) {
+		uint16_t op2 = soc.fetch(pc + 2);
+		r[15] = pc + 4;
+		execute32(op, op2);
+	}
+	else {
+		r[15] = pc + 2;
+		execute16(op);
+	}
+	if (faulted) {
+		if (ipsr == HARDFAULT) lockedUp = true;
+		else {
+			r[15] = pc;
+			enterException(HARDFAULT, pc);
+		}
+	}
+}
+
+// ================================ 16-bit instructions ================================
+
+void Cpu::execute16(uint16_t op) {
+	uint32_t pcRead = r[15] + 2;							// PC reads as instruction address + 4
+	unsigned rd = op & 7, rn = (op >> 3) & 7, rm;
+	uint32_t a, b, result, addr;
+	unsigned shift;
+
+	switch (op >> 12) {
+	case 0x0: case 0x1:
+		if ((op >> 11) == 0x3) {							// ADDS / SUBS register or 3-bit immediate
+			b = (op & 0x400) ? (uint32_t)((op >> 6) & 7) : r[(op >> 6) & 7];
+			r[rd] = (op & 0x200) ? addWithCarry(r[rn], ~b, 1) : addWithCarry(r[rn], b, 0);
+		}
+		else {																// LSLS / LSRS / ASRS immediate
+			shift = (op >> 6) & 31;
+			a = r[rn];
+			switch ((op >> 11) & 3) {
+			case 0:
+				if (shift) { c = (a >> (32 - shift)) & 1; a <<= shift; }
+				break;
+			case 1:
+				if (shift == 0) { c = a >> 31; a = 0; }
+				else { c = (a >> (shift - 1)) & 1; a >>= shift; }
+				break;
+			default:
+				if (shift == 0) { c = a >> 31; a = (uint32_t)((int32_t)a >> 31); }
+				else { c = (a >> (shift - 1)) & 1; a = (uint32_t)((int32_t)a >> shift); }
+				break;
+			}
+			r[rd] = a;
+			setNZ(a);
+		}
+		cycles += 1;
+		return;
+
+	case 0x2: case 0x3:												// MOVS / CMP / ADDS / SUBS 8-bit immediate
+		rd = (op >> 8) & 7;
+		b = op & 0xFF;
+		switch ((op >> 11) & 3) {
+		case 0: r[rd] = b; setNZ(b); break;
+		case 1: addWithCarry(r[rd], ~b, 1); break;
+		case 2: r[rd] = addWithCarry(r[rd], b, 0); break;
+		default: r[rd] = addWithCarry(r[rd], ~b, 1); break;
+		}
+		cycles += 1;
+		return;
+
+	case 0x4:
+		if ((op >> 10) == 0x10) {							// data processing, registers
+			a = r[rd];
+			b = r[rn];
+			cycles += 1;
+			switch ((op >> 6) & 0xF) {
+			case 0x0: r[rd] = a & b; setNZ(r[rd]); break;
+			case 0x1: r[rd] = a ^ b; setNZ(r[rd]); break;
+			case 0x2:																// LSLS
+				shift = b & 0xFF;
+				if (shift >= 32) { c = (shift == 32) ? (a & 1) : 0; a = 0; }
+				else if (shift) { c = (a >> (32 - shift)) & 1; a <<= shift; }
+				r[rd] = a; setNZ(a); break;
+			case 0x3:																// LSRS
+				shift = b & 0xFF;
+				if (shift >= 32) { c = (shift == 32) ? (a >> 31) : 0; a = 0; }
+				else if (shift) { c = (a >> (shift - 1)) & 1; a >>= shift; }
+				r[rd] = a; setNZ(a); break;
+			case 0x4:																// ASRS
+				shift = b & 0xFF;
+				if (shift >= 32) { c = a >> 31; a = (uint32_t)((int32_t)a >> 31); }
+				else if (shift) { c = (a >> (shift - 1)) & 1; a = (uint32_t)((int32_t)a >> shift); }
+				r[rd] = a; setNZ(a); break;
+			case 0x5: r[rd] = addWithCarry(a, b, c); break;				// ADCS
+			case 0x6: r[rd] = addWithCarry(a, ~b, c); break;			// SBCS
+			case 0x7:																// RORS
+				shift = b & 0xFF;
+				if (shift) {
+					shift &= 31;
+					if (shift) a = (a >> shift) | (a << (32 - shift));
+					c = a >> 31;
+				}
+				r[rd] = a; setNZ(a); break;
+			case 0x8: setNZ(a & b); break;											// TST
+			case 0x9: r[rd] = addWithCarry(~b, 0, 1); break;			// RSBS #0
+			case 0xA: addWithCarry(a, ~b, 1); break;							// CMP
+			case 0xB: addWithCarry(a, b, 0); break;							// CMN
+			case 0xC: r[rd] = a | b; setNZ(r[rd]); break;
+			case 0xD: r[rd] = a * b; setNZ(r[rd]); cycles += mulCycles - 1; break;
+			case 0xE: r[rd] = a & ~b; setNZ(r[rd]); break;
+			default:  r[rd] = ~b; setNZ(r[rd]); break;							// MVNS
+			}
+			return;
+		}
+		if ((op >> 10) == 0x11) {							// special data processing and branch exchange
+			rd = (op & 7) | ((op >> 4) & 8);
+			rm = (op >> 3) & 0xF;
+			b = (rm == 15) ? pcRead : r[rm];
+			switch ((op >> 8) & 3) {
+			case 0:																	// ADD, no flags
+				a = (rd == 15) ? pcRead : r[rd];
+				result = a + b;
+				if (rd == 15) { r[15] = result & ~1u; cycles += 3; }
+				else { r[rd] = (rd == 13) ? (result & ~3u) : result; cycles += 1; }
+				return;
+			case 1:																	// CMP high registers
+				a = (rd == 15) ? pcRead : r[rd];
+				addWithCarry(a, ~b, 1);
+				cycles += 1;
+				return;
+			case 2:																	// MOV, no flags
+				if (rd == 15) { r[15] = b & ~1u; cycles += 3; }
+				else { r[rd] = (rd == 13) ? (b & ~3u) : b; cycles += 1; }
+				return;
+			default:																// BX / BLX
+				if (op & 0x80) {
+					r[14] = r[15] | 1;
+					ev.call = true;
+					ev.ret = r[15];
+				}
+				branchWritePC(b);
+				if (ev.call) ev.target = r[15];
+				cycles += 3;
+				return;
+			}
+		}
+		// LDR literal
+		rd = (op >> 8) & 7;
+		r[rd] = load((pcRead & ~3u) + (op & 0xFF) * 4, 4);
+		cycles += 2;
+		return;
+
+	case 0x5:																// load and store, register offset
+		addr = r[rn] + r[(op >> 6) & 7];
+		switch ((op >> 9) & 7) {
+		case 0: store(addr, r[rd], 4); break;
+		case 1: store(addr, r[rd] & 0xFFFF, 2); break;
+		case 2: store(addr, r[rd] & 0xFF, 1); break;
+		case 3: r[rd] = (uint32_t)(int32_t)(int8_t)load(addr, 1); break;
+		case 4: r[rd] = load(addr, 4); break;
+		case 5: r[rd] = load(addr, 2); break;
+		case 6: r[rd] = load(addr, 1); break;
+		default: r[rd] = (uint32_t)(int32_t)(int16_t)load(addr, 2); break;
+		}
+		cycles += 2;
+		return;
+
+	case 0x6:																// STR / LDR word, immediate offset
+		addr = r[rn] + ((op >> 6) & 31) * 4;
+		if (op & 0x800) r[rd] = load(addr, 4);
+		else store(addr, r[rd], 4);
+		cycles += 2;
+		return;
+
+	case 0x7:																// STRB / LDRB, immediate offset
+		addr = r[rn] + ((op >> 6) & 31);
+		if (op & 0x800) r[rd] = load(addr, 1);
+		else store(addr, r[rd] & 0xFF, 1);
+		cycles += 2;
+		return;
+
+	case 0x8:																// STRH / LDRH, immediate offset
+		addr = r[rn] + ((op >> 6) & 31) * 2;
+		if (op & 0x800) r[rd] = load(addr, 2);
+		else store(addr, r[rd] & 0xFFFF, 2);
+		cycles += 2;
+		return;
+
+	case 0x9:																// STR / LDR, SP relative
+		rd = (op >> 8) & 7;
+		addr = r[13] + (op & 0xFF) * 4;
+		if (op & 0x800) r[rd] = load(addr, 4);
+		else store(addr, r[rd], 4);
+		cycles += 2;
+		return;
+
+	case 0xA:																// ADR, ADD rd, SP, #imm
+		rd = (op >> 8) & 7;
+		r[rd] = ((op & 0x800) ? r[13] : (pcRead & ~3u)) + (op & 0xFF) * 4;
+		cycles += 1;
+		return;
+
+	case 0xB:																// miscellaneous
+		switch ((op >> 8) & 0xF) {
+		case 0x0:															// ADD / SUB SP, #imm
+			if (op & 0x80) r[13] -= (op & 0x7F) * 4;
+			else r[13] += (op & 0x7F) * 4;
+			cycles += 1;
+			return;
+		case 0x2:															// SXTH, SXTB, UXTH, UXTB
+			a = r[rn];
+			switch ((op >> 6) & 3) {
+			case 0: r[rd] = (uint32_t)(int32_t)(int16_t)a; break;
+			case 1: r[rd] = (uint32_t)(int32_t)(int8_t)a; break;
+			case 2: r[rd] = a & 0xFFFF; break;
+			default: r[rd] = a & 0xFF; break;
+			}
+			cycles += 1;
+			return;
+		case 0x4: case 0x5: {											// PUSH
+			unsigned list = (op & 0xFF) | ((op & 0x100) ? 0x4000 : 0);
+			unsigned count = __builtin_popcount(list);
+			addr = r[13] - 4 * count;
+			r[13] = addr;
+			for (int i = 0; i < 15; i++)
+				if (list & (1u << i)) { store(addr, r[i], 4); addr += 4; }
+			cycles += 1 + count;
+			return;
+		}
+		case 0x6:
+			if ((op & 0xFFEF) == 0xB662) {							// CPSIE i / CPSID i
+				primask = (op & 0x10) != 0;
+				cycles += 1;
+				return;
+			}
+			break;
+		case 0xA:															// REV, REV16, REVSH
+			a = r[rn];
+			switch ((op >> 6) & 3) {
+			case 0: r[rd] = __builtin_bswap32(a); break;
+			case 1: r[rd] = ((a & 0x00FF00FF) << 8) | ((a >> 8) & 0x00FF00FF); break;
+			case 3: r[rd] = (uint32_t)(int32_t)(int16_t)(((a & 0xFF) << 8) | ((a >> 8) & 0xFF)); break;
+			default: raiseFault("undefined instruction"); return;
+			}
+			cycles += 1;
+			return;
+		case 0xC: case 0xD: {											// POP
+			unsigned list = op & 0xFF;
+			unsigned count = __builtin_popcount(list) + ((op & 0x100) ? 1 : 0);
+			addr = r[13];
+			r[13] += 4 * count;
+			for (int i = 0; i < 8; i++)
+				if (list & (1u << i)) { r[i] = load(addr, 4); addr += 4; }
+			cycles += 1 + count;
+			if (op & 0x100) {
+				branchWritePC(load(addr, 4));
+				cycles += 3;
+			}
+			return;
+		}
+		case 0xE:															// BKPT - stops the simulation
+			breakpoint = true;
+			r[15] -= 2;
+			return;
+		case 0xF:															// hints
+			if ((op & 0xF) == 0) {
+				if (((op >> 4) & 0xF) == 3) {						// WFI
+					if (!pendingException()) sleeping = true;
+					cycles += 2;
+				}
+				else cycles += 1;									// NOP, YIELD, WFE, SEV
+				return;
+			}
+			break;
+		default:
+			break;
+		}
+		raiseFault("undefined instruction");
+		return;
+
+	case 0xC: {														// STM / LDM, increment after
+		unsigned list = op & 0xFF;
+		unsigned count = __builtin_popcount(list);
+		rn = (op >> 8) & 7;
+		addr = r[rn];
+		if (op & 0x800) {
+			for (int i = 0; i < 8; i++)
+				if (list & (1u << i)) { r[i] = load(addr, 4); addr += 4; }
+			if (!(list & (1u << rn))) r[rn] = addr;
+		}
+		else {
+			for (int i = 0; i < 8; i++)
+				if (list & (1u << i)) { store(addr, r[i], 4); addr += 4; }
+			r[rn] = addr;
+		}
+		cycles += 1 + count;
+		return;
+	}
+
+	case 0xD: {
+		unsigned cond = (op >> 8) & 0xF;
+		if (cond == 0xF) {													// SVC
+			cycles += 1;
+			enterException(SVCALL, r[15]);
+			return;
+		}
+		if (cond == 0xE) {
+			raiseFault("permanently undefined instruction");
+			return;
+		}
+		if (condition(cond)) {
+			r[15] = pcRead + (uint32_t)((int32_t)(int8_t)(op & 0xFF) * 2);
+			cycles += 3;
+		}
+		else cycles += 1;
+		return;
+	}
+
+	default:															// B, 11-bit offset
+		r[15] = pcRead + (uint32_t)(((int32_t)(op << 21)) >> 20);
+		cycles += 3;
+		return;
+	}
+}
+
+// ================================ 32-bit instructions ================================
+
+void Cpu::execute32(uint16_t op, uint16_t op2) {
+	if ((op >> 11) == 0x1E && (op2 & 0xD000) == 0xD000) {		// BL
+		uint32_t s = (op >> 10) & 1;
+		uint32_t i1 = !(((op2 >> 13) & 1) ^ s), i2 = !(((op2 >> 11) & 1) ^ s);
+		uint32_t imm = (s << 24) | (i1 << 23) | (i2 << 22) | ((op & 0x3FFu) << 12) | ((op2 & 0x7FFu) << 1);
+		int32_t offset = ((int32_t)(imm << 7)) >> 7;
+		r[14] = r[15] | 1;
+		ev.call = true;
+		ev.ret = r[15];
+		r[15] += (uint32_t)offset;
+		ev.target = r[15];
+		cycles += 4;
+		return;
+	}
+	if ((op & 0xFFF0) == 0xF380 && (op2 & 0xFF00) == 0x8800) {	// MSR
+		uint32_t value = r[op & 0xF];
+		switch (op2 & 0xFF) {
+		case 8:  r[13] = value & ~3u; break;
+		case 9:  psp = value & ~3u; break;
+		case 16: primask = value & 1; break;
+		case 20:
+			control = value & 3;
+			if (control & 2) raiseFault("process stack not supported");
+			break;
+		default: break;											// APSR flags
+		}
+		if ((op2 & 0xFF) < 4) {
+			n = (value >> 31) & 1; z = (value >> 30) & 1;
+			c = (value >> 29) & 1; v = (value >> 28) & 1;
+		}
+		cycles += 4;
+		return;
+	}
+	if (op == 0xF3EF && (op2 & 0xF000) == 0x8000) {				// MRS
+		uint32_t sysm = op2 & 0xFF, value = 0;
+		if (sysm < 8) {
+			if (!(sysm & 4)) value |= xpsr() & 0xF0000000;		// APSR
+			if (sysm & 1) value |= ipsr;								// IPSR
+		}
+		else if (sysm == 8) value = r[13];
+		else if (sysm == 9) value = psp;
+		else if (sysm == 16) value = primask;
+		else if (sysm == 20) value = control;
+		r[(op2 >> 8) & 0xF] = value;
+		cycles += 4;
+		return;
+	}
+	if (op == 0xF3BF && (op2 & 0xFF00) == 0x8F00) {				// DSB, DMB, ISB
+		cycles += 4;
+		return;
+	}
+	raiseFault("undefined 32-bit instruction");
+}
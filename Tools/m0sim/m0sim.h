@@ -0,0 +1,242 @@
+/*  m0sim.h
+	Instruction-set simulator for the Cortex-M0 SoC - see main.cpp.
+	Cpu executes ARMv6-M Thumb code with the cycle counts of the Cortex-M0, and
+	includes the private peripheral bus: NVIC, SysTick and the few SCB registers
+	the firmware uses.  Soc is the AHB memory map decoded by AHBDCD.v, with models
+	of the peripherals.  Time is counted in clock cycles of the 50 MHz bus clock,
+	and the peripherals are updated when they are accessed, so an access costs
+	the same whether the peripheral has been idle for 1 cycle or 1 million.
+
+	April 2023 - SoC Group 14
+*/
+
+#ifndef M0SIM_HDR_ALREADY_INCLUDED
+#define M0SIM_HDR_ALREADY_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+static const double CLOCK_HZ = 50e6;
+static const uint32_t ROM_WORDS = 8192;			// 32 KB at 0x00000000
+static const uint32_t RAM_WORDS = 4096;			// 16 KB at 0x20000000
+static const uint64_t NEVER = ~0ull;
+
+// ADXL362 model in Software/host/adxl362_model.c
+extern "C" {
+	struct AdxlSample { int16_t x, y, z, temp; };	// same layout as AccSample
+	void AdxlModelReset(void);
+	void AdxlModelSelect(uint8_t active);
+	uint8_t AdxlModelByte(uint8_t mosi);
+	uint8_t AdxlModelOut(void);
+	void AdxlModelIn(uint8_t mosi);
+	uint8_t AdxlModelSample(const AdxlSample *sample);
+	uint8_t AdxlModelInt1(void);
+	uint8_t AdxlModelInt2(void);
+	uint32_t AdxlModelPeriodUs(void);
+	uint32_t AdxlModelBytes(void);
+	uint32_t AdxlModelTransactions(void);
+}
+
+// ================================ Memory map and peripherals ================================
+
+class Soc {
+public:
+	Soc();
+	void reset();
+
+	/* Bus access.  now is the cycle of the access, and wait is set to the number of
+	   wait states (HREADYOUT low).  Sizes are 1, 2 or 4 bytes, already aligned.  */
+	uint32_t read(uint32_t addr, int size, uint64_t now, uint32_t &wait);
+	void write(uint32_t addr, uint32_t data, int size, uint64_t now, uint32_t &wait);
+	uint16_t fetch(uint32_t addr) const {				// instruction fetch, ROM or RAM
+		const std::vector<uint32_t> &m = (addr >> 24) == 0x20 ? ram : rom;
+		uint32_t w = m[(addr >> 2) & (m.size() - 1)];
+		return (uint16_t)((addr & 2) ? (w >> 16) : w);
+	}
+
+	// Interrupt request lines IRQ[31:0] at cycle now
+	uint32_t irqLines(uint64_t now);
+
+	// Cycles until a peripheral may change an interrupt line by itself - used when sleeping
+	uint64_t nextEvent(uint64_t now);
+
+	std::vector<uint32_t> rom, ram;
+
+	// Board inputs and outputs
+	uint16_t switches = 0;
+	uint8_t buttons = 0;						// {U, D, L, C, R}
+	uint16_t leds = 0;
+	std::deque<uint8_t> uartIn;				// bytes waiting to be sent to the SoC
+	FILE *uartOut = stdout;						// bytes sent by the SoC
+	std::vector<AdxlSample> samples;	// accelerometer stimulus, repeated
+
+	// Statistics
+	uint64_t uartTxBytes = 0, uartRxBytes = 0, unmapped = 0, displayWrites = 0, waitCycles = 0;
+	uint64_t smpSets = 0, smpLost = 0;
+	int32_t displayNumber = 0;
+	bool displayNumberUsed = false;
+	uint8_t displayReg[11] = {0};						// shadow bank as seen by the bus, then control
+	uint32_t displayDecimals = 0;						// digits after the decimal point of the number
+
+	// Start delivering host input from now, at the serial bit rate
+	void uartInputAdded(uint64_t now);
+
+	// Bus activity the processor reports for the performance counters
+	void countFetch(uint32_t addr);				// instruction fetch, 32 bits
+	void countSleep(uint64_t n);					// cycles asleep
+
+private:
+	void advance(uint64_t now);					// process timed events up to now
+	void adxlSchedule(uint64_t now);
+	uint32_t readWord(uint32_t addr, uint64_t now, uint32_t &wait);
+	void writeLanes(uint32_t addr, uint32_t data, uint32_t mask, uint64_t now, uint32_t &wait);
+
+	// GPIO, and bit-banged SPI when the firmware drives the accelerometer through output port 1
+	void spiPins(uint16_t out1);
+	uint16_t gpioOut1 = 0;
+	uint32_t gpioRise = 0, gpioFall = 0, gpioEvents = 0, gpioDebounce = 0;	// inputs are fixed, so no events
+	uint8_t misoByte = 0xFF, rxByte = 0;
+	int bitCount = 0;
+	bool miso = true, misoLoaded = false, slaveSelected = false;
+
+	// UART
+	void uartUpdate(uint64_t now);
+	uint8_t uartStatus(uint64_t now);
+	uint64_t uartByteCycles() const { return (uint64_t)(10 * 8388608.0 / (uartIncr ? uartIncr : 1)); }
+	std::deque<uint8_t> txFifo, rxFifo;
+	uint64_t txFree = 0, rxNext = NEVER, rxLast = 0;
+	uint32_t uartCtl = 0, uartIncr = 3221, uartRxLevel = 0, uartTxLevel = 0, uartTimeout = 0;
+
+	// SPI master
+	uint8_t spiCtl = 0, spiDiv = 3, spiData = 0, spiTx = 0, spiRx = 0;
+	uint64_t spiDone = NEVER;
+
+	// Accelerometer timing
+	uint64_t adxlNext = NEVER;
+	size_t sampleIndex = 0;
+
+	// Sampling engine
+	void smpTrigger(uint64_t now);
+	void smpFinish(uint64_t now);
+	bool smpFilterSet(AdxlSample &s);
+	struct SmpSet { uint32_t time; AdxlSample s; };
+	std::deque<SmpSet> smpBuf;
+	uint32_t smpCtl = 0, smpPeriod = 125000, smpLevel = 0, smpDiv = 3, smpStamp = 0;
+	bool smpOverflow = false, smpPending = false;
+	uint32_t smpFilter = 0, smpGroup = 0;			// filter register, sets already in this group
+	int64_t smpAcc[3] = {0, 0, 0};						// filter sums or IIR states, X, Y, Z
+	bool smpPrimed = false, smpLimited = false;
+	uint64_t smpDone = NEVER, smpTimerNext = NEVER, smpHoldoff = 0;
+
+	// Arithmetic unit
+	uint32_t arA = 0, arB = 0, arResult = 0, arRem = 0;
+	uint64_t arAcc = 0, arBusyUntil = 0;
+	bool arDivZero = false, arSaturated = false;
+
+	// DMA controller - transfers run when the request is ready, one per DMA_CYCLES,
+	// without taking bus cycles from the processor
+	void dmaSchedule(uint64_t now);
+	void dmaStep(uint64_t now);
+	bool dmaReady(int ch) const;
+	struct DmaChannel { uint32_t src = 0, srcStart = 0, dst = 0, count = 0, control = 0; };
+	DmaChannel dma[2];
+	uint32_t dmaDone = 0, dmaBurstLeft = 0;
+	int dmaCh = 0;
+	bool dmaInStep = false;							// a transfer is using the bus
+	uint64_t dmaNext = NEVER, dmaFree = 0;
+
+	// Mailbox - processor 0 only, its own messages
+	uint32_t mboxMessage[2] = {0, 0};
+	uint32_t mboxFull = 0, mboxIntEnable = 0;
+
+	// CORDIC unit - results calculated at the start, available at cdBusyUntil
+	static const int CORDIC_FRAC = 10;			// fraction bits below the input LSB
+	static int16_t cordicPass(int64_t x, int64_t y, int64_t &length);
+	static uint16_t cordicRound(int64_t length);
+	int16_t cdX = 0, cdY = 0, cdZ = 0, cdAngle = 0, cdPitch = 0, cdRoll = 0;
+	uint16_t cdMag = 0;
+	uint64_t cdBusyUntil = 0;
+
+	// Performance counters
+	static const int PERF_SLAVES = 13;			// AHBDCD slaves 0 to 11, then unmapped
+	static int perfSlave(uint32_t addr);
+	void perfUpdate(uint64_t now);
+	void stall(uint64_t n, uint32_t &wait);		// wait states, counted
+	bool perfFrozen = false;
+	uint64_t perfTotal = 0, perfLast = 0, perfSleep = 0, perfWait = 0;
+	uint64_t perfReads[PERF_SLAVES] = {0}, perfWrites[PERF_SLAVES] = {0};
+
+	// Cached interrupt lines
+	uint32_t irqCache = 0;
+	uint64_t irqValidUntil = 0;
+};
+
+// ================================ Processor ================================
+
+// What the last step did, for the profiler
+struct CpuEvents {
+	bool call = false;				// BL or BLX: target and return address
+	uint32_t target = 0, ret = 0;
+	bool exception = false;		// exception entry: handler, and interrupted address in ret
+	bool sleep = false;				// time passed asleep, no instruction
+	bool executed = false;		// an instruction was executed at the previous pc
+};
+
+class Cpu {
+public:
+	explicit Cpu(Soc &s) : soc(s) {}
+	void reset();
+	void step();							// one instruction, one exception entry, or some time asleep
+
+	uint32_t pc() const { return r[15]; }
+	uint32_t sp() const { return r[13]; }
+	uint32_t reg(int n) const { return r[n]; }
+
+	uint64_t cycles = 0, instructions = 0, sleepCycles = 0, exceptions = 0;
+	bool lockedUp = false, breakpoint = false;
+	std::string fault;				// reason for the first fault
+	CpuEvents ev;
+	unsigned mulCycles = 1;		// 1 for the fast multiplier, 32 for the small one
+
+private:
+	Soc &soc;
+	uint32_t r[16] = {0};
+	bool n = false, z = false, c = false, v = false;
+	uint32_t ipsr = 0;				// exception number, 0 in thread mode
+	bool primask = false, sleeping = false, sleepOnExit = false;
+	uint32_t psp = 0, control = 0;
+
+	// NVIC and system exceptions
+	uint32_t nvicEnable = 0, nvicPending = 0;
+	uint8_t nvicPriority[32] = {0};
+	bool pendSysTick = false, pendPendSV = false;
+
+	// SysTick, updated when accessed or when it may have reached 0
+	void sysTickUpdate();
+	uint32_t stCtrl = 0, stLoad = 0, stVal = 0;
+	uint64_t stLast = 0;
+
+	uint32_t load(uint32_t addr, int size);
+	void store(uint32_t addr, uint32_t data, int size);
+	uint32_t ppbRead(uint32_t addr);
+	void ppbWrite(uint32_t addr, uint32_t data);
+
+	uint32_t addWithCarry(uint32_t a, uint32_t b, uint32_t carry);
+	bool condition(unsigned cond) const;
+	void setNZ(uint32_t result) { n = (result >> 31) != 0; z = (result == 0); }
+	uint32_t xpsr() const;
+	void branchWritePC(uint32_t addr);		// BX, BLX, POP and LDR PC: may be an exception return
+	int pendingException();							// highest priority pending and enabled, or 0
+	void enterException(int number, uint32_t returnAddr);
+	void exceptionReturn(uint32_t excReturn);
+	void raiseFault(const std::string &why);
+	bool faulted = false;								// set by a fault during the current instruction
+	uint32_t lastPc = 0;								// for counting instruction fetches
+	void execute16(uint16_t op);
+	void execute32(uint16_t op, uint16_t op2);
+};
+
+#endif
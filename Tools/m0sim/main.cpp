@@ -0,0 +1,453 @@
+/*  main.cpp
+	m0sim - instruction-set simulator for the Cortex-M0 SoC, for profiling the firmware.
+	Boots the firmware image from its vector table, as the processor does after
+	reset, and runs it on models of the processor (ARMv6-M, with the Cortex-M0
+	cycle counts, NVIC and SysTick) and of the peripherals in AHBliteTop.v.  The
+	accelerometer is the model in Software/host/adxl362_model.c, so bit-banged
+	GPIO, AHBspi and the sampling engine all see the same device.
+	Characters sent by the firmware are written to standard output, and standard
+	input is sent to the UART (a newline is sent as CR, like a terminal).
+	At the end, standard error gets a report: cycles, instructions and time at
+	50 MHz, then with a .map file, the functions with the most cycles (self and
+	inclusive, from a shadow call stack), and the instructions with the most
+	cycles, with the text from disasm.txt if given.  This runs at tens of millions
+	of instructions per second, so whole minutes of board time can be profiled,
+	where the Verilator model gives milliseconds.
+
+	Build:	make		(see Makefile)
+	Use:	m0sim [options] image
+			image is ROMcode.txt (one hex word per line), an Intel .hex file, or the .axf
+		--map file		symbols from the linker map, for the function report
+		--disasm file	instruction text from fromelf -c, for the hot spot report
+		--cycles n		stop after n clock cycles (default 100000000, 2 s)
+		--loop name		function called once per main loop, for cycles per loop
+						(default displayValue, if in the map)
+		--loops n		stop after n calls of the loop function
+		--sw hex		switch settings	--btn hex	buttons held, {U, D, L, C, R}
+		--send text		send text to the UART at the start (\r for CR)
+		--no-stdin		do not read standard input
+		--acl file		accelerometer stimulus, as Hardware/Testbench/adxl362_stim.txt
+		--top n			lines in each report table (default 20)
+		--mul-cycles n	cycles for MULS: 1 (default) or 32, as configured in the processor
+	Example:	m0sim --map temp_files/DES_M0_SoC.map --disasm temp_files/disasm.txt
+					--no-stdin --cycles 50000000 ROMcode.txt
+
+	April 2023 - SoC Group 14
+*/
+
+#include "m0sim.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <poll.h>
+#include <unistd.h>
+
+static const uint64_t INPUT_POLL_CYCLES = 500000;		// 10 ms between checks of standard input
+
+// ================================ Program image ================================
+
+// ROMcode.txt: one 32-bit word per line, in hex, from address 0
+static bool loadWords(const std::string &path, Soc &soc) {
+	std::ifstream in(path);
+	std::string line;
+	uint32_t addr = 0;
+	if (!in) return false;
+	while (std::getline(in, line) && addr < ROM_WORDS) {
+		if (line.find_first_of("0123456789abcdefABCDEF") == std::string::npos) continue;
+		soc.rom[addr++] = (uint32_t)std::stoul(line, nullptr, 16);
+	}
+	return addr > 0;
+}
+
+static void storeByte(Soc &soc, uint32_t addr, uint8_t b) {
+	std::vector<uint32_t> &m = (addr >> 24) == 0x20 ? soc.ram : soc.rom;
+	uint32_t i = (addr & 0xFFFFFF) >> 2;
+	if (i >= m.size()) return;
+	m[i] = (m[i] & ~(0xFFu << 8 * (addr & 3))) | ((uint32_t)b << 8 * (addr & 3));
+}
+
+// Intel hex, as written by fromelf --i32
+static bool loadHex(const std::string &path, Soc &soc) {
+	std::ifstream in(path);
+	std::string line;
+	uint32_t base = 0, bytes = 0;
+	if (!in) return false;
+	while (std::getline(in, line)) {
+		if (line.size() < 11 || line[0] != ':') continue;
+		unsigned count = std::stoul(line.substr(1, 2), nullptr, 16);
+		unsigned offset = std::stoul(line.substr(3, 4), nullptr, 16);
+		unsigned type = std::stoul(line.substr(7, 2), nullptr, 16);
+		if (line.size() < 11 + 2 * count) return false;
+		if (type == 0) {
+			for (unsigned i = 0; i < count; i++)
+				storeByte(soc, base + offset + i, (uint8_t)std::stoul(line.substr(9 + 2 * i, 2), nullptr, 16));
+			bytes += count;
+		}
+		else if (type == 4) base = std::stoul(line.substr(9, 4), nullptr, 16) << 16;
+		else if (type == 2) base = std::stoul(line.substr(9, 4), nullptr, 16) << 4;
+		else if (type == 1) break;
+	}
+	return bytes > 0;
+}
+
+// ELF (.axf): the loadable segments, at their load addresses
+static bool loadElf(const std::string &path, Soc &soc) {
+	std::ifstream in(path, std::ios::binary);
+	std::vector<uint8_t> f((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	auto get32 = [&](size_t p) { return (uint32_t)(f[p] | (f[p+1] << 8) | (f[p+2] << 16) | ((uint32_t)f[p+3] << 24)); };
+	auto get16 = [&](size_t p) { return (uint32_t)(f[p] | (f[p+1] << 8)); };
+	if (f.size() < 52 || std::memcmp(f.data(), "\177ELF", 4) != 0 || f[4] != 1) return false;
+	uint32_t phoff = get32(28), phentsize = get16(42), phnum = get16(44);
+	bool any = false;
+	for (uint32_t i = 0; i < phnum; i++) {
+		size_t ph = phoff + (size_t)i * phentsize;
+		if (ph + 32 > f.size() || get32(ph) != 1) continue;		// PT_LOAD
+		uint32_t offset = get32(ph + 4), paddr = get32(ph + 12), filesz = get32(ph + 16);
+		if ((size_t)offset + filesz > f.size()) return false;
+		for (uint32_t j = 0; j < filesz; j++) storeByte(soc, paddr + j, f[offset + j]);
+		any = true;
+	}
+	return any;
+}
+
+static bool endsWith(const std::string &s, const std::string &end) {
+	return s.size() >= end.size() && s.compare(s.size() - end.size(), end.size(), end) == 0;
+}
+
+// ================================ Symbols and disassembly ================================
+
+struct Symbol {
+	uint32_t addr, size;
+	std::string name;
+};
+
+// Thumb Code lines from the Image Symbol Table of the linker map
+static std::vector<Symbol> loadMap(const std::string &path) {
+	std::ifstream in(path);
+	std::vector<Symbol> syms;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.find("Thumb Code") == std::string::npos) continue;
+		std::istringstream ls(line);
+		std::string name, addr, kind1, kind2;
+		uint32_t size;
+		if (!(ls >> name >> addr >> kind1 >> kind2 >> size) || size == 0) continue;
+		syms.push_back({(uint32_t)std::stoul(addr, nullptr, 16) & ~1u, size, name});
+	}
+	std::sort(syms.begin(), syms.end(), [](const Symbol &a, const Symbol &b) { return a.addr < b.addr; });
+	return syms;
+}
+
+// Instruction text from fromelf -c, by address
+static std::map<uint32_t, std::string> loadDisasm(const std::string &path) {
+	std::ifstream in(path);
+	std::map<uint32_t, std::string> text;
+	std::string line;
+	while (std::getline(in, line)) {
+		size_t p = line.find("0x");
+		if (p == std::string::npos || line.size() < p + 11 || line[p + 10] != ':') continue;
+		if (line.find_first_not_of(" \t") != p) continue;
+		size_t t = p + 10 + 25;						// after the hex and character columns
+		if (line.size() <= t) continue;
+		std::string s = line.substr(t);
+		while (!s.empty() && (s.back() == '\r' || s.back() == ' ')) s.pop_back();
+		text[(uint32_t)std::stoul(line.substr(p, 10), nullptr, 16)] = s;
+	}
+	return text;
+}
+
+// x y z temperature per line, as read by ADXL362_model.v
+static bool loadStim(const std::string &path, std::vector<AdxlSample> &samples) {
+	std::ifstream in(path);
+	int x, y, z, t;
+	if (!in) return false;
+	samples.clear();
+	while (in >> x >> y >> z >> t) samples.push_back({(int16_t)x, (int16_t)y, (int16_t)z, (int16_t)t});
+	return !samples.empty();
+}
+
+// Board tilting slowly, the same as the default in host_bench.c
+static void defaultStim(std::vector<AdxlSample> &samples) {
+	const double PI = 3.14159265358979;
+	for (int i = 0; i < 64; i++)
+		samples.push_back({(int16_t)std::lround(1000 * std::sin(2 * PI * i / 64)),
+			(int16_t)std::lround(100 * std::sin(2 * PI * i / 16)),
+			(int16_t)std::lround(1000 * std::cos(2 * PI * i / 64)), (int16_t)(350 + i / 16)});
+}
+
+// ================================ Profiler ================================
+
+class Profiler {
+public:
+	Profiler(const std::vector<Symbol> &s) : syms(s), calls(s.size() + 1), inclusive(s.size() + 1),
+		onStack(s.size() + 1), count(2 * (ROM_WORDS + RAM_WORDS)), cycles(2 * (ROM_WORDS + RAM_WORDS)) {}
+
+	// Index of the function containing addr, or syms.size() for none
+	size_t function(uint32_t addr) const {
+		auto it = std::upper_bound(syms.begin(), syms.end(), addr,
+			[](uint32_t a, const Symbol &s) { return a < s.addr; });
+		if (it == syms.begin()) return syms.size();
+		--it;
+		return addr < it->addr + it->size ? (size_t)(it - syms.begin()) : syms.size();
+	}
+
+	// Cycles used by one step of the processor that started at pc
+	void step(const Cpu &cpu, uint32_t pc, uint64_t used) {
+		const CpuEvents &ev = cpu.ev;
+		if (ev.sleep) {
+			sleep += used;
+			return;
+		}
+		if (ev.executed) {
+			size_t i = slot(pc);
+			count[i]++;
+			cycles[i] += used;
+		}
+		else if (ev.exception) cycles[slot(ev.target)] += used;		// entry counted in the handler
+		if (ev.call || ev.exception) {
+			size_t f = function(ev.target);
+			calls[f]++;
+			stack.push_back({f, ev.ret, cpu.sp(), cpu.cycles - (ev.exception ? used : 0)});
+			onStack[f]++;
+		}
+		while (!stack.empty() && cpu.pc() == stack.back().ret && cpu.sp() >= stack.back().sp) {
+			Frame &fr = stack.back();
+			if (--onStack[fr.func] == 0) inclusive[fr.func] += cpu.cycles - fr.start;	// outermost only
+			stack.pop_back();
+		}
+		if (stack.size() > 10000) stack.erase(stack.begin(), stack.begin() + 5000);	// lost track
+	}
+
+	void report(const Cpu &cpu, const std::map<uint32_t, std::string> &text, size_t top) {
+		uint64_t total = cpu.cycles ? cpu.cycles : 1;
+		// Self cycles and instructions per function
+		std::vector<uint64_t> self(syms.size() + 1), instr(syms.size() + 1);
+		for (size_t i = 0; i < cycles.size(); i++) {
+			if (!cycles[i] && !count[i]) continue;
+			size_t f = function(address(i));
+			self[f] += cycles[i];
+			instr[f] += count[i];
+		}
+		// Functions still running at the end
+		for (const Frame &fr : stack)
+			if (onStack[fr.func] && fr.start) {
+				inclusive[fr.func] += cpu.cycles - fr.start;
+				onStack[fr.func] = 0;
+			}
+		if (!syms.empty()) {
+			std::vector<size_t> order;
+			for (size_t f = 0; f <= syms.size(); f++) if (self[f] || calls[f]) order.push_back(f);
+			std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return self[a] > self[b]; });
+			std::fprintf(stderr, "\n%-28s %10s %12s %12s %6s %12s %6s\n", "function", "calls",
+				"instructions", "self cycles", "%", "inclusive", "%");
+			for (size_t k = 0; k < order.size() && k < top; k++) {
+				size_t f = order[k];
+				std::fprintf(stderr, "%-28.28s %10llu %12llu %12llu %6.2f %12llu %6.2f\n", name(f).c_str(),
+					(unsigned long long)calls[f], (unsigned long long)instr[f], (unsigned long long)self[f],
+					100.0 * self[f] / total, (unsigned long long)inclusive[f], 100.0 * inclusive[f] / total);
+			}
+			if (sleep)
+				std::fprintf(stderr, "%-28s %10s %12s %12llu %6.2f\n", "(asleep, WFI)", "", "",
+					(unsigned long long)sleep, 100.0 * sleep / total);
+		}
+		// Hot spots
+		std::vector<size_t> hot;
+		for (size_t i = 0; i < cycles.size(); i++) if (cycles[i]) hot.push_back(i);
+		std::sort(hot.begin(), hot.end(), [&](size_t a, size_t b) { return cycles[a] > cycles[b]; });
+		std::fprintf(stderr, "\n%-10s %-28s %12s %12s %6s  %s\n", "address", "function", "executed",
+			"cycles", "%", "instruction");
+		for (size_t k = 0; k < hot.size() && k < top; k++) {
+			uint32_t a = address(hot[k]);
+			size_t f = function(a);
+			char where[64];
+			if (f < syms.size()) std::snprintf(where, sizeof where, "%s+0x%x", syms[f].name.c_str(), a - syms[f].addr);
+			else std::snprintf(where, sizeof where, "?");
+			auto t = text.find(a);
+			std::fprintf(stderr, "0x%08X %-28.28s %12llu %12llu %6.2f  %s\n", a, where,
+				(unsigned long long)count[hot[k]], (unsigned long long)cycles[hot[k]],
+				100.0 * cycles[hot[k]] / total, t == text.end() ? "" : t->second.c_str());
+		}
+	}
+
+	std::string name(size_t f) const { return f < syms.size() ? syms[f].name : "(no symbol)"; }
+	uint64_t callsOf(size_t f) const { return calls[f]; }
+
+private:
+	struct Frame {
+		size_t func;
+		uint32_t ret, sp;
+		uint64_t start;
+	};
+	// Halfword slots: ROM first, then RAM
+	static size_t slot(uint32_t pc) {
+		if ((pc >> 24) == 0x20) return 2 * ROM_WORDS + ((pc & 0xFFFFFF) >> 1) % (2 * RAM_WORDS);
+		return (pc >> 1) % (2 * ROM_WORDS);
+	}
+	static uint32_t address(size_t i) {
+		return i < 2 * ROM_WORDS ? (uint32_t)(i << 1) : 0x20000000 + (uint32_t)((i - 2 * ROM_WORDS) << 1);
+	}
+	const std::vector<Symbol> &syms;
+	std::vector<uint64_t> calls, inclusive;
+	std::vector<uint32_t> onStack;
+	std::vector<uint64_t> count, cycles;
+	std::vector<Frame> stack;
+	uint64_t sleep = 0;
+};
+
+// ================================ Main ================================
+
+static void usage() {
+	std::fprintf(stderr, "Usage: m0sim [--map file] [--disasm file] [--cycles n] [--loop name] [--loops n]\n"
+		"             [--sw hex] [--btn hex] [--send text] [--no-stdin] [--acl file] [--top n]\n"
+		"             [--mul-cycles n] image\n");
+	std::exit(2);
+}
+
+// Text for --send, with \r and \n
+static std::string unescape(const std::string &s) {
+	std::string out;
+	for (size_t i = 0; i < s.size(); i++) {
+		if (s[i] == '\\' && i + 1 < s.size()) {
+			char c = s[++i];
+			out += c == 'r' ? '\r' : c == 'n' ? '\n' : c;
+		}
+		else out += s[i];
+	}
+	return out;
+}
+
+// Bytes waiting on standard input, without blocking.  Returns false at end of file.
+static bool pollInput(Soc &soc, uint64_t now) {
+	struct pollfd p = {0, POLLIN, 0};
+	char buf[256];
+	while (poll(&p, 1, 0) > 0 && (p.revents & (POLLIN | POLLHUP))) {
+		ssize_t n = read(0, buf, sizeof buf);
+		if (n <= 0) return false;
+		for (ssize_t i = 0; i < n; i++) soc.uartIn.push_back(buf[i] == '\n' ? '\r' : (uint8_t)buf[i]);
+		soc.uartInputAdded(now);
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	std::string image, mapFile, disasmFile, stimFile, loopName = "displayValue", send;
+	uint64_t maxCycles = 100000000, maxLoops = 0;
+	size_t top = 20;
+	bool readStdin = true, loopGiven = false;
+	Soc soc;
+	Cpu cpu(soc);
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		bool more = i + 1 < argc;
+		if (a == "--map" && more) mapFile = argv[++i];
+		else if (a == "--disasm" && more) disasmFile = argv[++i];
+		else if (a == "--cycles" && more) maxCycles = std::strtoull(argv[++i], nullptr, 0);
+		else if (a == "--loop" && more) { loopName = argv[++i]; loopGiven = true; }
+		else if (a == "--loops" && more) maxLoops = std::strtoull(argv[++i], nullptr, 0);
+		else if (a == "--sw" && more) soc.switches = (uint16_t)std::strtoul(argv[++i], nullptr, 16);
+		else if (a == "--btn" && more) soc.buttons = (uint8_t)std::strtoul(argv[++i], nullptr, 16);
+		else if (a == "--send" && more) send = unescape(argv[++i]);
+		else if (a == "--no-stdin") readStdin = false;
+		else if (a == "--acl" && more) stimFile = argv[++i];
+		else if (a == "--top" && more) top = std::strtoul(argv[++i], nullptr, 0);
+		else if (a == "--mul-cycles" && more) cpu.mulCycles = std::strtoul(argv[++i], nullptr, 0);
+		else if (a[0] == '-' || !image.empty()) usage();
+		else image = a;
+	}
+	if (image.empty()) usage();
+
+	bool loaded = endsWith(image, ".hex") ? loadHex(image, soc)
+		: endsWith(image, ".axf") || endsWith(image, ".elf") ? loadElf(image, soc) : loadWords(image, soc);
+	if (!loaded) {
+		std::fprintf(stderr, "m0sim: cannot load %s\n", image.c_str());
+		return 2;
+	}
+	std::vector<Symbol> syms;
+	if (!mapFile.empty() && (syms = loadMap(mapFile)).empty())
+		std::fprintf(stderr, "m0sim: no symbols in %s\n", mapFile.c_str());
+	std::map<uint32_t, std::string> text;
+	if (!disasmFile.empty()) text = loadDisasm(disasmFile);
+	if (!stimFile.empty()) {
+		if (!loadStim(stimFile, soc.samples)) {
+			std::fprintf(stderr, "m0sim: cannot read %s\n", stimFile.c_str());
+			return 2;
+		}
+	}
+	else defaultStim(soc.samples);
+
+	Profiler prof(syms);
+	size_t loopFunc = syms.size();
+	for (size_t f = 0; f < syms.size(); f++) if (syms[f].name == loopName) loopFunc = f;
+	if (loopGiven && loopFunc == syms.size())
+		std::fprintf(stderr, "m0sim: loop function %s not in the map\n", loopName.c_str());
+
+	AdxlModelReset();
+	cpu.reset();
+	for (char c : send) soc.uartIn.push_back((uint8_t)c);
+	soc.uartInputAdded(0);
+
+	// Run
+	auto start = std::chrono::steady_clock::now();
+	uint64_t nextPoll = 0, firstLoop = 0, lastLoop = 0;
+	while (cpu.cycles < maxCycles && !cpu.lockedUp && !cpu.breakpoint) {
+		uint32_t pc = cpu.pc();
+		uint64_t before = cpu.cycles;
+		cpu.step();
+		prof.step(cpu, pc, cpu.cycles - before);
+		if (cpu.ev.call && loopFunc < syms.size() && (cpu.ev.target & ~1u) == syms[loopFunc].addr) {
+			if (prof.callsOf(loopFunc) == 1) firstLoop = cpu.cycles;
+			lastLoop = cpu.cycles;
+			if (maxLoops && prof.callsOf(loopFunc) >= maxLoops) break;
+		}
+		if (readStdin && cpu.cycles >= nextPoll) {
+			readStdin = pollInput(soc, cpu.cycles);
+			nextPoll = cpu.cycles + INPUT_POLL_CYCLES;
+		}
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::fflush(stdout);
+
+	// Report
+	double boardTime = cpu.cycles / CLOCK_HZ;
+	std::fprintf(stderr, "\n==== m0sim: %s\n", image.c_str());
+	if (cpu.lockedUp) std::fprintf(stderr, "Locked up: %s\n", cpu.fault.c_str());
+	else if (!cpu.fault.empty()) std::fprintf(stderr, "HardFault: %s\n", cpu.fault.c_str());
+	if (cpu.breakpoint) std::fprintf(stderr, "Stopped at BKPT, pc 0x%08X\n", cpu.pc());
+	std::fprintf(stderr, "Cycles %llu (%.3f ms at 50 MHz), instructions %llu, CPI %.2f, asleep %.1f%%\n",
+		(unsigned long long)cpu.cycles, boardTime * 1e3, (unsigned long long)cpu.instructions,
+		cpu.instructions ? (double)(cpu.cycles - cpu.sleepCycles) / cpu.instructions : 0.0,
+		cpu.cycles ? 100.0 * cpu.sleepCycles / cpu.cycles : 0.0);
+	std::fprintf(stderr, "Exceptions %llu, bus wait states %llu, unmapped accesses %llu\n",
+		(unsigned long long)cpu.exceptions, (unsigned long long)soc.waitCycles, (unsigned long long)soc.unmapped);
+	std::fprintf(stderr, "Host time %.3f s: %.1f million instructions/s, %.1f x real time\n", elapsed,
+		elapsed > 0 ? cpu.instructions / elapsed / 1e6 : 0.0, elapsed > 0 ? boardTime / elapsed : 0.0);
+	std::fprintf(stderr, "UART: %llu bytes sent, %llu received.  LEDs 0x%04X",
+		(unsigned long long)soc.uartTxBytes, (unsigned long long)soc.uartRxBytes, soc.leds);
+	if (soc.displayNumberUsed) {
+		long long v = soc.displayNumber, scale = 1;
+		for (uint32_t i = 0; i < soc.displayDecimals; i++) scale *= 10;
+		if (scale == 1) std::fprintf(stderr, ", display %lld", v);
+		else std::fprintf(stderr, ", display %s%lld.%0*lld", v < 0 ? "-" : "",
+			std::llabs(v) / scale, (int)soc.displayDecimals, std::llabs(v) % scale);
+	}
+	std::fprintf(stderr, "\nAccelerometer: %u SPI transactions, %u bytes",
+		AdxlModelTransactions(), AdxlModelBytes());
+	if (soc.smpSets) std::fprintf(stderr, ", sampling engine %llu sets (%llu lost)",
+		(unsigned long long)soc.smpSets, (unsigned long long)soc.smpLost);
+	std::fprintf(stderr, "\n");
+	if (loopFunc < syms.size()) {
+		uint64_t loops = prof.callsOf(loopFunc);
+		std::fprintf(stderr, "Main loop (%s): %llu calls", loopName.c_str(), (unsigned long long)loops);
+		if (loops > 1) std::fprintf(stderr, ", %.0f cycles each", (double)(lastLoop - firstLoop) / (loops - 1));
+		std::fprintf(stderr, "\n");
+	}
+	prof.report(cpu, text, top);
+	return cpu.lockedUp ? 1 : 0;
+}
@@ -0,0 +1,821 @@
+/*  soc.cpp
+	Memory map and peripheral models for m0sim - see m0sim.h.
+	The slaves are at the addresses decoded by AHBDCD.v, with the register maps in
+	the header comments of the Verilog files.  Only the timing the firmware can see
+	is modelled: the serial bit rate, the SPI byte time, the sampling engine
+	sequence, the arithmetic and CORDIC unit busy times, the DMA transfer rate, and
+	the wait states these cause.  The CORDIC results are calculated as the hardware
+	does, so they match it bit for bit.  The system has one processor, so the mailbox CPU ID is 0
+	and only processor 0 takes semaphores.  */
+
+#include "m0sim.h"
+
+static const size_t UART_FIFO_BYTES = 256;			// FIFO_AWIDTH = 8
+static const size_t SMP_BUFFER_SETS = 256;			// BUF_AWIDTH = 8
+static const uint32_t SMP_HOLDOFF = 15;				// cycles after a sequence before the next trigger
+static const uint32_t DIV_CYCLES = 34, MAC_CYCLES = 2;
+static const uint32_t CORDIC_CYCLES = 17;				// one pass: 16 iterations and the result
+static const uint64_t CYCLES_PER_US = 50;
+static const uint64_t DMA_CYCLES = 4;					// bus cycles per DMA transfer, read then write
+
+Soc::Soc() : rom(ROM_WORDS, 0), ram(RAM_WORDS, 0) {}
+
+// System reset: the peripherals return to their reset state, memory and the board do not
+void Soc::reset() {
+	Soc fresh;
+	fresh.rom.swap(rom);
+	fresh.ram.swap(ram);
+	fresh.samples.swap(samples);
+	fresh.uartIn.swap(uartIn);
+	fresh.uartOut = uartOut;
+	fresh.switches = switches;
+	fresh.buttons = buttons;
+	fresh.uartTxBytes = uartTxBytes;
+	fresh.uartRxBytes = uartRxBytes;
+	fresh.unmapped = unmapped;
+	*this = std::move(fresh);
+	rxNext = NEVER;
+}
+
+// ================================ Bus ================================
+
+uint32_t Soc::read(uint32_t addr, int size, uint64_t now, uint32_t &wait) {
+	if (!perfFrozen) perfReads[perfSlave(addr)]++;
+	uint32_t w = readWord(addr & ~3u, now, wait);
+	w >>= 8 * (addr & 3);
+	return size == 4 ? w : w & ((1u << (8 * size)) - 1);
+}
+
+void Soc::write(uint32_t addr, uint32_t data, int size, uint64_t now, uint32_t &wait) {
+	uint32_t mask = size == 4 ? 0xFFFFFFFF : ((1u << (8 * size)) - 1);
+	if (!perfFrozen) perfWrites[perfSlave(addr)]++;
+	writeLanes(addr & ~3u, data << 8 * (addr & 3), mask << 8 * (addr & 3), now, wait);
+}
+
+uint32_t Soc::readWord(uint32_t addr, uint64_t now, uint32_t &wait) {
+	uint32_t offset = addr & 0xFFFFFF;
+	if ((addr >> 24) == 0x00 && offset < ROM_WORDS * 4) return rom[offset >> 2];
+	if ((addr >> 24) == 0x20 && offset < RAM_WORDS * 4) return ram[offset >> 2];
+	irqValidUntil = 0;											// a peripheral access may change the lines
+	switch (addr >> 24) {
+	case 0x50:													// GPIO
+		advance(now);
+		switch (offset & 0x3C) {
+			case 0x08: return switches;
+			case 0x0C: return ((uint32_t)miso << 15) | (buttons & 0x1F);
+			case 0x28: return gpioRise;
+			case 0x2C: return gpioFall;
+			case 0x30: return gpioEvents;
+			case 0x34: return gpioDebounce;
+			case 0x38: return ((uint32_t)miso << 31) | ((uint32_t)(buttons & 0x1F) << 16) | switches;
+			case 0x3C: return 0;
+			default:   return (offset & 0x4) ? gpioOut1 : leds;	// outputs and their aliases
+		}
+	case 0x51:													// UART
+		advance(now);
+		switch (offset & 0x3F) {
+		case 0x00:
+			if (rxFifo.empty()) return 0;
+			else {
+				uint8_t b = rxFifo.front();
+				rxFifo.pop_front();
+				rxLast = now;										// restarts the idle timeout
+				return b;
+			}
+		case 0x04: return txFifo.empty() ? 0 : txFifo.front();
+		case 0x08: return uartStatus(now);
+		case 0x0C: return uartCtl;
+		case 0x10: return uartIncr;
+		case 0x14: return uartRxLevel;
+		case 0x18: return uartTxLevel;
+		case 0x1C: return uartTimeout;
+		case 0x20: return (uint32_t)rxFifo.size() | ((uint32_t)txFifo.size() << 16);
+		default:   return 0;
+		}
+	case 0x52:													// display
+		offset &= 0x1F;
+		if (offset == 0xC) return (uint32_t)displayNumber;
+		if (offset == 0x10) return displayDecimals;
+		if (offset < 0xC) {
+			uint32_t w = 0;
+			for (int i = 0; i < 4; i++)
+				if ((offset & 0xC) + i < 11) w |= (uint32_t)displayReg[(offset & 0xC) + i] << (8 * i);
+			return w;
+		}
+		return 0;
+	case 0x53:													// SPI
+		advance(now);
+		switch (offset & 0xF) {
+		case 0x0:
+			if (spiDone != NEVER) {							// wait for the byte to finish
+				stall(spiDone - now, wait);
+				advance(spiDone);
+			}
+			return spiData;
+		case 0x4:
+			return (spiDone != NEVER ? 1 : 0) | (slaveSelected ? 2 : 0)
+				| (AdxlModelInt1() ? 4 : 0) | (AdxlModelInt2() ? 8 : 0);
+		case 0x8: return spiCtl;
+		default:  return spiDiv;
+		}
+	case 0x54:													// sampling engine
+		advance(now);
+		switch (offset & 0x3F) {
+		case 0x00: return smpCtl;
+		case 0x04:
+			return (smpDone != NEVER ? 1 : 0) | (!smpBuf.empty() ? 2 : 0)
+				| (smpLevel && smpBuf.size() >= smpLevel ? 4 : 0) | (smpOverflow ? 8 : 0) | (smpLimited ? 16 : 0);
+		case 0x08: return smpPeriod;
+		case 0x0C: return smpLevel;
+		case 0x10: return (uint32_t)smpBuf.size();
+		case 0x14: return smpDiv;
+		case 0x18: return (uint32_t)(now / CYCLES_PER_US);
+		case 0x1C: return smpFilter;
+		case 0x20: return smpBuf.empty() ? 0 : smpBuf.front().time;
+		case 0x24:
+			if (smpBuf.empty()) return 0;
+			return (uint16_t)smpBuf.front().s.x | ((uint32_t)(uint16_t)smpBuf.front().s.y << 16);
+		case 0x28:
+			if (smpBuf.empty()) return 0;
+			else {
+				uint32_t w = (uint16_t)smpBuf.front().s.z | ((uint32_t)(uint16_t)smpBuf.front().s.temp << 16);
+				smpBuf.pop_front();
+				return w;
+			}
+		default: return 0;
+		}
+	case 0x55:													// arithmetic unit
+		if (((offset & 0x3F) >= 0x0C && (offset & 0x3F) <= 0x18) && arBusyUntil > now)
+			stall(arBusyUntil - now, wait);
+		switch (offset & 0x3F) {
+		case 0x00: return arA;
+		case 0x04: return arB;
+		case 0x08: return (arBusyUntil > now ? 1 : 0) | (arDivZero ? 2 : 0) | (arSaturated ? 4 : 0);
+		case 0x0C: return arResult;
+		case 0x10: return arRem;
+		case 0x14: return (uint32_t)arAcc;
+		case 0x18: return (uint32_t)(arAcc >> 32);
+		default:   return 0;
+		}
+	case 0x56:													// performance counters
+		perfUpdate(now);
+		offset &= 0xFF;
+		switch (offset) {
+		case 0x00: return perfFrozen ? 1 : 0;
+		case 0x04: return (uint32_t)perfTotal;
+		case 0x08: return (uint32_t)perfSleep;
+		case 0x0C: return 0;										// the simulation stops at lockup
+		case 0x10: return (uint32_t)perfWait;
+		case 0x14: {
+			uint64_t busy = perfWait;							// idle: no wait state and no transaction
+			for (int i = 0; i < PERF_SLAVES; i++) busy += perfReads[i] + perfWrites[i];
+			return (uint32_t)(perfTotal > busy ? perfTotal - busy : 0);
+		}
+		default:
+			if (offset >= 0x40 && offset < 0x40 + 8 * PERF_SLAVES)
+				return (uint32_t)((offset & 4) ? perfWrites[(offset - 0x40) >> 3] : perfReads[(offset - 0x40) >> 3]);
+			return 0;
+		}
+	case 0x57:													// DMA controller
+		advance(now);
+		offset &= 0x3F;
+		if (offset == 0x20)
+			return dmaDone | (dma[0].control & 1) << 8 | (dma[1].control & 1) << 9;
+		if (offset < 0x20) {
+			const DmaChannel &d = dma[offset >> 4];
+			switch (offset & 0xC) {
+			case 0x0: return d.src;
+			case 0x4: return d.dst;
+			case 0x8: return d.count;
+			default:  return d.control;
+			}
+		}
+		return 0;
+	case 0x58:													// mailbox
+		offset &= 0x3F;
+		if (offset >= 0x20) return 0;							// semaphore: always free to processor 0
+		switch (offset) {
+		case 0x04: return mboxFull;
+		case 0x08: return mboxIntEnable;
+		case 0x10:
+		case 0x14:
+			irqValidUntil = 0;
+			mboxFull &= ~(1u << ((offset >> 2) & 1));			// reading clears full
+			return mboxMessage[(offset >> 2) & 1];
+		default:   return 0;									// CPU ID and unused addresses
+		}
+	case 0x59:													// CORDIC unit
+		offset &= 0x3F;
+		if (offset >= 0x18 && offset <= 0x24 && cdBusyUntil > now)
+			stall(cdBusyUntil - now, wait);
+		switch (offset) {
+		case 0x00: return (uint32_t)(int32_t)cdX;
+		case 0x04: return (uint32_t)(int32_t)cdY;
+		case 0x08: return (uint32_t)(int32_t)cdZ;
+		case 0x0C: return cdBusyUntil > now ? 1 : 0;
+		case 0x18: return (uint32_t)(int32_t)cdAngle;
+		case 0x1C: return cdMag;
+		case 0x20: return (uint32_t)(int32_t)cdPitch;
+		case 0x24: return (uint32_t)(int32_t)cdRoll;
+		default:   return 0;
+		}
+	default:
+		break;
+	}
+	unmapped++;
+	return 0;
+}
+
+void Soc::writeLanes(uint32_t addr, uint32_t data, uint32_t mask, uint64_t now, uint32_t &wait) {
+	uint32_t offset = addr & 0xFFFFFF;
+	uint32_t merged;
+	if ((addr >> 24) == 0x20 && offset < RAM_WORDS * 4) {
+		uint32_t &w = ram[offset >> 2];
+		w = (w & ~mask) | (data & mask);
+		return;
+	}
+	if ((addr >> 24) == 0x00) return;							// ROM is read only
+	irqValidUntil = 0;
+	switch (addr >> 24) {
+	case 0x50:													// GPIO: byte, halfword or word
+		switch (offset & 0x3C) {								// edge detection, word writes only
+		case 0x28: gpioRise = data; return;
+		case 0x2C: gpioFall = data; return;
+		case 0x30: gpioEvents &= ~data; return;
+		case 0x34: gpioDebounce = data & 0xFFFF; return;
+		}
+		merged = (offset & 0x4) ? gpioOut1 : leds;
+		switch (offset & 0x38) {
+		case 0x00: merged = (merged & ~mask) | (data & mask); break;
+		case 0x10: merged |= data & mask; break;				// set alias
+		case 0x18: merged &= ~(data & mask); break;				// clear alias
+		case 0x20: merged ^= data & mask; break;				// toggle alias
+		default:   return;										// inputs are read only
+		}
+		if (offset & 0x4) {
+			advance(now);
+			spiPins((uint16_t)merged);
+			adxlSchedule(now);
+		}
+		else leds = (uint16_t)merged;
+		return;
+	case 0x51:													// UART: byte lanes are ignored
+		advance(now);
+		switch (offset & 0x3F) {
+		case 0x04:
+			if (txFifo.size() >= UART_FIFO_BYTES) return;		// full: byte lost
+			uartTxBytes++;
+			if (txFifo.empty() && txFree <= now) {				// line idle: starts now
+				txFree = now + uartByteCycles();
+				fputc(data & 0xFF, uartOut);
+			}
+			else txFifo.push_back((uint8_t)data);
+			return;
+		case 0x0C: uartCtl = data & 0x7F; return;
+		case 0x10: uartIncr = data & 0xFFFFF; return;
+		case 0x14: uartRxLevel = data & 0x1FFF; return;
+		case 0x18: uartTxLevel = data & 0x1FFF; return;
+		case 0x1C: uartTimeout = data & 0xFF; return;
+		default:   return;
+		}
+	case 0x52:													// display: registers 0 to 9, control, the number and decimals
+		displayWrites++;
+		offset &= 0x1F;
+		if (offset == 0xC) {
+			displayNumber = (int32_t)data;
+			displayNumberUsed = true;
+			return;
+		}
+		if (offset >= 0x10) {
+			if (offset == 0x10 && (mask & 0xFF)) displayDecimals = data & 7;
+			return;
+		}
+		for (int i = 0; i < 4; i++)
+			if ((mask >> (8 * i)) & 0xFF && (offset & 0xC) + i < 11)
+				displayReg[(offset & 0xC) + i] = (uint8_t)(data >> (8 * i));
+		displayReg[10] &= 1;									// only the buffered bit reads back
+		return;
+	case 0x53:													// SPI
+		advance(now);
+		switch (offset & 0xC) {
+		case 0x0:
+			if (spiDone != NEVER || (smpCtl & 1)) return;		// busy, or the engine has the pins
+			if (!slaveSelected) AdxlModelSelect(1);
+			slaveSelected = true;
+			spiTx = (uint8_t)data;
+			spiRx = AdxlModelOut();
+			spiDone = now + 16 * ((uint64_t)spiDiv + 1) + 2;
+			return;
+		case 0x8:
+			spiCtl = data & 0x0D;
+			if ((spiCtl & 1) && !slaveSelected && !(smpCtl & 1)) {
+				AdxlModelSelect(1);
+				slaveSelected = true;
+			}
+			else if (!(spiCtl & 1) && slaveSelected && spiDone == NEVER) {
+				AdxlModelSelect(0);
+				slaveSelected = false;
+			}
+			return;
+		case 0xC:
+			spiDiv = (uint8_t)data;
+			return;
+		default:
+			return;
+		}
+	case 0x54:													// sampling engine
+		advance(now);
+		switch (offset & 0x3F) {
+		case 0x00:
+			if ((data & 1) && !(smpCtl & 1)) {
+				smpTimerNext = now + smpPeriod;
+				smpPending = false;
+			}
+			if (!(data & 1)) {
+				smpTimerNext = NEVER;
+				smpPending = false;
+				smpDone = NEVER;
+				smpGroup = 0;									// the filter starts again
+				smpPrimed = false;
+			}
+			smpCtl = data & 0xF;
+			smpTrigger(now);
+			return;
+		case 0x04:
+			if (data & 8) smpOverflow = false;
+			if (data & 16) smpLimited = false;
+			return;
+		case 0x08: smpPeriod = data & 0xFFFFFF; return;
+		case 0x0C: smpLevel = data & 0x1FFF; return;
+		case 0x14: smpDiv = data & 0xFF; return;
+		case 0x1C:
+			smpFilter = data & 0x1FFF;
+			smpGroup = 0;
+			smpPrimed = false;
+			return;
+		default:   return;
+		}
+	case 0x55:													// arithmetic unit
+		offset &= 0x3F;
+		if (offset >= 0x14 && arBusyUntil > now) {		// operations and accumulator wait
+			stall(arBusyUntil - now, wait);
+			now = arBusyUntil;
+		}
+		switch (offset) {
+		case 0x00: arA = data; return;
+		case 0x04: arB = data; return;
+		case 0x14: arAcc = (arAcc & 0xFFFFFFFF00000000ull) | data; return;
+		case 0x18: arAcc = (arAcc & 0xFFFFFFFFull) | ((uint64_t)data << 32); return;
+		case 0x20: case 0x24:
+			arB = data;
+			arDivZero = (data == 0);
+			if (arDivZero) {
+				arResult = 0xFFFFFFFF;
+				arRem = arA;
+			}
+			else if (offset == 0x20) {
+				arResult = arA / arB;
+				arRem = arA % arB;
+			}
+			else if (arA == 0x80000000 && arB == 0xFFFFFFFF) {	// the one overflow case
+				arResult = 0x80000000;
+				arRem = 0;
+			}
+			else {
+				arResult = (uint32_t)((int32_t)arA / (int32_t)arB);
+				arRem = (uint32_t)((int32_t)arA % (int32_t)arB);
+			}
+			arBusyUntil = now + DIV_CYCLES;
+			return;
+		case 0x28:
+			arB = data;
+			arAcc += (uint64_t)arA * arB;
+			arBusyUntil = now + MAC_CYCLES;
+			return;
+		case 0x2C:
+			arB = data;
+			arAcc += (uint64_t)((int64_t)(int32_t)arA * (int32_t)arB);
+			arBusyUntil = now + MAC_CYCLES;
+			return;
+		case 0x30: {
+			arB = data;
+			int64_t sum = (int64_t)(int32_t)arA + (int32_t)arB;
+			arSaturated = sum > INT32_MAX || sum < INT32_MIN;
+			arResult = (uint32_t)(int32_t)(sum > INT32_MAX ? INT32_MAX : sum < INT32_MIN ? INT32_MIN : sum);
+			arBusyUntil = now + 1;
+			return;
+		}
+		default:
+			return;
+		}
+	case 0x56:													// performance counters
+		if ((offset & 0xFF) == 0) {
+			perfUpdate(now);
+			if (data & 2) {
+				perfTotal = perfSleep = perfWait = 0;
+				for (int i = 0; i < PERF_SLAVES; i++) perfReads[i] = perfWrites[i] = 0;
+			}
+			perfFrozen = (data & 1) != 0;
+		}
+		return;
+	case 0x57:													// DMA controller, word registers
+		advance(now);
+		offset &= 0x3F;
+		if (offset == 0x20) dmaDone &= ~data;
+		else if (offset < 0x20) {
+			DmaChannel &d = dma[offset >> 4];
+			switch (offset & 0xC) {
+			case 0x0: d.src = d.srcStart = data; break;
+			case 0x4: d.dst = data; break;
+			case 0x8: d.count = data & 0xFFFF; break;
+			default:
+				d.control = data & 0xFFFF;
+				if (data & 1) dmaDone &= ~(1u << (offset >> 4));	// a new start clears done
+				break;
+			}
+		}
+		dmaSchedule(now);
+		return;
+	case 0x58:													// mailbox
+		offset &= 0x3F;
+		if (offset == 0x08) mboxIntEnable = data & 3;
+		else if (offset == 0x10 || offset == 0x14) {
+			mboxMessage[(offset >> 2) & 1] = data;
+			mboxFull |= 1u << ((offset >> 2) & 1);
+		}
+		return;
+	case 0x59:													// CORDIC unit
+		offset &= 0x3F;
+		if ((offset == 0x10 || offset == 0x14) && cdBusyUntil > now) {	// operations wait
+			stall(cdBusyUntil - now, wait);
+			now = cdBusyUntil;
+		}
+		switch (offset) {
+		case 0x00: cdX = (int16_t)data; return;
+		case 0x04: cdY = (int16_t)data; return;
+		case 0x08: cdZ = (int16_t)data; return;
+		case 0x10: {
+			int64_t length;
+			cdAngle = cordicPass((int64_t)cdX << CORDIC_FRAC, (int64_t)cdY << CORDIC_FRAC, length);
+			cdMag = cordicRound(length);
+			cdBusyUntil = now + CORDIC_CYCLES;
+			return;
+		}
+		case 0x14: {
+			int64_t length;
+			cdRoll = cordicPass((int64_t)cdZ << CORDIC_FRAC, (int64_t)cdY << CORDIC_FRAC, length);
+			cdPitch = cordicPass(length, (int64_t)cdX << CORDIC_FRAC, length);
+			cdMag = cordicRound(length);
+			cdBusyUntil = now + 2 * CORDIC_CYCLES;
+			return;
+		}
+		default:
+			return;
+		}
+	default:
+		break;
+	}
+	unmapped++;
+}
+
+// ================================ CORDIC unit ================================
+
+// atan(2^-i) in 1/25600 degree, as in AHBcordic.v
+static const int32_t CORDIC_ATAN[16] = {
+	1152000, 680065, 359328, 182400, 91554, 45822, 22916, 11459,
+	5730, 2865, 1432, 716, 358, 179, 90, 45
+};
+static const int32_t CORDIC_180 = 4608000;
+static const int64_t CORDIC_INV_GAIN = 39797;		// 65536 / gain
+
+/* One pass in vectoring mode, from the vector (x, y) with CORDIC_FRAC fraction bits:
+   returns the angle in hundredths of a degree and sets the length, still with the
+   fraction bits.  The registers are wide enough that nothing overflows.  */
+int16_t Soc::cordicPass(int64_t x, int64_t y, int64_t &length) {
+	bool zero = (x == 0 && y == 0);
+	int32_t z = 0;
+	if (x < 0) {												// turn through 180 degrees
+		z = y < 0 ? -CORDIC_180 : CORDIC_180;
+		x = -x;
+		y = -y;
+	}
+	for (int i = 0; i < 16; i++) {
+		int64_t xs = x >> i, ys = y >> i;					// arithmetic shifts
+		if (y >= 0) {
+			x += ys;
+			y -= xs;
+			z += CORDIC_ATAN[i];
+		}
+		else {
+			x -= ys;
+			y += xs;
+			z -= CORDIC_ATAN[i];
+		}
+	}
+	length = (x * CORDIC_INV_GAIN) >> 16;
+	return zero ? 0 : (int16_t)((z + 128) >> 8);
+}
+
+uint16_t Soc::cordicRound(int64_t length) {
+	return (uint16_t)((length + (1 << (CORDIC_FRAC - 1))) >> CORDIC_FRAC);
+}
+
+// ================================ Performance counters ================================
+
+// Slave number from AHBDCD, for the performance counters
+int Soc::perfSlave(uint32_t addr) {
+	uint32_t top = addr >> 24;
+	if (top == 0x00) return 0;
+	if (top == 0x20) return 1;
+	if (top >= 0x50 && top <= 0x59) return (int)(top - 0x50) + 2;
+	return PERF_SLAVES - 1;
+}
+
+void Soc::perfUpdate(uint64_t now) {
+	if (!perfFrozen) perfTotal += now - perfLast;
+	perfLast = now;
+}
+
+// HREADY low for n cycles
+void Soc::stall(uint64_t n, uint32_t &wait) {
+	wait += (uint32_t)n;
+	waitCycles += n;
+	if (!perfFrozen) perfWait += n;
+}
+
+void Soc::countFetch(uint32_t addr) {
+	if (!perfFrozen) perfReads[perfSlave(addr)]++;
+}
+
+void Soc::countSleep(uint64_t n) {
+	if (!perfFrozen) perfSleep += n;
+}
+
+// ================================ Bit-banged SPI ================================
+
+/* SPI mode 0 through GPIO output port 1: bit 0 slave select (active low), bit 1 SCK,
+   bit 2 MOSI.  MISO is input port 1 bit 15.  The slave sees a byte at a time, so the
+   MISO byte is taken from the model before the first clock edge of each byte.  */
+void Soc::spiPins(uint16_t out1) {
+	uint16_t old = gpioOut1;
+	gpioOut1 = out1;
+	bool ss = !(out1 & 1), sckRise = (out1 & 2) && !(old & 2), sckFall = !(out1 & 2) && (old & 2);
+	if (ss && !slaveSelected) {
+		AdxlModelSelect(1);
+		slaveSelected = true;
+		bitCount = 0;
+		misoByte = AdxlModelOut();
+		misoLoaded = true;
+	}
+	else if (!ss && slaveSelected) {
+		AdxlModelSelect(0);
+		slaveSelected = false;
+		misoLoaded = false;
+		miso = true;
+		return;
+	}
+	if (!ss) return;
+	if (sckRise) {
+		rxByte = (uint8_t)((rxByte << 1) | ((out1 >> 2) & 1));
+		if (++bitCount == 8) {
+			AdxlModelIn(rxByte);
+			bitCount = 0;
+			misoLoaded = false;
+		}
+	}
+	else if (sckFall && bitCount == 0 && !misoLoaded) {
+		misoByte = AdxlModelOut();
+		misoLoaded = true;
+	}
+	miso = (misoByte >> (7 - bitCount)) & 1;
+}
+
+// ================================ Timed events ================================
+
+void Soc::adxlSchedule(uint64_t now) {
+	uint64_t period = (uint64_t)AdxlModelPeriodUs() * CYCLES_PER_US;
+	if (period == 0) adxlNext = NEVER;
+	else if (adxlNext == NEVER) adxlNext = now + period;
+}
+
+void Soc::uartInputAdded(uint64_t now) {
+	if (rxNext == NEVER && !uartIn.empty()) rxNext = now + uartByteCycles();
+	irqValidUntil = 0;
+}
+
+void Soc::uartUpdate(uint64_t now) {
+	while (!txFifo.empty() && txFree <= now) {
+		fputc(txFifo.front(), uartOut);
+		txFifo.pop_front();
+		txFree += uartByteCycles();
+	}
+	while (rxNext <= now) {
+		if (rxFifo.size() < UART_FIFO_BYTES) rxFifo.push_back(uartIn.front());
+		uartIn.pop_front();
+		uartRxBytes++;
+		rxLast = rxNext;
+		rxNext = uartIn.empty() ? NEVER : rxNext + uartByteCycles();
+	}
+}
+
+uint8_t Soc::uartStatus(uint64_t now) {
+	uint64_t timeout = (uint64_t)uartTimeout * uartByteCycles() / 10;
+	return (txFifo.size() >= UART_FIFO_BYTES ? 0x01 : 0)
+		| (txFifo.empty() ? 0x02 : 0)
+		| (rxFifo.size() >= UART_FIFO_BYTES ? 0x04 : 0)
+		| (!rxFifo.empty() ? 0x08 : 0)
+		| (uartRxLevel && rxFifo.size() >= uartRxLevel ? 0x10 : 0)
+		| (uartTxLevel && txFifo.size() < uartTxLevel ? 0x20 : 0)
+		| (uartTimeout && !rxFifo.empty() && now - rxLast >= timeout ? 0x40 : 0);
+}
+
+// Start a sampling sequence if there is a trigger and the engine is free
+void Soc::smpTrigger(uint64_t now) {
+	if (!(smpCtl & 1) || smpDone != NEVER || now < smpHoldoff) return;
+	bool go = (smpCtl & 2) ? AdxlModelInt1() != 0 : smpPending;
+	if (!go) return;
+	smpPending = false;
+	smpStamp = (uint32_t)(now / CYCLES_PER_US);
+	uint64_t bytes = (smpCtl & 4) ? 10 : 8;				// command, address, X, Y, Z, temperature
+	smpDone = now + 2 + bytes * (16 * ((uint64_t)smpDiv + 1) + 2) + 2;
+}
+
+// The sequence has finished: read the set from the model, filter it, and store the
+// filter output at the end of each group
+void Soc::smpFinish(uint64_t now) {
+	SmpSet set = {smpStamp, {0, 0, 0, 0}};
+	uint8_t d[8] = {0};
+	int n = (smpCtl & 4) ? 8 : 6;
+	AdxlModelSelect(1);
+	AdxlModelByte(0x0B);
+	AdxlModelByte(0x0E);
+	for (int i = 0; i < n; i++) d[i] = AdxlModelByte(0);
+	AdxlModelSelect(0);
+	set.s.x = (int16_t)(d[0] | (d[1] << 8));
+	set.s.y = (int16_t)(d[2] | (d[3] << 8));
+	set.s.z = (int16_t)(d[4] | (d[5] << 8));
+	set.s.temp = (int16_t)(d[6] | (d[7] << 8));
+	smpDone = NEVER;
+	smpHoldoff = now + SMP_HOLDOFF;
+	if (!smpFilterSet(set.s)) return;
+	if (smpBuf.size() >= SMP_BUFFER_SETS) {
+		smpBuf.pop_front();
+		smpOverflow = true;
+		smpLost++;
+	}
+	smpBuf.push_back(set);
+	smpSets++;
+}
+
+/* Add a set to the filters, as smp_filter.v: sums for the average, or IIR states with
+   16 fraction bits.  Returns true at the end of a group, with X, Y and Z replaced by
+   the filter outputs.  */
+bool Soc::smpFilterSet(AdxlSample &s) {
+	bool iir = (smpFilter >> 12) & 1;
+	bool restart = iir ? !smpPrimed : smpGroup == 0;
+	unsigned shift = (smpFilter >> 8) & 0xF;
+	int16_t *axis[3] = {&s.x, &s.y, &s.z};
+	int16_t out[3];
+	bool limited = false;
+	for (int i = 0; i < 3; i++) {
+		int64_t sample = iir ? (int64_t)*axis[i] * 65536 : *axis[i];
+		if (restart) smpAcc[i] = sample;
+		else if (iir) smpAcc[i] += (sample - smpAcc[i]) >> shift;	// arithmetic shifts
+		else smpAcc[i] += sample;
+		int64_t scaled = iir ? (smpAcc[i] + 32768) >> 16 : smpAcc[i] >> shift;
+		if (scaled > INT16_MAX || scaled < INT16_MIN) limited = true;
+		out[i] = (int16_t)(scaled > INT16_MAX ? INT16_MAX : scaled < INT16_MIN ? INT16_MIN : scaled);
+	}
+	smpPrimed = true;
+	if (smpGroup != (smpFilter & 0xFF)) {
+		smpGroup++;
+		return false;
+	}
+	smpGroup = 0;
+	for (int i = 0; i < 3; i++) *axis[i] = out[i];
+	if (limited) smpLimited = true;
+	return true;
+}
+
+// ================================ DMA controller ================================
+
+// Channel enabled, with transfers to do and its request active
+bool Soc::dmaReady(int ch) const {
+	const DmaChannel &d = dma[ch];
+	if (!(d.control & 1) || d.count == 0) return false;
+	switch ((d.control >> 8) & 7) {
+	case 0:  return true;
+	case 1:  return !rxFifo.empty();
+	case 2:  return txFifo.size() < UART_FIFO_BYTES;
+	case 3:  return !smpBuf.empty();
+	default: return false;
+	}
+}
+
+// Set the time of the next transfer, if there is one to do and none is set
+void Soc::dmaSchedule(uint64_t now) {
+	if (dmaNext != NEVER || dmaInStep) return;
+	bool burst = dmaBurstLeft && (dma[dmaCh].control & 1) && dma[dmaCh].count;
+	if (burst || dmaReady(0) || dmaReady(1)) dmaNext = now > dmaFree ? now : dmaFree;
+}
+
+/* One transfer, through the bus like the processor's accesses, so the peripherals see
+   it and the performance counters count it.  Channels take turns by burst, as in
+   AHBdma.v.  */
+void Soc::dmaStep(uint64_t now) {
+	dmaNext = NEVER;
+	if (!(dmaBurstLeft && (dma[dmaCh].control & 1) && dma[dmaCh].count)) {
+		int other = dmaCh ^ 1;
+		if (dmaReady(other)) dmaCh = other;
+		else if (!dmaReady(dmaCh)) return;
+		dmaBurstLeft = ((dma[dmaCh].control >> 12) & 0xF) + 1;
+	}
+	DmaChannel &d = dma[dmaCh];
+	int size = (d.control & 4) ? 4 : (d.control & 2) ? 2 : 1;
+	uint32_t wait = 0;
+	dmaInStep = true;
+	uint32_t data = read(d.src & ~(uint32_t)(size - 1), size, now, wait);
+	write(d.dst & ~(uint32_t)(size - 1), data, size, now + 2 + wait, wait);
+	dmaInStep = false;
+	dmaBurstLeft--;
+	if (d.control & 0x08) d.src = ((d.control & 0x40) && !dmaBurstLeft) ? d.srcStart : d.src + size;
+	if (d.control & 0x10) d.dst += size;
+	if (--d.count == 0) {
+		d.control &= ~1u;
+		dmaDone |= 1u << dmaCh;
+		dmaBurstLeft = 0;
+	}
+	irqValidUntil = 0;
+	dmaFree = now + DMA_CYCLES + wait;
+	dmaNext = NEVER;
+	dmaSchedule(dmaFree);
+}
+
+// Process everything that happens by itself up to now, in time order
+void Soc::advance(uint64_t now) {
+	for (;;) {
+		uint64_t t = adxlNext;
+		if (spiDone < t) t = spiDone;
+		if (smpDone < t) t = smpDone;
+		if (smpTimerNext < t) t = smpTimerNext;
+		if ((smpCtl & 3) == 3 && smpDone == NEVER && smpHoldoff > 0 && smpHoldoff < t) t = smpHoldoff;
+		if (dmaNext < t) t = dmaNext;
+		if (t > now) break;
+		if (t == smpHoldoff) smpHoldoff = 0;
+		if (t == adxlNext) {
+			if (!samples.empty()) AdxlModelSample(&samples[sampleIndex++ % samples.size()]);
+			adxlNext = NEVER;
+			adxlSchedule(t);
+		}
+		if (t == spiDone) {
+			AdxlModelIn(spiTx);
+			spiData = spiRx;
+			spiDone = NEVER;
+			if (!(spiCtl & 1)) {
+				AdxlModelSelect(0);
+				slaveSelected = false;
+			}
+			adxlSchedule(t);
+		}
+		if (t == smpDone) smpFinish(t);
+		if (t == smpTimerNext) {
+			smpPending = true;
+			smpTimerNext += smpPeriod ? smpPeriod : 1;
+		}
+		smpTrigger(t);
+		if (t == dmaNext) dmaStep(t);
+		dmaSchedule(t);							// a request may have become ready
+	}
+	uartUpdate(now);
+	dmaSchedule(now);
+}
+
+uint32_t Soc::irqLines(uint64_t now) {
+	if (now < irqValidUntil) return irqCache;
+	advance(now);
+	uint32_t spiStatus = (AdxlModelInt1() ? 4 : 0) | (AdxlModelInt2() ? 8 : 0);
+	irqCache = ((uartStatus(now) & uartCtl) ? (1u << 1) : 0)
+		| ((spiStatus & spiCtl & 0xC) ? (1u << 2) : 0)
+		| ((smpCtl & 8) && smpLevel && smpBuf.size() >= smpLevel ? (1u << 3) : 0)
+		| (gpioEvents ? (1u << 4) : 0)
+		| ((dmaDone & ((dma[0].control >> 5 & 1) | (dma[1].control >> 4 & 2))) ? (1u << 5) : 0)
+		| ((mboxFull & mboxIntEnable & 1) ? (1u << 6) : 0);
+	irqValidUntil = now + nextEvent(now);
+	return irqCache;
+}
+
+uint64_t Soc::nextEvent(uint64_t now) {
+	uint64_t t = adxlNext;
+	if (spiDone < t) t = spiDone;
+	if (smpDone < t) t = smpDone;
+	if (smpTimerNext < t) t = smpTimerNext;
+	if (smpHoldoff > now && smpHoldoff < t) t = smpHoldoff;
+	if (rxNext < t) t = rxNext;
+	if (!txFifo.empty() && txFree < t) t = txFree;
+	if (dmaNext < t) t = dmaNext;
+	if (uartTimeout && !rxFifo.empty()) {
+		uint64_t timeout = rxLast + (uint64_t)uartTimeout * uartByteCycles() / 10;
+		if (timeout > now && timeout < t) t = timeout;
+	}
+	return t == NEVER ? NEVER : (t > now ? t - now : 1);
+}
@@ -0,0 +1,173 @@
+/*  rom_pack.cpp
+	Converts a program image into the binary stream taken by the ROM loader
+	(see Hardware/Design/ram_loader.v for the stream format).
+	Input is the Intel hex file from Keil (DES_M0_SoC.hex) or the fromelf
+	word-per-line file (ROMcode.txt) - a line starting with ':' means Intel hex.
+	Zero words are sent as runs, other words as literal records, and the stream
+	ends with the CRC-32 of the image.  A summary is written to standard error.
+
+	Build:	g++ -O2 -std=c++11 -o rom_pack rom_pack.cpp
+	Use:	rom_pack DES_M0_SoC.hex rom.bin
+			then, with the loader active (BTNU held during reset), send rom.bin to
+			the serial port at 921600 bit/s, 8 bits, no parity, 1 stop bit, e.g.
+			stty -F /dev/ttyUSB1 921600 raw && cat rom.bin > /dev/ttyUSB1
+
+	April 2023 - SoC Group 14
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Stream format - must match Hardware/Design/ram_loader.v
+static const uint8_t BIN_START = 0xB5;
+static const uint8_t ZERO_RUN = 0x80;		// control byte bit 7 - run of zero words
+static const size_t MAX_RUN = 128;			// words in one record
+static const size_t ROM_WORDS = 8192;		// 32 kbyte ROM
+
+static const double LOAD_BAUD = 921600.0;	// loader bit rate in AHBliteTop
+static const double HEX_BAUD = 19200.0;		// previous ASCII hex loader bit rate
+
+// CRC-32 as used by zlib and Ethernet, one byte at a time
+static uint32_t crc32(uint32_t crc, uint8_t byte) {
+	crc ^= byte;
+	for (int b = 0; b < 8; b++)
+		crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+	return crc;
+}
+
+static int hexValue(const std::string &s, size_t pos, size_t digits, uint32_t &value) {
+	value = 0;
+	if (pos + digits > s.size()) return 0;
+	for (size_t i = pos; i < pos + digits; i++) {
+		char c = s[i];
+		int n;
+		if (c >= '0' && c <= '9') n = c - '0';
+		else if (c >= 'A' && c <= 'F') n = c - 'A' + 10;
+		else if (c >= 'a' && c <= 'f') n = c - 'a' + 10;
+		else return 0;
+		value = (value << 4) | n;
+	}
+	return 1;
+}
+
+// Store a byte in the image, which grows as needed
+static bool putByte(std::vector<uint32_t> &image, uint32_t addr, uint8_t byte) {
+	if (addr >= ROM_WORDS * 4) return false;
+	if (addr / 4 >= image.size()) image.resize(addr / 4 + 1, 0);
+	image[addr / 4] |= (uint32_t)byte << (8 * (addr % 4));	// little-endian
+	return true;
+}
+
+// Read an Intel hex record into the image - false if it is bad
+static bool readHexLine(const std::string &line, uint32_t &base, std::vector<uint32_t> &image) {
+	uint32_t count, addr, type, value;
+	if (!hexValue(line, 1, 2, count) || !hexValue(line, 3, 4, addr) || !hexValue(line, 7, 2, type))
+		return false;
+	uint8_t sum = count + (addr >> 8) + addr + type;
+	std::vector<uint8_t> data;
+	for (uint32_t i = 0; i <= count; i++) {			// data bytes then checksum
+		if (!hexValue(line, 9 + 2 * i, 2, value)) return false;
+		sum += value;
+		if (i < count) data.push_back(value);
+	}
+	if (sum != 0) return false;
+	switch (type) {
+	case 0:		// data
+		for (uint32_t i = 0; i < count; i++)
+			if (!putByte(image, base + addr + i, data[i])) return false;
+		return true;
+	case 2:		// extended segment address
+		base = ((data[0] << 8) | data[1]) << 4;
+		return count == 2;
+	case 4:		// extended linear address
+		base = ((data[0] << 8) | data[1]) << 16;
+		return count == 2;
+	default:	// end of file, start addresses - nothing to do
+		return true;
+	}
+}
+
+// Make the loader stream for the image
+static std::vector<uint8_t> pack(const std::vector<uint32_t> &image, uint32_t &crc) {
+	std::vector<uint8_t> out;
+	out.push_back(BIN_START);
+	out.push_back(image.size() & 0xFF);
+	out.push_back(image.size() >> 8);
+	crc = 0xFFFFFFFFu;
+	size_t i = 0;
+	while (i < image.size()) {
+		bool zero = (image[i] == 0);
+		size_t n = 1;
+		while (n < MAX_RUN && i + n < image.size() && (image[i + n] == 0) == zero)
+			n++;
+		out.push_back((zero ? ZERO_RUN : 0) | (uint8_t)(n - 1));
+		for (size_t j = i; j < i + n; j++)
+			for (int b = 0; b < 4; b++) {
+				uint8_t byte = image[j] >> (8 * b);
+				crc = crc32(crc, byte);
+				if (!zero) out.push_back(byte);
+			}
+		i += n;
+	}
+	crc = ~crc;
+	for (int b = 0; b < 4; b++)
+		out.push_back(crc >> (8 * b));
+	return out;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		std::cerr << "use: rom_pack DES_M0_SoC.hex rom.bin\n";
+		return 1;
+	}
+	std::ifstream in(argv[1]);
+	if (!in) {
+		std::cerr << "rom_pack: cannot open " << argv[1] << "\n";
+		return 1;
+	}
+
+	std::vector<uint32_t> image;
+	std::string line;
+	uint32_t base = 0;
+	unsigned long lineNo = 0;
+	while (std::getline(in, line)) {
+		lineNo++;
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty()) continue;
+		bool ok;
+		if (line[0] == ':')
+			ok = readHexLine(line, base, image);
+		else {										// one word per line, in address order
+			uint32_t word;
+			ok = (line.size() == 8) && hexValue(line, 0, 8, word) && (image.size() < ROM_WORDS);
+			if (ok) image.push_back(word);
+		}
+		if (!ok) {
+			std::cerr << "rom_pack: " << argv[1] << " line " << lineNo << " is bad or outside the ROM\n";
+			return 1;
+		}
+	}
+	if (image.empty()) {
+		std::cerr << "rom_pack: no data in " << argv[1] << "\n";
+		return 1;
+	}
+
+	uint32_t crc;
+	std::vector<uint8_t> stream = pack(image, crc);
+	std::ofstream out(argv[2], std::ios::binary);
+	out.write((const char *)stream.data(), stream.size());
+	if (!out) {
+		std::cerr << "rom_pack: cannot write " << argv[2] << "\n";
+		return 1;
+	}
+
+	size_t hexBytes = image.size() * 10;			// 8 hex digits and CR LF per word
+	std::fprintf(stderr, "rom_pack: %zu words, %zu bytes, CRC %08X\n", image.size(), stream.size(), crc);
+	std::fprintf(stderr, "rom_pack: %.2f s to load at %.0f bit/s (ASCII hex %.1f s at %.0f bit/s)\n",
+			stream.size() * 10 / LOAD_BAUD, LOAD_BAUD, hexBytes * 10 / HEX_BAUD, HEX_BAUD);
+	return 0;
+}
@@ -0,0 +1,100 @@
+/*  tlm_decode.cpp
+	Host-side decoder for the binary telemetry frames sent by the SoC
+	(see Software/telemetry.h for the frame format).
+	Reads a captured byte stream from the serial port (e.g. a RealTerm capture
+	file) and writes one CSV line per valid frame to standard output.
+	Text between frames (e.g. characters echoed by the SoC) is skipped by
+	searching for the sync word, and frames with a bad checksum are discarded.
+	A summary is written to standard error.
+
+	Build:	g++ -O2 -std=c++11 -o tlm_decode tlm_decode.cpp
+	Use:	tlm_decode capture.bin > samples.csv
+			tlm_decode < capture.bin > samples.csv
+
+	April 2023 - SoC Group 14
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+// Frame layout - must match Software/telemetry.h
+static const uint8_t SYNC0 = 0xA5;
+static const uint8_t SYNC1 = 0x5A;
+static const size_t FRAME_BYTES = 12;
+
+struct Frame {
+	uint8_t  seq;
+	uint16_t timestamp;
+	int16_t  x, y, z;
+};
+
+// Read a 16-bit value, LSB first
+static uint16_t get16(const uint8_t *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Check and unpack a frame starting at p (sync bytes already matched)
+static bool decodeFrame(const uint8_t *p, Frame &f) {
+	uint8_t sum = 0;
+	for (size_t i = 2; i < FRAME_BYTES; i++)	// sequence number to checksum
+		sum += p[i];
+	if (sum != 0) return false;
+	f.seq       = p[2];
+	f.timestamp = get16(p + 3);
+	f.x         = (int16_t)get16(p + 5);
+	f.y         = (int16_t)get16(p + 7);
+	f.z         = (int16_t)get16(p + 9);
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	std::vector<uint8_t> data;
+	if (argc > 1) {
+		std::ifstream in(argv[1], std::ios::binary);
+		if (!in) {
+			std::cerr << "tlm_decode: cannot open " << argv[1] << "\n";
+			return 1;
+		}
+		data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	else {
+		std::cin >> std::noskipws;
+		data.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+	}
+
+	unsigned long frames = 0, badSum = 0, missing = 0, skipped = 0;
+	bool first = true;
+	uint8_t lastSeq = 0;
+
+	std::printf("seq,timestamp,x_mg,y_mg,z_mg\n");
+	size_t i = 0;
+	while (i + FRAME_BYTES <= data.size()) {
+		Frame f;
+		if (data[i] != SYNC0 || data[i+1] != SYNC1) {
+			i++;							// hunt for the sync word
+			skipped++;
+			continue;
+		}
+		if (!decodeFrame(&data[i], f)) {
+			badSum++;						// not a frame, or corrupted - resync from next byte
+			i++;
+			skipped++;
+			continue;
+		}
+		if (!first)
+			missing += (uint8_t)(f.seq - lastSeq - 1);	// frames lost between these two
+		first = false;
+		lastSeq = f.seq;
+		std::printf("%u,%u,%d,%d,%d\n", f.seq, f.timestamp, f.x, f.y, f.z);
+		frames++;
+		i += FRAME_BYTES;
+	}
+
+	std::cerr << "tlm_decode: " << frames << " frames, " << badSum << " bad checksums, "
+			  << missing << " frames missing, " << skipped << " bytes skipped\n";
+	return 0;
+}